@@ -30,6 +30,7 @@
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/corestrings.h"
+#include "utils/trace.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/bitmap.h"
 #include "netsurf/content.h"
@@ -61,6 +62,9 @@ const char * const content_status_name[] = {
  *   CONTENT_MSG_READY is sent to all users.
  * - If the conversion succeeds and is complete, the content gets status
  *   CONTENT_STATUS_DONE, and CONTENT_MSG_READY then CONTENT_MSG_DONE are sent.
+ * - If the content was already made READY while loading (see
+ *   content_set_ready_partial()) the handler finishes it and only
+ *   CONTENT_MSG_DONE is sent.
  * - If the conversion fails, CONTENT_MSG_ERROR is sent. The content will soon
  *   be destroyed and must no longer be used.
  */
@@ -68,9 +72,10 @@ static void content_convert(struct content *c)
 {
 	assert(c);
 	assert(c->status == CONTENT_STATUS_LOADING ||
+	       c->status == CONTENT_STATUS_READY ||
 	       c->status == CONTENT_STATUS_ERROR);
 
-	if (c->status != CONTENT_STATUS_LOADING)
+	if (c->status == CONTENT_STATUS_ERROR)
 		return;
 
 	if (c->locked == true)
@@ -79,7 +84,15 @@ static void content_convert(struct content *c)
 	NSLOG(netsurf, INFO, "content "URL_FMT_SPC" (%p)",
 	      nsurl_access_log(llcache_handle_get_url(c->llcache)), c);
 
-	if (c->handler->data_complete != NULL) {
+	if (c->status == CONTENT_STATUS_READY) {
+		/* Content was made ready while its data was arriving,
+		 * the handler must now complete it.
+		 */
+		assert(c->handler->data_complete != NULL);
+		if (c->handler->data_complete(c) == false) {
+			content_set_error(c);
+		}
+	} else if (c->handler->data_complete != NULL) {
 		c->locked = true;
 		if (c->handler->data_complete(c) == false) {
 			content_set_error(c);
@@ -228,12 +241,14 @@ content__init(struct content *c,
 	c->size = 0;
 	c->title = NULL;
 	c->active = 0;
+	c->trace_track = nstrace_track;
 	user_sentinel->callback = NULL;
 	user_sentinel->pw = NULL;
 	user_sentinel->next = NULL;
 	c->user_list = user_sentinel;
 	c->sub_status[0] = 0;
 	c->locked = false;
+	c->partial = false;
 	c->total_size = 0;
 	c->http_code = 0;
 
@@ -295,6 +310,21 @@ void content_set_ready(struct content *c)
 }
 
 
+/* exported interface documented in content/protected.h */
+void content_set_ready_partial(struct content *c)
+{
+	/* Only an unlocked content which is still loading may become
+	 * READY before conversion. */
+	assert(c->status == CONTENT_STATUS_LOADING);
+	assert(c->locked == false);
+
+	c->partial = true;
+	c->status = CONTENT_STATUS_READY;
+	content_update_status(c);
+	content_broadcast(c, CONTENT_MSG_READY, NULL);
+}
+
+
 /* exported interface documented in content/protected.h */
 void content_set_done(struct content *c)
 {
@@ -302,6 +332,7 @@ void content_set_done(struct content *c)
 
 	nsu_getmonotonic_ms(&now_ms);
 
+	c->partial = false;
 	c->status = CONTENT_STATUS_DONE;
 	c->time = now_ms - c->time;
 	content_update_status(c);
@@ -1308,6 +1339,18 @@ bool content_get_quirks(hlcache_handle *h)
 }
 
 
+/* exported interface documented in content/content.h */
+bool content_is_partial(hlcache_handle *h)
+{
+	struct content *c = hlcache_handle_get_content(h);
+
+	if (c == NULL)
+		return false;
+
+	return c->partial;
+}
+
+
 /* exported interface documented in content/content.h */
 const char *
 content_get_encoding(hlcache_handle *h, enum content_encoding_type op)
@@ -1419,6 +1462,7 @@ nserror content__clone(const struct content *c, struct content *nc)
 	}
 
 	nc->active = c->active;
+	nc->trace_track = c->trace_track;
 
 	nc->user_list = calloc(1, sizeof(struct content_user));
 	if (nc->user_list == NULL) {
@@ -1429,6 +1473,7 @@ nserror content__clone(const struct content *c, struct content *nc)
 	memcpy(&(nc->sub_status), &(c->sub_status), 80);
 
 	nc->locked = c->locked;
+	nc->partial = c->partial;
 	nc->total_size = c->total_size;
 	nc->http_code = c->http_code;
 
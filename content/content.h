@@ -505,6 +505,16 @@ bool content_get_opaque(struct hlcache_handle *h);
 bool content_get_quirks(struct hlcache_handle *h);
 
 
+/**
+ * Determine if a content is displaying partly loaded data
+ *
+ * \param h Content to examine
+ * \return true if the content was made READY before all its data had
+ *         arrived and is not yet DONE, false otherwise
+ */
+bool content_is_partial(struct hlcache_handle *h);
+
+
 /**
  * Return whether a content is currently locked
  *
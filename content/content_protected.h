@@ -104,8 +104,14 @@ struct content_handler {
 
 	/**
 	 * content specific free text search find
+	 *
+	 * Matches of the context's pattern are found with
+	 * content_textsearch_find_match(). Handlers for large contents
+	 * may suspend the search with content_textsearch_suspend()
+	 * once content_textsearch_expired() indicates the time slice
+	 * is used.
 	 */
-	nserror (*textsearch_find)(struct content *c, struct textsearch_context *context, const char *pattern, int p_len, bool case_sens);
+	nserror (*textsearch_find)(struct content *c, struct textsearch_context *context);
 
 	/**
 	 * get bounds of free text search match
@@ -258,6 +264,10 @@ struct content {
 	 * Number of child fetches or conversions currently in progress.
 	 */
 	unsigned int active;
+	/**
+	 * Trace track the content's work is attributed to.
+	 */
+	unsigned int trace_track;
 	/**
 	 * List of users.
 	 */
@@ -275,6 +285,11 @@ struct content {
 	 * inconsistent and content must not be redrawn or modified.
 	 */
 	bool locked;
+	/**
+	 * Content was made READY before all its data had arrived and
+	 * has not been completed yet.
+	 */
+	bool partial;
 
 	/**
 	 * Total data size, 0 if unknown.
@@ -329,6 +344,17 @@ nserror content__clone(const struct content *c, struct content *nc);
  */
 void content_set_ready(struct content *c);
 
+/**
+ * Put a content in status CONTENT_STATUS_READY while its source data
+ * is still arriving.
+ *
+ * This allows handlers which can display partial data to be shown
+ * before the fetch completes. The handler's data_complete entry is
+ * still called once all the data has arrived and must then finish
+ * the content with content_set_done().
+ */
+void content_set_ready_partial(struct content *c);
+
 /**
  * Put a content in status CONTENT_STATUS_DONE.
  */
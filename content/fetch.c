@@ -47,6 +47,7 @@
 #include "utils/messages.h"
 #include "utils/nsurl.h"
 #include "utils/ring.h"
+#include "utils/trace.h"
 #include "netsurf/misc.h"
 #include "desktop/gui_internal.h"
 
@@ -98,12 +99,16 @@ struct fetch {
 	void *fetcher_handle;	/**< The handle for the fetcher. */
 	bool fetch_is_active;	/**< This fetch is active. */
 	fetch_msg_type last_msg;/**< The last message sent for this fetch */
+	unsigned int trace_track; /**< Trace track fetch is for */
+	unsigned int trace_id;	/**< Trace span id, or 0 if not traced */
+	uint64_t trace_start;	/**< Time fetch was queued or started */
 	struct fetch *r_prev;	/**< Previous active fetch in ::fetch_ring. */
 	struct fetch *r_next;	/**< Next active fetch in ::fetch_ring. */
 };
 
 static struct fetch *fetch_ring = NULL;	/**< Ring of active fetches. */
 static struct fetch *queue_ring = NULL;	/**< Ring of queued fetches */
+static unsigned int fetch_trace_id = 0; /**< Last fetch trace span id */
 
 /******************************************************************************
  * fetch internals							      *
@@ -159,6 +164,11 @@ static bool fetch_dispatch_job(struct fetch *fetch)
 	} else {
 		RING_INSERT(fetch_ring, fetch);
 		fetch->fetch_is_active = true;
+		if (fetch->trace_id != 0) {
+			nstrace_record("fetch", "queued", fetch->trace_start,
+				       fetch->trace_id, fetch->trace_track);
+			fetch->trace_start = nstrace_time();
+		}
 		return true;
 	}
 }
@@ -486,6 +496,11 @@ fetch_start(nsurl *url,
 	fetch->verifiable = verifiable;
 	fetch->p = p;
 	fetch->host = nsurl_get_component(url, NSURL_HOST);
+	fetch->trace_track = nstrace_track;
+	fetch->trace_start = nstrace_begin();
+	if (fetch->trace_start != 0) {
+		fetch->trace_id = ++fetch_trace_id;
+	}
 
 	if (referer != NULL) {
 		fetch->referer = nsurl_ref(referer);
@@ -568,6 +583,11 @@ void fetch_free(struct fetch *f)
 
 	fetch_unref_fetcher(f->fetcherd);
 
+	if (f->trace_id != 0 && f->fetch_is_active) {
+		nstrace_record("fetch", "fetch", f->trace_start,
+			       f->trace_id, f->trace_track);
+	}
+
 	nsurl_unref(f->url);
 	if (f->referer != NULL) {
 		nsurl_unref(f->referer);
@@ -752,10 +772,16 @@ fetch_multipart_data_new_kv(struct fetch_multipart_data **list,
 void
 fetch_send_callback(const fetch_msg *msg, struct fetch *fetch)
 {
+	unsigned int track;
+
 	/* Bump the last_msg to the greatest seen msg */
 	if (msg->type > fetch->last_msg)
 		fetch->last_msg = msg->type;
+
+	/* Attribute work done for the fetch to whoever started it */
+	track = nstrace_enter(fetch->trace_track);
 	fetch->callback(msg, fetch->p);
+	nstrace_leave(track);
 }
 
 
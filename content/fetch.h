@@ -42,6 +42,7 @@ typedef enum {
 	FETCH_CERTS,
 	FETCH_HEADER,
 	FETCH_DATA,
+	FETCH_DATA_BUFFER,
 	/* Anything after here is a completed fetch of some kind. */
 	FETCH_FINISHED,
 	FETCH_TIMEDOUT,
@@ -66,6 +67,35 @@ typedef enum {
  */
 #define FETCH__INTERNAL_ABORTED FETCH_ERROR
 
+/**
+ * Heap buffer of object data handed to the fetch client.
+ *
+ * A fetcher which reads an object's entire content into memory sends
+ * one of these with FETCH_DATA_BUFFER.  On delivery ownership passes to
+ * the recipient, which may take the data for its own use by clearing
+ * buf, in which case it must later free() it.  Either way it must
+ * eventually call the release operation exactly once.
+ */
+struct fetch_buffer {
+	uint8_t *buf; /**< Data allocated with malloc(), or NULL once taken */
+	size_t len; /**< Byte length of data */
+
+	/**
+	 * Check whether the source the data was read from has changed.
+	 *
+	 * \param fbuf The buffer to check.
+	 * \return true if the data no longer reflects its source.
+	 */
+	bool (*changed)(struct fetch_buffer *fbuf);
+
+	/**
+	 * Release the buffer and any data not taken from it.
+	 *
+	 * \param fbuf The buffer to release, invalid on return.
+	 */
+	void (*release)(struct fetch_buffer *fbuf);
+};
+
 /**
  * Fetcher message data
  */
@@ -80,6 +110,8 @@ typedef struct fetch_msg {
 			size_t len;
 		} header_or_data;
 
+		struct fetch_buffer *buffer;
+
 		const char *error;
 
 		/** \todo Use nsurl */
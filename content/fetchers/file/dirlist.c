@@ -55,6 +55,7 @@ static char* dirlist_filesize_unit(unsigned long bytesize);
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -94,6 +95,7 @@ bool dirlist_generate_top(char *buffer, int buffer_length)
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -137,6 +139,7 @@ bool dirlist_generate_hide_columns(int flags, char *buffer, int buffer_length)
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -196,6 +199,7 @@ bool dirlist_generate_title(const char *title, char *buffer, int buffer_length)
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -231,6 +235,7 @@ bool dirlist_generate_parent_link(const char *parent, char *buffer,
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -283,6 +288,7 @@ bool dirlist_generate_headings(char *buffer, int buffer_length)
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -324,6 +330,53 @@ bool dirlist_generate_row(bool even, bool directory, nsurl *url, char *name,
 }
 
 
+/**
+ * Generates the part of an HTML directory listing page that links to the
+ * neighbouring pages of a paged listing
+ *
+ * \param  prev		  url of previous page, or NULL if none
+ * \param  next		  url of next page, or NULL if none
+ * \param  buffer	  buffer to fill with generated HTML
+ * \param  buffer_length  maximum size of buffer
+ * \return  true iff buffer filled without error
+ *
+ * This is part of a series of functions.  To generate a complete page,
+ * call the following functions in order:
+ *
+ *     dirlist_generate_top()
+ *     dirlist_generate_hide_columns()  -- optional
+ *     dirlist_generate_title()
+ *     dirlist_generate_parent_link()   -- optional
+ *     dirlist_generate_headings()
+ *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
+ *     dirlist_generate_bottom()
+ */
+
+bool dirlist_generate_page_links(const char *prev, const char *next,
+		char *buffer, int buffer_length)
+{
+	int error = snprintf(buffer, buffer_length,
+			"</div>\n<p>%s%s%s%s%s%s%s%s%s%s</p>\n<div>\n",
+			(prev != NULL) ? "<a href=\"" : "",
+			(prev != NULL) ? prev : "",
+			(prev != NULL) ? "\">" : "",
+			(prev != NULL) ? messages_get("FilePrevious") : "",
+			(prev != NULL) ? "</a> " : "",
+			(next != NULL) ? "<a href=\"" : "",
+			(next != NULL) ? next : "",
+			(next != NULL) ? "\">" : "",
+			(next != NULL) ? messages_get("FileNext") : "",
+			(next != NULL) ? "</a>" : "");
+	if (error < 0 || error >= buffer_length)
+		/* Error or buffer too small */
+		return false;
+	else
+		/* OK */
+		return true;
+}
+
+
 /**
  * Generates the bottom part of an HTML directory listing page
  *
@@ -338,6 +391,7 @@ bool dirlist_generate_row(bool even, bool directory, nsurl *url, char *name,
  *     dirlist_generate_parent_link()   -- optional
  *     dirlist_generate_headings()
  *     dirlist_generate_row()           -- call 'n' times for 'n' rows
+ *     dirlist_generate_page_links()    -- optional
  *     dirlist_generate_bottom()
  */
 
@@ -45,6 +45,8 @@ bool dirlist_generate_headings(char *buffer, int buffer_length);
 bool dirlist_generate_row(bool even, bool directory, struct nsurl *url,
 		char *name, const char *mimetype, long long size, char *date,
 		char *time, char *buffer, int buffer_length);
+bool dirlist_generate_page_links(const char *prev, const char *next,
+		char *buffer, int buffer_length);
 bool dirlist_generate_bottom(char *buffer, int buffer_length);
 
 #endif
@@ -39,10 +39,8 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdarg.h>
-#ifdef HAVE_MMAP
-#include <sys/mman.h>
-#endif
 #include <libwapcaplet/libwapcaplet.h>
+#include <nsutils/time.h>
 
 #include "netsurf/inttypes.h"
 #include "utils/nsurl.h"
@@ -62,8 +60,43 @@
 #include "dirlist.h"
 #include "file.h"
 
-/* Maximum size of read buffer */
-#define FETCH_FILE_MAX_BUF_SIZE (1024 * 1024)
+/* Size of the buffer directory listing rows are batched into */
+#define FETCH_FILE_DIR_BATCH_SIZE (64 * 1024)
+
+/* Time in ms a directory listing may run for before yielding */
+#define FETCH_FILE_DIR_BUDGET_MS 10
+
+/* Number of rows listed between checks of the time budget */
+#define FETCH_FILE_DIR_CHECK_ROWS 32
+
+/* Default number of entries on a directory listing page */
+#define FETCH_FILE_DIR_PAGE_SIZE 1000
+
+/**
+ * State of a directory listing in progress.
+ *
+ * The listing is produced a batch at a time from the fetcher poll so
+ * huge directories do not block the browser.  Entries either come
+ * from a sorted scandir() or, with the "sort=none" query parameter,
+ * straight from readdir() without reading the whole directory first.
+ * The "page" and "pagesize" query parameters restrict the listing to
+ * a single page of entries.
+ */
+struct fetch_file_dir {
+	DIR *dirp; /**< Directory being read when listing unsorted */
+	struct dirent **listing; /**< Sorted directory entries */
+	int count; /**< Number of sorted entries */
+	int index; /**< Index of next sorted entry */
+
+	unsigned int page; /**< Page being listed, from 1, or 0 for all */
+	unsigned int pagesize; /**< Number of entries on a page */
+	unsigned int remaining; /**< Entries left to list on the page */
+
+	bool even; /**< Formatting flag for the next row */
+
+	char *buf; /**< Buffer rows are batched into */
+	size_t len; /**< Length of batched data */
+};
 
 /** Context for a fetch */
 struct fetch_file_context {
@@ -78,6 +111,19 @@ struct fetch_file_context {
 	char *path; /**< The actual path to be used with open() */
 
 	time_t file_etag; /**< Request etag for file (previous st.m_time) */
+	int64_t file_etag_size; /**< Request etag file size, or -1 if absent */
+
+	struct fetch_file_dir *dir; /**< Directory listing in progress */
+};
+
+/** File contents handed to the fetch client */
+struct fetch_file_buffer {
+	struct fetch_buffer buf; /**< Buffer handed to the client */
+	char *path; /**< Path of the file read */
+	dev_t dev; /**< Device of the file read */
+	ino_t ino; /**< Inode of the file read */
+	off_t size; /**< Size of the file when read */
+	time_t mtime; /**< Modification time of the file when read */
 };
 
 static struct fetch_file_context *ring = NULL;
@@ -157,6 +203,7 @@ fetch_file_setup(struct fetch *fetchh,
 	}
 
 	ctx->url = nsurl_ref(url);
+	ctx->file_etag_size = -1;
 
 	/* Scan request headers looking for If-None-Match */
 	for (i = 0; headers[i] != NULL; i++) {
@@ -180,6 +227,13 @@ fetch_file_setup(struct fetch *fetchh,
 						"Bad If-None-Match value");
 			}
 		}
+
+		/* Optional file size follows the time: "12345678-42" */
+		while (*d >= '0' && *d <= '9')
+			d++;
+		if (*d == '-' && d[1] >= '0' && d[1] <= '9') {
+			ctx->file_etag_size = strtoll(d + 1, NULL, 10);
+		}
 	}
 
 	ctx->fetchh = fetchh;
@@ -189,10 +243,33 @@ fetch_file_setup(struct fetch *fetchh,
 	return ctx;
 }
 
+/** release the state of a directory listing */
+static void fetch_file_dir_free(struct fetch_file_dir *dir)
+{
+	int i;
+
+	if (dir->dirp != NULL) {
+		closedir(dir->dirp);
+	}
+
+	if (dir->listing != NULL) {
+		for (i = 0; i < dir->count; i++) {
+			free(dir->listing[i]);
+		}
+		free(dir->listing);
+	}
+
+	free(dir->buf);
+	free(dir);
+}
+
 /** callback to free a file fetch */
 static void fetch_file_free(void *ctx)
 {
 	struct fetch_file_context *c = ctx;
+	if (c->dir != NULL) {
+		fetch_file_dir_free(c->dir);
+	}
 	nsurl_unref(c->url);
 	free(c->path);
 	free(ctx);
@@ -278,101 +355,121 @@ fetch_file_process_error_aborted:
 }
 
 
-/** Process object as a regular file */
-static void fetch_file_process_plain(struct fetch_file_context *ctx,
-				     struct stat *fdstat)
+/**
+ * Check whether the file is unchanged from the requested etag
+ *
+ * \param ctx The fetch context holding any requested etag.
+ * \param fdstat The current status of the file.
+ * \return true if the client's copy is still valid.
+ */
+static bool
+fetch_file_not_modified(struct fetch_file_context *ctx, struct stat *fdstat)
 {
-#ifdef HAVE_MMAP
-	fetch_msg msg;
-	char *buf = NULL;
-	size_t buf_size;
-
-	int fd; /**< The file descriptor of the object */
-
-	/* Check if we can just return not modified */
-	if (ctx->file_etag != 0 && ctx->file_etag == fdstat->st_mtime) {
-		fetch_set_http_code(ctx->fetchh, 304);
-		msg.type = FETCH_NOTMODIFIED;
-		fetch_file_send_callback(&msg, ctx);
-		return;
+	if (ctx->file_etag == 0 || ctx->file_etag != fdstat->st_mtime) {
+		return false;
 	}
 
-	fd = open(ctx->path, O_RDONLY);
-	if (fd < 0) {
-		/* process errors as appropriate */
-		fetch_file_process_error(ctx,
-				fetch_file_errno_to_http_code(errno));
-		return;
+	/* etags from older versions carry no size */
+	if (ctx->file_etag_size != -1 &&
+	    ctx->file_etag_size != (int64_t)fdstat->st_size) {
+		return false;
 	}
 
-	/* set buffer size */
-	buf_size = fdstat->st_size;
+	return true;
+}
 
-	/* allocate the buffer storage */
-	if (buf_size > 0) {
-		buf = mmap(NULL, buf_size, PROT_READ, MAP_SHARED, fd, 0);
-		if (buf == MAP_FAILED) {
-			msg.type = FETCH_ERROR;
-			msg.data.error = "Unable to map memory for file data buffer";
-			fetch_file_send_callback(&msg, ctx);
-			close(fd);
-			return;
-		}
+/**
+ * Check whether a file's data handed to the fetch client still matches
+ * the file on disc.
+ */
+static bool fetch_file_buffer_changed(struct fetch_buffer *fbuf)
+{
+	struct fetch_file_buffer *ffbuf = (struct fetch_file_buffer *)fbuf;
+	struct stat fdstat;
+
+	if (stat(ffbuf->path, &fdstat) != 0) {
+		return true;
 	}
 
-	/* fetch is going to be successful */
-	fetch_set_http_code(ctx->fetchh, 200);
+	return ((fdstat.st_dev != ffbuf->dev) ||
+		(fdstat.st_ino != ffbuf->ino) ||
+		(fdstat.st_size != ffbuf->size) ||
+		(fdstat.st_mtime != ffbuf->mtime));
+}
 
-	/* Any callback can result in the fetch being aborted.
-	 * Therefore, we _must_ check for this after _every_ call to
-	 * fetch_file_send_callback().
-	 */
+/**
+ * Release a file buffer handed to the fetch client.
+ */
+static void fetch_file_buffer_release(struct fetch_buffer *fbuf)
+{
+	struct fetch_file_buffer *ffbuf = (struct fetch_file_buffer *)fbuf;
 
-	/* content type */
-	if (fetch_file_send_header(ctx, "Content-Type: %s", 
-				   guit->fetch->filetype(ctx->path))) {
-		goto fetch_file_process_aborted;
-	}
+	free(fbuf->buf);
+	free(ffbuf->path);
+	free(ffbuf);
+}
 
-	/* content length */
-	if (fetch_file_send_header(ctx, "Content-Length: %" PRIsizet,
-				   fdstat->st_size)) {
-		goto fetch_file_process_aborted;
-	}
+/**
+ * Read a file's contents into a buffer for handing to the fetch client.
+ *
+ * \param ctx The fetch context.
+ * \param infile The open file.
+ * \param fdstat The status of the open file.
+ * \param ffbuf_out Updated with the buffer on success.
+ * \return NSERROR_OK on success, NSERROR_NOMEM if the buffer could not
+ *         be allocated or NSERROR_NOT_FOUND if the file could not be
+ *         read in full.
+ */
+static nserror
+fetch_file_buffer_create(struct fetch_file_context *ctx,
+			 FILE *infile,
+			 struct stat *fdstat,
+			 struct fetch_file_buffer **ffbuf_out)
+{
+	struct fetch_file_buffer *ffbuf;
+	size_t len = fdstat->st_size;
 
-	/* create etag */
-	if (fetch_file_send_header(ctx, "ETag: \"%10" PRId64 "\"",
-				   (int64_t) fdstat->st_mtime)) {
-		goto fetch_file_process_aborted;
+	ffbuf = calloc(1, sizeof(*ffbuf));
+	if (ffbuf == NULL) {
+		return NSERROR_NOMEM;
 	}
 
-	msg.type = FETCH_DATA;
-	msg.data.header_or_data.buf = (const uint8_t *) buf;
-	msg.data.header_or_data.len = buf_size;
-	fetch_file_send_callback(&msg, ctx);
+	ffbuf->path = strdup(ctx->path);
+	ffbuf->buf.buf = malloc(len);
+	if ((ffbuf->path == NULL) || (ffbuf->buf.buf == NULL)) {
+		fetch_file_buffer_release(&ffbuf->buf);
+		return NSERROR_NOMEM;
+	}
 
-	if (ctx->aborted == false) {
-		msg.type = FETCH_FINISHED;
-		fetch_file_send_callback(&msg, ctx);
+	if (fread(ffbuf->buf.buf, 1, len, infile) != len) {
+		fetch_file_buffer_release(&ffbuf->buf);
+		return NSERROR_NOT_FOUND;
 	}
 
-fetch_file_process_aborted:
+	ffbuf->buf.len = len;
+	ffbuf->buf.changed = fetch_file_buffer_changed;
+	ffbuf->buf.release = fetch_file_buffer_release;
+	ffbuf->dev = fdstat->st_dev;
+	ffbuf->ino = fdstat->st_ino;
+	ffbuf->size = fdstat->st_size;
+	ffbuf->mtime = fdstat->st_mtime;
 
-	if (buf != NULL)
-		munmap(buf, buf_size);
-	close(fd);
-#else
-	fetch_msg msg;
-	char *buf;
-	size_t buf_size;
+	*ffbuf_out = ffbuf;
 
-	ssize_t tot_read = 0;
-	ssize_t res;
+	return NSERROR_OK;
+}
 
+/** Process object as a regular file */
+static void fetch_file_process_plain(struct fetch_file_context *ctx,
+				     struct stat *fdstat)
+{
+	fetch_msg msg;
+	struct fetch_file_buffer *ffbuf = NULL;
 	FILE *infile;
+	nserror res;
 
 	/* Check if we can just return not modified */
-	if (ctx->file_etag != 0 && ctx->file_etag == fdstat->st_mtime) {
+	if (fetch_file_not_modified(ctx, fdstat)) {
 		fetch_set_http_code(ctx->fetchh, 304);
 		msg.type = FETCH_NOTMODIFIED;
 		fetch_file_send_callback(&msg, ctx);
@@ -387,21 +484,22 @@ fetch_file_process_aborted:
 		return;
 	}
 
-	/* set buffer size */
-	buf_size = fdstat->st_size;
-	if (buf_size > FETCH_FILE_MAX_BUF_SIZE)
-		buf_size = FETCH_FILE_MAX_BUF_SIZE;
-
-	/* allocate the buffer storage */
-	buf = malloc(buf_size);
-	if (buf == NULL) {
-		msg.type = FETCH_ERROR;
-		msg.data.error =
-			"Unable to allocate memory for file data buffer";
-		fetch_file_send_callback(&msg, ctx);
-		fclose(infile);
-		return;
+	/* read the file contents */
+	if (fdstat->st_size > 0) {
+		res = fetch_file_buffer_create(ctx, infile, fdstat, &ffbuf);
+		if (res != NSERROR_OK) {
+			msg.type = FETCH_ERROR;
+			if (res == NSERROR_NOMEM) {
+				msg.data.error = "Unable to allocate memory for file data buffer";
+			} else {
+				msg.data.error = "Error reading file";
+			}
+			fetch_file_send_callback(&msg, ctx);
+			fclose(infile);
+			return;
+		}
 	}
+	fclose(infile);
 
 	/* fetch is going to be successful */
 	fetch_set_http_code(ctx->fetchh, 200);
@@ -412,7 +510,7 @@ fetch_file_process_aborted:
 	 */
 
 	/* content type */
-	if (fetch_file_send_header(ctx, "Content-Type: %s", 
+	if (fetch_file_send_header(ctx, "Content-Type: %s",
 				   guit->fetch->filetype(ctx->path))) {
 		goto fetch_file_process_aborted;
 	}
@@ -424,35 +522,23 @@ fetch_file_process_aborted:
 	}
 
 	/* create etag */
-	if (fetch_file_send_header(ctx, "ETag: \"%10" PRId64 "\"", 
-				   (int64_t) fdstat->st_mtime)) {
+	if (fetch_file_send_header(ctx, "ETag: \"%10" PRId64 "-%" PRId64 "\"",
+				   (int64_t) fdstat->st_mtime,
+				   (int64_t) fdstat->st_size)) {
 		goto fetch_file_process_aborted;
 	}
 
-	/* main data loop */
-	while (tot_read < fdstat->st_size) {
-		res = fread(buf, 1, buf_size, infile);
-		if (res == 0) {
-			if (feof(infile)) {
-				msg.type = FETCH_ERROR;
-				msg.data.error = "Unexpected EOF reading file";
-				fetch_file_send_callback(&msg, ctx);
-				goto fetch_file_process_aborted;
-			} else {
-				msg.type = FETCH_ERROR;
-				msg.data.error = "Error reading file";
-				fetch_file_send_callback(&msg, ctx);
-				goto fetch_file_process_aborted;
-			}
-		}
-		tot_read += res;
-
+	if (ffbuf != NULL) {
+		/* the client owns the buffer once it is delivered */
+		msg.type = FETCH_DATA_BUFFER;
+		msg.data.buffer = &ffbuf->buf;
+		ffbuf = NULL;
+	} else {
 		msg.type = FETCH_DATA;
-		msg.data.header_or_data.buf = (const uint8_t *) buf;
-		msg.data.header_or_data.len = res;
-		if (fetch_file_send_callback(&msg, ctx))
-			break;
+		msg.data.header_or_data.buf = NULL;
+		msg.data.header_or_data.len = 0;
 	}
+	fetch_file_send_callback(&msg, ctx);
 
 	if (ctx->aborted == false) {
 		msg.type = FETCH_FINISHED;
@@ -461,10 +547,8 @@ fetch_file_process_aborted:
 
 fetch_file_process_aborted:
 
-	fclose(infile);
-	free(buf);
-#endif
-	return;
+	if (ffbuf != NULL)
+		fetch_file_buffer_release(&ffbuf->buf);
 }
 
 static char *gen_nice_title(char *path)
@@ -662,26 +746,338 @@ static int dir_sort_alpha(const struct dirent **d1, const struct dirent **d2)
 	return tolower(*s1) - tolower(*s2);
 }
 
+/**
+ * Select visible directory entries.
+ *
+ * \param ent directory entry
+ * \return non zero if the entry should be listed
+ */
+static int dir_select_visible(const struct dirent *ent)
+{
+	return ent->d_name[0] != '.';
+}
+
+/**
+ * Read the listing options from the query of a directory url.
+ *
+ * \param ctx The fetch context.
+ * \param dir The listing state to update.
+ * \param sorted Updated with whether the listing should be sorted.
+ */
+static void
+fetch_file_dir_options(struct fetch_file_context *ctx,
+		       struct fetch_file_dir *dir,
+		       bool *sorted)
+{
+	lwc_string *query;
+	const char *param;
+
+	*sorted = true;
+
+	query = nsurl_get_component(ctx->url, NSURL_QUERY);
+	if (query == NULL) {
+		return;
+	}
+
+	param = lwc_string_data(query);
+	while (*param != '\0') {
+		size_t len = strcspn(param, "&");
+
+		if (strncmp(param, "sort=none", len) == 0 &&
+		    len == SLEN("sort=none")) {
+			*sorted = false;
+		} else if (strncmp(param, "page=", SLEN("page=")) == 0) {
+			dir->page = strtoul(param + SLEN("page="), NULL, 10);
+		} else if (strncmp(param, "pagesize=", SLEN("pagesize=")) == 0) {
+			dir->pagesize = strtoul(param + SLEN("pagesize="),
+						NULL, 10);
+		}
+
+		param += len;
+		if (*param == '&') {
+			param++;
+		}
+	}
+
+	lwc_string_unref(query);
+
+	if (dir->pagesize != 0 && dir->page == 0) {
+		dir->page = 1;
+	}
+	if (dir->page != 0 && dir->pagesize == 0) {
+		dir->pagesize = FETCH_FILE_DIR_PAGE_SIZE;
+	}
+}
+
+/**
+ * Get the next visible entry of a directory listing.
+ *
+ * \param dir The listing state.
+ * \return The next entry or NULL if there are no more.
+ */
+static struct dirent *fetch_file_dir_next(struct fetch_file_dir *dir)
+{
+	struct dirent *ent;
+
+	if (dir->listing != NULL) {
+		if (dir->index >= dir->count) {
+			return NULL;
+		}
+		return dir->listing[dir->index++];
+	}
+
+	do {
+		ent = readdir(dir->dirp);
+	} while ((ent != NULL) && (dir_select_visible(ent) == 0));
+
+	return ent;
+}
+
+/**
+ * Send the batched directory listing data.
+ *
+ * \param ctx The fetch context.
+ * \return true if the fetch was aborted.
+ */
+static bool fetch_file_dir_flush(struct fetch_file_context *ctx)
+{
+	struct fetch_file_dir *dir = ctx->dir;
+	fetch_msg msg;
+
+	if (dir->len == 0) {
+		return false;
+	}
+
+	msg.type = FETCH_DATA;
+	msg.data.header_or_data.buf = (const uint8_t *) dir->buf;
+	msg.data.header_or_data.len = dir->len;
+	dir->len = 0;
+
+	return fetch_file_send_callback(&msg, ctx);
+}
+
+/**
+ * Add generated text to the batched directory listing data.
+ *
+ * \param ctx The fetch context.
+ * \param text The text to add.
+ * \return true if the fetch was aborted.
+ */
+static bool fetch_file_dir_append(struct fetch_file_context *ctx,
+				  const char *text)
+{
+	struct fetch_file_dir *dir = ctx->dir;
+	size_t len = strlen(text);
+
+	if ((dir->len + len) > FETCH_FILE_DIR_BATCH_SIZE) {
+		if (fetch_file_dir_flush(ctx)) {
+			return true;
+		}
+	}
+
+	/* generated text is never larger than the batch buffer */
+	memcpy(dir->buf + dir->len, text, len);
+	dir->len += len;
+
+	return false;
+}
+
+/**
+ * Generate links to the neighbouring pages of a directory listing.
+ *
+ * \param ctx The fetch context.
+ * \param more Whether there are entries after the current page.
+ * \param buffer buffer to fill with generated HTML
+ * \param buffer_len maximum size of buffer
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static nserror
+fetch_file_dir_page_links(struct fetch_file_context *ctx,
+			  bool more,
+			  char *buffer,
+			  size_t buffer_len)
+{
+	struct fetch_file_dir *dir = ctx->dir;
+	char query[64];
+	nsurl *prev = NULL;
+	nsurl *next = NULL;
+	nserror ret = NSERROR_OK;
+
+	if (dir->page > 1) {
+		snprintf(query, sizeof query, "page=%u&pagesize=%u%s",
+			 dir->page - 1, dir->pagesize,
+			 (dir->listing == NULL) ? "&sort=none" : "");
+		ret = nsurl_replace_query(ctx->url, query, &prev);
+	}
+
+	if ((ret == NSERROR_OK) && more) {
+		snprintf(query, sizeof query, "page=%u&pagesize=%u%s",
+			 dir->page + 1, dir->pagesize,
+			 (dir->listing == NULL) ? "&sort=none" : "");
+		ret = nsurl_replace_query(ctx->url, query, &next);
+	}
+
+	if (ret == NSERROR_OK) {
+		if (!dirlist_generate_page_links(
+				(prev != NULL) ? nsurl_access(prev) : NULL,
+				(next != NULL) ? nsurl_access(next) : NULL,
+				buffer, buffer_len)) {
+			ret = NSERROR_NOSPACE;
+		}
+	}
+
+	if (prev != NULL) {
+		nsurl_unref(prev);
+	}
+	if (next != NULL) {
+		nsurl_unref(next);
+	}
+
+	return ret;
+}
+
+/**
+ * List the next batch of entries of a directory listing.
+ *
+ * Rows are generated until the time budget is exhausted, the batch is
+ * then sent and the fetch yields until the next poll.  Once all the
+ * entries have been listed the listing is completed and its state
+ * released.
+ *
+ * \param ctx The fetch context with a listing in progress.
+ */
+static void fetch_file_process_dir_rows(struct fetch_file_context *ctx)
+{
+	struct fetch_file_dir *dir = ctx->dir;
+	char buffer[1024]; /* Output buffer */
+	struct dirent *ent;
+	uint64_t start_ms;
+	uint64_t now_ms;
+	unsigned int rows = 0;
+	bool more = false;
+	fetch_msg msg;
+	nserror err;
+
+	nsu_getmonotonic_ms(&start_ms);
+
+	while ((dir->page == 0) || (dir->remaining > 0)) {
+		ent = fetch_file_dir_next(dir);
+		if (ent == NULL) {
+			break;
+		}
+
+		err = process_dir_ent(ctx, ent, dir->even, buffer,
+				      sizeof(buffer));
+		if (err == NSERROR_OK) {
+			if (fetch_file_dir_append(ctx, buffer)) {
+				goto fetch_file_process_dir_rows_done;
+			}
+			dir->even = !dir->even;
+		}
+
+		if (dir->page != 0) {
+			dir->remaining--;
+		}
+
+		/* yield once the time budget has been used */
+		if ((++rows % FETCH_FILE_DIR_CHECK_ROWS) == 0) {
+			nsu_getmonotonic_ms(&now_ms);
+			if ((now_ms - start_ms) >= FETCH_FILE_DIR_BUDGET_MS) {
+				if (fetch_file_dir_flush(ctx)) {
+					goto fetch_file_process_dir_rows_done;
+				}
+				return;
+			}
+		}
+	}
+
+	/* page links */
+	if (dir->page != 0) {
+		more = (fetch_file_dir_next(dir) != NULL);
+		if ((dir->page > 1) || more) {
+			err = fetch_file_dir_page_links(ctx, more, buffer,
+							sizeof buffer);
+			if ((err == NSERROR_OK) &&
+			    fetch_file_dir_append(ctx, buffer)) {
+				goto fetch_file_process_dir_rows_done;
+			}
+		}
+	}
+
+	/* directory listing bottom */
+	dirlist_generate_bottom(buffer, sizeof buffer);
+	if (fetch_file_dir_append(ctx, buffer) ||
+	    fetch_file_dir_flush(ctx)) {
+		goto fetch_file_process_dir_rows_done;
+	}
+
+	msg.type = FETCH_FINISHED;
+	fetch_file_send_callback(&msg, ctx);
+
+fetch_file_process_dir_rows_done:
+	fetch_file_dir_free(ctx->dir);
+	ctx->dir = NULL;
+}
+
+/**
+ * Start listing a directory.
+ *
+ * The page header is generated and the first batch of rows listed.
+ * Any remaining rows are listed by subsequent polls of the fetcher.
+ */
 static void fetch_file_process_dir(struct fetch_file_context *ctx,
 				   struct stat *fdstat)
 {
-	fetch_msg msg;
+	struct fetch_file_dir *dir;
 	char buffer[1024]; /* Output buffer */
-	bool even = false; /* formatting flag */
 	char *title; /* pretty printed title */
 	nserror err; /* result from url routines */
 	nsurl *up; /* url of parent */
+	bool sorted;
+	unsigned int skip;
+	fetch_msg msg;
 
-	struct dirent **listing = NULL; /* directory entry listing */
-	int i; /* directory entry index */
-	int n; /* number of directory entries */
+	dir = calloc(1, sizeof(*dir));
+	if (dir == NULL) {
+		msg.type = FETCH_ERROR;
+		msg.data.error = "Unable to allocate directory listing";
+		fetch_file_send_callback(&msg, ctx);
+		return;
+	}
 
-	n = scandir(ctx->path, &listing, 0, dir_sort_alpha);
-	if (n < 0) {
-		fetch_file_process_error(ctx,
-			fetch_file_errno_to_http_code(errno));
+	dir->buf = malloc(FETCH_FILE_DIR_BATCH_SIZE);
+	if (dir->buf == NULL) {
+		free(dir);
+		msg.type = FETCH_ERROR;
+		msg.data.error = "Unable to allocate directory listing";
+		fetch_file_send_callback(&msg, ctx);
 		return;
 	}
+	ctx->dir = dir;
+
+	fetch_file_dir_options(ctx, dir, &sorted);
+
+	if (sorted) {
+		/* only the names are read here, entries are only
+		 * examined as they are listed
+		 */
+		dir->count = scandir(ctx->path, &dir->listing,
+				     dir_select_visible, dir_sort_alpha);
+		if (dir->count < 0) {
+			dir->count = 0;
+			dir->listing = NULL;
+			fetch_file_process_error(ctx,
+				fetch_file_errno_to_http_code(errno));
+			goto fetch_file_process_dir_aborted;
+		}
+	} else {
+		dir->dirp = opendir(ctx->path);
+		if (dir->dirp == NULL) {
+			fetch_file_process_error(ctx,
+				fetch_file_errno_to_http_code(errno));
+			goto fetch_file_process_dir_aborted;
+		}
+	}
 
 	/* fetch is going to be successful */
 	fetch_set_http_code(ctx->fetchh, 200);
@@ -694,21 +1090,16 @@ static void fetch_file_process_dir(struct fetch_file_context *ctx,
 	if (fetch_file_send_header(ctx, "Content-Type: text/html; charset=utf-8"))
 		goto fetch_file_process_dir_aborted;
 
-	msg.type = FETCH_DATA;
-	msg.data.header_or_data.buf = (const uint8_t *) buffer;
-
 	/* directory listing top */
 	dirlist_generate_top(buffer, sizeof buffer);
-	msg.data.header_or_data.len = strlen(buffer);
-	if (fetch_file_send_callback(&msg, ctx))
+	if (fetch_file_dir_append(ctx, buffer))
 		goto fetch_file_process_dir_aborted;
 
 	/* directory listing title */
 	title = gen_nice_title(ctx->path);
 	dirlist_generate_title(title, buffer, sizeof buffer);
 	free(title);
-	msg.data.header_or_data.len = strlen(buffer);
-	if (fetch_file_send_callback(&msg, ctx))
+	if (fetch_file_dir_append(ctx, buffer))
 		goto fetch_file_process_dir_aborted;
 
 	/* Print parent directory link */
@@ -718,54 +1109,39 @@ static void fetch_file_process_dir(struct fetch_file_context *ctx,
 			/* different URL; have parent */
 			dirlist_generate_parent_link(nsurl_access(up),
 					buffer, sizeof buffer);
-
-			msg.data.header_or_data.len = strlen(buffer);
-			fetch_file_send_callback(&msg, ctx);
+			fetch_file_dir_append(ctx, buffer);
 		}
 		nsurl_unref(up);
 
 		if (ctx->aborted)
 			goto fetch_file_process_dir_aborted;
-
 	}
 
 	/* directory list headings */
 	dirlist_generate_headings(buffer, sizeof buffer);
-	msg.data.header_or_data.len = strlen(buffer);
-	if (fetch_file_send_callback(&msg, ctx))
+	if (fetch_file_dir_append(ctx, buffer))
 		goto fetch_file_process_dir_aborted;
 
-	for (i = 0; i < n; i++) {
-
-		err = process_dir_ent(ctx, listing[i], even, buffer,
-				       sizeof(buffer));
-
-		if (err == NSERROR_OK) {
-			msg.data.header_or_data.len = strlen(buffer);
-			if (fetch_file_send_callback(&msg, ctx))
-				goto fetch_file_process_dir_aborted;
-
-			even = !even;
+	/* skip to the requested page */
+	if (dir->page != 0) {
+		skip = (dir->page - 1) * dir->pagesize;
+		if (dir->listing != NULL) {
+			dir->index = (skip < (unsigned int)dir->count) ?
+				(int)skip : dir->count;
+		} else {
+			while ((skip > 0) && (fetch_file_dir_next(dir) != NULL)) {
+				skip--;
+			}
 		}
+		dir->remaining = dir->pagesize;
 	}
 
-	/* directory listing bottom */
-	dirlist_generate_bottom(buffer, sizeof buffer);
-	msg.data.header_or_data.len = strlen(buffer);
-	if (fetch_file_send_callback(&msg, ctx))
-		goto fetch_file_process_dir_aborted;
-
-	msg.type = FETCH_FINISHED;
-	fetch_file_send_callback(&msg, ctx);
+	fetch_file_process_dir_rows(ctx);
+	return;
 
 fetch_file_process_dir_aborted:
-
-	if (listing != NULL) {
-		for (i = 0; i < n; i++) {
-			free(listing[i]);
-		}
-		free(listing);
-	}
+	fetch_file_dir_free(ctx->dir);
+	ctx->dir = NULL;
 }
 
 
@@ -820,8 +1196,19 @@ static void fetch_file_poll(lwc_string *scheme)
 
 		/* Only process non-aborted fetches */
 		if (c->aborted == false) {
-			/* file fetches can be processed in one go */
-			fetch_file_process(c);
+			if (c->dir != NULL) {
+				/* continue a directory listing */
+				fetch_file_process_dir_rows(c);
+			} else {
+				/* files are processed in one go */
+				fetch_file_process(c);
+			}
+		}
+
+		/* Directory listings yield between batches */
+		if ((c->aborted == false) && (c->dir != NULL)) {
+			RING_INSERT(save_ring, c);
+			continue;
 		}
 
 		/* And now finish */
@@ -830,8 +1217,9 @@ static void fetch_file_poll(lwc_string *scheme)
 
 	}
 
-	/* Finally, if we saved any fetches which were locked, put them back
-	 * into the ring for next time
+	/* Finally, if we saved any fetches which were locked or are
+	 * part way through a listing, put them back into the ring for
+	 * next time
 	 */
 	ring = save_ring;
 }
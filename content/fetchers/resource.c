@@ -37,6 +37,7 @@
 #include "utils/messages.h"
 #include "utils/utils.h"
 #include "utils/ring.h"
+#include "utils/file.h"
 #include "netsurf/fetch.h"
 #include "desktop/gui_internal.h"
 
@@ -44,6 +45,10 @@
 #include "content/fetchers.h"
 #include "content/fetchers/resource.h"
 
+#include "resource/adblock.css.inc"
+#include "resource/default.css.inc"
+#include "resource/quirks.css.inc"
+
 #define DIRECT_ETAG_VALUE 123456
 
 /** Valid resource paths */
@@ -68,6 +73,39 @@ static const char *fetch_resource_paths[] = {
 	"icons/search.png"
 };
 
+/**
+ * Resources built into the browser.
+ *
+ * The user agent stylesheets are compacted at build time and used in
+ * place of the frontend's copy of them, unless that copy differs from
+ * the stylesheet the browser was built with because the user has
+ * changed it. This avoids tokenising their comments and whitespace
+ * each time the browser is started.
+ */
+static const struct fetch_resource_builtin {
+	const char *path; /**< resource scheme path */
+	const uint8_t *data; /**< resource data */
+	size_t data_len; /**< length of resource data */
+	const uint8_t *stock; /**< resource the data was built from */
+	size_t stock_len; /**< length of stock resource */
+} fetch_resource_builtins[] = {
+	{
+		"adblock.css",
+		adblock_css, sizeof(adblock_css),
+		adblock_css_stock, sizeof(adblock_css_stock),
+	},
+	{
+		"default.css",
+		default_css, sizeof(default_css),
+		default_css_stock, sizeof(default_css_stock),
+	},
+	{
+		"quirks.css",
+		quirks_css, sizeof(quirks_css),
+		quirks_css_stock, sizeof(quirks_css_stock),
+	},
+};
+
 /**
  * map of resource scheme paths to redirect urls
  */
@@ -76,6 +114,7 @@ static struct fetch_resource_map_entry {
 	nsurl *redirect_url; /**< url to redirect to */
 	const uint8_t *data; /**< direct pointer to data */
 	size_t data_len; /**< length of direct data */
+	bool builtin; /**< data is built in, not from the frontend */
 } fetch_resource_map[NOF_ELEMENTS(fetch_resource_paths)];
 
 struct fetch_resource_context;
@@ -265,9 +304,90 @@ fetch_resource_notfound_handler_aborted:
 
 
 
+/**
+ * Find the built in data for a resource.
+ *
+ * \param path The resource scheme path
+ * \return The built in data or NULL if there is none
+ */
+static const struct fetch_resource_builtin *
+fetch_resource_find_builtin(const char *path)
+{
+	uint32_t i;
+
+	for (i = 0; i < NOF_ELEMENTS(fetch_resource_builtins); i++) {
+		if (strcmp(fetch_resource_builtins[i].path, path) == 0) {
+			return &fetch_resource_builtins[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Determine if a file holds the stock copy of a built in resource.
+ *
+ * \param builtin The built in resource
+ * \param url The url of the file
+ * \return true if the file contents are the stock resource
+ */
+static bool
+fetch_resource_file_is_stock(const struct fetch_resource_builtin *builtin,
+			     nsurl *url)
+{
+	char *path;
+	FILE *fp;
+	uint8_t *data;
+	size_t len;
+	bool stock = false;
+
+	if (netsurf_nsurl_to_path(url, &path) != NSERROR_OK) {
+		/* not a file */
+		return false;
+	}
+
+	fp = fopen(path, "rb");
+	free(path);
+	if (fp == NULL) {
+		return false;
+	}
+
+	/* read one byte more than the stock length to spot a longer file */
+	data = malloc(builtin->stock_len + 1);
+	if (data != NULL) {
+		len = fread(data, 1, builtin->stock_len + 1, fp);
+		stock = (len == builtin->stock_len) &&
+			(memcmp(data, builtin->stock, len) == 0);
+		free(data);
+	}
+
+	fclose(fp);
+
+	return stock;
+}
+
+
+/**
+ * Use built in data for a resource in place of the frontend's copy.
+ *
+ * \param e The resource map entry to update
+ * \param builtin The built in resource
+ */
+static void
+fetch_resource_use_builtin(struct fetch_resource_map_entry *e,
+			   const struct fetch_resource_builtin *builtin)
+{
+	e->data = builtin->data;
+	e->data_len = builtin->data_len;
+	e->builtin = true;
+}
+
+
 /** callback to initialise the resource fetcher. */
 static bool fetch_resource_initialise(lwc_string *scheme)
 {
+	const struct fetch_resource_builtin *builtin;
 	struct fetch_resource_map_entry *e;
 	uint32_t i;
 	nserror res;
@@ -289,21 +409,50 @@ static bool fetch_resource_initialise(lwc_string *scheme)
 		}
 
 		e->data = NULL;
+		e->builtin = false;
+		builtin = fetch_resource_find_builtin(fetch_resource_paths[i]);
 		res = guit->fetch->get_resource_data(lwc_string_data(e->path),
 						     &e->data,
 						     &e->data_len);
 		if (res == NSERROR_OK) {
-			NSLOG(netsurf, INFO, "direct data for %s",
-			      fetch_resource_paths[i]);
+			if ((builtin != NULL) &&
+			    (e->data_len == builtin->stock_len) &&
+			    (memcmp(e->data, builtin->stock,
+				    e->data_len) == 0)) {
+				guit->fetch->release_resource_data(e->data);
+				fetch_resource_use_builtin(e, builtin);
+				NSLOG(netsurf, INFO, "built in data for %s",
+				      fetch_resource_paths[i]);
+			} else {
+				NSLOG(netsurf, INFO, "direct data for %s",
+				      fetch_resource_paths[i]);
+			}
 			fetch_resource_path_count++;
 		} else {
 			e->redirect_url = guit->fetch->get_resource_url(fetch_resource_paths[i]);
-			if (e->redirect_url == NULL) {
-				lwc_string_unref(e->path);
-			} else {
-				NSLOG(netsurf, INFO, "redirect url for %s",
+			if (e->redirect_url != NULL) {
+				if ((builtin != NULL) &&
+				    fetch_resource_file_is_stock(builtin,
+							e->redirect_url)) {
+					nsurl_unref(e->redirect_url);
+					e->redirect_url = NULL;
+					fetch_resource_use_builtin(e, builtin);
+					NSLOG(netsurf, INFO,
+					      "built in data for %s",
+					      fetch_resource_paths[i]);
+				} else {
+					NSLOG(netsurf, INFO,
+					      "redirect url for %s",
+					      fetch_resource_paths[i]);
+				}
+				fetch_resource_path_count++;
+			} else if (builtin != NULL) {
+				fetch_resource_use_builtin(e, builtin);
+				NSLOG(netsurf, INFO, "built in data for %s",
 				      fetch_resource_paths[i]);
 				fetch_resource_path_count++;
+			} else {
+				lwc_string_unref(e->path);
 			}
 		}
 	}
@@ -318,7 +467,9 @@ static void fetch_resource_finalise(lwc_string *scheme)
 
 	for (i = 0; i < fetch_resource_path_count; i++) {
 		lwc_string_unref(fetch_resource_map[i].path);
-		if (fetch_resource_map[i].data != NULL) {
+		if (fetch_resource_map[i].builtin) {
+			/* nothing to release */
+		} else if (fetch_resource_map[i].data != NULL) {
 			guit->fetch->release_resource_data(fetch_resource_map[i].data);
 		} else {
 			nsurl_unref(fetch_resource_map[i].redirect_url);
@@ -1137,7 +1137,7 @@ read_entries(struct store_state *state)
 		return ret;
 	}
 
-	state->entries = hashmap_create(&entries_hashmap_parameters);
+	state->entries = hashmap_create_open(&entries_hashmap_parameters, 0);
 	if (state->entries == NULL) {
 		free(fname);
 		return NSERROR_NOMEM;
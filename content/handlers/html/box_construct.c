@@ -26,15 +26,19 @@
  */
 
 #include <string.h>
+#include <inttypes.h>
+#include <nsutils/time.h>
 #include <dom/dom.h>
 
 #include "utils/errors.h"
+#include "utils/log.h"
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
 #include "utils/talloc.h"
 #include "utils/string.h"
 #include "utils/ascii.h"
 #include "utils/nsurl.h"
+#include "utils/trace.h"
 #include "utils/utils.h"
 #include "netsurf/misc.h"
 #include "css/select.h"
@@ -62,6 +66,15 @@ struct box_construct_ctx {
 	box_construct_complete_cb cb;	/**< Callback to invoke on completion */
 
 	int *bctx;			/**< talloc context */
+
+	bool provisional;		/**< Building a provisional tree */
+
+	uint32_t converted;		/**< Number of elements converted */
+
+	uint64_t elapsed;		/**< Time spent converting, in ms */
+
+	uint64_t select_time;		/**< Time spent selecting styles in
+					 *   this slice, in us, if tracing */
 };
 
 /**
@@ -242,18 +255,21 @@ box_extract_properties(dom_node *n, struct box_construct_props *props)
  * \param  parent_style    style at this point in xml tree, or NULL for root
  * \param  root_style      root node's style, or NULL for root
  * \param  n               node in xml tree
+ * \param  select_time     updated with time spent selecting, if tracing
  * \return  the new style, or NULL on memory exhaustion
  */
 static css_select_results *
 box_get_style(html_content *c,
 	      const css_computed_style *parent_style,
 	      const css_computed_style *root_style,
-	      dom_node *n)
+	      dom_node *n,
+	      uint64_t *select_time)
 {
 	dom_string *s = NULL;
 	css_stylesheet *inline_style = NULL;
 	css_select_results *styles;
 	nscss_select_ctx ctx;
+	uint64_t trace;
 
 	/* Firstly, construct inline stylesheet, if any */
 	if (nsoption_bool(author_level_css)) {
@@ -287,8 +303,13 @@ box_get_style(html_content *c,
 	ctx.parent_style = parent_style;
 
 	/* Select style for element */
+	trace = nstrace_begin();
 	styles = nscss_get_style(&ctx, n, &c->media, &c->unit_len_ctx,
 			inline_style);
+	if (trace != 0) {
+		/* too short to trace singly, the total is traced */
+		*select_time += nstrace_time() - trace;
+	}
 
 	/* No longer need inline style */
 	if (inline_style != NULL)
@@ -414,6 +435,7 @@ box_construct_marker(struct box *box,
 
 	if (css_computed_list_style_image(box->style, &image_uri) == CSS_LIST_STYLE_IMAGE_URI &&
 	    (image_uri != NULL) &&
+	    (ctx->provisional == false) &&
 	    (nsoption_bool(foreground_images) == true)) {
 		nsurl *url;
 		nserror error;
@@ -497,7 +519,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	}
 
 	styles = box_get_style(ctx->content, props.parent_style, root_style,
-			ctx->n);
+			ctx->n, &ctx->select_time);
 	if (styles == NULL)
 		return false;
 
@@ -616,6 +638,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	if (convert_special_elements(ctx->n,
 				     ctx->content,
 				     box,
+				     ctx->provisional,
 				     convert_children) == false) {
 		return false;
 	}
@@ -686,6 +709,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	/* Kick off fetch for any background image */
 	if (css_computed_background_image(box->style, &bgimage_uri) ==
 			CSS_BACKGROUND_IMAGE_IMAGE && bgimage_uri != NULL &&
+			ctx->provisional == false &&
 			nsoption_bool(background_images) == true) {
 		nsurl *url;
 		nserror error;
@@ -1228,15 +1252,80 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 
 
 /**
- * Convert an ELEMENT node to a box tree fragment,
- * then schedule conversion of the next ELEMENT node
+ * Complete construction of the elements enclosing a node.
+ *
+ * Used when construction stops before the end of the document, to
+ * finish the elements which were left open.
+ *
+ * \param n        First node which was not converted
+ * \param content  Containing document
  */
-static void convert_xml_to_box(struct box_construct_ctx *ctx)
+static void box_construct_close(dom_node *n, html_content *content)
+{
+	dom_node *parent;
+	dom_exception err;
+
+	dom_node_ref(n);
+
+	while (box_is_root(n) == false) {
+		err = dom_node_get_parent_node(n, &parent);
+		dom_node_unref(n);
+		if (err != DOM_NO_ERR || parent == NULL)
+			return;
+
+		if (box_for_node(parent) != NULL)
+			box_construct_element_after(parent, content);
+
+		n = parent;
+	}
+
+	dom_node_unref(n);
+}
+
+
+/**
+ * Normalise a constructed box tree.
+ *
+ * \param ctx  Box construction context
+ * \return root of the normalised tree or NULL on memory exhaustion
+ */
+static struct box *box_construct_normalise(struct box_construct_ctx *ctx)
+{
+	struct box root;
+	bool ok;
+
+	memset(&root, 0, sizeof(root));
+
+	root.type = BOX_BLOCK;
+	root.children = root.last = ctx->root_box;
+	root.children->parent = &root;
+
+	/** \todo Remove box_normalise_block */
+	ok = box_normalise_block(&root, ctx->root_box, ctx->content);
+
+	root.children->parent = NULL;
+
+	return ok ? root.children : NULL;
+}
+
+
+/**
+ * Convert a batch of ELEMENT nodes to box tree fragments
+ *
+ * Elements are converted until the time slice given by the
+ * box_construct_slice option has been used.
+ *
+ * \param ctx Box construction context, freed on completion or error
+ * \param ms_start Time the batch started, in ms
+ * \return true if there is more work to do, false if ctx was freed
+ */
+static bool
+convert_xml_to_box_batch(struct box_construct_ctx *ctx, uint64_t ms_start)
 {
 	dom_node *next;
 	bool convert_children;
-	uint32_t num_processed = 0;
-	const uint32_t max_processed_before_yield = 10;
+	uint64_t ms_now;
+	uint64_t ms_end = ms_start + nsoption_uint(box_construct_slice);
 
 	do {
 		convert_children = true;
@@ -1247,7 +1336,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 			ctx->cb(ctx->content, false);
 			dom_node_unref(ctx->n);
 			free(ctx);
-			return;
+			return false;
 		}
 
 		/* Find next element to process, converting text nodes as we go */
@@ -1261,7 +1350,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 				ctx->cb(ctx->content, false);
 				dom_node_unref(next);
 				free(ctx);
-				return;
+				return false;
 			}
 
 			if (type == DOM_ELEMENT_NODE)
@@ -1273,7 +1362,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 					ctx->cb(ctx->content, false);
 					dom_node_unref(ctx->n);
 					free(ctx);
-					return;
+					return false;
 				}
 			}
 
@@ -1281,24 +1370,22 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 		}
 
 		ctx->n = next;
+		ctx->converted++;
 
 		if (next == NULL) {
 			/* Conversion complete */
-			struct box root;
+			struct box *layout = box_construct_normalise(ctx);
 
-			memset(&root, 0, sizeof(root));
+			nsu_getmonotonic_ms(&ms_now);
+			ctx->elapsed += ms_now - ms_start;
+			NSLOG(netsurf, INFO,
+			      "Converted %"PRIu32" elements in %"PRIu64"ms",
+			      ctx->converted, ctx->elapsed);
 
-			root.type = BOX_BLOCK;
-			root.children = root.last = ctx->root_box;
-			root.children->parent = &root;
-
-			/** \todo Remove box_normalise_block */
-			if (box_normalise_block(&root, ctx->root_box,
-					ctx->content) == false) {
+			if (layout == NULL) {
 				ctx->cb(ctx->content, false);
 			} else {
-				ctx->content->layout = root.children;
-				ctx->content->layout->parent = NULL;
+				ctx->content->layout = layout;
 
 				ctx->cb(ctx->content, true);
 			}
@@ -1306,12 +1393,56 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 			assert(ctx->n == NULL);
 
 			free(ctx);
-			return;
+			return false;
+		}
+
+		/* Reading the clock is cheap, but not free */
+		if ((ctx->converted & 7) == 0) {
+			nsu_getmonotonic_ms(&ms_now);
+		} else {
+			ms_now = ms_start;
 		}
-	} while (++num_processed < max_processed_before_yield);
+	} while (ms_now < ms_end);
 
-	/* More work to do: schedule a continuation */
-	guit->misc->schedule(0, (void *)convert_xml_to_box, ctx);
+	ctx->elapsed += ms_now - ms_start;
+
+	return true;
+}
+
+
+/**
+ * Convert an ELEMENT node to a box tree fragment,
+ * then schedule conversion of the next ELEMENT node
+ */
+static void convert_xml_to_box(struct box_construct_ctx *ctx)
+{
+	unsigned int track;
+	uint64_t trace;
+	uint64_t ms_start;
+	uint32_t converted = ctx->converted;
+	bool more;
+
+	track = nstrace_enter(ctx->content->base.trace_track);
+	trace = nstrace_begin();
+
+	nsu_getmonotonic_ms(&ms_start);
+	ctx->select_time = 0;
+	more = convert_xml_to_box_batch(ctx, ms_start);
+
+	nstrace_total("css", "select", ctx->select_time);
+	nstrace_end("html", "box construct", trace);
+	if (more) {
+		/* Elements converted in this slice, which ran for the
+		 * whole slice time */
+		nstrace_counter("html", "box construct elements",
+				ctx->converted - converted);
+	}
+	nstrace_leave(track);
+
+	if (more) {
+		/* More work to do: schedule a continuation */
+		guit->misc->schedule(0, (void *)convert_xml_to_box, ctx);
+	}
 }
 
 
@@ -1344,6 +1475,9 @@ dom_to_box(dom_node *n,
 	ctx->root_box = NULL;
 	ctx->cb = cb;
 	ctx->bctx = c->bctx;
+	ctx->provisional = false;
+	ctx->converted = 0;
+	ctx->elapsed = 0;
 
 	*box_conversion_context = ctx;
 
@@ -1351,6 +1485,102 @@ dom_to_box(dom_node *n,
 }
 
 
+/* exported function documented in html/box_construct.h */
+nserror
+dom_to_box_provisional(dom_node *n,
+		       html_content *c,
+		       struct box *root,
+		       unsigned int budget,
+		       struct box **layout,
+		       dom_node **stop)
+{
+	struct box_construct_ctx ctx;
+	bool convert_children;
+	unsigned int converted = 0;
+
+	assert(c->bctx != NULL);
+
+	ctx.content = c;
+	ctx.n = dom_node_ref(n);
+	ctx.root_box = root;
+	ctx.cb = NULL;
+	ctx.bctx = c->bctx;
+	ctx.provisional = true;
+	ctx.converted = 0;
+	ctx.elapsed = 0;
+	ctx.select_time = 0;
+
+	*stop = NULL;
+
+	/* When resuming, n may be any node following the part of the
+	 * document already in the tree, so each node is examined in turn
+	 */
+	while (ctx.n != NULL) {
+		dom_node_type type;
+		dom_exception err;
+
+		err = dom_node_get_node_type(ctx.n, &type);
+		if (err != DOM_NO_ERR) {
+			dom_node_unref(ctx.n);
+			goto error;
+		}
+
+		convert_children = true;
+
+		if (type == DOM_ELEMENT_NODE) {
+			if (converted == budget) {
+				break;
+			}
+
+			if (box_construct_element(&ctx,
+					&convert_children) == false) {
+				dom_node_unref(ctx.n);
+				goto error;
+			}
+			converted++;
+
+		} else if (type == DOM_TEXT_NODE) {
+			if (box_construct_text(&ctx) == false) {
+				dom_node_unref(ctx.n);
+				goto error;
+			}
+		}
+
+		ctx.n = next_node(ctx.n, c, convert_children);
+	}
+
+	nstrace_total("css", "select", ctx.select_time);
+
+	if (ctx.n != NULL) {
+		/* Out of budget; the rest of the document is left out */
+		box_construct_close(ctx.n, c);
+		*stop = ctx.n;
+	}
+
+	if (ctx.root_box == NULL) {
+		/* Nothing was converted */
+		goto error;
+	}
+
+	*layout = box_construct_normalise(&ctx);
+	if (*layout != NULL) {
+		return NSERROR_OK;
+	}
+
+error:
+	if (*stop != NULL) {
+		dom_node_unref(*stop);
+		*stop = NULL;
+	}
+
+	if (root == NULL && ctx.root_box != NULL) {
+		box_detach_dom(ctx.root_box);
+	}
+
+	return NSERROR_NOMEM;
+}
+
+
 /* exported function documented in html/box_construct.h */
 nserror cancel_dom_to_box(void *box_conversion_context)
 {
@@ -1383,6 +1613,47 @@ struct box *box_for_node(dom_node *n)
 	return box;
 }
 
+/* exported function documented in html/box_construct.h */
+void box_detach_dom(struct box *box)
+{
+	struct box *child;
+	struct box *current;
+	dom_exception err;
+
+	if (box->node != NULL) {
+		err = dom_node_get_user_data(box->node,
+				corestring_dom___ns_key_box_node_data,
+				(void *) &current);
+		if (err == DOM_NO_ERR && current == box) {
+			dom_node_set_user_data(box->node,
+					corestring_dom___ns_key_box_node_data,
+					NULL, NULL, (void *) &current);
+		}
+	}
+
+	for (child = box->children; child != NULL; child = child->next) {
+		box_detach_dom(child);
+	}
+}
+
+/* exported function documented in html/box_construct.h */
+void box_attach_dom(struct box *box)
+{
+	struct box *child;
+	struct box *old_box;
+
+	/* Boxes continuing a wrapped box share its node */
+	if (box->node != NULL && (box->flags & CLONE) == 0) {
+		dom_node_set_user_data(box->node,
+				corestring_dom___ns_key_box_node_data,
+				box, NULL, (void *) &old_box);
+	}
+
+	for (child = box->children; child != NULL; child = child->next) {
+		box_attach_dom(child);
+	}
+}
+
 /* exported function documented in html/box_construct.h */
 bool
 box_extract_link(const html_content *content,
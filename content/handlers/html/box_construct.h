@@ -84,6 +84,29 @@
 nserror dom_to_box(struct dom_node *n, struct html_content *c, box_construct_complete_cb cb, void **box_conversion_context);
 
 
+/**
+ * Construct a provisional box tree for a partly loaded document
+ *
+ * The tree is constructed synchronously from the DOM as it currently
+ * stands. No objects are fetched and no form controls or frames are
+ * created; those are left to the final construction by dom_to_box().
+ *
+ * A new tree is constructed from the document element. Alternatively an
+ * existing provisional tree, which must already hold the part of the
+ * document before \a n and nothing after it, is extended from \a n.
+ *
+ * \param n dom document element, or first node to convert into root
+ * \param c content of type CONTENT_HTML whose bctx the tree is built in
+ * \param root existing provisional tree to extend, or NULL for a new tree
+ * \param budget maximum number of elements to convert
+ * \param layout updated to the root of the tree on success
+ * \param stop updated to a reference to the first node not converted if
+ *             the budget ran out, or NULL if the whole DOM was converted
+ * \return NSERROR_OK on success else error code
+ */
+nserror dom_to_box_provisional(struct dom_node *n, struct html_content *c, struct box *root, unsigned int budget, struct box **layout, struct dom_node **stop);
+
+
 /**
  * aborts any ongoing box construction
  */
@@ -98,6 +121,25 @@ nserror cancel_dom_to_box(void *box_conversion_context);
  */
 struct box *box_for_node(struct dom_node *node);
 
+/**
+ * Remove the association of a box tree's boxes with their DOM nodes
+ *
+ * This must be done before a box tree is freed while the DOM it was
+ * constructed from remains in use.
+ *
+ * \param box The root of the box tree
+ */
+void box_detach_dom(struct box *box);
+
+/**
+ * Associate a box tree's boxes with their DOM nodes again
+ *
+ * Reverses box_detach_dom() for a tree which is to be used once more.
+ *
+ * \param box The root of the box tree
+ */
+void box_attach_dom(struct box *box);
+
 /**
  * Extract a URL from a relative link, handling junk like whitespace and
  * attempting to read a real URL from "javascript:" links.
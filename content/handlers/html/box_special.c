@@ -1853,6 +1853,7 @@ bool
 convert_special_elements(dom_node *node,
 			 html_content *content,
 			 struct box *box,
+			 bool provisional,
 			 bool *convert_children)
 {
 	dom_exception exc;
@@ -1864,6 +1865,28 @@ convert_special_elements(dom_node *node,
 		tag_type = DOM_HTML_ELEMENT_TYPE__UNKNOWN;
 	}
 
+	if (provisional) {
+		/* Elements which fetch objects, create frames or own form
+		 * controls are left empty until the final construction.
+		 */
+		switch (tag_type) {
+		case DOM_HTML_ELEMENT_TYPE_BUTTON:
+		case DOM_HTML_ELEMENT_TYPE_EMBED:
+		case DOM_HTML_ELEMENT_TYPE_FRAMESET:
+		case DOM_HTML_ELEMENT_TYPE_IFRAME:
+		case DOM_HTML_ELEMENT_TYPE_IMG:
+		case DOM_HTML_ELEMENT_TYPE_INPUT:
+		case DOM_HTML_ELEMENT_TYPE_OBJECT:
+		case DOM_HTML_ELEMENT_TYPE_SELECT:
+		case DOM_HTML_ELEMENT_TYPE_TEXTAREA:
+			*convert_children = false;
+			return true;
+
+		default:
+			break;
+		}
+	}
+
 	switch (tag_type) {
 	case DOM_HTML_ELEMENT_TYPE_A:
 		res =  box_a(node, content, box, convert_children);
@@ -28,8 +28,11 @@
 /**
  * call an elements special conversion handler
  *
+ * When constructing a provisional box tree elements which would fetch
+ * objects, create frames or form controls are not converted.
+ *
  * \return true if box construction should continue else false on error.
  */
-bool convert_special_elements(dom_node *node, html_content *content, struct box *box, bool *convert_children);
+bool convert_special_elements(dom_node *node, html_content *content, struct box *box, bool provisional, bool *convert_children);
 
 #endif
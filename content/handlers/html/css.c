@@ -33,6 +33,7 @@
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
 #include "utils/log.h"
+#include "utils/trace.h"
 #include "netsurf/inttypes.h"
 #include "netsurf/misc.h"
 #include "netsurf/content.h"
@@ -43,12 +44,36 @@
 #include "html/html.h"
 #include "html/private.h"
 #include "html/css.h"
+#include "html/progressive.h"
 
 static nsurl *html_default_stylesheet_url;
 static nsurl *html_adblock_stylesheet_url;
 static nsurl *html_quirks_stylesheet_url;
 static nsurl *html_user_stylesheet_url;
 
+/**
+ * A selection context shared by the contents with the same stylesheets
+ *
+ * The context is a user of each stylesheet content, so no sheet in it
+ * is freed, and its address reused by another sheet, while the
+ * context exists.
+ */
+struct html_css_select {
+	struct html_css_select *next;	/**< Next context in list */
+	css_select_ctx *ctx;		/**< The selection context */
+	unsigned int refcnt;		/**< Number of users */
+	uint32_t sheet_count;		/**< Number of sheets in context */
+	/** Sheets in the context, in order, with their origins */
+	struct html_css_select_sheet {
+		css_stylesheet *sheet;
+		css_origin origin;
+		struct content *content;	/**< Content owning sheet */
+	} sheets[];
+};
+
+/** Selection contexts in use */
+static struct html_css_select *html_css_selects;
+
 /**
  * Convert css error to netsurf error.
  */
@@ -115,6 +140,7 @@ html_convert_css_callback(hlcache_handle *css,
 		      nsurl_access(hlcache_handle_get_url(css)));
 		parent->base.active--;
 		NSLOG(netsurf, INFO, "%d fetches active", parent->base.active);
+		html_progressive_invalidate(parent);
 		break;
 
 	case CONTENT_MSG_ERROR:
@@ -126,6 +152,7 @@ html_convert_css_callback(hlcache_handle *css,
 		s->sheet = NULL;
 		parent->base.active--;
 		NSLOG(netsurf, INFO, "%d fetches active", parent->base.active);
+		html_progressive_invalidate(parent);
 		break;
 
 	case CONTENT_MSG_POINTER:
@@ -648,26 +675,92 @@ nserror html_css_new_stylesheets(html_content *c)
 }
 
 
+/**
+ * Callback for the stylesheet contents used by a selection context.
+ *
+ * The context only uses the contents to keep their sheets alive so
+ * their messages are ignored.
+ */
+static void
+html_css_select_sheet_callback(struct content *c,
+		content_msg msg,
+		const union content_msg_data *data,
+		void *pw)
+{
+}
+
+
+/**
+ * Destroy a selection context entry
+ *
+ * \param sel The entry, which is not in the list of contexts
+ * \param count The number of sheets the entry is a user of
+ */
+static void html_css_destroy_select(struct html_css_select *sel, uint32_t count)
+{
+	uint32_t i;
+
+	if (sel->ctx != NULL) {
+		css_select_ctx_destroy(sel->ctx);
+	}
+
+	for (i = 0; i != count; i++) {
+		content_remove_user(sel->sheets[i].content,
+				html_css_select_sheet_callback, sel);
+	}
+
+	free(sel);
+}
+
+
+/**
+ * Find a selection context for a list of stylesheets
+ *
+ * \param sheets The stylesheets, in order, with their origins
+ * \param sheet_count The number of stylesheets
+ * \return The selection context entry or NULL if there is none
+ */
+static struct html_css_select *
+html_css_find_select(const struct html_css_select_sheet *sheets,
+		uint32_t sheet_count)
+{
+	struct html_css_select *sel;
+
+	for (sel = html_css_selects; sel != NULL; sel = sel->next) {
+		if (sel->sheet_count == sheet_count &&
+		    memcmp(sel->sheets, sheets,
+				sheet_count * sizeof(*sheets)) == 0) {
+			return sel;
+		}
+	}
+
+	return NULL;
+}
+
+
 /* exported function documented in html/css.h */
 nserror
 html_css_new_selection_context(html_content *c, css_select_ctx **ret_select_ctx)
 {
 	uint32_t i;
+	uint32_t count = 0;
 	css_error css_ret;
-	css_select_ctx *select_ctx;
+	struct html_css_select *sel;
+	struct html_css_select *found;
+	uint64_t trace;
 
 	/* check that the base stylesheet loaded; layout fails without it */
 	if (c->stylesheets[STYLESHEET_BASE].sheet == NULL) {
 		return NSERROR_CSS_BASE;
 	}
 
-	/* Create selection context */
-	css_ret = css_select_ctx_create(&select_ctx);
-	if (css_ret != CSS_OK) {
-		return css_error_to_nserror(css_ret);
+	sel = malloc(sizeof(*sel) +
+			c->stylesheet_count * sizeof(sel->sheets[0]));
+	if (sel == NULL) {
+		return NSERROR_NOMEM;
 	}
 
-	/* Add sheets to it */
+	/* Determine the sheets which form the context */
 	for (i = STYLESHEET_BASE; i != c->stylesheet_count; i++) {
 		const struct html_stylesheet *hsheet = &c->stylesheets[i];
 		css_stylesheet *sheet = NULL;
@@ -692,26 +785,104 @@ html_css_new_selection_context(html_content *c, css_select_ctx **ret_select_ctx)
 		}
 
 		if (sheet != NULL) {
-			/* TODO: Pass the sheet's full media query, instead of
-			 *       "screen".
-			 */
-			css_ret = css_select_ctx_append_sheet(select_ctx,
-							      sheet,
-							      origin,
-							      "screen");
-			if (css_ret != CSS_OK) {
-				css_select_ctx_destroy(select_ctx);
-				return css_error_to_nserror(css_ret);
-			}
+			/* zero padding so entries can be compared whole */
+			memset(&sel->sheets[count], 0, sizeof(sel->sheets[0]));
+			sel->sheets[count].sheet = sheet;
+			sel->sheets[count].origin = origin;
+			sel->sheets[count].content =
+				hlcache_handle_get_content(hsheet->sheet);
+			count++;
+		}
+	}
+
+	/* Share an existing context with the same sheets. Stylesheet
+	 * contents are shared between pages, so pages on the same site
+	 * usually have the same sheets.
+	 */
+	found = html_css_find_select(sel->sheets, count);
+	if (found != NULL) {
+		free(sel);
+
+		found->refcnt++;
+		NSLOG(netsurf, INFO, "Sharing selection context %p (%u users)",
+		      found->ctx, found->refcnt);
+
+		*ret_select_ctx = found->ctx;
+		return NSERROR_OK;
+	}
+
+	/* Keep the sheets alive for as long as the context */
+	sel->ctx = NULL;
+	for (i = 0; i != count; i++) {
+		if (!content_add_user(sel->sheets[i].content,
+				html_css_select_sheet_callback, sel)) {
+			html_css_destroy_select(sel, i);
+			return NSERROR_NOMEM;
+		}
+	}
+
+	trace = nstrace_begin();
+
+	/* Create selection context */
+	css_ret = css_select_ctx_create(&sel->ctx);
+	if (css_ret != CSS_OK) {
+		sel->ctx = NULL;
+		html_css_destroy_select(sel, count);
+		return css_error_to_nserror(css_ret);
+	}
+
+	/* Add sheets to it */
+	for (i = 0; i != count; i++) {
+		/* TODO: Pass the sheet's full media query, instead of
+		 *       "screen".
+		 */
+		css_ret = css_select_ctx_append_sheet(sel->ctx,
+						      sel->sheets[i].sheet,
+						      sel->sheets[i].origin,
+						      "screen");
+		if (css_ret != CSS_OK) {
+			html_css_destroy_select(sel, count);
+			return css_error_to_nserror(css_ret);
 		}
 	}
 
+	nstrace_end("css", "selection context", trace);
+
+	sel->refcnt = 1;
+	sel->sheet_count = count;
+	sel->next = html_css_selects;
+	html_css_selects = sel;
+
 	/* return new selection context to caller */
-	*ret_select_ctx = select_ctx;
+	*ret_select_ctx = sel->ctx;
 	return NSERROR_OK;
 }
 
 
+/* exported function documented in html/css.h */
+void html_css_free_selection_context(css_select_ctx *select_ctx)
+{
+	struct html_css_select **prev = &html_css_selects;
+	struct html_css_select *sel;
+
+	for (sel = html_css_selects; sel != NULL; sel = sel->next) {
+		if (sel->ctx == select_ctx) {
+			break;
+		}
+		prev = &sel->next;
+	}
+
+	assert(sel != NULL);
+
+	if (--sel->refcnt > 0) {
+		return;
+	}
+
+	*prev = sel->next;
+	html_css_destroy_select(sel, sel->sheet_count);
+}
+
+
 /* exported function documented in html/css.h */
 nserror html_css_init(void)
 {
@@ -746,6 +917,10 @@ nserror html_css_init(void)
 /* exported function documented in html/css.h */
 void html_css_fini(void)
 {
+	if (html_css_selects != NULL) {
+		NSLOG(netsurf, ERROR, "Selection contexts still in use");
+	}
+
 	if (html_user_stylesheet_url != NULL) {
 		nsurl_unref(html_user_stylesheet_url);
 		html_user_stylesheet_url = NULL;
@@ -39,12 +39,22 @@ void html_css_fini(void);
 /**
  * create a new css selection context for an html content.
  *
+ * Contents with the same stylesheets share a selection context, so the
+ * context must not be modified by the caller.
+ *
  * \param c The html content to create css selction on.
  * \param select_ctx A pointer to receive the new context.
  * \return NSERROR_OK on success and \a select_ctx updated else error code
  */
 nserror html_css_new_selection_context(struct html_content *c, css_select_ctx **select_ctx);
 
+/**
+ * Release a css selection context.
+ *
+ * \param select_ctx Context from html_css_new_selection_context()
+ */
+void html_css_free_selection_context(css_select_ctx *select_ctx);
+
 /**
  * Initialise core stylesheets for a content
  *
@@ -44,6 +44,7 @@
 #include "html/box_construct.h"
 #include "html/form_internal.h"
 #include "html/dom_event.h"
+#include "html/progressive.h"
 
 
 /**
@@ -591,6 +592,8 @@ dom_default_action_DOMNodeInserted_cb(struct dom_event *evt, void *pw)
 		return;
 	}
 
+	html_progressive_node_changed(htmlc, (dom_node *)node);
+
 	exc = dom_node_get_node_type(node, &type);
 	if ((exc == DOM_NO_ERR) && (type == DOM_ELEMENT_NODE)) {
 		/* an element node has been inserted */
@@ -711,6 +714,8 @@ dom_default_action_DOMSubtreeModified_cb(struct dom_event *evt, void *pw)
 
 	exc = dom_event_get_target(evt, &node);
 	if ((exc == DOM_NO_ERR) && (node != NULL)) {
+		html_progressive_node_changed(htmlc, (dom_node *)node);
+
 		if (htmlc->title == (dom_node *)node) {
 			/* Node is our title node */
 			html_process_title(htmlc, (dom_node *)node);
@@ -41,6 +41,7 @@
 #include "utils/nsoption.h"
 #include "utils/string.h"
 #include "utils/ascii.h"
+#include "utils/trace.h"
 #include "netsurf/content.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/utf8.h"
@@ -71,6 +72,7 @@
 #include "html/imagemap.h"
 #include "html/layout.h"
 #include "html/textselection.h"
+#include "html/progressive.h"
 
 #define CHUNK 4096
 
@@ -273,7 +275,12 @@ static void html_box_convert_done(html_content *c, bool success)
 	dom_hubbub_parser_destroy(c->parser);
 	c->parser = NULL;
 
-	content_set_ready(&c->base);
+	if (c->progressive.active) {
+		/* Already READY; replace the provisional box tree */
+		html_progressive_complete(c);
+	} else {
+		content_set_ready(&c->base);
+	}
 
 	html_proceed_to_done(c);
 
@@ -286,7 +293,8 @@ html_proceed_to_done(html_content *html)
 {
 	switch (content__get_status(&html->base)) {
 	case CONTENT_STATUS_READY:
-		if (html->base.active == 0) {
+		if (html->base.active == 0 &&
+		    html->progressive.active == false) {
 			content_set_done(&html->base);
 			return NSERROR_OK;
 		}
@@ -303,7 +311,8 @@ html_proceed_to_done(html_content *html)
 }
 
 
-static void html_get_dimensions(html_content *htmlc)
+/* exported function documented in html/private.h */
+void html_get_dimensions(html_content *htmlc)
 {
 	css_fixed device_dpi = nscss_screen_dpi;
 	unsigned f_size;
@@ -401,6 +410,9 @@ void html_finish_conversion(html_content *htmlc)
 
 	html_get_dimensions(htmlc);
 
+	/* stop provisional rendering */
+	html_progressive_detach(htmlc);
+
 	error = dom_to_box(html, htmlc, html_box_convert_done, &htmlc->box_conversion_context);
 	if (error != NSERROR_OK) {
 		NSLOG(netsurf, INFO, "box conversion failed");
@@ -462,6 +474,7 @@ html_create_html_data(html_content *c, const http_parameter *params)
 			"dark" : "light";
 
 	c->parser = NULL;
+	c->data_completed = false;
 	c->parse_completed = false;
 	c->conversion_begun = false;
 	c->document = NULL;
@@ -475,6 +488,7 @@ html_create_html_data(html_content *c, const http_parameter *params)
 	c->title = NULL;
 	c->bctx = NULL;
 	c->layout = NULL;
+	html_progressive_init(c);
 	c->background_colour = NS_TRANSPARENT;
 	c->stylesheet_count = 0;
 	c->stylesheets = NULL;
@@ -738,10 +752,16 @@ html_process_data(struct content *c, const char *data, unsigned int size)
 	html_content *html = (html_content *) c;
 	dom_hubbub_error dom_ret;
 	nserror err = NSERROR_OK; /* assume its all going to be ok */
+	unsigned int track;
+	uint64_t trace;
 
+	track = nstrace_enter(c->trace_track);
+	trace = nstrace_begin();
 	dom_ret = dom_hubbub_parser_parse_chunk(html->parser,
 					      (const uint8_t *) data,
 					      size);
+	nstrace_end("html", "parse", trace);
+	nstrace_leave(track);
 
 	err = libdom_hubbub_error_to_nserror(dom_ret);
 
@@ -756,6 +776,8 @@ html_process_data(struct content *c, const char *data, unsigned int size)
 		return false;
 	}
 
+	html_progressive_update(html);
+
 	return true;
 }
 
@@ -779,6 +801,12 @@ static bool html_convert(struct content *c)
 	html_content *htmlc = (html_content *) c;
 	dom_exception exc; /* returned by libdom functions */
 
+	/* Stopping a provisionally displayed document ends its source */
+	if (htmlc->data_completed) {
+		return true;
+	}
+	htmlc->data_completed = true;
+
 	/* The quirk check and associated stylesheet fetch is "safe"
 	 * once the root node has been inserted into the document
 	 * which must have happened by this point in the parse.
@@ -1026,9 +1054,22 @@ static void html_stop(struct content *c)
 	case CONTENT_STATUS_READY:
 		html_object_abort_objects(htmlc);
 
+		if (htmlc->progressive.active &&
+		    htmlc->data_completed == false) {
+			/* A provisionally displayed document ends with the
+			 * source received so far, which is converted as if
+			 * it had all arrived. */
+			if (html_convert(c) == false) {
+				content_set_error(c);
+			}
+			break;
+		}
+
 		/* If there are no further active fetches and we're still
-		 * in the READY state, transition to the DONE state. */
-		if (c->status == CONTENT_STATUS_READY && c->active == 0) {
+		 * in the READY state, transition to the DONE state. A
+		 * provisionally displayed document is still converting. */
+		if (c->status == CONTENT_STATUS_READY && c->active == 0 &&
+		    htmlc->progressive.active == false) {
 			content_set_done(c);
 		}
 
@@ -1057,6 +1098,8 @@ static void html_reformat(struct content *c, int width, int height)
 	uint64_t ms_before;
 	uint64_t ms_after;
 	uint64_t ms_interval;
+	unsigned int track;
+	uint64_t trace;
 
 	nsu_getmonotonic_ms(&ms_before);
 
@@ -1068,7 +1111,11 @@ static void html_reformat(struct content *c, int width, int height)
 			INTTOFIX(height), htmlc->unit_len_ctx.device_dpi);
 	htmlc->unit_len_ctx.root_style = htmlc->layout->style;
 
+	track = nstrace_enter(c->trace_track);
+	trace = nstrace_begin();
 	layout_document(htmlc, width, height);
+	nstrace_end("layout", "layout", trace);
+	nstrace_leave(track);
 	layout = htmlc->layout;
 
 	/* width and height are at least margin box of document */
@@ -1213,6 +1260,9 @@ static void html_destroy(struct content *c)
 		}
 	}
 
+	/* Cancel provisional rendering and free any provisional layout */
+	html_progressive_destroy(html);
+
 	selection_destroy(html->sel);
 
 	/* Destroy forms */
@@ -1280,7 +1330,7 @@ static void html_destroy(struct content *c)
 
 	/* Destroy selection context */
 	if (html->select_ctx != NULL) {
-		css_select_ctx_destroy(html->select_ctx);
+		html_css_free_selection_context(html->select_ctx);
 		html->select_ctx = NULL;
 	}
 
@@ -2216,23 +2266,16 @@ static void html_fini(void)
 }
 
 /**
- * Finds all occurrences of a given string in an html box
+ * Finds all occurrences of the search pattern in an html box's text
  *
- * \param pattern   the string pattern to search for
- * \param p_len     pattern length
  * \param cur       pointer to the current box
- * \param case_sens whether to perform a case sensitive search
  * \param context   The search context to add the entry to.
- * \return true on success, false on memory allocation failure
+ * \return NSERROR_OK on success else error code
  */
 static nserror
-find_occurrences_html_box(const char *pattern,
-			  int p_len,
-			  struct box *cur,
-			  bool case_sens,
+find_occurrences_html_box(struct box *cur,
 			  struct textsearch_context *context)
 {
-	struct box *a;
 	nserror res = NSERROR_OK;
 
 	/* ignore this box, if there's no visible text */
@@ -2246,11 +2289,9 @@ find_occurrences_html_box(const char *pattern,
 			const char *new_text;
 			const char *pos;
 
-			pos = content_textsearch_find_pattern(text,
+			pos = content_textsearch_find_match(context,
+					   text,
 					   length,
-					   pattern,
-					   p_len,
-					   case_sens,
 					   &match_length);
 			if (!pos)
 				break;
@@ -2273,49 +2314,61 @@ find_occurrences_html_box(const char *pattern,
 		}
 	}
 
-	/* and recurse */
-	for (a = cur->children; a; a = a->next) {
-		res = find_occurrences_html_box(pattern,
-						p_len,
-						a,
-						case_sens,
-						context);
-		if (res != NSERROR_OK) {
-			return res;
-		}
-	}
-
 	return res;
 }
 
 /**
- * Finds all occurrences of a given string in the html box tree
+ * Finds all occurrences of the search pattern in the html box tree
+ *
+ * The tree is walked in document order without recursion so the
+ * search may be suspended at any box and resumed from it.
  *
- * \param pattern   the string pattern to search for
- * \param p_len     pattern length
  * \param c The content to search
- * \param csens whether to perform a case sensitive search
  * \param context   The search context to add the entry to.
- * \return true on success, false on memory allocation failure
+ * \return NSERROR_OK on success else error code
  */
 static nserror
 html_textsearch_find(struct content *c,
-		     struct textsearch_context *context,
-		     const char *pattern,
-		     int p_len,
-		     bool csens)
+		     struct textsearch_context *context)
 {
 	html_content *html = (html_content *)c;
+	struct box *box;
+	nserror res;
 
 	if (html->layout == NULL) {
 		return NSERROR_INVALID;
 	}
 
-	return find_occurrences_html_box(pattern,
-					 p_len,
-					 html->layout,
-					 csens,
-					 context);
+	box = content_textsearch_position(context);
+	if (box == NULL) {
+		box = html->layout;
+	}
+
+	while (box != NULL) {
+		res = find_occurrences_html_box(box, context);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+
+		/* next box in document order */
+		if (box->children != NULL) {
+			box = box->children;
+		} else {
+			while (box != NULL && box->next == NULL) {
+				box = box->parent;
+			}
+			if (box != NULL) {
+				box = box->next;
+			}
+		}
+
+		if (box != NULL && content_textsearch_expired(context)) {
+			content_textsearch_suspend(context, box);
+			break;
+		}
+	}
+
+	return NSERROR_OK;
 }
 
 
@@ -475,6 +475,7 @@ html_object_callback(hlcache_handle *object,
 
 	if (c->base.status == CONTENT_STATUS_READY &&
 	    c->base.active == 0 &&
+	    c->progressive.active == false &&
 	    (event->type == CONTENT_MSG_LOADING ||
 	     event->type == CONTENT_MSG_DONE ||
 	     event->type == CONTENT_MSG_ERROR)) {
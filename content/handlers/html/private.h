@@ -87,6 +87,30 @@ union html_focus_owner {
 	struct box *content;
 };
 
+/**
+ * State of progressive rendering while a document loads.
+ */
+struct html_progressive {
+	/** The box tree is a provisional one of a partly loaded document */
+	bool active;
+	/** The DOM has changed since the provisional tree was built */
+	bool dirty;
+	/** The whole provisional tree must be rebuilt */
+	bool full;
+	/** Earliest child of the body changed since the last build */
+	dom_node *from;
+	/** A provisional tree build is scheduled */
+	bool scheduled;
+	/** Earliest time, in ms, the next provisional tree may be built */
+	uint64_t time;
+	/** First node left out of the provisional tree, or NULL if none */
+	dom_node *stop;
+	/** Provisional tree talloc context, during the final construction */
+	int *bctx;
+	/** Selection context of the last provisional tree */
+	css_select_ctx *select_ctx;
+};
+
 /**
  * Data specific to CONTENT_HTML.
  */
@@ -94,6 +118,7 @@ typedef struct html_content {
 	struct content base;
 
 	dom_hubbub_parser *parser; /**< Parser object handle */
+	bool data_completed; /**< Whether all the source has been received */
 	bool parse_completed; /**< Whether the parse has been completed */
 	bool conversion_begun; /**< Whether or not the conversion has begun */
 
@@ -138,6 +163,8 @@ typedef struct html_content {
 	void *box_conversion_context;
 	/** Box tree, or NULL. */
 	struct box *layout;
+	/** Progressive rendering state */
+	struct html_progressive progressive;
 	/** Document background colour. */
 	colour background_colour;
 
@@ -229,6 +256,14 @@ extern bool html_redraw_debug;
 void html__redraw_a_box(html_content *htmlc, struct box *box);
 
 
+/**
+ * Update the viewport dimensions used for style selection and layout
+ *
+ * \param htmlc HTML content
+ */
+void html_get_dimensions(html_content *htmlc);
+
+
 /**
  * Complete conversion of an HTML document
  *
@@ -0,0 +1,851 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Progressive rendering of HTML documents while they load.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <nsutils/time.h>
+#include <dom/dom.h>
+
+#include "utils/log.h"
+#include "utils/nsoption.h"
+#include "utils/talloc.h"
+#include "utils/trace.h"
+#include "netsurf/misc.h"
+#include "content/hlcache.h"
+#include "content/textsearch.h"
+#include "desktop/gui_internal.h"
+#include "desktop/frames.h"
+#include "desktop/selection.h"
+
+#include "html/html.h"
+#include "html/private.h"
+#include "html/box.h"
+#include "html/box_construct.h"
+#include "html/css.h"
+#include "html/interaction.h"
+#include "html/progressive.h"
+
+/**
+ * Maximum number of elements converted by one provisional build.
+ *
+ * This bounds the cost of each provisional build for large documents.
+ * A tree cut short is extended by the following builds.
+ */
+#define PROGRESSIVE_ELEMENT_BUDGET 2000
+
+
+/**
+ * Determine if a provisional box tree can be built for a content.
+ *
+ * \param htmlc HTML content
+ * \return true if a provisional tree can be built and displayed
+ */
+static bool html_progressive_possible(html_content *htmlc)
+{
+	dom_html_element_type tag_type;
+	dom_html_element *body;
+	dom_exception exc;
+	unsigned int i;
+
+	if (nsoption_bool(incremental_reflow) == false ||
+	    htmlc->aborted ||
+	    htmlc->conversion_begun ||
+	    htmlc->document == NULL) {
+		return false;
+	}
+
+	switch (htmlc->base.status) {
+	case CONTENT_STATUS_LOADING:
+		/* A locked content is being converted */
+		if (htmlc->base.locked) {
+			return false;
+		}
+		break;
+
+	case CONTENT_STATUS_READY:
+		if (htmlc->progressive.active == false) {
+			return false;
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	/* The document must not be displayed without its styling */
+	for (i = 0; i != htmlc->stylesheet_count; i++) {
+		struct html_stylesheet *s = &htmlc->stylesheets[i];
+
+		if (s->modified) {
+			return false;
+		}
+
+		if (s->sheet != NULL &&
+		    content_get_status(s->sheet) != CONTENT_STATUS_DONE) {
+			return false;
+		}
+	}
+
+	/* Nothing to display until the body has started; framesets are
+	 * never displayed progressively.
+	 */
+	exc = dom_html_document_get_body(htmlc->document, &body);
+	if (exc != DOM_NO_ERR || body == NULL) {
+		return false;
+	}
+
+	exc = dom_html_element_get_tag_type(body, &tag_type);
+	dom_node_unref(body);
+	if (exc != DOM_NO_ERR || tag_type != DOM_HTML_ELEMENT_TYPE_BODY) {
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Drop all references into a box tree which is about to be freed.
+ *
+ * \param htmlc HTML content
+ */
+static void html_progressive_release(html_content *htmlc)
+{
+	if (htmlc->base.textsearch.context != NULL) {
+		content_textsearch_destroy(htmlc->base.textsearch.context);
+		htmlc->base.textsearch.context = NULL;
+	}
+
+	if (htmlc->drag_type != HTML_DRAG_NONE) {
+		union html_drag_owner drag_owner;
+
+		drag_owner.no_owner = true;
+		html_set_drag_type(htmlc, HTML_DRAG_NONE, drag_owner, NULL);
+	}
+
+	if (htmlc->selection_type != HTML_SELECTION_NONE) {
+		union html_selection_owner sel_owner;
+
+		/* The tree is replaced so there is nothing to redraw */
+		selection_clear(htmlc->sel, false);
+
+		sel_owner.none = true;
+		html_set_selection(htmlc, HTML_SELECTION_NONE, sel_owner, true);
+	}
+
+	if (htmlc->focus_type != HTML_FOCUS_SELF) {
+		union html_focus_owner focus_owner;
+
+		focus_owner.self = true;
+		html_set_focus(htmlc, HTML_FOCUS_SELF, focus_owner,
+				true, 0, 0, 0, NULL);
+	}
+}
+
+
+/**
+ * Find the child of the body containing a node.
+ *
+ * \param htmlc HTML content
+ * \param node The node
+ * \param child Updated to a reference to the child of the body element
+ *              which is, or contains, node, or NULL if there is none
+ * \return true if node is the body element itself
+ */
+static bool
+html_progressive_body_child(html_content *htmlc, dom_node *node,
+		dom_node **child)
+{
+	dom_html_element *body;
+	dom_node *parent;
+	dom_exception exc;
+
+	*child = NULL;
+
+	exc = dom_html_document_get_body(htmlc->document, &body);
+	if (exc != DOM_NO_ERR || body == NULL) {
+		return false;
+	}
+
+	if (node == (dom_node *) body) {
+		dom_node_unref(body);
+		return true;
+	}
+
+	dom_node_ref(node);
+
+	while (node != NULL) {
+		exc = dom_node_get_parent_node(node, &parent);
+		if (exc != DOM_NO_ERR) {
+			break;
+		}
+
+		if (parent == (dom_node *) body) {
+			*child = node;
+			dom_node_unref(parent);
+			break;
+		}
+
+		dom_node_unref(node);
+		node = parent;
+	}
+
+	if (*child == NULL && node != NULL) {
+		dom_node_unref(node);
+	}
+
+	dom_node_unref(body);
+
+	return false;
+}
+
+
+/**
+ * Note that the provisional tree must be rebuilt from a child of the body.
+ *
+ * \param htmlc HTML content
+ * \param child Child of the body element which has changed
+ */
+static void html_progressive_mark(html_content *htmlc, dom_node *child)
+{
+	dom_node *from = htmlc->progressive.from;
+	dom_node *next;
+	dom_node *n;
+	dom_exception exc;
+
+	htmlc->progressive.dirty = true;
+
+	if (from == child) {
+		return;
+	}
+
+	if (from != NULL) {
+		/* Parser changes are at the end of the document, so look
+		 * for the earlier changed node after the new one.
+		 */
+		n = dom_node_ref(child);
+		while (n != NULL && n != from) {
+			exc = dom_node_get_next_sibling(n, &next);
+			dom_node_unref(n);
+			if (exc != DOM_NO_ERR) {
+				next = NULL;
+			}
+			n = next;
+		}
+
+		if (n == NULL) {
+			/* The new node is the later one */
+			return;
+		}
+
+		dom_node_unref(n);
+		dom_node_unref(from);
+	}
+
+	htmlc->progressive.from = dom_node_ref(child);
+}
+
+
+/**
+ * Find the child of the body box containing a box.
+ *
+ * \param body The body box
+ * \param box The box, or NULL
+ * \return The child of the body box or NULL if box is not in the body
+ */
+static struct box *html_progressive_body_box(struct box *body, struct box *box)
+{
+	while (box != NULL && box->parent != body) {
+		box = box->parent;
+	}
+
+	return box;
+}
+
+
+/**
+ * Find the last box which a provisional tree extension can keep.
+ *
+ * That is the last child of the body box, before the changed part of
+ * the document, which is the box of a block level child of the body
+ * element. Everything after it is constructed again.
+ *
+ * \param body The body box
+ * \param body_node The body element
+ * \param from The earliest changed child of the body element
+ * \return The box to keep or NULL if the whole tree must be rebuilt
+ */
+static struct box *
+html_progressive_keep(struct box *body, dom_node *body_node, dom_node *from)
+{
+	struct box *box = box_for_node(from);
+	struct box *keep;
+	dom_node *parent;
+	dom_node *prev;
+	dom_node *n;
+	dom_exception exc;
+
+	/* The node may have been removed since it changed */
+	exc = dom_node_get_parent_node(from, &parent);
+	if (exc != DOM_NO_ERR || parent == NULL) {
+		return NULL;
+	}
+	dom_node_unref(parent);
+	if (parent != body_node) {
+		return NULL;
+	}
+
+	if (box == NULL) {
+		/* A node without a box is new or not displayed, so all
+		 * before it may be kept, up to the box of an earlier node
+		 */
+		n = dom_node_ref(from);
+		while (n != NULL && box == NULL) {
+			exc = dom_node_get_previous_sibling(n, &prev);
+			dom_node_unref(n);
+			if (exc != DOM_NO_ERR) {
+				return NULL;
+			}
+			n = prev;
+			if (n != NULL) {
+				box = box_for_node(n);
+			}
+		}
+		if (n != NULL) {
+			dom_node_unref(n);
+		}
+
+		box = html_progressive_body_box(body, box);
+	} else {
+		/* Boxes from the changed node onward are replaced */
+		box = html_progressive_body_box(body, box);
+		if (box != NULL) {
+			box = box->prev;
+		}
+	}
+
+	for (keep = box; keep != NULL; keep = keep->prev) {
+		if (keep->node == NULL ||
+		    keep->type == BOX_INLINE_CONTAINER ||
+		    box_for_node(keep->node) != keep) {
+			continue;
+		}
+
+		exc = dom_node_get_parent_node(keep->node, &parent);
+		if (exc != DOM_NO_ERR || parent == NULL) {
+			continue;
+		}
+		dom_node_unref(parent);
+
+		if (parent == body_node) {
+			break;
+		}
+	}
+
+	return keep;
+}
+
+
+/**
+ * Detach a list of sibling boxes from their DOM nodes.
+ *
+ * \param box First box of the list
+ */
+static void html_progressive_detach_list(struct box *box)
+{
+	for (; box != NULL; box = box->next) {
+		box_detach_dom(box);
+	}
+}
+
+
+/**
+ * Extend the provisional box tree from the earliest change in the body.
+ *
+ * The boxes of the body's children before the change are kept, and the
+ * rest of the document, up to the element budget, is converted after
+ * them. If the extension fails the tree is left as it was.
+ *
+ * \param htmlc HTML content
+ * \param stop Updated to a reference to the first node not converted if
+ *             the budget ran out, or NULL if the whole DOM was converted
+ * \return NSERROR_OK on success, NSERROR_NOT_FOUND if the whole tree
+ *         must be rebuilt, or another error code on failure
+ */
+static nserror html_progressive_extend(html_content *htmlc, dom_node **stop)
+{
+	struct box *root = htmlc->layout;
+	struct box *layout;
+	struct box *body;
+	struct box *keep;
+	struct box *body_rest;
+	struct box *body_last;
+	struct box *root_rest;
+	struct box *root_last;
+	dom_html_element *body_node;
+	dom_node *resume;
+	dom_exception exc;
+	nserror error;
+
+	if (root == NULL || htmlc->progressive.from == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	exc = dom_html_document_get_body(htmlc->document, &body_node);
+	if (exc != DOM_NO_ERR || body_node == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	body = box_for_node((dom_node *) body_node);
+	if (body == NULL || body->parent != root) {
+		dom_node_unref(body_node);
+		return NSERROR_NOT_FOUND;
+	}
+
+	keep = html_progressive_keep(body, (dom_node *) body_node,
+			htmlc->progressive.from);
+	dom_node_unref(body_node);
+	if (keep == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	exc = dom_node_get_next_sibling(keep->node, &resume);
+	if (exc != DOM_NO_ERR || resume == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	/* Boxes may be referenced from the part about to be replaced */
+	html_progressive_release(htmlc);
+
+	/* Take off the rest of the body, and what follows the body */
+	body_rest = keep->next;
+	body_last = body->last;
+	keep->next = NULL;
+	body->last = keep;
+
+	root_rest = body->next;
+	root_last = root->last;
+	body->next = NULL;
+	root->last = body;
+
+	html_progressive_detach_list(body_rest);
+	html_progressive_detach_list(root_rest);
+
+	error = dom_to_box_provisional(resume, htmlc, root,
+			PROGRESSIVE_ELEMENT_BUDGET, &layout, stop);
+	dom_node_unref(resume);
+	if (error == NSERROR_OK) {
+		/* The boxes taken off are freed with the tree */
+		return NSERROR_OK;
+	}
+
+	/* Put back the boxes which were to be replaced */
+	html_progressive_detach_list(keep->next);
+	html_progressive_detach_list(body->next);
+
+	keep->next = body_rest;
+	body->last = (body_rest != NULL) ? body_last : keep;
+	body->next = root_rest;
+	root->last = (root_rest != NULL) ? root_last : body;
+
+	for (; body_rest != NULL; body_rest = body_rest->next) {
+		box_attach_dom(body_rest);
+	}
+	for (; root_rest != NULL; root_rest = root_rest->next) {
+		box_attach_dom(root_rest);
+	}
+
+	return error;
+}
+
+
+/**
+ * Build a new provisional box tree of the document as parsed so far.
+ *
+ * On success the new tree replaces any previous provisional tree.
+ * On failure any previous tree is left in place.
+ *
+ * \param htmlc HTML content
+ * \param html The document element
+ * \param stop Updated to a reference to the first node not converted if
+ *             the budget ran out, or NULL if the whole DOM was converted
+ * \return NSERROR_OK on success or error code on failure
+ */
+static nserror
+html_progressive_rebuild(html_content *htmlc, dom_node *html, dom_node **stop)
+{
+	struct box *old_layout = htmlc->layout;
+	int *old_bctx = htmlc->bctx;
+	struct box *layout = NULL;
+	nserror error;
+
+	/* The new tree takes over the DOM nodes from the old one */
+	if (old_layout != NULL) {
+		box_detach_dom(old_layout);
+	}
+
+	htmlc->bctx = talloc_zero(0, int);
+	if (htmlc->bctx == NULL) {
+		error = NSERROR_NOMEM;
+	} else {
+		error = dom_to_box_provisional(html, htmlc, NULL,
+				PROGRESSIVE_ELEMENT_BUDGET, &layout, stop);
+	}
+
+	if (error != NSERROR_OK) {
+		talloc_free(htmlc->bctx);
+		htmlc->bctx = old_bctx;
+		if (old_layout != NULL) {
+			box_attach_dom(old_layout);
+		}
+		return error;
+	}
+
+	if (old_layout != NULL) {
+		html_progressive_release(htmlc);
+	}
+
+	htmlc->layout = layout;
+	talloc_free(old_bctx);
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Build or extend the provisional box tree of the document.
+ *
+ * The first build makes the content READY; later ones reformat it. A
+ * tree cut short by the element budget is extended by the next build.
+ *
+ * \param htmlc HTML content
+ */
+static void html_progressive_build(html_content *htmlc)
+{
+	struct content *c = &htmlc->base;
+	dom_node *stop = NULL;
+	dom_node *child;
+	dom_node *html;
+	dom_exception exc;
+	nserror error;
+	uint64_t ms_before;
+	uint64_t ms_after;
+	uint64_t ms_interval;
+	unsigned int track;
+	uint64_t trace;
+
+	nsu_getmonotonic_ms(&ms_before);
+
+	exc = dom_document_get_document_element(htmlc->document,
+			(void *) &html);
+	if ((exc != DOM_NO_ERR) || (html == NULL)) {
+		return;
+	}
+
+	html_get_dimensions(htmlc);
+
+	error = html_css_new_selection_context(htmlc, &htmlc->select_ctx);
+	if (error != NSERROR_OK) {
+		dom_node_unref(html);
+		return;
+	}
+
+	htmlc->progressive.dirty = false;
+
+	track = nstrace_enter(c->trace_track);
+	trace = nstrace_begin();
+
+	error = NSERROR_NOT_FOUND;
+	if (htmlc->progressive.full == false) {
+		error = html_progressive_extend(htmlc, &stop);
+	}
+	if (error == NSERROR_NOT_FOUND) {
+		error = html_progressive_rebuild(htmlc, html, &stop);
+	}
+
+	nstrace_end("html", "box construct", trace);
+	nstrace_leave(track);
+
+	/* Keep the context until the next build, or the final
+	 * construction, which shares it if the stylesheets are unchanged.
+	 * The new context was found before the old one is released, so
+	 * they are the same context in that case.
+	 */
+	if (htmlc->progressive.select_ctx != NULL) {
+		html_css_free_selection_context(htmlc->progressive.select_ctx);
+	}
+	htmlc->progressive.select_ctx = htmlc->select_ctx;
+	htmlc->select_ctx = NULL;
+
+	dom_node_unref(html);
+
+	if (htmlc->progressive.from != NULL) {
+		dom_node_unref(htmlc->progressive.from);
+		htmlc->progressive.from = NULL;
+	}
+
+	if (htmlc->progressive.stop != NULL) {
+		dom_node_unref(htmlc->progressive.stop);
+		htmlc->progressive.stop = NULL;
+	}
+
+	if (error != NSERROR_OK) {
+		/* Try again, from scratch, after the usual interval */
+		NSLOG(netsurf, INFO, "Provisional box tree failed (%p)", htmlc);
+		htmlc->progressive.dirty = true;
+		htmlc->progressive.full = true;
+	} else {
+		htmlc->progressive.full = false;
+		htmlc->progressive.stop = stop;
+
+		if (htmlc->progressive.active == false) {
+			NSLOG(netsurf, INFO,
+			      "Displaying partly loaded document (%p)", htmlc);
+			htmlc->progressive.active = true;
+			content_set_ready_partial(c);
+		} else {
+			content__reformat(c, false,
+					c->available_width,
+					c->available_height);
+		}
+
+		/* Carry on from where the budget ran out */
+		if (stop != NULL) {
+			if (html_progressive_body_child(htmlc, stop, &child) ||
+			    child == NULL) {
+				htmlc->progressive.dirty = true;
+				htmlc->progressive.full = true;
+			} else {
+				html_progressive_mark(htmlc, child);
+				dom_node_unref(child);
+			}
+		}
+	}
+
+	/* calculate next build time at three times what this one took */
+	nsu_getmonotonic_ms(&ms_after);
+
+	ms_interval = (ms_after - ms_before) * 3;
+	if (ms_interval < (nsoption_uint(min_reflow_period) * 10)) {
+		ms_interval = nsoption_uint(min_reflow_period) * 10;
+	}
+	htmlc->progressive.time = ms_after + ms_interval;
+
+	html_progressive_update(htmlc);
+}
+
+
+/**
+ * Scheduler callback to build a provisional box tree.
+ *
+ * \param p HTML content
+ */
+static void html_progressive_callback(void *p)
+{
+	html_content *htmlc = p;
+
+	htmlc->progressive.scheduled = false;
+
+	if (htmlc->progressive.dirty && html_progressive_possible(htmlc)) {
+		html_progressive_build(htmlc);
+	}
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_init(html_content *htmlc)
+{
+	uint64_t ms_now;
+
+	nsu_getmonotonic_ms(&ms_now);
+
+	htmlc->progressive.active = false;
+	htmlc->progressive.dirty = true;
+	htmlc->progressive.full = true;
+	htmlc->progressive.from = NULL;
+	htmlc->progressive.scheduled = false;
+	htmlc->progressive.stop = NULL;
+	htmlc->progressive.bctx = NULL;
+	htmlc->progressive.select_ctx = NULL;
+
+	/* Documents which load within a reflow period are never
+	 * displayed progressively.
+	 */
+	htmlc->progressive.time = ms_now +
+			nsoption_uint(min_reflow_period) * 10;
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_update(html_content *htmlc)
+{
+	uint64_t ms_now;
+	int delay = 0;
+
+	if (htmlc->progressive.scheduled ||
+	    htmlc->progressive.dirty == false ||
+	    html_progressive_possible(htmlc) == false) {
+		return;
+	}
+
+	nsu_getmonotonic_ms(&ms_now);
+	if (htmlc->progressive.time > ms_now) {
+		delay = htmlc->progressive.time - ms_now;
+	}
+
+	if (guit->misc->schedule(delay, html_progressive_callback,
+			htmlc) == NSERROR_OK) {
+		htmlc->progressive.scheduled = true;
+	}
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_invalidate(html_content *htmlc)
+{
+	htmlc->progressive.dirty = true;
+	htmlc->progressive.full = true;
+
+	html_progressive_update(htmlc);
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_node_changed(html_content *htmlc, dom_node *node)
+{
+	dom_node *child;
+
+	if (htmlc->progressive.active == false ||
+	    htmlc->progressive.full ||
+	    htmlc->conversion_begun) {
+		/* Nothing provisional is displayed, or it is all to be
+		 * rebuilt anyway */
+		return;
+	}
+
+	if (html_progressive_body_child(htmlc, node, &child)) {
+		/* The body element itself changed */
+		html_progressive_invalidate(htmlc);
+		return;
+	}
+
+	if (child == NULL) {
+		/* Not within the body */
+		return;
+	}
+
+	html_progressive_mark(htmlc, child);
+	dom_node_unref(child);
+
+	html_progressive_update(htmlc);
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_detach(html_content *htmlc)
+{
+	if (htmlc->progressive.scheduled) {
+		guit->misc->schedule(-1, html_progressive_callback, htmlc);
+		htmlc->progressive.scheduled = false;
+	}
+
+	if (htmlc->progressive.stop != NULL) {
+		dom_node_unref(htmlc->progressive.stop);
+		htmlc->progressive.stop = NULL;
+	}
+
+	if (htmlc->progressive.from != NULL) {
+		dom_node_unref(htmlc->progressive.from);
+		htmlc->progressive.from = NULL;
+	}
+
+	/* The final construction has found its selection context */
+	if (htmlc->progressive.select_ctx != NULL) {
+		html_css_free_selection_context(htmlc->progressive.select_ctx);
+		htmlc->progressive.select_ctx = NULL;
+	}
+
+	if (htmlc->progressive.active == false) {
+		return;
+	}
+
+	/* The provisional tree stays on display while the final one is
+	 * constructed in its own talloc context.
+	 */
+	box_detach_dom(htmlc->layout);
+	htmlc->progressive.bctx = htmlc->bctx;
+	htmlc->bctx = NULL;
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_complete(html_content *htmlc)
+{
+	struct content *c = &htmlc->base;
+
+	assert(htmlc->progressive.active);
+
+	html_progressive_release(htmlc);
+
+	talloc_free(htmlc->progressive.bctx);
+	htmlc->progressive.bctx = NULL;
+	htmlc->progressive.active = false;
+
+	content__reformat(c, false, c->available_width, c->available_height);
+
+	/* The frames the provisional tree left out can now be created */
+	if (htmlc->bw != NULL && htmlc->page == NULL) {
+		browser_window_create_frameset(htmlc->bw);
+		browser_window_create_iframes(htmlc->bw);
+	}
+}
+
+
+/* exported interface documented in html/progressive.h */
+void html_progressive_destroy(html_content *htmlc)
+{
+	if (htmlc->progressive.scheduled) {
+		guit->misc->schedule(-1, html_progressive_callback, htmlc);
+		htmlc->progressive.scheduled = false;
+	}
+
+	if (htmlc->progressive.stop != NULL) {
+		dom_node_unref(htmlc->progressive.stop);
+		htmlc->progressive.stop = NULL;
+	}
+
+	if (htmlc->progressive.from != NULL) {
+		dom_node_unref(htmlc->progressive.from);
+		htmlc->progressive.from = NULL;
+	}
+
+	if (htmlc->progressive.select_ctx != NULL) {
+		html_css_free_selection_context(htmlc->progressive.select_ctx);
+		htmlc->progressive.select_ctx = NULL;
+	}
+
+	if (htmlc->progressive.bctx != NULL) {
+		talloc_free(htmlc->progressive.bctx);
+		htmlc->progressive.bctx = NULL;
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * HTML progressive rendering interface.
+ *
+ * While a document is loading, a provisional box tree is built from the
+ * part of the DOM parsed so far and laid out so the document can be
+ * displayed before it has finished loading. The first provisional tree
+ * makes the content READY. As the DOM changes the tree is extended, no
+ * more often than the reflow period allows: the boxes of the body's
+ * children before the earliest change are kept and only the rest of the
+ * document is converted again. Once the document has completely loaded
+ * the final box tree is constructed as usual and replaces the
+ * provisional one.
+ */
+
+#ifndef NETSURF_HTML_PROGRESSIVE_H
+#define NETSURF_HTML_PROGRESSIVE_H
+
+struct html_content;
+struct dom_node;
+
+/**
+ * Initialise the progressive rendering state of a new content.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_init(struct html_content *htmlc);
+
+/**
+ * Schedule a provisional box tree build if one is due.
+ *
+ * Called as data is parsed; does nothing unless the document has
+ * changed since the last provisional tree and can be displayed.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_update(struct html_content *htmlc);
+
+/**
+ * Note that the styling of the whole document may have changed.
+ *
+ * The whole provisional tree is rebuilt.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_invalidate(struct html_content *htmlc);
+
+/**
+ * Note that a DOM node has been inserted or modified.
+ *
+ * The provisional tree is extended from the child of the body element
+ * containing the node. Changes outside the body are ignored.
+ *
+ * \param htmlc HTML content
+ * \param node The node inserted or modified
+ */
+void html_progressive_node_changed(struct html_content *htmlc, struct dom_node *node);
+
+/**
+ * Prepare for the final box tree construction.
+ *
+ * Stops further provisional builds. A provisional tree remains the
+ * content's layout, for display, until the final tree replaces it.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_detach(struct html_content *htmlc);
+
+/**
+ * Replace a provisional box tree with the final one.
+ *
+ * Called once the final box tree has been constructed for a content
+ * which was made READY with a provisional tree.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_complete(struct html_content *htmlc);
+
+/**
+ * Release all progressive rendering resources of a content.
+ *
+ * \param htmlc HTML content
+ */
+void html_progressive_destroy(struct html_content *htmlc);
+
+#endif
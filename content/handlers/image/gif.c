@@ -54,13 +54,24 @@
 #include "desktop/bitmap.h"
 
 #include "image/image.h"
+#include "image/image_cache.h"
 #include "image/gif.h"
 
+/** Number of frames beyond the current one to decode ahead into the
+ * frame cache
+ */
+#define GIF_LOOKAHEAD_FRAMES 2
+
 typedef struct gif_content {
 	struct content base;
 
 	nsgif_t *gif; /**< GIF animation data */
 	uint32_t current_frame;   /**< current frame to display [0...(max-1)] */
+	uint32_t delay; /**< delay until the next frame (cs) */
+
+	bool cache_frames; /**< decoded frames are kept in the frame cache */
+	bool redrawn; /**< redrawn within a clip since the last frame step */
+	bool paused; /**< animation paused as content is not visible */
 } gif_content;
 
 static inline nserror gif__nsgif_error_to_ns(nsgif_error gif_res)
@@ -186,6 +197,9 @@ static nserror gif__animate(gif_content *gif, bool redraw)
 	}
 
 	gif->current_frame = f;
+	gif->delay = delay;
+	gif->redrawn = false;
+	gif->paused = false;
 
 	/* Continue animating if we should */
 	if (nsoption_bool(animate_images) && delay != NSGIF_INFINITE) {
@@ -207,11 +221,55 @@ static nserror gif__animate(gif_content *gif, bool redraw)
 	return NSERROR_OK;
 }
 
+/**
+ * Decode the current and upcoming frames into the frame cache.
+ *
+ * Frames are decoded in sequence, which is cheapest for libnsgif, so
+ * that subsequent redraws are satisfied from the cache.
+ *
+ * \param gif The gif content.
+ */
+static void gif__lookahead(gif_content *gif)
+{
+	const nsgif_info_t *gif_info;
+	nsgif_bitmap_t *bitmap;
+	uint32_t frame;
+
+	gif_info = nsgif_get_info(gif->gif);
+	frame = gif->current_frame;
+
+	for (unsigned int n = 0; n <= GIF_LOOKAHEAD_FRAMES; n++) {
+		if (image_cache_has_frame(&gif->base, frame) == false) {
+			if (nsgif_frame_decode(gif->gif,
+					frame, &bitmap) != NSGIF_OK) {
+				break;
+			}
+			if (image_cache_add_frame(&gif->base,
+					frame, bitmap) != NSERROR_OK) {
+				break;
+			}
+		}
+		frame = (frame + 1) % gif_info->frame_count;
+	}
+}
+
 static void gif_animate_cb(void *p)
 {
 	gif_content *gif = p;
 
+	if (gif->redrawn == false) {
+		/* The previous frame was never redrawn so the content
+		 * is not visible. Pause until it is next redrawn.
+		 */
+		gif->paused = true;
+		return;
+	}
+
 	gif__animate(gif, true);
+
+	if (gif->cache_frames) {
+		gif__lookahead(gif);
+	}
 }
 
 static bool gif_convert(struct content *c)
@@ -255,6 +313,11 @@ static bool gif_convert(struct content *c)
 	c->height = gif_info->height;
 	c->size += (gif_info->width * gif_info->height * 4) + 16 + 44;
 
+	/* Only cache decoded frames of animations which fit */
+	gif->cache_frames = (gif_info->frame_count > 1) &&
+		image_cache_speculate_frames(gif_info->frame_count *
+				gif_info->width * gif_info->height * 4llu);
+
 	/* set title text */
 	title = messages_get_buff("GIFTitle",
 			nsurl_access_leaf(llcache_handle_get_url(c->llcache)),
@@ -289,11 +352,47 @@ static nsgif_error gif_get_frame(gif_content *gif,
 		nsgif_bitmap_t **bitmap)
 {
 	uint32_t current_frame = gif->current_frame;
+	nsgif_error gif_res;
+	struct bitmap *cached;
+
 	if (!nsoption_bool(animate_images)) {
 		current_frame = 0;
 	}
 
-	return nsgif_frame_decode(gif->gif, current_frame, bitmap);
+	if (gif->cache_frames) {
+		cached = image_cache_get_frame(&gif->base, current_frame);
+		if (cached != NULL) {
+			*bitmap = cached;
+			return NSGIF_OK;
+		}
+	}
+
+	gif_res = nsgif_frame_decode(gif->gif, current_frame, bitmap);
+	if ((gif_res == NSGIF_OK) && gif->cache_frames) {
+		image_cache_add_frame(&gif->base, current_frame, *bitmap);
+	}
+
+	return gif_res;
+}
+
+/**
+ * Check if a redraw of the content will be visible.
+ *
+ * \param data The content redraw data.
+ * \param clip The redraw clip rectangle.
+ * \return true if the content area intersects the clip.
+ */
+static bool gif__redraw_visible(const struct content_redraw_data *data,
+		const struct rect *clip)
+{
+	if (data->repeat_x || data->repeat_y) {
+		return true;
+	}
+
+	return ((data->x < clip->x1) &&
+		(data->x + data->width > clip->x0) &&
+		(data->y < clip->y1) &&
+		(data->y + data->height > clip->y0));
 }
 
 static bool gif_redraw(struct content *c, struct content_redraw_data *data,
@@ -302,6 +401,17 @@ static bool gif_redraw(struct content *c, struct content_redraw_data *data,
 	gif_content *gif = (gif_content *) c;
 	nsgif_bitmap_t *bitmap;
 
+	if (gif__redraw_visible(data, clip)) {
+		gif->redrawn = true;
+
+		if (gif->paused) {
+			/* visible again, resume the animation */
+			gif->paused = false;
+			guit->misc->schedule(gif->delay * 10,
+					gif_animate_cb, gif);
+		}
+	}
+
 	if (gif_get_frame(gif, &bitmap) != NSGIF_OK) {
 		return false;
 	}
@@ -315,6 +425,7 @@ static void gif_destroy(struct content *c)
 
 	/* Free all the associated memory buffers */
 	guit->misc->schedule(-1, gif_animate_cb, c);
+	image_cache_remove_frames(c);
 	nsgif_destroy(gif->gif);
 }
 
@@ -371,9 +482,12 @@ static void gif_add_user(struct content *c)
 
 static void gif_remove_user(struct content *c)
 {
+	gif_content *gif = (gif_content *) c;
+
 	if (content_count_users(c) == 1) {
 		/* Last user is about to be removed from this content, so stop the animation. */
 		guit->misc->schedule(-1, gif_animate_cb, c);
+		gif->paused = false;
 	}
 }
 
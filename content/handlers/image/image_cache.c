@@ -39,6 +39,9 @@
 #include "image/image_cache.h"
 #include "image/image.h"
 
+/** Number of decoded animation frame hash buckets, must be a power of two */
+#define IMAGE_CACHE_FRAME_BUCKETS 256
+
 /**
  * Age of an entry within the cache
  *
@@ -71,6 +74,26 @@ struct image_cache_entry_s {
 	int conversion_count; /**< Number of times image has been converted */
 };
 
+/**
+ * Decoded animation frame cache entry
+ */
+struct image_cache_frame_s {
+	struct image_cache_frame_s *next; /**< next frame in use order */
+	struct image_cache_frame_s *prev; /**< previous frame in use order */
+	struct image_cache_frame_s *chain; /**< next frame in hash bucket */
+
+	/** content the frame belongs to */
+	const struct content *content;
+	/** frame number within the content animation */
+	uint32_t frame;
+	/** decoded frame */
+	struct bitmap *bitmap;
+	/** size of storage occupied by bitmap */
+	size_t bitmap_size;
+	/** Age of last use */
+	cache_age use_age;
+};
+
 /**
  * Current state of the cache.
  *
@@ -89,6 +112,13 @@ struct image_cache_s {
 	/* The objects the cache holds */
 	struct image_cache_entry_s *entries;
 
+	/** Decoded animation frames, most recently used first */
+	struct image_cache_frame_s *frames;
+	/** Least recently used decoded animation frame */
+	struct image_cache_frame_s *frames_tail;
+	/** Decoded animation frames hashed by content and frame number */
+	struct image_cache_frame_s *frame_bucket[IMAGE_CACHE_FRAME_BUCKETS];
+
 
 	/* Statistics for management algorithm */
 
@@ -134,6 +164,17 @@ struct image_cache_s {
 	int peak_conversions;
 	/** Size of bitmap with most conversions */
 	unsigned int peak_conversions_size;
+
+	/** total size of decoded animation frames, included in
+	 * total_bitmap_size
+	 */
+	size_t total_frame_size;
+	/** Count of decoded animation frames currently held */
+	int frame_count;
+	/** Animation frame was available at plot time */
+	int frame_hit_count;
+	/** Animation frame was not available at plot time */
+	int frame_miss_count;
 };
 
 /** image cache state */
@@ -296,6 +337,107 @@ static void image_cache__free_entry(struct image_cache_entry_s *centry)
 	free(centry);
 }
 
+/**
+ * Unlink a decoded animation frame from the use ordered list.
+ *
+ * \param fentry The frame entry to unlink.
+ */
+static void image_cache__frame_unlink(struct image_cache_frame_s *fentry)
+{
+	if (fentry->prev == NULL) {
+		image_cache->frames = fentry->next;
+	} else {
+		fentry->prev->next = fentry->next;
+	}
+
+	if (fentry->next == NULL) {
+		image_cache->frames_tail = fentry->prev;
+	} else {
+		fentry->next->prev = fentry->prev;
+	}
+}
+
+/**
+ * Link a decoded animation frame as most recently used.
+ *
+ * \param fentry The frame entry to link.
+ */
+static void image_cache__frame_link(struct image_cache_frame_s *fentry)
+{
+	fentry->prev = NULL;
+	fentry->next = image_cache->frames;
+	if (fentry->next != NULL) {
+		fentry->next->prev = fentry;
+	} else {
+		image_cache->frames_tail = fentry;
+	}
+	image_cache->frames = fentry;
+}
+
+/**
+ * Compute the hash bucket of a decoded animation frame
+ *
+ * \param c The content the frame belongs to.
+ * \param frame The frame number.
+ * \return The hash bucket the frame belongs in.
+ */
+static struct image_cache_frame_s **
+image_cache__frame_bucket(const struct content *c, uint32_t frame)
+{
+	uintptr_t hash;
+
+	hash = ((uintptr_t)c >> 4) ^ ((uintptr_t)c >> 12);
+	hash += frame * 0x9e3779b1u;
+
+	return &image_cache->frame_bucket[hash & (IMAGE_CACHE_FRAME_BUCKETS - 1)];
+}
+
+/**
+ * free a decoded animation frame
+ *
+ * \param fentry The frame entry to free.
+ */
+static void image_cache__free_frame(struct image_cache_frame_s *fentry)
+{
+	struct image_cache_frame_s **link;
+
+	link = image_cache__frame_bucket(fentry->content, fentry->frame);
+	while (*link != fentry) {
+		link = &(*link)->chain;
+	}
+	*link = fentry->chain;
+
+	image_cache__frame_unlink(fentry);
+
+	guit->bitmap->destroy(fentry->bitmap);
+
+	image_cache->total_frame_size -= fentry->bitmap_size;
+	image_cache->total_bitmap_size -= fentry->bitmap_size;
+	image_cache->frame_count--;
+
+	free(fentry);
+}
+
+/**
+ * Find a decoded animation frame
+ *
+ * \param c The content the frame belongs to.
+ * \param frame The frame number.
+ * \return The frame entry or NULL if not found.
+ */
+static struct image_cache_frame_s *
+image_cache__find_frame(const struct content *c, uint32_t frame)
+{
+	struct image_cache_frame_s *found;
+
+	found = *image_cache__frame_bucket(c, frame);
+	while ((found != NULL) &&
+	       ((found->content != c) || (found->frame != frame))) {
+		found = found->chain;
+	}
+	return found;
+}
+
 /**
  * Image cache cleaner
  *
@@ -305,6 +447,15 @@ static void image_cache__clean(struct image_cache_s *icache)
 {
 	struct image_cache_entry_s *centry = icache->entries;
 
+	/* animation frames unused for a whole clean period belong to
+	 * animations which are stopped or not visible.
+	 */
+	while ((icache->frames_tail != NULL) &&
+	       ((icache->current_age - icache->frames_tail->use_age) >
+		icache->params.bg_clean_time)) {
+		image_cache__free_frame(icache->frames_tail);
+	}
+
 	while (centry != NULL) {
 		if ((icache->current_age - centry->redraw_age) >
 		    icache->params.bg_clean_time) {
@@ -445,6 +596,10 @@ nserror image_cache_fini(void)
 	NSLOG(netsurf, INFO, "Size at finish %"PRIsizet" (in %d)",
 	      image_cache->total_bitmap_size, image_cache->bitmap_count);
 
+	while (image_cache->frames != NULL) {
+		image_cache__free_frame(image_cache->frames);
+	}
+
 	while (image_cache->entries != NULL) {
 		image_cache__free_entry(image_cache->entries);
 	}
@@ -501,6 +656,10 @@ nserror image_cache_fini(void)
 	      image_cache->peak_conversions_size,
 	      image_cache->peak_conversions);
 
+	NSLOG(netsurf, INFO, "Animation frame hit/miss %d/%d",
+	      image_cache->frame_hit_count,
+	      image_cache->frame_miss_count);
+
 	free(image_cache);
 
 	return NSERROR_OK;
@@ -581,6 +740,156 @@ nserror image_cache_remove(struct content *content)
 	return NSERROR_OK;
 }
 
+/* exported interface documented in image_cache.h */
+struct bitmap *image_cache_get_frame(const struct content *c, uint32_t frame)
+{
+	struct image_cache_frame_s *fentry;
+
+	fentry = image_cache__find_frame(c, frame);
+	if (fentry == NULL) {
+		image_cache->frame_miss_count++;
+		return NULL;
+	}
+
+	image_cache->frame_hit_count++;
+	fentry->use_age = image_cache->current_age;
+
+	/* keep most recently used frames at the head */
+	if (fentry != image_cache->frames) {
+		image_cache__frame_unlink(fentry);
+		image_cache__frame_link(fentry);
+	}
+
+	return fentry->bitmap;
+}
+
+/* exported interface documented in image_cache.h */
+bool image_cache_speculate_frames(size_t size)
+{
+	/* an animation may use at most half of the frame cache so it
+	 * cannot evict every other animation
+	 */
+	return (size <= (image_cache->params.frame_limit / 2));
+}
+
+/* exported interface documented in image_cache.h */
+bool image_cache_has_frame(const struct content *c, uint32_t frame)
+{
+	return image_cache__find_frame(c, frame) != NULL;
+}
+
+/* exported interface documented in image_cache.h */
+nserror image_cache_add_frame(const struct content *c,
+			      uint32_t frame,
+			      struct bitmap *bitmap)
+{
+	struct image_cache_frame_s *fentry;
+	struct image_cache_frame_s **link;
+	unsigned char *src, *dst;
+	size_t src_rowstride, dst_rowstride;
+	size_t frame_size;
+	int width, height;
+
+	width = guit->bitmap->get_width(bitmap);
+	height = guit->bitmap->get_height(bitmap);
+	frame_size = width * height * 4llu;
+
+	if ((frame_size > image_cache->params.frame_limit) ||
+	    (frame_size > image_cache->params.limit)) {
+		return NSERROR_NOSPACE;
+	}
+
+	if (image_cache__find_frame(c, frame) != NULL) {
+		return NSERROR_OK;
+	}
+
+	/* make space by discarding least recently used frames */
+	while ((image_cache->frames_tail != NULL) &&
+	       (((image_cache->total_frame_size + frame_size) >
+		 image_cache->params.frame_limit) ||
+		((image_cache->total_bitmap_size + frame_size) >
+		 image_cache->params.limit))) {
+		image_cache__free_frame(image_cache->frames_tail);
+	}
+
+	if ((image_cache->total_bitmap_size + frame_size) >
+	    image_cache->params.limit) {
+		return NSERROR_NOSPACE;
+	}
+
+	src = guit->bitmap->get_buffer(bitmap);
+	if (src == NULL) {
+		return NSERROR_INVALID;
+	}
+
+	fentry = calloc(1, sizeof(struct image_cache_frame_s));
+	if (fentry == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	fentry->bitmap = guit->bitmap->create(width, height, BITMAP_NONE);
+	if (fentry->bitmap == NULL) {
+		free(fentry);
+		return NSERROR_NOMEM;
+	}
+
+	dst = guit->bitmap->get_buffer(fentry->bitmap);
+	if (dst == NULL) {
+		guit->bitmap->destroy(fentry->bitmap);
+		free(fentry);
+		return NSERROR_NOMEM;
+	}
+
+	src_rowstride = guit->bitmap->get_rowstride(bitmap);
+	dst_rowstride = guit->bitmap->get_rowstride(fentry->bitmap);
+	if (src_rowstride == dst_rowstride) {
+		memcpy(dst, src, src_rowstride * height);
+	} else {
+		for (int y = 0; y < height; y++) {
+			memcpy(dst + (y * dst_rowstride),
+			       src + (y * src_rowstride),
+			       width * 4);
+		}
+	}
+	guit->bitmap->set_opaque(fentry->bitmap,
+				 guit->bitmap->get_opaque(bitmap));
+	guit->bitmap->modified(fentry->bitmap);
+
+	fentry->content = c;
+	fentry->frame = frame;
+	fentry->bitmap_size = frame_size;
+	fentry->use_age = image_cache->current_age;
+	image_cache__frame_link(fentry);
+	link = image_cache__frame_bucket(c, frame);
+	fentry->chain = *link;
+	*link = fentry;
+
+	image_cache->total_frame_size += frame_size;
+	image_cache->total_bitmap_size += frame_size;
+	image_cache->frame_count++;
+
+	if (image_cache->total_bitmap_size > image_cache->max_bitmap_size) {
+		image_cache->max_bitmap_size = image_cache->total_bitmap_size;
+		image_cache->max_bitmap_size_count = image_cache->bitmap_count;
+	}
+
+	return NSERROR_OK;
+}
+
+/* exported interface documented in image_cache.h */
+void image_cache_remove_frames(const struct content *c)
+{
+	struct image_cache_frame_s *fentry;
+	struct image_cache_frame_s *next;
+
+	for (fentry = image_cache->frames; fentry != NULL; fentry = next) {
+		next = fentry->next;
+		if (fentry->content == c) {
+			image_cache__free_frame(fentry);
+		}
+	}
+}
+
 /* exported interface documented in image_cache.h */
 int image_cache_snsummaryf(char *string, size_t size, const char *fmt)
 {
@@ -667,6 +976,8 @@ case chr :					\
 			FMTCHR('v', "d", total_extra_conversions_count);
 			FMTCHR('w', "u", peak_conversions_size);
 			FMTCHR('x', "d", peak_conversions);
+			FMTCHR('y', "d", frame_count);
+			FMTCHR('z', PRIsizet, total_frame_size);
 
 
 			}
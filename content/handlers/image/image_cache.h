@@ -37,6 +37,8 @@
 #ifndef NETSURF_IMAGE_IMAGE_CACHE_H_
 #define NETSURF_IMAGE_IMAGE_CACHE_H_
 
+#include <stdint.h>
+
 #include "utils/errors.h"
 #include "netsurf/content_type.h"
 
@@ -58,6 +60,11 @@ struct image_cache_parameters {
 
 	/** The speculative conversion "small" size */
 	size_t speculative_small;
+
+	/** The upper bound of the cache used by decoded animation
+	 * frames, zero disables frame caching
+	 */
+	size_t frame_limit;
 };
 
 /** Initialise the image cache 
@@ -99,6 +106,51 @@ struct bitmap *image_cache_find_bitmap(struct content *c);
  */
 bool image_cache_speculate(struct content *c);
 
+/** Decide if the decoded frames of an animation should be cached.
+ *
+ * \param size The total size of all the decoded animation frames.
+ * \return true if the frames should be cached false otherwise.
+ */
+bool image_cache_speculate_frames(size_t size);
+
+/** Obtain a decoded animation frame from the cache.
+ *
+ * \param c The content the frame belongs to.
+ * \param frame The frame number.
+ * \return The decoded frame bitmap or NULL if not cached.
+ */
+struct bitmap *image_cache_get_frame(const struct content *c, uint32_t frame);
+
+/** Check if a decoded animation frame is cached without using it.
+ *
+ * \param c The content the frame belongs to.
+ * \param frame The frame number.
+ * \return true if the frame is cached.
+ */
+bool image_cache_has_frame(const struct content *c, uint32_t frame);
+
+/** Add a decoded animation frame to the cache.
+ *
+ * The frame cache is shared by all animations and its memory is
+ * accounted against the image cache limit. Least recently used frames
+ * are discarded to make space.
+ *
+ * \param c The content the frame belongs to.
+ * \param frame The frame number.
+ * \param bitmap The decoded frame, the cache stores a copy.
+ * \return NSERROR_OK on success, NSERROR_NOSPACE if the frame does
+ *         not fit in the cache or appropriate error otherwise.
+ */
+nserror image_cache_add_frame(const struct content *c,
+			      uint32_t frame,
+			      struct bitmap *bitmap);
+
+/** Discard all decoded animation frames of a content.
+ *
+ * \param c The content to discard frames of.
+ */
+void image_cache_remove_frames(const struct content *c);
+
 /**
  * Fill a buffer with information about a cache entry using a format.
  *
@@ -156,6 +208,8 @@ int image_cache_snentryf(char *string, size_t size, unsigned int entryn,
  *     of times.
  * x The number of times the image that was converted (read missed cache) 
  *     highest number of times.
+ * y The number of decoded animation frames in the cache.
+ * z The size of the decoded animation frames in the cache.
  *
  * format modifiers:
  * A p before the value modifies the replacement to be a percentage.
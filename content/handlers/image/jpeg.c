@@ -28,9 +28,12 @@
 #include <stdlib.h>
 #include <setjmp.h>
 
+#include <nsutils/time.h>
+
 #include "utils/utils.h"
 #include "utils/log.h"
 #include "utils/messages.h"
+#include "netsurf/misc.h"
 #include "netsurf/bitmap.h"
 #include "content/llcache.h"
 #include "content/content.h"
@@ -39,6 +42,7 @@
 #include "desktop/gui_internal.h"
 #include "desktop/bitmap.h"
 
+#include "image/image.h"
 #include "image/image_cache.h"
 
 #define JPEG_INTERNAL_OPTIONS
@@ -54,36 +58,58 @@
 #warning Using libjpeg (libjpeg-turbo is recommended)
 #endif
 
+/** minimum interval between redraw requests while progressively
+ * rendering (ms)
+ */
+#define NSJPEG_REDRAW_INTERVAL_MS 250
+
 static char nsjpeg_error_buffer[JMSG_LENGTH_MAX];
 
 static unsigned char nsjpeg_eoi[] = { 0xff, JPEG_EOI };
 
 /**
- * Content create entry point.
+ * Progress of progressive decoding.
  */
-static nserror nsjpeg_create(const content_handler *handler,
-		lwc_string *imime_type, const struct http_parameter *params,
-		llcache_handle *llcache, const char *fallback_charset,
-		bool quirks, struct content **c)
-{
-	struct content *jpeg;
-	nserror error;
-
-	jpeg = calloc(1, sizeof(struct content));
-	if (jpeg == NULL)
-		return NSERROR_NOMEM;
+enum nsjpeg_progress {
+	NSJPEG_PROGRESS_HEADER, /**< waiting for the complete header */
+	NSJPEG_PROGRESS_START, /**< waiting to start decompression */
+	NSJPEG_PROGRESS_SCAN, /**< waiting to start an output pass */
+	NSJPEG_PROGRESS_LINES, /**< outputting scanlines of a pass */
+	NSJPEG_PROGRESS_FINISH, /**< waiting to finish an output pass */
+	NSJPEG_PROGRESS_DONE, /**< decoding finished or failed */
+};
 
-	error = content__init(jpeg, handler, imime_type, params,
-			      llcache, fallback_charset, quirks);
-	if (error != NSERROR_OK) {
-		free(jpeg);
-		return error;
-	}
+/**
+ * Progressive decode state.
+ *
+ * The decompressor runs in buffered-image mode with a suspending data
+ * source so scans can be output into the bitmap as data arrives. It is
+ * only kept for images with more than one scan, others are left to the
+ * image cache to convert when they are needed.
+ */
+struct nsjpeg_progressive {
+	struct jpeg_source_mgr source_mgr; /**< data source, must be first */
+	struct jpeg_decompress_struct cinfo; /**< decompressor */
+	struct jpeg_error_mgr jerr; /**< decompressor error handler */
+
+	enum nsjpeg_progress progress; /**< decode progress */
+	bool failed; /**< decoding stopped on a decompressor error */
+	bool complete; /**< all source data is available */
+	size_t fed; /**< source data length given to the decompressor */
+	size_t skip; /**< bytes to skip which had not yet arrived */
+
+	struct bitmap *bitmap; /**< bitmap being rendered into */
+	size_t rowstride; /**< bitmap rowstride */
+	bool modified; /**< bitmap changed since last redraw request */
+	uint64_t redraw_time; /**< time of last redraw request */
+};
 
-	*c = jpeg;
+typedef struct nsjpeg_content {
+	struct content base; /**< base content type */
 
-	return NSERROR_OK;
-}
+	/** progressive decode state or NULL when not in progress */
+	struct nsjpeg_progressive *prog;
+} nsjpeg_content;
 
 /**
  * JPEG data source manager: initialize source.
@@ -131,6 +157,51 @@ static void nsjpeg_term_source(j_decompress_ptr cinfo)
 }
 
 
+/**
+ * Progressive JPEG data source manager: fill the input buffer.
+ *
+ * Suspends the decompressor until more data arrives. Once all data is
+ * available behaves as nsjpeg_fill_input_buffer().
+ */
+static boolean nsjpeg_progressive_fill_input_buffer(j_decompress_ptr cinfo)
+{
+	struct nsjpeg_progressive *prog;
+
+	prog = (struct nsjpeg_progressive *)cinfo->src;
+	if (prog->complete) {
+		return nsjpeg_fill_input_buffer(cinfo);
+	}
+
+	return FALSE;
+}
+
+
+/**
+ * Progressive JPEG data source manager: skip num_bytes worth of data.
+ *
+ * Data which has not yet arrived is skipped when it does.
+ */
+static void
+nsjpeg_progressive_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+	struct nsjpeg_progressive *prog;
+
+	if (num_bytes <= 0) {
+		return;
+	}
+
+	prog = (struct nsjpeg_progressive *)cinfo->src;
+	if ((long) cinfo->src->bytes_in_buffer < num_bytes) {
+		prog->skip += num_bytes - cinfo->src->bytes_in_buffer;
+		cinfo->src->next_input_byte += cinfo->src->bytes_in_buffer;
+		cinfo->src->bytes_in_buffer = 0;
+	} else {
+		cinfo->src->next_input_byte += num_bytes;
+		cinfo->src->bytes_in_buffer -= num_bytes;
+	}
+}
+
+
 /**
  * Error output handler for JPEG library.
  *
@@ -160,6 +231,81 @@ static void nsjpeg_error_exit(j_common_ptr cinfo)
 	longjmp(*setjmp_buffer, 1);
 }
 
+/**
+ * Convert a scan line from CMYK to core client bitmap layout.
+ */
+static inline void nsjpeg__convert_cmyk(
+		struct jpeg_decompress_struct *cinfo,
+		JSAMPROW scanline)
+{
+	int width = cinfo->output_width * 4;
+
+	for (int i = width - 4; 0 <= i; i -= 4) {
+		/* Trivial inverse CMYK -> RGBA */
+		const int c = scanline[i + 0];
+		const int m = scanline[i + 1];
+		const int y = scanline[i + 2];
+		const int k = scanline[i + 3];
+
+		const int ck = c * k;
+		const int mk = m * k;
+		const int yk = y * k;
+
+#define DIV255(x) ((x) + 1 + ((x) >> 8)) >> 8
+		scanline[i + bitmap_layout.r] = DIV255(ck);
+		scanline[i + bitmap_layout.g] = DIV255(mk);
+		scanline[i + bitmap_layout.b] = DIV255(yk);
+		scanline[i + bitmap_layout.a] = 0xff;
+#undef DIV255
+	}
+}
+
+/**
+ * Convert a scan line from RGB to core client bitmap layout.
+ */
+static inline void nsjpeg__convert_rgb(
+		struct jpeg_decompress_struct *cinfo,
+		JSAMPROW scanline)
+{
+#if RGB_RED != 0 || RGB_GREEN != 1 || RGB_BLUE != 2 || RGB_PIXELSIZE != 4
+	int width = cinfo->output_width;
+
+	/* Missmatch between configured libjpeg pixel format and
+	 * NetSurf pixel format.  Convert to RGBA */
+	for (int i = width - 1; 0 <= i; i--) {
+		int r = scanline[i * RGB_PIXELSIZE + RGB_RED];
+		int g = scanline[i * RGB_PIXELSIZE + RGB_GREEN];
+		int b = scanline[i * RGB_PIXELSIZE + RGB_BLUE];
+		scanline[i * 4 + bitmap_layout.r] = r;
+		scanline[i * 4 + bitmap_layout.g] = g;
+		scanline[i * 4 + bitmap_layout.b] = b;
+		scanline[i * 4 + bitmap_layout.a] = 0xff;
+	}
+#endif
+}
+
+/**
+ * Convert a scan line to core client bitmap layout.
+ */
+static inline void nsjpeg__convert_row(
+		struct jpeg_decompress_struct *cinfo,
+		JSAMPROW scanline)
+{
+	switch (cinfo->out_color_space) {
+	case JCS_CMYK:
+		nsjpeg__convert_cmyk(cinfo, scanline);
+		break;
+
+	case JCS_RGB:
+		nsjpeg__convert_rgb(cinfo, scanline);
+		break;
+
+	default:
+		/* already in client format */
+		break;
+	}
+}
+
 /**
  * Convert scan lines from CMYK to core client bitmap layout.
  */
@@ -168,8 +314,6 @@ static inline void nsjpeg__decode_cmyk(
 		uint8_t * volatile pixels,
 		size_t rowstride)
 {
-	int width = cinfo->output_width * 4;
-
 	do {
 		JSAMPROW scanlines[1] = {
 			[0] = (JSAMPROW)
@@ -177,39 +321,18 @@ static inline void nsjpeg__decode_cmyk(
 		};
 		jpeg_read_scanlines(cinfo, scanlines, 1);
 
-		for (int i = width - 4; 0 <= i; i -= 4) {
-			/* Trivial inverse CMYK -> RGBA */
-			const int c = scanlines[0][i + 0];
-			const int m = scanlines[0][i + 1];
-			const int y = scanlines[0][i + 2];
-			const int k = scanlines[0][i + 3];
-
-			const int ck = c * k;
-			const int mk = m * k;
-			const int yk = y * k;
-
-#define DIV255(x) ((x) + 1 + ((x) >> 8)) >> 8
-			scanlines[0][i + bitmap_layout.r] = DIV255(ck);
-			scanlines[0][i + bitmap_layout.g] = DIV255(mk);
-			scanlines[0][i + bitmap_layout.b] = DIV255(yk);
-			scanlines[0][i + bitmap_layout.a] = 0xff;
-#undef DIV255
-		}
+		nsjpeg__convert_cmyk(cinfo, scanlines[0]);
 	} while (cinfo->output_scanline != cinfo->output_height);
 }
 
 /**
- * Convert scan lines from CMYK to core client bitmap layout.
+ * Convert scan lines from RGB to core client bitmap layout.
  */
 static inline void nsjpeg__decode_rgb(
 		struct jpeg_decompress_struct *cinfo,
 		uint8_t * volatile pixels,
 		size_t rowstride)
 {
-#if RGB_RED != 0 || RGB_GREEN != 1 || RGB_BLUE != 2 || RGB_PIXELSIZE != 4
-	int width = cinfo->output_width;
-#endif
-
 	do {
 		JSAMPROW scanlines[1] = {
 			[0] = (JSAMPROW)
@@ -217,24 +340,12 @@ static inline void nsjpeg__decode_rgb(
 		};
 		jpeg_read_scanlines(cinfo, scanlines, 1);
 
-#if RGB_RED != 0 || RGB_GREEN != 1 || RGB_BLUE != 2 || RGB_PIXELSIZE != 4
-		/* Missmatch between configured libjpeg pixel format and
-		 * NetSurf pixel format.  Convert to RGBA */
-		for (int i = width - 1; 0 <= i; i--) {
-			int r = scanlines[0][i * RGB_PIXELSIZE + RGB_RED];
-			int g = scanlines[0][i * RGB_PIXELSIZE + RGB_GREEN];
-			int b = scanlines[0][i * RGB_PIXELSIZE + RGB_BLUE];
-			scanlines[0][i * 4 + bitmap_layout.r] = r;
-			scanlines[0][i * 4 + bitmap_layout.g] = g;
-			scanlines[0][i * 4 + bitmap_layout.b] = b;
-			scanlines[0][i * 4 + bitmap_layout.a] = 0xff;
-		}
-#endif
+		nsjpeg__convert_rgb(cinfo, scanlines[0]);
 	} while (cinfo->output_scanline != cinfo->output_height);
 }
 
 /**
- * Convert scan lines from CMYK to core client bitmap layout.
+ * Convert scan lines from client format to core client bitmap layout.
  */
 static inline void nsjpeg__decode_client_fmt(
 		struct jpeg_decompress_struct *cinfo,
@@ -250,6 +361,46 @@ static inline void nsjpeg__decode_client_fmt(
 	} while (cinfo->output_scanline != cinfo->output_height);
 }
 
+/**
+ * Set decompressor output colour space to suit the core bitmap layout.
+ *
+ * \param cinfo The decompressor with header information read.
+ * \return true on success, false if bitmap format is not supported.
+ */
+static bool nsjpeg__set_output_colour(struct jpeg_decompress_struct *cinfo)
+{
+	if (cinfo->jpeg_color_space == JCS_CMYK ||
+	    cinfo->jpeg_color_space == JCS_YCCK) {
+		cinfo->out_color_space = JCS_CMYK;
+	} else {
+#ifdef JCS_ALPHA_EXTENSIONS
+		switch (bitmap_fmt.layout) {
+		case BITMAP_LAYOUT_R8G8B8A8:
+			cinfo->out_color_space = JCS_EXT_RGBA;
+			break;
+		case BITMAP_LAYOUT_B8G8R8A8:
+			cinfo->out_color_space = JCS_EXT_BGRA;
+			break;
+		case BITMAP_LAYOUT_A8R8G8B8:
+			cinfo->out_color_space = JCS_EXT_ARGB;
+			break;
+		case BITMAP_LAYOUT_A8B8G8R8:
+			cinfo->out_color_space = JCS_EXT_ABGR;
+			break;
+		default:
+			NSLOG(netsurf, ERROR, "Unexpected bitmap format: %u",
+					bitmap_fmt.layout);
+			return false;
+		}
+#else
+		cinfo->out_color_space = JCS_RGB;
+#endif
+	}
+	cinfo->dct_method = JDCT_ISLOW;
+
+	return true;
+}
+
 /**
  * create a bitmap from jpeg content.
  */
@@ -304,35 +455,10 @@ jpeg_cache_convert(struct content *c)
 	jpeg_read_header(&cinfo, TRUE);
 
 	/* set output processing parameters */
-	if (cinfo.jpeg_color_space == JCS_CMYK ||
-	    cinfo.jpeg_color_space == JCS_YCCK) {
-		cinfo.out_color_space = JCS_CMYK;
-	} else {
-#ifdef JCS_ALPHA_EXTENSIONS
-		switch (bitmap_fmt.layout) {
-		case BITMAP_LAYOUT_R8G8B8A8:
-			cinfo.out_color_space = JCS_EXT_RGBA;
-			break;
-		case BITMAP_LAYOUT_B8G8R8A8:
-			cinfo.out_color_space = JCS_EXT_BGRA;
-			break;
-		case BITMAP_LAYOUT_A8R8G8B8:
-			cinfo.out_color_space = JCS_EXT_ARGB;
-			break;
-		case BITMAP_LAYOUT_A8B8G8R8:
-			cinfo.out_color_space = JCS_EXT_ABGR;
-			break;
-		default:
-			NSLOG(netsurf, ERROR, "Unexpected bitmap format: %u",
-					bitmap_fmt.layout);
-			jpeg_destroy_decompress(&cinfo);
-			return NULL;
-		}
-#else
-		cinfo.out_color_space = JCS_RGB;
-#endif
+	if (nsjpeg__set_output_colour(&cinfo) == false) {
+		jpeg_destroy_decompress(&cinfo);
+		return NULL;
 	}
-	cinfo.dct_method = JDCT_ISLOW;
 
 	/* commence the decompression, output parameters now valid */
 	jpeg_start_decompress(&cinfo);
@@ -380,11 +506,446 @@ jpeg_cache_convert(struct content *c)
 	return bitmap;
 }
 
+/**
+ * Request a redraw of a progressively rendered content.
+ *
+ * Requests are rate limited, a request made too soon after the previous
+ * one is deferred.
+ *
+ * \param jpeg_c The jpeg content.
+ * \param force true to request a redraw regardless of rate limit.
+ */
+static void nsjpeg__progressive_redraw(nsjpeg_content *jpeg_c, bool force);
+
+/**
+ * Scheduled callback for a deferred progressive redraw.
+ */
+static void nsjpeg__progressive_redraw_cb(void *p)
+{
+	nsjpeg_content *jpeg_c = p;
+
+	if (jpeg_c->prog != NULL) {
+		nsjpeg__progressive_redraw(jpeg_c, true);
+	}
+}
+
+static void nsjpeg__progressive_redraw(nsjpeg_content *jpeg_c, bool force)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	union content_msg_data data;
+	uint64_t now_ms;
+
+	if ((prog->modified == false) ||
+	    (jpeg_c->base.status != CONTENT_STATUS_READY)) {
+		return;
+	}
+
+	nsu_getmonotonic_ms(&now_ms);
+
+	if ((force == false) &&
+	    ((now_ms - prog->redraw_time) < NSJPEG_REDRAW_INTERVAL_MS)) {
+		guit->misc->schedule(NSJPEG_REDRAW_INTERVAL_MS -
+				     (now_ms - prog->redraw_time),
+				     nsjpeg__progressive_redraw_cb,
+				     jpeg_c);
+		return;
+	}
+
+	guit->misc->schedule(-1, nsjpeg__progressive_redraw_cb, jpeg_c);
+
+	prog->redraw_time = now_ms;
+	prog->modified = false;
+
+	guit->bitmap->modified(prog->bitmap);
+
+	data.redraw.x = 0;
+	data.redraw.y = 0;
+	data.redraw.width = jpeg_c->base.width;
+	data.redraw.height = jpeg_c->base.height;
+
+	content_broadcast(&jpeg_c->base, CONTENT_MSG_REDRAW, &data);
+}
+
+
+/**
+ * Create progressive decode state for a jpeg content.
+ */
+static nserror nsjpeg__progressive_create(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog;
+	jmp_buf setjmp_buffer;
+
+	prog = calloc(1, sizeof(struct nsjpeg_progressive));
+	if (prog == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	prog->cinfo.err = jpeg_std_error(&prog->jerr);
+	prog->jerr.error_exit = nsjpeg_error_exit;
+	prog->jerr.output_message = nsjpeg_error_log;
+
+	if (setjmp(setjmp_buffer)) {
+		jpeg_destroy_decompress(&prog->cinfo);
+		free(prog);
+		return NSERROR_NOMEM;
+	}
+
+	prog->cinfo.client_data = &setjmp_buffer;
+	jpeg_create_decompress(&prog->cinfo);
+	prog->cinfo.client_data = NULL;
+
+	prog->source_mgr.init_source = nsjpeg_init_source;
+	prog->source_mgr.fill_input_buffer =
+		nsjpeg_progressive_fill_input_buffer;
+	prog->source_mgr.skip_input_data = nsjpeg_progressive_skip_input_data;
+	prog->source_mgr.resync_to_restart = jpeg_resync_to_restart;
+	prog->source_mgr.term_source = nsjpeg_term_source;
+	prog->cinfo.src = &prog->source_mgr;
+
+	prog->progress = NSJPEG_PROGRESS_HEADER;
+
+	jpeg_c->prog = prog;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Destroy progressive decode state of a jpeg content.
+ */
+static void nsjpeg__progressive_destroy(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+
+	guit->misc->schedule(-1, nsjpeg__progressive_redraw_cb, jpeg_c);
+
+	jpeg_destroy_decompress(&prog->cinfo);
+
+	if (prog->bitmap != NULL) {
+		guit->bitmap->destroy(prog->bitmap);
+	}
+
+	free(prog);
+	jpeg_c->prog = NULL;
+}
+
+
+/**
+ * Give the progressive decompressor all source data received so far.
+ */
+static void nsjpeg__progressive_feed(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	const uint8_t *data;
+	size_t size;
+	size_t offset;
+	size_t skip;
+
+	data = content__get_source_data(&jpeg_c->base, &size);
+	if ((data == NULL) || (size <= prog->fed)) {
+		return;
+	}
+
+	/* source data may have moved, locate the unconsumed input */
+	offset = prog->fed - prog->source_mgr.bytes_in_buffer;
+
+	/* apply any skip which was waiting for data */
+	skip = min(prog->skip, size - offset);
+	offset += skip;
+	prog->skip -= skip;
+
+	prog->source_mgr.next_input_byte = data + offset;
+	prog->source_mgr.bytes_in_buffer = size - offset;
+	prog->fed = size;
+}
+
+
+/**
+ * Set up output once the header has been read by the progressive
+ * decompressor.
+ *
+ * \param jpeg_c The jpeg content.
+ * \return true on success, false if progressive rendering is not possible.
+ */
+static bool nsjpeg__progressive_setup(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	struct jpeg_decompress_struct *cinfo = &prog->cinfo;
+
+	if (nsjpeg__set_output_colour(cinfo) == false) {
+		return false;
+	}
+	cinfo->buffered_image = TRUE;
+
+	jpeg_calc_output_dimensions(cinfo);
+
+	jpeg_c->base.width = cinfo->output_width;
+	jpeg_c->base.height = cinfo->output_height;
+	jpeg_c->base.size = cinfo->output_width * cinfo->output_height * 4;
+
+	/* Cleared bitmap so areas not yet decoded are transparent. It
+	 * is marked opaque when decoding finishes.
+	 */
+	prog->bitmap = guit->bitmap->create(
+			cinfo->output_width,
+			cinfo->output_height, BITMAP_CLEAR);
+	if (prog->bitmap == NULL) {
+		return false;
+	}
+
+	if (guit->bitmap->get_buffer(prog->bitmap) == NULL) {
+		guit->bitmap->destroy(prog->bitmap);
+		prog->bitmap = NULL;
+		return false;
+	}
+
+	prog->rowstride = guit->bitmap->get_rowstride(prog->bitmap);
+	prog->modified = true;
+
+	return true;
+}
+
+
+/**
+ * Advance the progressive decompressor as far as the available data allows.
+ *
+ * May longjmp via the decompressor error handler.
+ */
+static void nsjpeg__progressive_decode(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	struct jpeg_decompress_struct *cinfo = &prog->cinfo;
+	uint8_t *pixels;
+	int ret;
+
+	while (prog->progress != NSJPEG_PROGRESS_DONE) {
+		switch (prog->progress) {
+		case NSJPEG_PROGRESS_HEADER:
+			if (jpeg_read_header(cinfo, TRUE) == JPEG_SUSPENDED) {
+				return;
+			}
+			if (jpeg_has_multiple_scans(cinfo) == FALSE) {
+				/* nothing to gain over a single decode */
+				prog->progress = NSJPEG_PROGRESS_DONE;
+				return;
+			}
+			if (nsjpeg__progressive_setup(jpeg_c) == false) {
+				prog->progress = NSJPEG_PROGRESS_DONE;
+				return;
+			}
+			prog->progress = NSJPEG_PROGRESS_START;
+			break;
+
+		case NSJPEG_PROGRESS_START:
+			if (jpeg_start_decompress(cinfo) == FALSE) {
+				return;
+			}
+			prog->progress = NSJPEG_PROGRESS_SCAN;
+			break;
+
+		case NSJPEG_PROGRESS_SCAN:
+			/* absorb available input so the output pass
+			 * shows the most recent scan
+			 */
+			do {
+				ret = jpeg_consume_input(cinfo);
+			} while ((ret != JPEG_SUSPENDED) &&
+				 (ret != JPEG_REACHED_EOI));
+
+			if ((cinfo->output_scan_number >=
+			     cinfo->input_scan_number) &&
+			    (jpeg_input_complete(cinfo) == FALSE)) {
+				/* no new scan to output yet */
+				return;
+			}
+
+			if (jpeg_start_output(cinfo,
+					cinfo->input_scan_number) == FALSE) {
+				return;
+			}
+			prog->progress = NSJPEG_PROGRESS_LINES;
+			break;
+
+		case NSJPEG_PROGRESS_LINES:
+			pixels = guit->bitmap->get_buffer(prog->bitmap);
+			while (cinfo->output_scanline < cinfo->output_height) {
+				JSAMPROW scanlines[1] = {
+					[0] = (JSAMPROW)(pixels +
+						prog->rowstride *
+						cinfo->output_scanline),
+				};
+				if (jpeg_read_scanlines(cinfo,
+						scanlines, 1) != 1) {
+					return;
+				}
+				nsjpeg__convert_row(cinfo, scanlines[0]);
+				prog->modified = true;
+			}
+			prog->progress = NSJPEG_PROGRESS_FINISH;
+			break;
+
+		case NSJPEG_PROGRESS_FINISH:
+			if (jpeg_finish_output(cinfo) == FALSE) {
+				return;
+			}
+			if ((jpeg_input_complete(cinfo) == TRUE) &&
+			    (cinfo->output_scan_number ==
+			     cinfo->input_scan_number)) {
+				prog->progress = NSJPEG_PROGRESS_DONE;
+			} else {
+				prog->progress = NSJPEG_PROGRESS_SCAN;
+			}
+			break;
+
+		case NSJPEG_PROGRESS_DONE:
+			break;
+		}
+	}
+}
+
+
+/**
+ * Run the progressive decompressor over the available source data.
+ */
+static void nsjpeg__progressive_run(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	jmp_buf setjmp_buffer;
+
+	if (prog->progress == NSJPEG_PROGRESS_DONE) {
+		return;
+	}
+
+	if (setjmp(setjmp_buffer)) {
+		/* decompressor state is no longer usable, stop
+		 * decoding but show any partially rendered image
+		 * until the content is converted.
+		 */
+		prog->cinfo.client_data = NULL;
+		prog->progress = NSJPEG_PROGRESS_DONE;
+		prog->failed = true;
+		return;
+	}
+
+	prog->cinfo.client_data = &setjmp_buffer;
+
+	nsjpeg__progressive_feed(jpeg_c);
+	nsjpeg__progressive_decode(jpeg_c);
+
+	prog->cinfo.client_data = NULL;
+}
+
+
+/**
+ * Finish progressive decoding once all source data has arrived.
+ *
+ * \param jpeg_c The jpeg content.
+ * \return The rendered bitmap or NULL if progressive rendering failed
+ *         and the image must be decoded afresh.
+ */
+static struct bitmap *nsjpeg__progressive_finish(nsjpeg_content *jpeg_c)
+{
+	struct nsjpeg_progressive *prog = jpeg_c->prog;
+	struct bitmap *bitmap;
+
+	prog->complete = true;
+	nsjpeg__progressive_run(jpeg_c);
+
+	if (prog->failed && (prog->bitmap != NULL)) {
+		/* never hand on a partial image as a complete one */
+		guit->bitmap->destroy(prog->bitmap);
+		prog->bitmap = NULL;
+	}
+
+	bitmap = prog->bitmap;
+	if (bitmap != NULL) {
+		guit->bitmap->set_opaque(bitmap, true);
+		nsjpeg__progressive_redraw(jpeg_c, true);
+		guit->bitmap->modified(bitmap);
+		prog->bitmap = NULL;
+	}
+
+	nsjpeg__progressive_destroy(jpeg_c);
+
+	return bitmap;
+}
+
+
+/**
+ * Content create entry point.
+ */
+static nserror nsjpeg_create(const content_handler *handler,
+		lwc_string *imime_type, const struct http_parameter *params,
+		llcache_handle *llcache, const char *fallback_charset,
+		bool quirks, struct content **c)
+{
+	nsjpeg_content *jpeg_c;
+	nserror error;
+
+	jpeg_c = calloc(1, sizeof(nsjpeg_content));
+	if (jpeg_c == NULL)
+		return NSERROR_NOMEM;
+
+	/* created first as a failed content__init() is simpler to undo */
+	error = nsjpeg__progressive_create(jpeg_c);
+	if (error != NSERROR_OK) {
+		free(jpeg_c);
+		return error;
+	}
+
+	error = content__init(&jpeg_c->base, handler, imime_type, params,
+			      llcache, fallback_charset, quirks);
+	if (error != NSERROR_OK) {
+		nsjpeg__progressive_destroy(jpeg_c);
+		free(jpeg_c);
+		return error;
+	}
+
+	*c = (struct content *)jpeg_c;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Process data for a CONTENT_JPEG.
+ *
+ * Decodes as much of the image as possible and makes the content ready
+ * for display once its dimensions are known.
+ */
+static bool nsjpeg_process_data(struct content *c, const char *data,
+		unsigned int size)
+{
+	nsjpeg_content *jpeg_c = (nsjpeg_content *)c;
+
+	if (jpeg_c->prog == NULL) {
+		return true;
+	}
+
+	nsjpeg__progressive_run(jpeg_c);
+
+	if (jpeg_c->prog->bitmap != NULL) {
+		if (c->status == CONTENT_STATUS_LOADING) {
+			content_set_ready_partial(c);
+		}
+		nsjpeg__progressive_redraw(jpeg_c, false);
+	} else if (jpeg_c->prog->progress == NSJPEG_PROGRESS_DONE) {
+		/* single scan image or progressive setup failed, leave
+		 * the image cache to convert it when it is needed
+		 */
+		nsjpeg__progressive_destroy(jpeg_c);
+	}
+
+	return true;
+}
+
+
 /**
  * Convert a CONTENT_JPEG for display.
  */
 static bool nsjpeg_convert(struct content *c)
 {
+	nsjpeg_content *jpeg_c = (nsjpeg_content *)c;
 	struct jpeg_decompress_struct cinfo;
 	struct jpeg_error_mgr jerr;
 	jmp_buf setjmp_buffer;
@@ -393,44 +954,51 @@ static bool nsjpeg_convert(struct content *c)
 		nsjpeg_skip_input_data, jpeg_resync_to_restart,
 		nsjpeg_term_source };
 	union content_msg_data msg_data;
+	struct bitmap *bitmap = NULL;
 	const uint8_t *data;
 	size_t size;
 	char *title;
 
-	/* check image header is valid and get width/height */
-	data = content__get_source_data(c, &size);
+	if (jpeg_c->prog != NULL) {
+		bitmap = nsjpeg__progressive_finish(jpeg_c);
+	}
 
-	cinfo.err = jpeg_std_error(&jerr);
-	jerr.error_exit = nsjpeg_error_exit;
-	jerr.output_message = nsjpeg_error_log;
+	if (bitmap == NULL) {
+		/* check image header is valid and get width/height */
+		data = content__get_source_data(c, &size);
 
-	if (setjmp(setjmp_buffer)) {
-		jpeg_destroy_decompress(&cinfo);
+		cinfo.err = jpeg_std_error(&jerr);
+		jerr.error_exit = nsjpeg_error_exit;
+		jerr.output_message = nsjpeg_error_log;
 
-		msg_data.errordata.errorcode = NSERROR_UNKNOWN;
-		msg_data.errordata.errormsg = nsjpeg_error_buffer;
-		content_broadcast(c, CONTENT_MSG_ERROR, &msg_data);
-		return false;
-	}
+		if (setjmp(setjmp_buffer)) {
+			jpeg_destroy_decompress(&cinfo);
 
-	cinfo.client_data = &setjmp_buffer;
-	jpeg_create_decompress(&cinfo);
-	source_mgr.next_input_byte = (unsigned char *) data;
-	source_mgr.bytes_in_buffer = size;
-	cinfo.src = &source_mgr;
-	jpeg_read_header(&cinfo, TRUE);
-	cinfo.out_color_space = JCS_RGB;
-	cinfo.dct_method = JDCT_ISLOW;
+			msg_data.errordata.errorcode = NSERROR_UNKNOWN;
+			msg_data.errordata.errormsg = nsjpeg_error_buffer;
+			content_broadcast(c, CONTENT_MSG_ERROR, &msg_data);
+			return false;
+		}
 
-	jpeg_calc_output_dimensions(&cinfo);
+		cinfo.client_data = &setjmp_buffer;
+		jpeg_create_decompress(&cinfo);
+		source_mgr.next_input_byte = (unsigned char *) data;
+		source_mgr.bytes_in_buffer = size;
+		cinfo.src = &source_mgr;
+		jpeg_read_header(&cinfo, TRUE);
+		cinfo.out_color_space = JCS_RGB;
+		cinfo.dct_method = JDCT_ISLOW;
 
-	c->width = cinfo.output_width;
-	c->height = cinfo.output_height;
-	c->size = c->width * c->height * 4;
+		jpeg_calc_output_dimensions(&cinfo);
 
-	jpeg_destroy_decompress(&cinfo);
+		c->width = cinfo.output_width;
+		c->height = cinfo.output_height;
+		c->size = c->width * c->height * 4;
 
-	image_cache_add(c, NULL, jpeg_cache_convert);
+		jpeg_destroy_decompress(&cinfo);
+	}
+
+	image_cache_add(c, bitmap, jpeg_cache_convert);
 
 	/* set title text */
 	title = messages_get_buff("JPEGTitle",
@@ -441,7 +1009,9 @@ static bool nsjpeg_convert(struct content *c)
 		free(title);
 	}
 
-	content_set_ready(c);
+	if (c->status == CONTENT_STATUS_LOADING) {
+		content_set_ready(c);
+	}
 	content_set_done(c);	
 	content_set_status(c, ""); /* Done: update status bar */
 
@@ -449,44 +1019,92 @@ static bool nsjpeg_convert(struct content *c)
 }
 
 
+/**
+ * Redraw a CONTENT_JPEG.
+ *
+ * Plots the partially rendered bitmap while progressively decoding.
+ */
+static bool nsjpeg_redraw(struct content *c,
+		struct content_redraw_data *data,
+		const struct rect *clip,
+		const struct redraw_context *ctx)
+{
+	nsjpeg_content *jpeg_c = (nsjpeg_content *)c;
+
+	if ((jpeg_c->prog != NULL) && (jpeg_c->prog->bitmap != NULL)) {
+		return image_bitmap_plot(jpeg_c->prog->bitmap, data, clip, ctx);
+	}
+
+	return image_cache_redraw(c, data, clip, ctx);
+}
+
+
+/**
+ * Destroy a CONTENT_JPEG.
+ */
+static void nsjpeg_destroy(struct content *c)
+{
+	nsjpeg_content *jpeg_c = (nsjpeg_content *)c;
+
+	if (jpeg_c->prog != NULL) {
+		/* not yet added to the image cache */
+		nsjpeg__progressive_destroy(jpeg_c);
+	} else {
+		image_cache_destroy(c);
+	}
+}
+
 
 /**
  * Clone content.
  */
 static nserror nsjpeg_clone(const struct content *old, struct content **newc)
 {
-	struct content *jpeg_c;
+	const nsjpeg_content *old_jpeg_c = (const nsjpeg_content *)old;
+	nsjpeg_content *jpeg_c;
 	nserror error;
 
-	jpeg_c = calloc(1, sizeof(struct content));
+	jpeg_c = calloc(1, sizeof(nsjpeg_content));
 	if (jpeg_c == NULL)
 		return NSERROR_NOMEM;
 
-	error = content__clone(old, jpeg_c);
+	error = content__clone(old, &jpeg_c->base);
 	if (error != NSERROR_OK) {
-		content_destroy(jpeg_c);
+		content_destroy(&jpeg_c->base);
 		return error;
 	}
 
-	/* re-convert if the content is ready */
-	if ((old->status == CONTENT_STATUS_READY) ||
-	    (old->status == CONTENT_STATUS_DONE)) {
-		if (nsjpeg_convert(jpeg_c) == false) {
-			content_destroy(jpeg_c);
+	if (old_jpeg_c->prog != NULL) {
+		/* still loading, replay the progressive decode */
+		jpeg_c->base.status = CONTENT_STATUS_LOADING;
+
+		error = nsjpeg__progressive_create(jpeg_c);
+		if (error != NSERROR_OK) {
+			content_destroy(&jpeg_c->base);
+			return error;
+		}
+
+		nsjpeg_process_data(&jpeg_c->base, NULL, 0);
+	} else if ((old->status == CONTENT_STATUS_READY) ||
+		   (old->status == CONTENT_STATUS_DONE)) {
+		/* re-convert if the content is ready */
+		if (nsjpeg_convert(&jpeg_c->base) == false) {
+			content_destroy(&jpeg_c->base);
 			return NSERROR_CLONE_FAILED;
 		}
 	}
 
-	*newc = jpeg_c;
+	*newc = (struct content *)jpeg_c;
 
 	return NSERROR_OK;
 }
 
 static const content_handler nsjpeg_content_handler = {
 	.create = nsjpeg_create,
+	.process_data = nsjpeg_process_data,
 	.data_complete = nsjpeg_convert,
-	.destroy = image_cache_destroy,
-	.redraw = image_cache_redraw,
+	.destroy = nsjpeg_destroy,
+	.redraw = nsjpeg_redraw,
 	.clone = nsjpeg_clone,
 	.get_internal = image_cache_get_internal,
 	.type = image_cache_content_type,
@@ -0,0 +1,450 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Duktape compiled script bytecode cache.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <nsutils/time.h>
+
+#include "netsurf/inttypes.h"
+#include "utils/log.h"
+
+#include "duktape.h"
+#include "bytecode.h"
+
+/** Smallest script worth keeping compiled bytecode for */
+#define JS_BYTECODE_MIN_SIZE 1024
+
+/** Maximum total size of cached compiled bytecode and source */
+#define JS_BYTECODE_CACHE_SIZE (4 * 1024 * 1024)
+
+/** Number of hash buckets, must be a power of two */
+#define JS_BYTECODE_BUCKETS 256
+
+/**
+ * compiled script bytecode cache entry
+ *
+ * Entries are keyed on the script name (its URL for external scripts)
+ * and its whole source, which is kept with the bytecode, so a changed
+ * script is never served stale bytecode.
+ */
+struct dukky_bytecode {
+	struct dukky_bytecode *next; /**< next less recently used entry */
+	struct dukky_bytecode *prev; /**< previous more recently used entry */
+	struct dukky_bytecode *chain; /**< next entry in the same bucket */
+	uint32_t hash; /**< hash of script name and source */
+	char *name; /**< script name */
+	size_t srclen; /**< length of script source */
+	size_t len; /**< length of bytecode */
+	uint8_t data[]; /**< bytecode from duk_dump_function() followed
+			 * by the script source
+			 */
+};
+
+/**
+ * compiled script bytecode cache
+ */
+static struct {
+	struct dukky_bytecode *head; /**< most recently used entry */
+	struct dukky_bytecode *tail; /**< least recently used entry */
+	struct dukky_bytecode *bucket[JS_BYTECODE_BUCKETS]; /**< hash chains */
+	size_t size; /**< total size of cached bytecode and source */
+	unsigned int hits; /**< scripts loaded from bytecode */
+	unsigned int misses; /**< cacheable scripts compiled from source */
+	uint64_t compile_ms; /**< time spent compiling cacheable scripts */
+	uint64_t load_ms; /**< time spent loading bytecode */
+} bytecode_cache;
+
+
+/**
+ * compute the hash of a script
+ *
+ * \param name name of the script
+ * \param txt script source
+ * \param txtlen length of script source
+ * \return FNV-1a hash of the name and source
+ */
+static uint32_t
+dukky_bytecode_hash(const char *name, const uint8_t *txt, size_t txtlen)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	do {
+		hash ^= (uint8_t)*name;
+		hash *= 0x01000193;
+	} while (*name++ != '\0');
+
+	while (txtlen-- > 0) {
+		hash ^= *txt++;
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+/**
+ * unlink a bytecode cache entry from the recently used list
+ */
+static void dukky_bytecode_unlink(struct dukky_bytecode *entry)
+{
+	if (entry->prev != NULL) {
+		entry->prev->next = entry->next;
+	} else {
+		bytecode_cache.head = entry->next;
+	}
+	if (entry->next != NULL) {
+		entry->next->prev = entry->prev;
+	} else {
+		bytecode_cache.tail = entry->prev;
+	}
+}
+
+/**
+ * link a bytecode cache entry as the most recently used
+ */
+static void dukky_bytecode_link(struct dukky_bytecode *entry)
+{
+	entry->prev = NULL;
+	entry->next = bytecode_cache.head;
+	if (bytecode_cache.head != NULL) {
+		bytecode_cache.head->prev = entry;
+	} else {
+		bytecode_cache.tail = entry;
+	}
+	bytecode_cache.head = entry;
+}
+
+/**
+ * free a bytecode entry which is not in the cache
+ */
+static void dukky_bytecode_free(struct dukky_bytecode *entry)
+{
+	free(entry->name);
+	free(entry);
+}
+
+/**
+ * remove a bytecode cache entry and free it
+ */
+static void dukky_bytecode_remove(struct dukky_bytecode *entry)
+{
+	struct dukky_bytecode **link;
+
+	link = &bytecode_cache.bucket[entry->hash & (JS_BYTECODE_BUCKETS - 1)];
+	while (*link != entry) {
+		link = &(*link)->chain;
+	}
+	*link = entry->chain;
+
+	dukky_bytecode_unlink(entry);
+	bytecode_cache.size -= entry->len + entry->srclen;
+	dukky_bytecode_free(entry);
+}
+
+/**
+ * find compiled bytecode for a script
+ *
+ * \param name name of the script
+ * \param txt script source
+ * \param txtlen length of the script source
+ * \param hash hash of the script
+ * \return cache entry or NULL if the script has not been cached
+ */
+static struct dukky_bytecode *
+dukky_bytecode_find(const char *name,
+		    const uint8_t *txt,
+		    size_t txtlen,
+		    uint32_t hash)
+{
+	struct dukky_bytecode *entry;
+
+	entry = bytecode_cache.bucket[hash & (JS_BYTECODE_BUCKETS - 1)];
+	for (; entry != NULL; entry = entry->chain) {
+		if ((entry->hash == hash) &&
+		    (entry->srclen == txtlen) &&
+		    (strcmp(entry->name, name) == 0) &&
+		    (memcmp(entry->data + entry->len, txt, txtlen) == 0)) {
+			/* move to most recently used */
+			dukky_bytecode_unlink(entry);
+			dukky_bytecode_link(entry);
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * create a bytecode entry for a script
+ *
+ * \param name name of the script
+ * \param txt script source
+ * \param txtlen length of the script source
+ * \param hash hash of the script
+ * \param data bytecode
+ * \param len length of bytecode
+ * \return the entry or NULL on allocation failure
+ */
+static struct dukky_bytecode *
+dukky_bytecode_create(const char *name,
+		      const uint8_t *txt,
+		      size_t txtlen,
+		      uint32_t hash,
+		      const void *data,
+		      size_t len)
+{
+	struct dukky_bytecode *entry;
+
+	entry = malloc(sizeof(*entry) + len + txtlen);
+	if (entry == NULL) {
+		return NULL;
+	}
+	entry->name = strdup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return NULL;
+	}
+	entry->hash = hash;
+	entry->srclen = txtlen;
+	entry->len = len;
+	memcpy(entry->data, data, len);
+	memcpy(entry->data + len, txt, txtlen);
+
+	return entry;
+}
+
+/**
+ * add a bytecode entry to the cache
+ *
+ * The least recently used entries are discarded to keep the cache
+ * within its size limit. Entries too large to be worth caching are
+ * freed.
+ *
+ * \param entry the entry to add
+ */
+static void dukky_bytecode_add(struct dukky_bytecode *entry)
+{
+	size_t size = entry->len + entry->srclen;
+	unsigned int bucket = entry->hash & (JS_BYTECODE_BUCKETS - 1);
+
+	if (size > JS_BYTECODE_CACHE_SIZE / 4) {
+		dukky_bytecode_free(entry);
+		return;
+	}
+
+	while ((bytecode_cache.tail != NULL) &&
+	       (bytecode_cache.size + size > JS_BYTECODE_CACHE_SIZE)) {
+		dukky_bytecode_remove(bytecode_cache.tail);
+	}
+
+	entry->chain = bytecode_cache.bucket[bucket];
+	bytecode_cache.bucket[bucket] = entry;
+	dukky_bytecode_link(entry);
+	bytecode_cache.size += size;
+}
+
+static duk_ret_t dukky_bytecode_dump(duk_context *ctx, void *udata)
+{
+	/* ... func */
+	duk_dump_function(ctx);
+	/* ... bytecode */
+	return 1;
+}
+
+static duk_ret_t dukky_bytecode_load(duk_context *ctx, void *udata)
+{
+	/* ... bytecode */
+	duk_load_function(ctx);
+	/* ... func */
+	return 1;
+}
+
+/**
+ * load a script from its bytecode
+ *
+ * \param ctx duktape context to load in
+ * \param entry the bytecode entry for the script
+ * \return zero with the function on the stack on success else non zero
+ *          with nothing pushed.
+ */
+static duk_int_t
+dukky_bytecode_load_entry(duk_context *ctx, struct dukky_bytecode *entry)
+{
+	/* ... */
+	memcpy(duk_push_fixed_buffer(ctx, entry->len), entry->data, entry->len);
+	/* ..., bytecode */
+	if (duk_safe_call(ctx, dukky_bytecode_load, NULL, 1, 1) == 0) {
+		/* ..., func */
+		return 0;
+	}
+	/* ..., err */
+	NSLOG(dukky, WARNING, "Unable to load bytecode for %s: %s",
+	      entry->name, duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	/* ... */
+
+	return DUK_EXEC_ERROR;
+}
+
+/**
+ * compile a script from source and create a bytecode entry for it
+ *
+ * \param ctx duktape context to compile in
+ * \param txt script source
+ * \param txtlen length of script source
+ * \param name name of the script
+ * \param hash hash of the script
+ * \param entry_out updated with the new entry, or NULL if the bytecode
+ *                  could not be kept, on success
+ * \return zero with the function on the stack on success else non zero
+ *          with the error on the stack.
+ */
+static duk_int_t
+dukky_bytecode_compile_entry(duk_context *ctx,
+			     const uint8_t *txt,
+			     size_t txtlen,
+			     const char *name,
+			     uint32_t hash,
+			     struct dukky_bytecode **entry_out)
+{
+	duk_int_t res;
+
+	*entry_out = NULL;
+
+	/* ... */
+	duk_push_string(ctx, name);
+	/* ..., name */
+	res = duk_pcompile_lstring_filename(ctx, DUK_COMPILE_EVAL,
+					    (const char *)txt, txtlen);
+	if (res != 0) {
+		/* ..., err */
+		return res;
+	}
+	/* ..., func */
+	duk_dup_top(ctx);
+	/* ..., func, func */
+	if (duk_safe_call(ctx, dukky_bytecode_dump, NULL, 1, 1) == 0) {
+		/* ..., func, bytecode */
+		duk_size_t len;
+		void *data = duk_get_buffer(ctx, -1, &len);
+
+		*entry_out = dukky_bytecode_create(name, txt, txtlen, hash,
+						   data, len);
+	}
+	duk_pop(ctx);
+	/* ..., func */
+
+	return 0;
+}
+
+/* exported interface documented in duktape/bytecode.h */
+duk_int_t
+dukky_bytecode_compile(duk_context *ctx,
+		       const uint8_t *txt,
+		       size_t txtlen,
+		       const char *name)
+{
+	struct dukky_bytecode *entry;
+	uint64_t start;
+	uint64_t end;
+	uint32_t hash;
+	duk_int_t res;
+
+	if (txtlen < JS_BYTECODE_MIN_SIZE) {
+		/* not worth caching */
+		duk_push_string(ctx, name);
+		return duk_pcompile_lstring_filename(ctx, DUK_COMPILE_EVAL,
+						     (const char *)txt, txtlen);
+	}
+
+	(void) nsu_getmonotonic_ms(&start);
+
+	hash = dukky_bytecode_hash(name, txt, txtlen);
+	entry = dukky_bytecode_find(name, txt, txtlen, hash);
+	if (entry != NULL) {
+		if (dukky_bytecode_load_entry(ctx, entry) == 0) {
+			(void) nsu_getmonotonic_ms(&end);
+			bytecode_cache.hits++;
+			bytecode_cache.load_ms += end - start;
+			return 0;
+		}
+		dukky_bytecode_remove(entry);
+	}
+
+	res = dukky_bytecode_compile_entry(ctx, txt, txtlen, name, hash,
+					   &entry);
+	if (res != 0) {
+		return res;
+	}
+
+	(void) nsu_getmonotonic_ms(&end);
+	bytecode_cache.misses++;
+	bytecode_cache.compile_ms += end - start;
+
+	if (entry != NULL) {
+		dukky_bytecode_add(entry);
+	}
+
+	return 0;
+}
+
+/* exported interface documented in duktape/bytecode.h */
+duk_int_t
+dukky_bytecode_compile_builtin(duk_context *ctx,
+			       struct dukky_bytecode **builtin,
+			       const uint8_t *txt,
+			       size_t txtlen,
+			       const char *name)
+{
+	if (*builtin != NULL) {
+		if (dukky_bytecode_load_entry(ctx, *builtin) == 0) {
+			return 0;
+		}
+		dukky_bytecode_free(*builtin);
+		*builtin = NULL;
+	}
+
+	return dukky_bytecode_compile_entry(ctx, txt, txtlen, name, 0, builtin);
+}
+
+/* exported interface documented in duktape/bytecode.h */
+void dukky_bytecode_free_builtin(struct dukky_bytecode *builtin)
+{
+	if (builtin != NULL) {
+		dukky_bytecode_free(builtin);
+	}
+}
+
+/* exported interface documented in duktape/bytecode.h */
+void dukky_bytecode_finalise(void)
+{
+	NSLOG(dukky, INFO,
+	      "Bytecode cache %u hits (%"PRIu64"ms loading), %u misses (%"PRIu64"ms compiling), %"PRIsizet" bytes",
+	      bytecode_cache.hits, bytecode_cache.load_ms,
+	      bytecode_cache.misses, bytecode_cache.compile_ms,
+	      bytecode_cache.size);
+
+	while (bytecode_cache.head != NULL) {
+		dukky_bytecode_remove(bytecode_cache.head);
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ * Duktape compiled script bytecode cache interface.
+ */
+
+#ifndef DUKKY_BYTECODE_H
+#define DUKKY_BYTECODE_H
+
+struct dukky_bytecode;
+
+/**
+ * compile a script, using cached bytecode where possible
+ *
+ * Scripts large enough to be worth it have their bytecode cached on
+ * compilation. Bytecode does not depend on the heap it was compiled in
+ * so the cache is shared by all heaps.
+ *
+ * \param ctx duktape context to compile in
+ * \param txt script source
+ * \param txtlen length of script source
+ * \param name name of the script
+ * \return zero with the function on the stack on success else non zero
+ *          with the error on the stack.
+ */
+duk_int_t dukky_bytecode_compile(duk_context *ctx,
+				 const uint8_t *txt,
+				 size_t txtlen,
+				 const char *name);
+
+/**
+ * compile a built in script, using its bytecode where possible
+ *
+ * Built in scripts are compiled from source once, by this duktape, and
+ * every later compile loads the resulting bytecode. Their bytecode is
+ * kept apart from the cache so it is never discarded.
+ *
+ * \param ctx duktape context to compile in
+ * \param builtin bytecode of the script, NULL until first compiled
+ * \param txt script source
+ * \param txtlen length of script source
+ * \param name name of the script
+ * \return zero with the function on the stack on success else non zero
+ *          with the error on the stack.
+ */
+duk_int_t dukky_bytecode_compile_builtin(duk_context *ctx,
+					 struct dukky_bytecode **builtin,
+					 const uint8_t *txt,
+					 size_t txtlen,
+					 const char *name);
+
+/**
+ * free the bytecode of a built in script
+ *
+ * \param builtin bytecode of the script or NULL
+ */
+void dukky_bytecode_free_builtin(struct dukky_bytecode *builtin);
+
+/**
+ * discard all cached bytecode
+ */
+void dukky_bytecode_finalise(void);
+
+#endif
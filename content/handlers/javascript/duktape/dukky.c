@@ -25,6 +25,8 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <nsutils/time.h>
 
 #include "netsurf/inttypes.h"
@@ -43,6 +45,7 @@
 
 #include "duktape.h"
 #include "dukky.h"
+#include "bytecode.h"
 
 #include <dom/dom.h>
 
@@ -53,6 +56,39 @@
 #define GENERICS_MAGIC MAGIC(GENERICS_TABLE)
 #define THREAD_MAP MAGIC(THREAD_MAP)
 
+/** Number of pooled allocation size classes */
+#define DUKKY_POOL_CLASSES 8
+
+/** Size of the arenas pooled allocations are carved from */
+#define DUKKY_POOL_ARENA_SIZE (64 * 1024)
+
+/**
+ * Header preceding every heap allocation
+ *
+ * It holds the size of the allocation and keeps the memory following
+ * it suitably aligned.
+ */
+typedef union {
+	size_t size;
+	double d;
+	void *p;
+} dukky_alloc_header;
+
+/**
+ * Pool of small allocations for a heap
+ *
+ * Each size class has a list of freed slots and the unused space in
+ * its current arena. Arenas are only released when the heap is
+ * destroyed.
+ */
+struct dukky_pool {
+	void *free[DUKKY_POOL_CLASSES]; /**< freed slots of each class */
+	char *next[DUKKY_POOL_CLASSES]; /**< next unused slot of each class */
+	char *end[DUKKY_POOL_CLASSES]; /**< end of each current arena */
+	void *arenas; /**< list of all arenas */
+	size_t arena_count; /**< number of arenas */
+};
+
 /**
  * dukky javascript heap
  */
@@ -62,6 +98,11 @@ struct jsheap {
 	bool pending_destroy; /**< Whether this heap is pending destruction */
 	unsigned int live_threads; /**< number of live threads */
 	uint64_t exec_start_time;
+	bool pooled; /**< whether small allocations are pooled */
+	struct dukky_pool pool; /**< pool of small allocations */
+	size_t mem_used; /**< bytes currently allocated */
+	size_t mem_peak; /**< most bytes ever allocated */
+	size_t mem_limit; /**< allocation limit in bytes or zero */
 };
 
 /**
@@ -75,6 +116,10 @@ struct jsthread {
 	duk_uarridx_t thread_idx; /**< The thread number */
 };
 
+/** bytecode of the built in scripts */
+static struct dukky_bytecode *builtin_polyfill;
+static struct dukky_bytecode *builtin_generics;
+
 static duk_ret_t dukky_populate_object(duk_context *ctx, void *udata)
 {
 	/* ... obj args protoname nargs */
@@ -543,34 +588,210 @@ dukky_inject_not_ctr(duk_context *ctx, int idx, const char *name)
 /* We need to override the defaults because not all platforms are fully ANSI
  * compatible.  E.g. RISC OS gets upset if we malloc or realloc a zero byte
  * block, as do debugging tools such as Electric Fence by Bruce Perens.
+ *
+ * Every allocation is preceded by a header recording its size so the
+ * heap can account for the memory it uses and enforce a limit.  Small
+ * allocations are optionally served from per heap size class pools;
+ * duktape makes many short lived small allocations for strings and
+ * property tables which the system allocator handles poorly.
  */
 
+/** Slot sizes, including the header, of each pooled size class */
+static const size_t dukky_pool_class_size[DUKKY_POOL_CLASSES] = {
+	16, 32, 48, 64, 96, 128, 192, 256
+};
+
+/**
+ * get the pool size class for an allocation
+ *
+ * \param size size of allocation including its header
+ * \return the size class or DUKKY_POOL_CLASSES if it is not pooled
+ */
+static inline unsigned int dukky_pool_class(size_t size)
+{
+	/* size class of each 16 byte multiple up to the largest class */
+	static const uint8_t class_map[17] = {
+		0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+	};
+
+	if (size > dukky_pool_class_size[DUKKY_POOL_CLASSES - 1]) {
+		return DUKKY_POOL_CLASSES;
+	}
+	return class_map[(size + 15) >> 4];
+}
+
+/**
+ * allocate a slot from a heap pool
+ *
+ * \param pool pool to allocate from
+ * \param cls size class of slot
+ * \return slot or NULL on memory exhaustion
+ */
+static void *dukky_pool_alloc(struct dukky_pool *pool, unsigned int cls)
+{
+	void *slot;
+
+	slot = pool->free[cls];
+	if (slot != NULL) {
+		pool->free[cls] = *(void **)slot;
+		return slot;
+	}
+
+	if (pool->next[cls] + dukky_pool_class_size[cls] > pool->end[cls]) {
+		char *arena = malloc(DUKKY_POOL_ARENA_SIZE);
+		if (arena == NULL) {
+			return NULL;
+		}
+		/* arenas are chained through their first header */
+		*(void **)arena = pool->arenas;
+		pool->arenas = arena;
+		pool->arena_count++;
+
+		pool->next[cls] = arena + sizeof(dukky_alloc_header);
+		pool->end[cls] = arena + DUKKY_POOL_ARENA_SIZE;
+	}
+
+	slot = pool->next[cls];
+	pool->next[cls] += dukky_pool_class_size[cls];
+
+	return slot;
+}
+
+/**
+ * release all the arenas of a heap pool
+ */
+static void dukky_pool_destroy(struct dukky_pool *pool)
+{
+	void *arena = pool->arenas;
+
+	while (arena != NULL) {
+		void *next = *(void **)arena;
+		free(arena);
+		arena = next;
+	}
+	memset(pool, 0, sizeof(*pool));
+}
+
 static void *dukky_alloc_function(void *udata, duk_size_t size)
 {
+	jsheap *heap = udata;
+	dukky_alloc_header *hdr;
+	size_t total;
+	unsigned int cls;
+
 	if (size == 0)
 		return NULL;
 
-	return malloc(size);
+	if ((heap->mem_limit != 0) &&
+	    (heap->mem_used + size > heap->mem_limit)) {
+		/* duktape will collect garbage and try again */
+		return NULL;
+	}
+
+	total = size + sizeof(dukky_alloc_header);
+	cls = dukky_pool_class(total);
+	if (heap->pooled && (cls < DUKKY_POOL_CLASSES)) {
+		hdr = dukky_pool_alloc(&heap->pool, cls);
+	} else {
+		hdr = malloc(total);
+	}
+	if (hdr == NULL) {
+		return NULL;
+	}
+
+	hdr->size = size;
+	heap->mem_used += size;
+	if (heap->mem_used > heap->mem_peak) {
+		heap->mem_peak = heap->mem_used;
+	}
+
+	return hdr + 1;
+}
+
+static void dukky_free_function(void *udata, void *ptr)
+{
+	jsheap *heap = udata;
+	dukky_alloc_header *hdr;
+	unsigned int cls;
+
+	if (ptr == NULL)
+		return;
+
+	hdr = ((dukky_alloc_header *)ptr) - 1;
+	heap->mem_used -= hdr->size;
+
+	cls = dukky_pool_class(hdr->size + sizeof(dukky_alloc_header));
+	if (heap->pooled && (cls < DUKKY_POOL_CLASSES)) {
+		*(void **)hdr = heap->pool.free[cls];
+		heap->pool.free[cls] = hdr;
+	} else {
+		free(hdr);
+	}
 }
 
 static void *dukky_realloc_function(void *udata, void *ptr, duk_size_t size)
 {
-	if (ptr == NULL && size == 0)
-		return NULL;
+	jsheap *heap = udata;
+	dukky_alloc_header *hdr;
+	unsigned int old_cls;
+	unsigned int new_cls;
+	void *nptr;
+
+	if (ptr == NULL)
+		return dukky_alloc_function(udata, size);
 
 	if (size == 0) {
-		free(ptr);
+		dukky_free_function(udata, ptr);
 		return NULL;
 	}
 
-	return realloc(ptr, size);
-}
+	hdr = ((dukky_alloc_header *)ptr) - 1;
 
+	if ((heap->mem_limit != 0) &&
+	    (size > hdr->size) &&
+	    (heap->mem_used + (size - hdr->size) > heap->mem_limit)) {
+		return NULL;
+	}
 
-static void dukky_free_function(void *udata, void *ptr)
-{
-	if (ptr != NULL)
-		free(ptr);
+	old_cls = dukky_pool_class(hdr->size + sizeof(dukky_alloc_header));
+	new_cls = dukky_pool_class(size + sizeof(dukky_alloc_header));
+
+	if (heap->pooled == false ||
+	    ((old_cls == DUKKY_POOL_CLASSES) &&
+	     (new_cls == DUKKY_POOL_CLASSES))) {
+		/* neither allocation is pooled */
+		dukky_alloc_header *nhdr;
+
+		nhdr = realloc(hdr, size + sizeof(dukky_alloc_header));
+		if (nhdr == NULL) {
+			return NULL;
+		}
+		heap->mem_used = heap->mem_used - nhdr->size + size;
+		nhdr->size = size;
+		if (heap->mem_used > heap->mem_peak) {
+			heap->mem_peak = heap->mem_used;
+		}
+		return nhdr + 1;
+	}
+
+	if (old_cls == new_cls) {
+		/* still fits in the same slot */
+		heap->mem_used = heap->mem_used - hdr->size + size;
+		hdr->size = size;
+		if (heap->mem_used > heap->mem_peak) {
+			heap->mem_peak = heap->mem_used;
+		}
+		return ptr;
+	}
+
+	nptr = dukky_alloc_function(udata, size);
+	if (nptr == NULL) {
+		return NULL;
+	}
+	memcpy(nptr, ptr, min(size, hdr->size));
+	dukky_free_function(udata, ptr);
+
+	return nptr;
 }
 
 /* exported interface documented in js.h */
@@ -589,7 +810,12 @@ void js_initialise(void)
 /* exported interface documented in js.h */
 void js_finalise(void)
 {
-	/* NADA for now */
+	dukky_bytecode_finalise();
+
+	dukky_bytecode_free_builtin(builtin_polyfill);
+	builtin_polyfill = NULL;
+	dukky_bytecode_free_builtin(builtin_generics);
+	builtin_generics = NULL;
 }
 
 
@@ -602,13 +828,19 @@ js_newheap(int timeout, jsheap **heap)
 	*heap = NULL;
 	NSLOG(dukky, DEBUG, "Creating new duktape javascript heap");
 	if (ret == NULL) return NSERROR_NOMEM;
+	ret->pooled = nsoption_bool(js_pool_allocator);
+	ret->mem_limit = nsoption_uint(js_heap_limit);
 	ctx = ret->ctx = duk_create_heap(
 		dukky_alloc_function,
 		dukky_realloc_function,
 		dukky_free_function,
 		ret,
 		NULL);
-	if (ret->ctx == NULL) { free(ret); return NSERROR_NOMEM; }
+	if (ret->ctx == NULL) {
+		dukky_pool_destroy(&ret->pool);
+		free(ret);
+		return NSERROR_NOMEM;
+	}
 	/* Create the prototype stuffs */
 	duk_push_global_object(ctx);
 	duk_push_boolean(ctx, true);
@@ -631,9 +863,21 @@ static void dukky_destroyheap(jsheap *heap)
 	assert(heap->live_threads == 0);
 	NSLOG(dukky, DEBUG, "Destroying duktape javascript context");
 	duk_destroy_heap(heap->ctx);
+	NSLOG(dukky, DEBUG,
+	      "Heap peak %"PRIsizet" bytes, %"PRIsizet" pool arenas, %"PRIsizet" bytes unfreed",
+	      heap->mem_peak, heap->pool.arena_count, heap->mem_used);
+	/* release all pooled allocations in one go */
+	dukky_pool_destroy(&heap->pool);
 	free(heap);
 }
 
+/* exported interface documented in js.h */
+void js_heap_memory(jsheap *heap, size_t *used, size_t *limit)
+{
+	*used = heap->mem_used;
+	*limit = heap->mem_limit;
+}
+
 /* exported interface documented in js.h */
 void js_destroyheap(jsheap *heap)
 {
@@ -650,6 +894,8 @@ void js_destroyheap(jsheap *heap)
 nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **thread)
 {
 	jsthread *ret;
+	uint64_t start;
+	uint64_t end;
 	assert(heap != NULL);
 	assert(heap->pending_destroy == false);
 
@@ -663,6 +909,8 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 	      "New javascript/duktape thread, win_priv=%p, doc_priv=%p",
 	      win_priv, doc_priv);
 
+	(void) nsu_getmonotonic_ms(&start);
+
 	/* create new thread */
 	duk_get_global_string(heap->ctx, THREAD_MAP); /* ... threads */
 	duk_push_thread(heap->ctx); /* ... threads thread */
@@ -697,16 +945,15 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 
 	/* Now load the polyfills */
 	/* ... */
-	duk_push_string(CTX, "polyfill.js");
-	/* ..., polyfill.js */
-	if (duk_pcompile_lstring_filename(CTX, DUK_COMPILE_EVAL,
-					  (const char *)polyfill_js, polyfill_js_len) != 0) {
+	if (dukky_bytecode_compile_builtin(CTX, &builtin_polyfill,
+					   polyfill_js, polyfill_js_len,
+					   "polyfill.js") != 0) {
 		NSLOG(dukky, CRITICAL, "%s", duk_safe_to_string(CTX, -1));
 		NSLOG(dukky, CRITICAL, "Unable to compile polyfill.js, thread aborted");
 		js_destroythread(ret);
 		return NSERROR_INIT_FAILED;
 	}
-	/* ..., (generics.js) */
+	/* ..., (polyfill.js) */
 	if (dukky_pcall(CTX, 0, true) != 0) {
 		NSLOG(dukky, CRITICAL, "Unable to run polyfill.js, thread aborted");
 		js_destroythread(ret);
@@ -718,10 +965,9 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 
 	/* Now load the NetSurf table in */
 	/* ... */
-	duk_push_string(CTX, "generics.js");
-	/* ..., generics.js */
-	if (duk_pcompile_lstring_filename(CTX, DUK_COMPILE_EVAL,
-					  (const char *)generics_js, generics_js_len) != 0) {
+	if (dukky_bytecode_compile_builtin(CTX, &builtin_generics,
+					   generics_js, generics_js_len,
+					   "generics.js") != 0) {
 		NSLOG(dukky, CRITICAL, "%s", duk_safe_to_string(CTX, -1));
 		NSLOG(dukky, CRITICAL, "Unable to compile generics.js, thread aborted");
 		js_destroythread(ret);
@@ -747,7 +993,9 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 	/* ... */
 
 	dukky_log_stack_frame(CTX, "New thread created");
-	NSLOG(dukky, DEBUG, "New thread is %p in heap %p", thread, heap);
+	(void) nsu_getmonotonic_ms(&end);
+	NSLOG(dukky, DEBUG, "New thread is %p in heap %p, created in %"PRIu64"ms",
+	      thread, heap, end - start);
 	*thread = ret;
 
 	return NSERROR_OK;
@@ -939,16 +1187,12 @@ js_exec(jsthread *thread, const uint8_t *txt, size_t txtlen, const char *name)
 	NSLOG(dukky, DEEPDEBUG, "Running %"PRIsizet" bytes from %s", txtlen, name);
 	/* NSLOG(dukky, DEEPDEBUG, "\n%s\n", txt); */
 
-	dukky_reset_start_time(CTX);
-	if (name != NULL) {
-		duk_push_string(CTX, name);
-	} else {
-		duk_push_string(CTX, "?unknown source?");
+	if (name == NULL) {
+		name = "?unknown source?";
 	}
-	if (duk_pcompile_lstring_filename(CTX,
-					  DUK_COMPILE_EVAL,
-					  (const char *)txt,
-					  txtlen) != 0) {
+
+	dukky_reset_start_time(CTX);
+	if (dukky_bytecode_compile(CTX, txt, txtlen, name) != 0) {
 		NSLOG(dukky, DEBUG, "Failed to compile JavaScript input");
 		goto handle_error;
 	}
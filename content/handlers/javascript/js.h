@@ -80,6 +80,15 @@ nserror js_newheap(int timeout, jsheap **heap);
  */
 void js_destroyheap(jsheap *heap);
 
+/**
+ * Get the memory used by a heap.
+ *
+ * \param heap The heap to query
+ * \param used Updated with the number of bytes allocated by the heap
+ * \param limit Updated with the allocation limit in bytes, or 0 if unlimited
+ */
+void js_heap_memory(jsheap *heap, size_t *used, size_t *limit);
+
 /**
  * Create a new javascript thread
  *
@@ -46,6 +46,12 @@ void js_destroyheap(jsheap *heap)
 {
 }
 
+void js_heap_memory(jsheap *heap, size_t *used, size_t *limit)
+{
+	*used = 0;
+	*limit = 0;
+}
+
 nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **thread)
 {
 	*thread = NULL;
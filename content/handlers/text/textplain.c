@@ -24,6 +24,7 @@
  */
 
 #include <string.h>
+#include <limits.h>
 #include <parserutils/input/inputstream.h>
 
 #include "utils/errors.h"
@@ -39,6 +40,7 @@
 #include "netsurf/browser_window.h"
 #include "netsurf/plotters.h"
 #include "netsurf/layout.h"
+#include "netsurf/misc.h"
 #include "content/content_protected.h"
 #include "content/content_factory.h"
 #include "content/hlcache.h"
@@ -54,6 +56,20 @@ struct textplain_line {
 	size_t	length;
 };
 
+/**
+ * Block of hard lines which are wrapped together.
+ *
+ * Physical (wrapped) lines are only generated for blocks which are
+ * displayed, the line count of other blocks is an estimate until the
+ * block has been measured. The physical line number a block starts at
+ * is kept in the content's line tree.
+ */
+struct textplain_block {
+	unsigned long line_count; /**< number of physical lines in block */
+	struct textplain_line *line; /**< physical lines or NULL */
+	bool exact; /**< line_count has been measured at current width */
+};
+
 /**
  * plain text content
  */
@@ -65,8 +81,20 @@ typedef struct textplain_content {
 	char *utf8_data;
 	size_t utf8_data_size;
 	size_t utf8_data_allocated;
-	unsigned long physical_line_count;
-	struct textplain_line *physical_line;
+
+	size_t *hard_line; /**< byte offset of the start of each hard line */
+	unsigned long hard_line_count; /**< number of hard lines indexed */
+	unsigned long hard_line_allocated; /**< size of hard line index */
+	size_t indexed_size; /**< amount of data scanned for line breaks */
+
+	struct textplain_block *block; /**< blocks of hard lines */
+	unsigned long *line_tree; /**< Fenwick tree of block line counts */
+	unsigned long block_count; /**< number of blocks */
+	unsigned long measured_blocks; /**< background measuring progress */
+	unsigned long physical_line_count; /**< sum of block line counts */
+	bool line_count_changed; /**< line count altered outside reformat */
+	unsigned long moved_line; /**< first line moved since last redraw */
+	size_t columns; /**< number of columns text is wrapped to */
 	int formatted_width;
 	struct browser_window *bw;
 
@@ -78,6 +106,24 @@ typedef struct textplain_content {
 #define CHUNK 32768 /* Must be a power of 2 */
 #define MARGIN 4
 
+/** Number of hard lines in a formatting block */
+#define BLOCK_LINES 1024
+
+/**
+ * Size of text, in bytes, above which formatting is performed lazily.
+ *
+ * Smaller documents are wrapped completely on each reformat. Larger
+ * ones only wrap the blocks which are displayed and measure the rest
+ * in the background.
+ */
+#define LAZY_FORMAT_SIZE (1024 * 1024)
+
+/** Number of blocks measured by each background formatting step */
+#define BACKGROUND_BLOCKS 32
+
+/** Delay between background formatting steps, in ms */
+#define BACKGROUND_DELAY 10
+
 #define TAB_WIDTH 8  /* must be power of 2 currently */
 #define TEXT_SIZE 10 * PLOT_STYLE_SCALE  /* Unscaled text size in pt */
 
@@ -163,8 +209,18 @@ textplain_create_internal(textplain_content *c, lwc_string *encoding)
 	c->utf8_data = utf8_data;
 	c->utf8_data_size = 0;
 	c->utf8_data_allocated = CHUNK;
-	c->physical_line = 0;
+	c->hard_line = NULL;
+	c->hard_line_count = 0;
+	c->hard_line_allocated = 0;
+	c->indexed_size = 0;
+	c->block = NULL;
+	c->line_tree = NULL;
+	c->block_count = 0;
+	c->measured_blocks = 0;
 	c->physical_line_count = 0;
+	c->line_count_changed = false;
+	c->moved_line = ULONG_MAX;
+	c->columns = 0;
 	c->formatted_width = 0;
 	c->bw = NULL;
 	c->sel = selection_create((struct content *)c);
@@ -325,6 +381,157 @@ textplain_drain_input(textplain_content *c,
 }
 
 
+/**
+ * add a hard line to the line index
+ *
+ * \param c content to add line to
+ * \param start byte offset of the start of the line
+ * \return true on success else false on memory exhaustion
+ */
+static bool textplain_add_hard_line(textplain_content *c, size_t start)
+{
+	if (c->hard_line_count == c->hard_line_allocated) {
+		unsigned long allocated;
+		size_t *hard_line;
+
+		allocated = c->hard_line_allocated * 2;
+		if (allocated == 0) {
+			allocated = BLOCK_LINES;
+		}
+
+		hard_line = realloc(c->hard_line, sizeof(size_t) * allocated);
+		if (hard_line == NULL) {
+			return false;
+		}
+
+		c->hard_line = hard_line;
+		c->hard_line_allocated = allocated;
+	}
+
+	c->hard_line[c->hard_line_count++] = start;
+
+	return true;
+}
+
+
+/**
+ * find the next hard line break
+ *
+ * The scan uses memchr() which the C library implements with wide
+ * (vector) loads on most platforms. Carriage returns are only searched
+ * for up to the next line feed so the data is scanned at most twice.
+ *
+ * \param data text to search
+ * \param len length of text
+ * \return pointer to the line break or NULL if there is none
+ */
+static const char *textplain_find_break(const char *data, size_t len)
+{
+	const char *lf;
+	const char *cr;
+
+	lf = memchr(data, '\n', len);
+	cr = memchr(data, '\r', (lf != NULL) ? (size_t)(lf - data) : len);
+
+	return (cr != NULL) ? cr : lf;
+}
+
+
+/**
+ * index the hard line breaks in newly received data
+ *
+ * \param c content to index
+ * \param final true if there is no more data to come
+ * \return true on success else false on memory exhaustion
+ */
+static bool textplain_index_lines(textplain_content *c, bool final)
+{
+	const char *data = c->utf8_data;
+	size_t size = c->utf8_data_size;
+	size_t pos = c->indexed_size;
+
+	if (c->hard_line_count == 0) {
+		if (textplain_add_hard_line(c, 0) == false) {
+			return false;
+		}
+	}
+
+	while (pos < size) {
+		const char *brk;
+		size_t next;
+
+		brk = textplain_find_break(data + pos, size - pos);
+		if (brk == NULL) {
+			pos = size;
+			break;
+		}
+
+		next = (brk - data) + 1;
+		if (next == size && !final) {
+			/* cannot yet tell if this is a CR/LF or LF/CR pair */
+			pos = brk - data;
+			break;
+		}
+
+		/* skip second char of CR/LF or LF/CR pair */
+		if (next < size &&
+		    data[next] != *brk &&
+		    (data[next] == '\n' || data[next] == '\r')) {
+			next++;
+		}
+
+		if (textplain_add_hard_line(c, next) == false) {
+			return false;
+		}
+
+		pos = next;
+	}
+
+	c->indexed_size = pos;
+
+	return true;
+}
+
+
+/**
+ * get the extent of a hard line excluding its terminator
+ *
+ * \param c content containing line
+ * \param hard_line index of hard line
+ * \param[out] start receives byte offset of the line start
+ * \param[out] end receives byte offset of the line end
+ */
+static void
+textplain_hard_line_extent(textplain_content *c,
+			   unsigned long hard_line,
+			   size_t *start,
+			   size_t *end)
+{
+	const char *data = c->utf8_data;
+	size_t s = c->hard_line[hard_line];
+	size_t e;
+
+	if (hard_line + 1 >= c->hard_line_count) {
+		*start = s;
+		*end = c->utf8_data_size;
+		return;
+	}
+
+	e = c->hard_line[hard_line + 1];
+	if (e > s && (data[e - 1] == '\n' || data[e - 1] == '\r')) {
+		e--;
+		if (e > s &&
+		    data[e - 1] != data[e] &&
+		    (data[e - 1] == '\n' || data[e - 1] == '\r')) {
+			e--;
+		}
+	}
+
+	*start = s;
+	*end = e;
+}
+
+
 /**
  * Process data for CONTENT_TEXTPLAIN.
  */
@@ -344,6 +551,9 @@ textplain_process_data(struct content *c, const char *data, unsigned int size)
 	if (textplain_drain_input(text, stream, PARSERUTILS_NEEDDATA) == false)
 		goto no_memory;
 
+	if (textplain_index_lines(text, false) == false)
+		goto no_memory;
+
 	return true;
 
 no_memory:
@@ -369,6 +579,19 @@ static bool textplain_convert(struct content *c)
 	if (textplain_drain_input(text, stream, PARSERUTILS_EOF) == false)
 		return false;
 
+	if (textplain_index_lines(text, true) == false)
+		return false;
+
+	text->block_count = (text->hard_line_count + BLOCK_LINES - 1) /
+			BLOCK_LINES;
+	text->block = calloc(text->block_count, sizeof(struct textplain_block));
+	if (text->block == NULL)
+		return false;
+
+	text->line_tree = calloc(text->block_count + 1, sizeof(unsigned long));
+	if (text->line_tree == NULL)
+		return false;
+
 	parserutils_inputstream_destroy(stream);
 	text->inputstream = NULL;
 
@@ -395,123 +618,542 @@ static float textplain_line_height(void)
 
 
 /**
- * Reformat a CONTENT_TEXTPLAIN to a new width.
+ * Physical lines being generated by wrapping
  */
-static void textplain_reformat(struct content *c, int width, int height)
-{
-	textplain_content *text = (textplain_content *) c;
-	char *utf8_data = text->utf8_data;
-	size_t utf8_data_size = text->utf8_data_size;
-	unsigned long line_count = 0;
-	struct textplain_line *line = text->physical_line;
-	struct textplain_line *line1;
-	size_t i, space, col;
-	size_t columns = 80;
-	int character_width;
-	size_t line_start;
-	nserror res;
+struct textplain_wrap {
+	struct textplain_line *line; /**< generated lines */
+	unsigned long count; /**< number of lines generated */
+	unsigned long allocated; /**< size of line array */
+	bool store; /**< lines are stored, otherwise only counted */
+};
 
-	NSLOG(netsurf, INFO, "content %p w:%d h:%d", c, width, height);
 
-	/* compute available columns (assuming monospaced font) - use 8
-	 * characters for better accuracy
-	 */
-	res = guit->layout->width(&textplain_style,
-				  "ABCDEFGH", 8,
-				  &character_width);
-	if (res != NSERROR_OK) {
-		return;
+/**
+ * add a physical line to a wrapping
+ *
+ * \param wrap wrapping to add to
+ * \param start byte offset of line start
+ * \param length length of line in bytes
+ * \return true on success else false on memory exhaustion
+ */
+static bool
+textplain_wrap_add(struct textplain_wrap *wrap, size_t start, size_t length)
+{
+	if (wrap->store) {
+		if (wrap->count == wrap->allocated) {
+			unsigned long allocated = wrap->allocated + BLOCK_LINES;
+			struct textplain_line *line;
+
+			line = realloc(wrap->line,
+				       sizeof(struct textplain_line) * allocated);
+			if (line == NULL) {
+				return false;
+			}
+			wrap->line = line;
+			wrap->allocated = allocated;
+		}
+
+		wrap->line[wrap->count].start = start;
+		wrap->line[wrap->count].length = length;
 	}
 
-	columns = (width - MARGIN - MARGIN) * 8 / character_width;
-	textplain_tab_width = (TAB_WIDTH * character_width) / 8;
+	wrap->count++;
 
-	text->formatted_width = width;
+	return true;
+}
 
-	text->physical_line_count = 0;
 
-	if (!line) {
-		text->physical_line = line =
-			malloc(sizeof(struct textplain_line) * (1024 + 3));
-		if (!line)
-			goto no_memory;
+/**
+ * wrap a hard line into physical lines
+ *
+ * Lines which are shorter in bytes than the number of columns and
+ * contain no tabs cannot need wrapping so are added without
+ * decoding them.
+ *
+ * \param c content containing line
+ * \param start byte offset of line start
+ * \param end byte offset of line end
+ * \param wrap wrapping to add the physical lines to
+ * \return true on success else false on memory exhaustion
+ */
+static bool
+textplain_wrap_line(textplain_content *c,
+		    size_t start,
+		    size_t end,
+		    struct textplain_wrap *wrap)
+{
+	const char *utf8_data = c->utf8_data;
+	size_t columns = c->columns;
+	size_t line_start = start;
+	size_t space = 0;
+	bool have_space = false;
+	size_t col = 0;
+	size_t i = start;
+
+	if ((end - start) < columns &&
+	    memchr(utf8_data + start, '\t', end - start) == NULL) {
+		return textplain_wrap_add(wrap, start, end - start);
 	}
 
-	line[line_count++].start = line_start = 0;
-	space = 0;
-	i = 0;
-	col = 0;
-	while (i < utf8_data_size) {
+	while (i < end) {
 		size_t csize; /* number of bytes in character */
 		uint32_t chr;
-		bool term;
 		size_t next_col;
 		parserutils_error perror;
 
-		perror = parserutils_charset_utf8_to_ucs4((const uint8_t *)utf8_data + i, utf8_data_size - i, &chr, &csize);
+		perror = parserutils_charset_utf8_to_ucs4((const uint8_t *)utf8_data + i, end - i, &chr, &csize);
 		if (perror != PARSERUTILS_OK) {
 			chr = 0xfffd;
+			csize = 1;
 		}
 
-		term = (chr == '\n' || chr == '\r');
-
 		next_col = col + 1;
 
 		if (chr == '\t') {
 			next_col = (next_col + TAB_WIDTH - 1) & ~(TAB_WIDTH - 1);
 		}
 
-		if (term || next_col >= columns) {
-			if (line_count % 1024 == 0) {
-				line1 = realloc(line,
-						sizeof(struct textplain_line) *
-						(line_count + 1024 + 3));
-				if (!line1)
-					goto no_memory;
-				text->physical_line = line = line1;
-			}
-
-			if (term) {
-				line[line_count-1].length = i - line_start;
-
-				/* skip second char of CR/LF or LF/CR pair */
-				if (i + 1 < utf8_data_size &&
-				    utf8_data[i+1] != utf8_data[i] &&
-				    (utf8_data[i+1] == '\n' ||
-				     utf8_data[i+1] == '\r')) {
-					i++;
-				}
+		if (next_col >= columns && i > line_start) {
+			if (have_space) {
+				/* break at last space in line */
+				if (!textplain_wrap_add(wrap, line_start,
+						(space + 1) - line_start))
+					return false;
+				i = line_start = space + 1;
 			} else {
-				if (space) {
-					/* break at last space in line */
-					i = space;
-					line[line_count-1].length = (i + 1) - line_start;
-				} else
-					line[line_count-1].length = i - line_start;
+				if (!textplain_wrap_add(wrap, line_start,
+						i - line_start))
+					return false;
+				line_start = i;
 			}
 
-			line[line_count++].start = line_start = i + 1;
 			col = 0;
-			space = 0;
-		} else {
-			col++;
-			if (chr == ' ')
-				space = i;
+			have_space = false;
+			continue;
+		}
+
+		col = next_col;
+		if (chr == ' ') {
+			space = i;
+			have_space = true;
 		}
 		i += csize;
 	}
-	line[line_count-1].length = i - line[line_count-1].start;
-	line[line_count].start = utf8_data_size;
 
-	text->physical_line_count = line_count;
+	return textplain_wrap_add(wrap, line_start, end - line_start);
+}
+
+
+/**
+ * build the line tree from the line count of every block
+ *
+ * Entry i of the tree holds the sum of the line counts of the
+ * i & -i blocks ending with block i - 1, so both the first line of a
+ * block and the block containing a line are found in logarithmic time
+ * and a block's line count is changed without renumbering every block
+ * after it.
+ *
+ * \param c content to build the line tree of
+ */
+static void textplain_line_tree_build(textplain_content *c)
+{
+	unsigned long i;
+	unsigned long parent;
+
+	for (i = 1; i <= c->block_count; i++) {
+		c->line_tree[i] = c->block[i - 1].line_count;
+	}
+
+	for (i = 1; i <= c->block_count; i++) {
+		parent = i + (i & -i);
+		if (parent <= c->block_count) {
+			c->line_tree[parent] += c->line_tree[i];
+		}
+	}
+}
+
+
+/**
+ * get the physical line number a block starts at
+ *
+ * \param c content containing block
+ * \param blk index of block
+ * \return physical line number of the block start
+ */
+static unsigned long
+textplain_block_first_line(textplain_content *c, unsigned long blk)
+{
+	unsigned long first_line = 0;
+
+	while (blk > 0) {
+		first_line += c->line_tree[blk];
+		blk -= blk & -blk;
+	}
+
+	return first_line;
+}
+
+
+/**
+ * set the measured number of physical lines in a block
+ *
+ * \param c content containing block
+ * \param blk index of block
+ * \param line_count number of physical lines in the block
+ */
+static void
+textplain_block_set_count(textplain_content *c,
+			  unsigned long blk,
+			  unsigned long line_count)
+{
+	unsigned long old_count = c->block[blk].line_count;
+	unsigned long moved;
+	unsigned long i;
+
+	c->block[blk].exact = true;
+
+	if (line_count == old_count) {
+		return;
+	}
+
+	/* every line after the shorter of the old and new block has
+	 * moved, the block itself has not been displayed unless it was
+	 * already wrapped at this width
+	 */
+	moved = textplain_block_first_line(c, blk) + min(old_count, line_count);
+	if (moved < c->moved_line) {
+		c->moved_line = moved;
+	}
+
+	c->block[blk].line_count = line_count;
+	for (i = blk + 1; i <= c->block_count; i += i & -i) {
+		c->line_tree[i] = c->line_tree[i] - old_count + line_count;
+	}
+	c->physical_line_count = c->physical_line_count -
+			old_count + line_count;
+	c->line_count_changed = true;
+}
+
+
+/**
+ * wrap the hard lines of a block at the current width
+ *
+ * \param c content containing block
+ * \param blk index of block
+ * \param store true to keep the physical lines, false to only measure
+ * \return true on success else false on memory exhaustion
+ */
+static bool
+textplain_block_wrap(textplain_content *c, unsigned long blk, bool store)
+{
+	struct textplain_block *block = &c->block[blk];
+	struct textplain_wrap wrap = {
+		.line = NULL,
+		.count = 0,
+		.allocated = 0,
+		.store = store,
+	};
+	unsigned long hard_line;
+	unsigned long last;
+
+	if (block->line != NULL || (!store && block->exact)) {
+		return true;
+	}
+
+	last = min((blk + 1) * BLOCK_LINES, c->hard_line_count);
+	for (hard_line = blk * BLOCK_LINES; hard_line < last; hard_line++) {
+		size_t start, end;
+
+		textplain_hard_line_extent(c, hard_line, &start, &end);
+
+		if (textplain_wrap_line(c, start, end, &wrap) == false) {
+			free(wrap.line);
+			NSLOG(netsurf, INFO, "out of memory (block %lu)", blk);
+			return false;
+		}
+	}
+
+	block->line = wrap.line;
+	textplain_block_set_count(c, blk, wrap.count);
+
+	return true;
+}
+
+
+/**
+ * find the block containing a physical line
+ *
+ * \param c content to search
+ * \param lineno physical line number, less than the line count
+ * \return index of block containing the line
+ */
+static unsigned long
+textplain_find_block(textplain_content *c, unsigned long lineno)
+{
+	unsigned long blk = 0;
+	unsigned long step = 1;
+
+	while (step <= c->block_count / 2) {
+		step <<= 1;
+	}
+
+	/* descend the line tree to the last block starting at or
+	 * before the line
+	 */
+	for (; step > 0; step >>= 1) {
+		if ((blk + step <= c->block_count) &&
+		    (c->line_tree[blk + step] <= lineno)) {
+			blk += step;
+			lineno -= c->line_tree[blk];
+		}
+	}
+
+	return min(blk, c->block_count - 1);
+}
+
+
+/**
+ * get a physical line, wrapping its block if necessary
+ *
+ * \param c content containing the line
+ * \param lineno physical line number
+ * \return the line or NULL if there is no such line
+ */
+static struct textplain_line *
+textplain_get_physical_line(textplain_content *c, unsigned long lineno)
+{
+	while (lineno < c->physical_line_count) {
+		unsigned long blk = textplain_find_block(c, lineno);
+		struct textplain_block *block = &c->block[blk];
+
+		if (block->line != NULL) {
+			return &block->line[lineno -
+					textplain_block_first_line(c, blk)];
+		}
+
+		/* wrapping may alter the block's line count so search again */
+		if (textplain_block_wrap(c, blk, true) == false) {
+			return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * wrap all the blocks covering a range of physical lines
+ *
+ * \param c content to wrap
+ * \param line0 first physical line
+ * \param line1 physical line after the last one required
+ * \return true on success else false on memory exhaustion
+ */
+static bool
+textplain_wrap_range(textplain_content *c,
+		     unsigned long line0,
+		     unsigned long line1)
+{
+	unsigned long lineno = line0;
+
+	while (lineno < line1 && lineno < c->physical_line_count) {
+		unsigned long blk = textplain_find_block(c, lineno);
+
+		if (textplain_block_wrap(c, blk, true) == false) {
+			return false;
+		}
+
+		lineno = textplain_block_first_line(c, blk) +
+				c->block[blk].line_count;
+	}
+
+	return true;
+}
+
+
+/**
+ * request a redraw of the lines moved by changes to block line counts
+ *
+ * \param text content to redraw
+ */
+static void textplain_redraw_moved(textplain_content *text)
+{
+	int y;
+	int height;
+
+	if (text->moved_line == ULONG_MAX) {
+		return;
+	}
+
+	y = text->moved_line * textplain_line_height() + MARGIN;
+	height = max(text->base.height,
+		     (int)(text->physical_line_count * textplain_line_height()) +
+		     MARGIN + MARGIN);
+	text->moved_line = ULONG_MAX;
+
+	if (y < height) {
+		content__request_redraw(&text->base,
+					0, y, text->base.width, height - y);
+	}
+}
+
+
+/**
+ * update content height after a change to the physical line count
+ *
+ * \param p content to update
+ */
+static void textplain_update_height(void *p)
+{
+	textplain_content *text = p;
+	union content_msg_data msg_data;
+	int height;
+
+	text->line_count_changed = false;
+
+	height = text->physical_line_count * textplain_line_height() +
+			MARGIN + MARGIN;
+	if (height == text->base.height) {
+		textplain_redraw_moved(text);
+		return;
+	}
+
+	text->base.height = height;
+
+	/* the whole content is redrawn */
+	text->moved_line = ULONG_MAX;
+
+	msg_data.background = false;
+	content_broadcast(&text->base, CONTENT_MSG_REFORMAT, &msg_data);
+}
+
+
+/**
+ * measure blocks which have not been displayed
+ *
+ * A few blocks are measured on each call until the whole document has
+ * been measured at which point the content height is exact.
+ *
+ * \param p content to measure
+ */
+static void textplain_background_format(void *p)
+{
+	textplain_content *text = p;
+	unsigned long last;
+
+	last = min(text->measured_blocks + BACKGROUND_BLOCKS,
+		   text->block_count);
+
+	while (text->measured_blocks < last) {
+		textplain_block_wrap(text, text->measured_blocks, false);
+		text->measured_blocks++;
+	}
+
+	if (text->measured_blocks < text->block_count) {
+		/* the height is only updated once measuring is complete
+		 * but lines already displayed may have moved
+		 */
+		textplain_redraw_moved(text);
+
+		guit->misc->schedule(BACKGROUND_DELAY,
+				     textplain_background_format,
+				     text);
+		return;
+	}
+
+	NSLOG(netsurf, INFO, "content %p measured %lu lines in %lu blocks",
+	      text, text->physical_line_count, text->block_count);
+
+	textplain_update_height(text);
+}
+
+
+/**
+ * Reformat a CONTENT_TEXTPLAIN to a new width.
+ *
+ * Every block is given an estimated line count from its size which is
+ * replaced by the exact count once the block is wrapped. Small
+ * documents are wrapped immediately, large ones only as they are
+ * displayed with the remainder measured in the background.
+ */
+static void textplain_reformat(struct content *c, int width, int height)
+{
+	textplain_content *text = (textplain_content *) c;
+	unsigned long line_count = 0;
+	unsigned long blk;
+	int character_width;
+	int columns;
+	nserror res;
+
+	NSLOG(netsurf, INFO, "content %p w:%d h:%d", c, width, height);
+
+	/* compute available columns (assuming monospaced font) - use 8
+	 * characters for better accuracy
+	 */
+	res = guit->layout->width(&textplain_style,
+				  "ABCDEFGH", 8,
+				  &character_width);
+	if (res != NSERROR_OK) {
+		return;
+	}
+
+	columns = (width - MARGIN - MARGIN) * 8 / character_width;
+	if (columns < 1) {
+		columns = 1;
+	}
+	textplain_tab_width = (TAB_WIDTH * character_width) / 8;
+
+	text->formatted_width = width;
 	c->width = width;
-	c->height = line_count * textplain_line_height() + MARGIN + MARGIN;
 
-	return;
+	if ((size_t)columns == text->columns) {
+		/* wrapping is unchanged */
+		return;
+	}
+	text->columns = columns;
 
-no_memory:
-	NSLOG(netsurf, INFO, "out of memory (line_count %lu)", line_count);
-	return;
+	guit->misc->schedule(-1, textplain_background_format, text);
+	guit->misc->schedule(-1, textplain_update_height, text);
+
+	for (blk = 0; blk < text->block_count; blk++) {
+		struct textplain_block *block = &text->block[blk];
+		unsigned long first = blk * BLOCK_LINES;
+		unsigned long last = min(first + BLOCK_LINES,
+					 text->hard_line_count);
+		size_t end;
+		unsigned long estimate;
+
+		end = (last < text->hard_line_count) ?
+			text->hard_line[last] : text->utf8_data_size;
+		estimate = (end - text->hard_line[first]) / columns;
+
+		free(block->line);
+		block->line = NULL;
+		block->exact = false;
+		block->line_count = max(last - first, estimate);
+
+		line_count += block->line_count;
+	}
+	textplain_line_tree_build(text);
+	text->physical_line_count = line_count;
+	text->measured_blocks = 0;
+
+	if (text->utf8_data_size <= LAZY_FORMAT_SIZE) {
+		if (textplain_wrap_range(text, 0, line_count) == false) {
+			NSLOG(netsurf, INFO, "out of memory (line_count %lu)",
+			      text->physical_line_count);
+		}
+	} else {
+		guit->misc->schedule(BACKGROUND_DELAY,
+				     textplain_background_format,
+				     text);
+	}
+
+	/* the whole content is redrawn after a reformat */
+	text->line_count_changed = false;
+	text->moved_line = ULONG_MAX;
+	c->height = text->physical_line_count * textplain_line_height() +
+			MARGIN + MARGIN;
 }
 
 
@@ -522,6 +1164,10 @@ no_memory:
 static void textplain_destroy(struct content *c)
 {
 	textplain_content *text = (textplain_content *) c;
+	unsigned long blk;
+
+	guit->misc->schedule(-1, textplain_background_format, text);
+	guit->misc->schedule(-1, textplain_update_height, text);
 
 	lwc_string_unref(text->encoding);
 
@@ -529,8 +1175,16 @@ static void textplain_destroy(struct content *c)
 		parserutils_inputstream_destroy(text->inputstream);
 	}
 
-	if (text->physical_line != NULL) {
-		free(text->physical_line);
+	if (text->block != NULL) {
+		for (blk = 0; blk < text->block_count; blk++) {
+			free(text->block[blk].line);
+		}
+		free(text->block);
+	}
+	free(text->line_tree);
+
+	if (text->hard_line != NULL) {
+		free(text->hard_line);
 	}
 
 	if (text->utf8_data != NULL) {
@@ -633,7 +1287,10 @@ textplain_offset_from_coords(struct content *c, int x, int y, int dir)
 	else if ((unsigned)y >= nlines)
 		y = nlines - 1;
 
-	line = &textc->physical_line[y];
+	line = textplain_get_physical_line(textc, y);
+	if (line == NULL)
+		return 0;
+
 	text = textc->utf8_data + line->start;
 	length = line->length;
 	idx = 0;
@@ -1062,7 +1719,6 @@ textplain_redraw(struct content *c,
 	float scaled_line_height = line_height * data->scale;
 	long line0 = (clip->y0 - y * data->scale) / scaled_line_height - 1;
 	long line1 = (clip->y1 - y * data->scale) / scaled_line_height + 1;
-	struct textplain_line *line = text->physical_line;
 	size_t length;
 	plot_style_t *plot_style_highlight;
 	nserror res;
@@ -1083,9 +1739,22 @@ textplain_redraw(struct content *c,
 		return false;
 	}
 
-	if (!line)
+	if (text->block == NULL)
 		return true;
 
+	/* wrap the blocks being displayed */
+	if (textplain_wrap_range(text, line0, line1) == false)
+		return false;
+
+	if (text->line_count_changed) {
+		/* update extent once the redraw is complete */
+		guit->misc->schedule(0, textplain_update_height, text);
+		if (text->physical_line_count < (unsigned long) line1)
+			line1 = text->physical_line_count;
+		if (line1 < line0)
+			line1 = line0;
+	}
+
 	/* choose a suitable background colour for any highlighted text */
 	if ((data->background_colour & 0x808080) == 0x808080)
 		plot_style_highlight = plot_style_fill_black;
@@ -1098,14 +1767,20 @@ textplain_redraw(struct content *c,
 	x = (x + MARGIN) * data->scale;
 	y = (y + MARGIN) * data->scale;
 	for (lineno = line0; lineno != line1; lineno++) {
-		const char *text_d = utf8_data + line[lineno].start;
+		struct textplain_line *line;
+		const char *text_d;
 		int tab_width = textplain_tab_width * data->scale;
 		size_t offset = 0;
 		int tx = x;
 
 		if (!tab_width) tab_width = 1;
 
-		length = line[lineno].length;
+		line = textplain_get_physical_line(text, lineno);
+		if (line == NULL)
+			return false;
+
+		text_d = utf8_data + line->start;
+		length = line->length;
 		if (!length)
 			continue;
 
@@ -1124,7 +1799,7 @@ textplain_redraw(struct content *c,
 
 			if (!text_draw(text_d + offset,
 				       next_offset - offset,
-				       line[lineno].start + offset,
+				       line->start + offset,
 				       tx,
 				       y + (lineno * scaled_line_height),
 				       clip,
@@ -1157,7 +1832,7 @@ textplain_redraw(struct content *c,
 			 */
 
 			if (bw) {
-				unsigned tab_ofst = line[lineno].start + next_offset;
+				unsigned tab_ofst = line->start + next_offset;
 				struct selection *sel = text->sel;
 				bool highlighted = false;
 
@@ -1296,52 +1971,6 @@ textplain_coord_from_offset(const char *text, size_t offset, size_t length)
 }
 
 
-/**
- * Retrieve number of lines in content
- *
- * \param[in] c Content to retrieve line count from
- * \return Number of lines
- */
-static unsigned long textplain_line_count(struct content *c)
-{
-	textplain_content *text = (textplain_content *) c;
-
-	assert(c != NULL);
-
-	return text->physical_line_count;
-}
-
-
-/**
- * Return a pointer to the requested line of text.
- *
- * \param[in] c        content of type CONTENT_TEXTPLAIN
- * \param[in] lineno   line number
- * \param[out] poffset receives byte offset of line start within text
- * \param[out] plen    receives length of returned line
- * \return pointer to text, or NULL if invalid line number
- */
-static char *
-textplain_get_line(struct content *c,
-		   unsigned lineno,
-		   size_t *poffset,
-		   size_t *plen)
-{
-	textplain_content *text = (textplain_content *) c;
-	struct textplain_line *line;
-
-	assert(c != NULL);
-
-	if (lineno >= text->physical_line_count)
-		return NULL;
-	line = &text->physical_line[lineno];
-
-	*poffset = line->start;
-	*plen = line->length;
-	return text->utf8_data + line->start;
-}
-
-
 /**
  * Find line number of byte in text
  *
@@ -1355,90 +1984,120 @@ textplain_get_line(struct content *c,
 static int textplain_find_line(struct content *c, unsigned offset)
 {
 	textplain_content *text = (textplain_content *) c;
-	struct textplain_line *line;
-	int nlines;
-	int lineno = 0;
+	struct textplain_block *block;
+	unsigned long blk;
+	unsigned long lo, hi;
 
 	assert(c != NULL);
 
-	line = text->physical_line;
-	nlines = text->physical_line_count;
-
-	if (offset > text->utf8_data_size) {
+	if (offset > text->utf8_data_size || text->block == NULL) {
 		return -1;
 	}
 
-/* \todo - implement binary search here */
-	while (lineno < nlines && line[lineno].start < offset) {
-		lineno++;
+	/* find the hard line containing the offset */
+	lo = 0;
+	hi = text->hard_line_count;
+	while (hi - lo > 1) {
+		unsigned long mid = lo + (hi - lo) / 2;
+
+		if (text->hard_line[mid] <= offset) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+
+	blk = lo / BLOCK_LINES;
+	block = &text->block[blk];
+	if (textplain_block_wrap(text, blk, true) == false) {
+		return -1;
 	}
-	if (line[lineno].start > offset) {
-		lineno--;
+
+	/* find the physical line within the block */
+	lo = 0;
+	hi = block->line_count;
+	while (hi - lo > 1) {
+		unsigned long mid = lo + (hi - lo) / 2;
+
+		if (block->line[mid].start <= offset) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
 	}
 
-	return lineno;
+	return textplain_block_first_line(text, blk) + lo;
 }
 
 
 /**
- * Finds all occurrences of a given string in a textplain content
+ * Finds all occurrences of the search pattern in a textplain content
+ *
+ * The search is performed on hard lines so it does not depend upon the
+ * text having been wrapped.
  *
  * \param c the content to be searched
  * \param context The search context to add the entry to.
- * \param pattern the string pattern to search for
- * \param p_len pattern length
- * \param case_sens whether to perform a case sensitive search
  * \return NSERROR_OK on success else error code on faliure
  */
 static nserror
 textplain_textsearch_find(struct content *c,
-			  struct textsearch_context *context,
-			  const char *pattern,
-			  int p_len,
-			  bool case_sens)
+			  struct textsearch_context *context)
 {
-	int nlines = textplain_line_count(c);
-	int line;
+	textplain_content *textc = (textplain_content *) c;
+	size_t *position;
+	unsigned long line = 0;
 	nserror res = NSERROR_OK;
 
-	for(line = 0; line < nlines; line++) {
-		size_t offset, length;
+	/* resume from the hard line index entry the search stopped at */
+	position = content_textsearch_position(context);
+	if (position != NULL) {
+		line = position - textc->hard_line;
+	}
+
+	for (; line < textc->hard_line_count; line++) {
+		size_t offset, end, length;
 		const char *text;
 
-		text = textplain_get_line(c, line, &offset, &length);
-		if (text) {
-			while (length > 0) {
-				unsigned match_length;
-				size_t start_idx;
-				const char *new_text;
-				const char *pos;
-
-				pos = content_textsearch_find_pattern(
-						text,
-						length,
-						pattern,
-						p_len,
-						case_sens,
-						&match_length);
-				if (!pos)
-					break;
-
-				/* found string in line => add to list */
-				start_idx = offset + (pos - text);
-				res = content_textsearch_add_match(context,
-						start_idx,
-						start_idx + match_length,
-						NULL,
-						NULL);
-				if (res != NSERROR_OK) {
-					return res;
-				}
+		if ((line % BLOCK_LINES) == 0 &&
+		    content_textsearch_expired(context)) {
+			content_textsearch_suspend(context,
+						   &textc->hard_line[line]);
+			break;
+		}
+
+		textplain_hard_line_extent(textc, line, &offset, &end);
+		text = textc->utf8_data + offset;
+		length = end - offset;
+
+		while (length > 0) {
+			unsigned match_length;
+			size_t start_idx;
+			const char *new_text;
+			const char *pos;
+
+			pos = content_textsearch_find_match(context,
+							    text,
+							    length,
+							    &match_length);
+			if (!pos)
+				break;
 
-				new_text = pos + match_length;
-				offset += (new_text - text);
-				length -= (new_text - text);
-				text = new_text;
+			/* found string in line => add to list */
+			start_idx = offset + (pos - text);
+			res = content_textsearch_add_match(context,
+							   start_idx,
+							   start_idx + match_length,
+							   NULL,
+							   NULL);
+			if (res != NSERROR_OK) {
+				return res;
 			}
+
+			new_text = pos + match_length;
+			offset += (new_text - text);
+			length -= (new_text - text);
+			text = new_text;
 		}
 	}
 
@@ -1463,48 +2122,47 @@ textplain_coords_from_range(struct content *c,
 {
 	textplain_content *text = (textplain_content *) c;
 	float line_height = textplain_line_height();
-	char *utf8_data;
 	struct textplain_line *line;
-	unsigned lineno = 0;
-	unsigned nlines;
+	int lineno;
+	int end_lineno;
 
 	assert(c != NULL);
 	assert(start <= end);
 	assert(end <= text->utf8_data_size);
 
-	utf8_data = text->utf8_data;
-	nlines = text->physical_line_count;
-	line = text->physical_line;
-
 	/* find start */
 	lineno = textplain_find_line(c, start);
+	if (lineno < 0) {
+		lineno = 0;
+	}
 
 	r->y0 = (int)(MARGIN + lineno * line_height);
 
-	if (lineno + 1 <= nlines || line[lineno + 1].start >= end) {
-		/* \todo - it may actually be more efficient just to
-		 *   run forwards most of the time
-		 */
+	/* find end */
+	end_lineno = textplain_find_line(c, end);
+	if (end_lineno < lineno) {
+		end_lineno = lineno;
+	}
 
-		/* find end */
-		lineno = textplain_find_line(c, end);
+	line = textplain_get_physical_line(text, lineno);
 
+	if (end_lineno != lineno || line == NULL) {
 		r->x0 = 0;
 		r->x1 = text->formatted_width;
 	} else {
 		/* single line */
-		const char *text = utf8_data + line[lineno].start;
+		const char *utf8_text = text->utf8_data + line->start;
 
-		r->x0 = textplain_coord_from_offset(text,
-						    start - line[lineno].start,
-						    line[lineno].length);
+		r->x0 = MARGIN + textplain_coord_from_offset(utf8_text,
+				start - line->start,
+				line->length);
 
-		r->x1 = textplain_coord_from_offset(text,
-						    end - line[lineno].start,
-						    line[lineno].length);
+		r->x1 = MARGIN + textplain_coord_from_offset(utf8_text,
+				end - line->start,
+				line->length);
 	}
 
-	r->y1 = (int)(MARGIN + (lineno + 1) * line_height);
+	r->y1 = (int)(MARGIN + (end_lineno + 1) * line_height);
 }
 
 
@@ -29,6 +29,7 @@
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/ring.h"
+#include "utils/trace.h"
 #include "utils/utils.h"
 #include "netsurf/inttypes.h"
 #include "netsurf/misc.h"
@@ -260,15 +261,19 @@ static nserror hlcache_find_content(hlcache_retrieval_ctx *ctx,
 	}
 
 	if (entry == NULL) {
+		uint64_t trace;
+
 		/* No existing entry, so need to create one */
 		entry = malloc(sizeof(hlcache_entry));
 		if (entry == NULL)
 			return NSERROR_NOMEM;
 
 		/* Create content using llhandle */
+		trace = nstrace_begin();
 		entry->content = content_factory_create_content(ctx->llcache,
 				ctx->child.charset, ctx->child.quirks,
 				effective_type);
+		nstrace_end("hlcache", "create content", trace);
 		if (entry->content == NULL) {
 			free(entry);
 			return NSERROR_NOMEM;
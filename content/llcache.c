@@ -46,6 +46,7 @@
 #include "utils/nsurl.h"
 #include "utils/utils.h"
 #include "utils/time.h"
+#include "utils/trace.h"
 #include "utils/http.h"
 #include "utils/nsoption.h"
 #include "netsurf/misc.h"
@@ -81,6 +82,8 @@ struct llcache_handle {
 
 	llcache_fetch_state state;	/**< Last known state of object fetch */
 	size_t bytes;			/**< Last reported byte count */
+
+	unsigned int trace_track;	/**< Trace track handle was made on */
 };
 
 /**
@@ -176,6 +179,11 @@ struct llcache_object {
 	uint8_t *source_data;	     /**< Source data for object */
 	size_t source_len;	     /**< Byte length of source data */
 	size_t source_alloc;	     /**< Allocated size of source buffer */
+	struct fetch_buffer *source_buffer; /**< Fetch buffer the source
+					     * data was taken from, kept to
+					     * check its source for changes,
+					     * or NULL
+					     */
 
 	struct cert_chain *chain;    /**< Certificate chain from the fetch */
 
@@ -304,6 +312,7 @@ static nserror llcache_object_user_new(llcache_handle_callback cb, void *pw,
 
 	h->cb = cb;
 	h->pw = pw;
+	h->trace_track = nstrace_track;
 
 	u->handle = h;
 
@@ -374,6 +383,29 @@ static nserror llcache_object_remove_user(llcache_object *object,
 	return NSERROR_OK;
 }
 
+/**
+ * Call a handle's callback.
+ *
+ * Work the client does in response is attributed to the trace track
+ * the handle was created on.
+ *
+ * \param handle	The handle to call the callback of
+ * \param event		The event to pass to the callback.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror llcache_handle_emit(llcache_handle *handle,
+				   const llcache_event *event)
+{
+	unsigned int track;
+	nserror error;
+
+	track = nstrace_enter(handle->trace_track);
+	error = handle->cb(handle, event, handle->pw);
+	nstrace_leave(track);
+
+	return error;
+}
+
 /**
  * Iterate the users of an object, calling their callbacks.
  *
@@ -392,8 +424,7 @@ static nserror llcache_send_event_to_users(llcache_object *object,
 		bool was_target = user->iterator_target;
 		user->iterator_target = true;
 
-		error = user->handle->cb(user->handle, event,
-					user->handle->pw);
+		error = llcache_handle_emit(user->handle, event);
 
 		next_user = user->next;
 
@@ -1064,6 +1095,11 @@ static nserror llcache_object_destroy(llcache_object *object)
 
 	cert_chain_free(object->chain);
 
+	if (object->source_buffer != NULL) {
+		object->source_buffer->release(object->source_buffer);
+		object->source_buffer = NULL;
+	}
+
 	if (object->source_data != NULL) {
 		if (object->store_state == LLCACHE_STATE_DISC) {
 			guit->llcache->release(object->url, BACKING_STORE_NONE);
@@ -1181,6 +1217,14 @@ static bool llcache_object_is_fresh(const llcache_object *object)
 	int remaining_lifetime;
 	const llcache_cache_control *cd = &object->cache;
 
+	/* Data taken from a fetch buffer is only as fresh as its source */
+	if ((object->source_buffer != NULL) &&
+	    (object->fetch.state == LLCACHE_FETCH_COMPLETE) &&
+	    object->source_buffer->changed(object->source_buffer)) {
+		NSLOG(llcache, DEBUG, "%p: buffer source changed", object);
+		return false;
+	}
+
 	remaining_lifetime = llcache_object_rfc2616_remaining_lifetime(cd);
 
 	NSLOG(llcache, DEBUG, "%p: (%d > 0 || %d != %d)", object,
@@ -2499,17 +2543,11 @@ static nserror llcache_fetch_notmodified(llcache_object *object,
 }
 
 /**
- * Process a chunk of fetched data
+ * Move an object into the data fetch state, if it is not there already
  *
  * \param object  Object being fetched
- * \param data	  Data to process
- * \param len	  Byte length of data
- * \return NSERROR_OK on success, appropriate error otherwise.
  */
-static nserror
-llcache_fetch_process_data(llcache_object *object,
-			   const uint8_t *data,
-			   size_t len)
+static void llcache_fetch_begin_data(llcache_object *object)
 {
 	if (object->fetch.state != LLCACHE_FETCH_DATA) {
 		/**
@@ -2544,6 +2582,22 @@ llcache_fetch_process_data(llcache_object *object,
 
 		object->fetch.state = LLCACHE_FETCH_DATA;
 	}
+}
+
+/**
+ * Process a chunk of fetched data
+ *
+ * \param object  Object being fetched
+ * \param data	  Data to process
+ * \param len	  Byte length of data
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+llcache_fetch_process_data(llcache_object *object,
+			   const uint8_t *data,
+			   size_t len)
+{
+	llcache_fetch_begin_data(object);
 
 	/* Resize source buffer if it's too small */
 	if (object->source_len + len >= object->source_alloc) {
@@ -2563,6 +2617,44 @@ llcache_fetch_process_data(llcache_object *object,
 	return NSERROR_OK;
 }
 
+/**
+ * Process a buffer holding an object's fetched data
+ *
+ * When the buffer holds the first data for the object its data is
+ * taken as the source buffer without copying, otherwise it is appended
+ * to the existing data.
+ *
+ * \param object  Object being fetched
+ * \param fbuf	  Buffer of the data, owned by the object on return
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+llcache_fetch_process_buffer(llcache_object *object,
+			     struct fetch_buffer *fbuf)
+{
+	nserror error;
+
+	if ((object->source_len != 0) || (object->source_buffer != NULL)) {
+		error = llcache_fetch_process_data(object,
+						   fbuf->buf,
+						   fbuf->len);
+		fbuf->release(fbuf);
+		return error;
+	}
+
+	llcache_fetch_begin_data(object);
+
+	free(object->source_data);
+
+	object->source_data = fbuf->buf;
+	object->source_len = fbuf->len;
+	object->source_alloc = fbuf->len;
+	object->source_buffer = fbuf;
+	fbuf->buf = NULL;
+
+	return NSERROR_OK;
+}
+
 
 /**
  * Handle an authentication request
@@ -3072,12 +3164,18 @@ static void llcache_fetch_callback(const fetch_msg *msg, void *p)
 
 	switch (msg->type) {
 	case FETCH_HEADER:
+	{
+		uint64_t trace = nstrace_begin();
+
 		/* Received a fetch header */
 		object->fetch.state = LLCACHE_FETCH_HEADERS;
 
 		error = llcache_fetch_process_header(object,
 				msg->data.header_or_data.buf,
 				msg->data.header_or_data.len);
+
+		nstrace_end("llcache", "header", trace);
+	}
 		break;
 
 	/* 3xx responses */
@@ -3101,10 +3199,22 @@ static void llcache_fetch_callback(const fetch_msg *msg, void *p)
 
 	/* Normal 2xx state machine */
 	case FETCH_DATA:
+	{
+		uint64_t trace = nstrace_begin();
+
 		/* Received some data */
 		error = llcache_fetch_process_data(object,
 				msg->data.header_or_data.buf,
 				msg->data.header_or_data.len);
+
+		nstrace_end("llcache", "data", trace);
+	}
+		break;
+
+	case FETCH_DATA_BUFFER:
+		/* Received all the data in a buffer */
+		error = llcache_fetch_process_buffer(object,
+				msg->data.buffer);
 		break;
 
 	case FETCH_FINISHED:
@@ -3400,7 +3510,7 @@ static nserror llcache_object_notify_users(llcache_object *object)
 			if (object->chain != NULL) {
 				event.type = LLCACHE_EVENT_GOT_CERTS;
 				event.data.chain = object->chain;
-				error = handle->cb(handle, &event, handle->pw);
+				error = llcache_handle_emit(handle, &event);
 			} else {
 				error = NSERROR_OK;
 			}
@@ -3438,7 +3548,7 @@ static nserror llcache_object_notify_users(llcache_object *object)
 			/* Emit HAD_HEADERS event */
 			event.type = LLCACHE_EVENT_HAD_HEADERS;
 
-			error = handle->cb(handle, &event, handle->pw);
+			error = llcache_handle_emit(handle, &event);
 
 			if (user->queued_for_delete) {
 				next_user = user->next;
@@ -3493,7 +3603,7 @@ static nserror llcache_object_notify_users(llcache_object *object)
 			}
 
 			/* Emit event */
-			error = handle->cb(handle, &event, handle->pw);
+			error = llcache_handle_emit(handle, &event);
 			if (user->queued_for_delete) {
 				next_user = user->next;
 				llcache_object_remove_user(object, user);
@@ -3527,7 +3637,7 @@ static nserror llcache_object_notify_users(llcache_object *object)
 			/* Emit DONE event */
 			event.type = LLCACHE_EVENT_DONE;
 
-			error = handle->cb(handle, &event, handle->pw);
+			error = llcache_handle_emit(handle, &event);
 			if (user->queued_for_delete) {
 				next_user = user->next;
 				llcache_object_remove_user(object, user);
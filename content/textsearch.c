@@ -26,18 +26,86 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <nsutils/time.h>
 
 #include "utils/errors.h"
 #include "utils/utils.h"
-#include "utils/ascii.h"
+#include "utils/log.h"
 #include "netsurf/types.h"
+#include "netsurf/misc.h"
 #include "desktop/selection.h"
+#include "desktop/gui_internal.h"
 
 #include "content/content.h"
 #include "content/content_protected.h"
 #include "content/hlcache.h"
 #include "content/textsearch.h"
 
+/**
+ * Time a find operation may run for before yielding, in ms
+ */
+#define TEXTSEARCH_SLICE 20
+
+/**
+ * Delay before a suspended find operation is resumed, in ms
+ */
+#define TEXTSEARCH_RESUME_DELAY 10
+
+/**
+ * Maximum number of first bytes the candidate filter searches for
+ */
+#define TEXTSEARCH_MAX_LEAD 4
+
+/**
+ * Maximum number of wildcard runs which may be backtracked into
+ */
+#define TEXTSEARCH_MAX_BACKTRACK 16
+
+/**
+ * compiled pattern element
+ */
+enum textsearch_token_type {
+	TEXTSEARCH_TOKEN_CHAR, /**< a (case folded) character */
+	TEXTSEARCH_TOKEN_ANY, /**< any single character ('#') */
+	TEXTSEARCH_TOKEN_RUN, /**< any number of characters ('*') */
+};
+
+/**
+ * compiled pattern token
+ */
+struct textsearch_token {
+	enum textsearch_token_type type;
+	uint32_t ucs4; /**< character for TEXTSEARCH_TOKEN_CHAR */
+};
+
+/**
+ * compiled search pattern
+ */
+struct textsearch_pattern {
+	/**
+	 * pattern tokens with leading and trailing runs removed
+	 */
+	struct textsearch_token *token;
+
+	/**
+	 * number of tokens
+	 */
+	unsigned int token_count;
+
+	/**
+	 * characters are compared after case folding
+	 */
+	bool fold;
+
+	/**
+	 * first bytes of the possible encodings of the initial character
+	 *
+	 * When zero every character is a candidate match start.
+	 */
+	unsigned int lead_count;
+	char lead[TEXTSEARCH_MAX_LEAD];
+};
+
 /**
  * search match
  */
@@ -109,9 +177,455 @@ struct textsearch_context {
 	char *string;
 	bool prev_case_sens;
 	bool newsearch;
+
+	/**
+	 * compiled form of string
+	 */
+	struct textsearch_pattern pattern;
+
+	/**
+	 * flags of the search in progress
+	 */
+	search_flags_t flags;
+
+	/**
+	 * content position the find operation resumes from
+	 */
+	void *position;
+
+	/**
+	 * find operation has yielded before completion
+	 */
+	bool suspended;
+
+	/**
+	 * monotonic time at which the find operation should yield
+	 */
+	uint64_t deadline;
+};
+
+
+/**
+ * Simple case folding ranges.
+ *
+ * Each entry maps the characters first to last onto the character
+ * delta away. A stride of two maps only every other character
+ * starting at first, as used by the alternating upper/lower case
+ * blocks.
+ */
+static const struct textsearch_fold_range {
+	uint32_t first;
+	uint32_t last;
+	int32_t delta;
+	uint8_t stride;
+} textsearch_fold_table[] = {
+	{ 0x0041, 0x005A, 32, 1 },
+	{ 0x00B5, 0x00B5, 775, 1 },
+	{ 0x00C0, 0x00D6, 32, 1 },
+	{ 0x00D8, 0x00DE, 32, 1 },
+	{ 0x0100, 0x012E, 1, 2 },
+	{ 0x0132, 0x0136, 1, 2 },
+	{ 0x0139, 0x0147, 1, 2 },
+	{ 0x014A, 0x0176, 1, 2 },
+	{ 0x0178, 0x0178, -121, 1 },
+	{ 0x0179, 0x017D, 1, 2 },
+	{ 0x017F, 0x017F, -268, 1 },
+	{ 0x01CD, 0x01DB, 1, 2 },
+	{ 0x01DE, 0x01EE, 1, 2 },
+	{ 0x01F8, 0x021E, 1, 2 },
+	{ 0x0222, 0x0232, 1, 2 },
+	{ 0x0246, 0x024E, 1, 2 },
+	{ 0x0386, 0x0386, 38, 1 },
+	{ 0x0388, 0x038A, 37, 1 },
+	{ 0x038C, 0x038C, 64, 1 },
+	{ 0x038E, 0x038F, 63, 1 },
+	{ 0x0391, 0x03A1, 32, 1 },
+	{ 0x03A3, 0x03AB, 32, 1 },
+	{ 0x03C2, 0x03C2, 1, 1 },
+	{ 0x03D8, 0x03EE, 1, 2 },
+	{ 0x0400, 0x040F, 80, 1 },
+	{ 0x0410, 0x042F, 32, 1 },
+	{ 0x0460, 0x0480, 1, 2 },
+	{ 0x048A, 0x04BE, 1, 2 },
+	{ 0x04C0, 0x04C0, 15, 1 },
+	{ 0x04C1, 0x04CD, 1, 2 },
+	{ 0x04D0, 0x052E, 1, 2 },
+	{ 0x0531, 0x0556, 48, 1 },
+	{ 0x10A0, 0x10C5, 7264, 1 },
+	{ 0x1E00, 0x1E94, 1, 2 },
+	{ 0x1E9E, 0x1E9E, -7615, 1 },
+	{ 0x1EA0, 0x1EFE, 1, 2 },
+	{ 0x2126, 0x2126, -7517, 1 },
+	{ 0x212A, 0x212A, -8383, 1 },
+	{ 0x212B, 0x212B, -8262, 1 },
+	{ 0x2160, 0x216F, 16, 1 },
+	{ 0x24B6, 0x24CF, 26, 1 },
+	{ 0x2C00, 0x2C2F, 48, 1 },
+	{ 0xFF21, 0xFF3A, 32, 1 },
+	{ 0x10400, 0x10427, 40, 1 },
 };
 
 
+/**
+ * Fold the case of a character
+ *
+ * \param ucs4 character to fold
+ * \return the folded character
+ */
+static uint32_t textsearch_fold(uint32_t ucs4)
+{
+	const struct textsearch_fold_range *range;
+	unsigned int lo = 0;
+	unsigned int hi = NOF_ELEMENTS(textsearch_fold_table);
+
+	if (ucs4 < 0x80) {
+		if (ucs4 >= 'A' && ucs4 <= 'Z') {
+			return ucs4 + 32;
+		}
+		return ucs4;
+	}
+
+	while (lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+
+		range = &textsearch_fold_table[mid];
+		if (ucs4 < range->first) {
+			hi = mid;
+		} else if (ucs4 > range->last) {
+			lo = mid + 1;
+		} else {
+			if ((ucs4 - range->first) % range->stride != 0) {
+				return ucs4;
+			}
+			return ucs4 + range->delta;
+		}
+	}
+
+	return ucs4;
+}
+
+
+/**
+ * Decode a character from UTF-8 text
+ *
+ * Invalid sequences decode as U+FFFD consuming a single byte.
+ *
+ * \param s text to decode from
+ * \param es end of text
+ * \param ucs4 receives the decoded character
+ * \return number of bytes consumed
+ */
+static inline size_t
+textsearch_decode(const char *s, const char *es, uint32_t *ucs4)
+{
+	const unsigned char *u = (const unsigned char *)s;
+	size_t avail = es - s;
+	size_t len;
+	uint32_t c;
+	size_t i;
+
+	if (u[0] < 0x80) {
+		*ucs4 = u[0];
+		return 1;
+	} else if ((u[0] & 0xE0) == 0xC0) {
+		len = 2;
+		c = u[0] & 0x1F;
+	} else if ((u[0] & 0xF0) == 0xE0) {
+		len = 3;
+		c = u[0] & 0x0F;
+	} else if ((u[0] & 0xF8) == 0xF0) {
+		len = 4;
+		c = u[0] & 0x07;
+	} else {
+		*ucs4 = 0xFFFD;
+		return 1;
+	}
+
+	if (len > avail) {
+		*ucs4 = 0xFFFD;
+		return 1;
+	}
+
+	for (i = 1; i < len; i++) {
+		if ((u[i] & 0xC0) != 0x80) {
+			*ucs4 = 0xFFFD;
+			return 1;
+		}
+		c = (c << 6) | (u[i] & 0x3F);
+	}
+
+	*ucs4 = c;
+	return len;
+}
+
+
+/**
+ * Add the first byte of a character's UTF-8 encoding to a pattern
+ *
+ * \param pattern pattern to add to
+ * \param ucs4 character
+ * \return true on success, false if there are too many first bytes
+ */
+static bool
+textsearch_add_lead(struct textsearch_pattern *pattern, uint32_t ucs4)
+{
+	char lead;
+	unsigned int idx;
+
+	if (ucs4 < 0x80) {
+		lead = ucs4;
+	} else if (ucs4 < 0x800) {
+		lead = 0xC0 | (ucs4 >> 6);
+	} else if (ucs4 < 0x10000) {
+		lead = 0xE0 | (ucs4 >> 12);
+	} else {
+		lead = 0xF0 | (ucs4 >> 18);
+	}
+
+	for (idx = 0; idx < pattern->lead_count; idx++) {
+		if (pattern->lead[idx] == lead) {
+			return true;
+		}
+	}
+
+	if (pattern->lead_count == TEXTSEARCH_MAX_LEAD) {
+		return false;
+	}
+
+	pattern->lead[pattern->lead_count++] = lead;
+	return true;
+}
+
+
+/**
+ * Compute the first bytes a match of a pattern may start with
+ *
+ * \param pattern pattern to update
+ */
+static void textsearch_pattern_leads(struct textsearch_pattern *pattern)
+{
+	uint32_t first = pattern->token[0].ucs4;
+	unsigned int idx;
+
+	pattern->lead_count = 0;
+
+	if (pattern->token[0].type != TEXTSEARCH_TOKEN_CHAR) {
+		return;
+	}
+
+	textsearch_add_lead(pattern, first);
+
+	if (!pattern->fold) {
+		return;
+	}
+
+	/* every character which folds to the first character */
+	for (idx = 0; idx < NOF_ELEMENTS(textsearch_fold_table); idx++) {
+		const struct textsearch_fold_range *range;
+		uint32_t ucs4;
+
+		range = &textsearch_fold_table[idx];
+		ucs4 = first - range->delta;
+		if (ucs4 < range->first ||
+		    ucs4 > range->last ||
+		    (ucs4 - range->first) % range->stride != 0) {
+			continue;
+		}
+
+		if (textsearch_add_lead(pattern, ucs4) == false) {
+			/* too many to filter on */
+			pattern->lead_count = 0;
+			return;
+		}
+	}
+}
+
+
+/**
+ * Compile a search string
+ *
+ * \param pattern pattern to compile into
+ * \param string search string
+ * \param string_len length of search string
+ * \param case_sens true if the search is case sensitive
+ * \return NSERROR_OK on success or NSERROR_NOMEM
+ */
+static nserror
+textsearch_pattern_compile(struct textsearch_pattern *pattern,
+			   const char *string,
+			   int string_len,
+			   bool case_sens)
+{
+	const char *s = string;
+	const char *es = string + string_len;
+	struct textsearch_token *token;
+	unsigned int count = 0;
+
+	token = malloc(sizeof(struct textsearch_token) * (string_len + 1));
+	if (token == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	while (s < es) {
+		uint32_t ucs4;
+
+		s += textsearch_decode(s, es, &ucs4);
+
+		if (ucs4 == '*') {
+			/* one run is the same as many and leading runs
+			 * are implied by the search
+			 */
+			if (count > 0 &&
+			    token[count - 1].type != TEXTSEARCH_TOKEN_RUN) {
+				token[count].type = TEXTSEARCH_TOKEN_RUN;
+				token[count].ucs4 = 0;
+				count++;
+			}
+		} else if (ucs4 == '#') {
+			token[count].type = TEXTSEARCH_TOKEN_ANY;
+			token[count].ucs4 = 0;
+			count++;
+		} else {
+			token[count].type = TEXTSEARCH_TOKEN_CHAR;
+			token[count].ucs4 = case_sens ? ucs4 :
+					textsearch_fold(ucs4);
+			count++;
+		}
+	}
+
+	/* a trailing run matches nothing */
+	if (count > 0 && token[count - 1].type == TEXTSEARCH_TOKEN_RUN) {
+		count--;
+	}
+
+	free(pattern->token);
+	pattern->token = token;
+	pattern->token_count = count;
+	pattern->fold = !case_sens;
+	pattern->lead_count = 0;
+
+	if (count > 0) {
+		textsearch_pattern_leads(pattern);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Find the next position a match may start at
+ *
+ * The first byte of every match is searched for with memchr() which
+ * the C library implements with vector instructions on most
+ * platforms.
+ *
+ * \param pattern compiled pattern
+ * \param s start of text to search
+ * \param es end of text
+ * \return candidate start position or NULL if there is none
+ */
+static const char *
+textsearch_candidate(const struct textsearch_pattern *pattern,
+		     const char *s,
+		     const char *es)
+{
+	const char *found = NULL;
+	unsigned int idx;
+
+	if (pattern->lead_count == 0) {
+		return s;
+	}
+
+	for (idx = 0; idx < pattern->lead_count; idx++) {
+		const char *pos;
+
+		pos = memchr(s, pattern->lead[idx],
+			     ((found != NULL) ? found : es) - s);
+		if (pos != NULL) {
+			found = pos;
+		}
+	}
+
+	return found;
+}
+
+
+/**
+ * Match a pattern at a position
+ *
+ * Wildcard runs match as few characters as possible.
+ *
+ * \param pattern compiled pattern
+ * \param s position to match at
+ * \param es end of text
+ * \return end of the match or NULL if the pattern does not match
+ */
+static const char *
+textsearch_match_at(const struct textsearch_pattern *pattern,
+		    const char *s,
+		    const char *es)
+{
+	struct {
+		unsigned int t;
+		const char *s;
+	} stack[TEXTSEARCH_MAX_BACKTRACK];
+	unsigned int top = 0;
+	unsigned int t = 0;
+
+	while (t < pattern->token_count) {
+		const struct textsearch_token *token = &pattern->token[t];
+		uint32_t ucs4;
+		size_t len;
+
+		if (token->type == TEXTSEARCH_TOKEN_RUN) {
+			/* initially match nothing, remember where to
+			 * extend the run from if the remainder fails
+			 */
+			if (top < NOF_ELEMENTS(stack)) {
+				stack[top].t = t;
+				stack[top].s = s;
+				top++;
+			}
+			t++;
+			continue;
+		}
+
+		if (s < es) {
+			len = textsearch_decode(s, es, &ucs4);
+			if (token->type == TEXTSEARCH_TOKEN_ANY) {
+				s += len;
+				t++;
+				continue;
+			}
+
+			if (pattern->fold) {
+				ucs4 = textsearch_fold(ucs4);
+			}
+			if (ucs4 == token->ucs4) {
+				s += len;
+				t++;
+				continue;
+			}
+		}
+
+		/* no match, extend the most recent run which can be */
+		while (top > 0 && stack[top - 1].s >= es) {
+			top--;
+		}
+		if (top == 0) {
+			return NULL;
+		}
+
+		stack[top - 1].s += textsearch_decode(stack[top - 1].s,
+						      es, &ucs4);
+		s = stack[top - 1].s;
+		t = stack[top - 1].t + 1;
+	}
+
+	return s;
+}
+
+
 /**
  * broadcast textsearch message
  */
@@ -192,6 +706,142 @@ static void search_show_all(bool all, struct textsearch_context *context)
 }
 
 
+/**
+ * Update the front end with the current match state
+ *
+ * \param context The search context.
+ * \param scroll true to scroll the current match into view
+ * \return NSERROR_OK on success else error code
+ */
+static nserror
+search_update(struct textsearch_context *context, bool scroll)
+{
+	struct rect bounds;
+	union content_msg_data msg_data;
+	nserror res;
+
+	/* update match state */
+	textsearch_broadcast(context,
+			     CONTENT_TEXTSEARCH_MATCH,
+			     (context->current != NULL),
+			     NULL);
+
+	search_show_all(((context->flags & SEARCH_FLAG_SHOWALL) != 0),
+			context);
+
+	/* update back state */
+	textsearch_broadcast(context,
+			     CONTENT_TEXTSEARCH_BACK,
+			     ((context->current != NULL) &&
+			      (context->current->prev != NULL)),
+			     NULL);
+
+	/* update forward state */
+	textsearch_broadcast(context,
+			     CONTENT_TEXTSEARCH_FORWARD,
+			     ((context->current != NULL) &&
+			      (context->current->next != NULL)),
+			     NULL);
+
+
+	if ((context->current == NULL) || (scroll == false)) {
+		/* no current match */
+		return NSERROR_OK;
+	}
+
+	/* call content match bounds handler */
+	res = context->c->handler->textsearch_bounds(context->c,
+					context->current->start_idx,
+					context->current->end_idx,
+					context->current->start_box,
+					context->current->end_box,
+					&bounds);
+	if (res == NSERROR_OK) {
+		msg_data.scroll.area = true;
+		msg_data.scroll.x0 = bounds.x0;
+		msg_data.scroll.y0 = bounds.y0;
+		msg_data.scroll.x1 = bounds.x1;
+		msg_data.scroll.y1 = bounds.y1;
+		content_broadcast(context->c, CONTENT_MSG_SCROLL, &msg_data);
+	}
+
+	return res;
+}
+
+
+static void textsearch_resume(void *p);
+
+/**
+ * Run the content find handler for a time slice
+ *
+ * Matches found during the slice are reported immediately. If the
+ * handler suspends the find operation it is resumed from a scheduled
+ * callback.
+ *
+ * \param context The search context.
+ * \return NSERROR_OK on success else error code
+ */
+static nserror textsearch_run(struct textsearch_context *context)
+{
+	bool first_match;
+	uint64_t now;
+	nserror res;
+
+	nsu_getmonotonic_ms(&now);
+	context->deadline = now + TEXTSEARCH_SLICE;
+	context->suspended = false;
+
+	/* call content find handler */
+	res = context->c->handler->textsearch_find(context->c, context);
+	if (res != NSERROR_OK) {
+		context->current = NULL;
+		context->position = NULL;
+		free_matches(context);
+
+		/* indicate find operation finished */
+		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, false, NULL);
+		return res;
+	}
+
+	/* new search, beginning at the top of the page */
+	first_match = (context->current == NULL) &&
+		(context->found->next != NULL);
+	if (first_match) {
+		context->current = context->found->next;
+	}
+
+	if (context->suspended) {
+		guit->misc->schedule(TEXTSEARCH_RESUME_DELAY,
+				     textsearch_resume,
+				     context);
+	} else {
+		context->position = NULL;
+
+		/* indicate find operation finished */
+		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, false, NULL);
+	}
+
+	return search_update(context, first_match);
+}
+
+
+/**
+ * Scheduled callback to resume a suspended find operation
+ *
+ * \param p The search context.
+ */
+static void textsearch_resume(void *p)
+{
+	struct textsearch_context *context = p;
+	nserror res;
+
+	res = textsearch_run(context);
+	if (res != NSERROR_OK) {
+		NSLOG(netsurf, INFO, "search resume failed: %d", res);
+	}
+}
+
+
 /**
  * Search for a string in a content.
  *
@@ -206,20 +856,19 @@ search_text(struct textsearch_context *context,
 	    int string_len,
 	    search_flags_t flags)
 {
-	struct rect bounds;
-	union content_msg_data msg_data;
-	bool case_sensitive, forwards, showall;
+	bool case_sensitive, forwards;
 	nserror res = NSERROR_OK;
 
 	case_sensitive = ((flags & SEARCH_FLAG_CASE_SENSITIVE) != 0) ?
 			true : false;
 	forwards = ((flags & SEARCH_FLAG_FORWARDS) != 0) ? true : false;
-	showall = ((flags & SEARCH_FLAG_SHOWALL) != 0) ? true : false;
 
 	if (context->c == NULL) {
 		return res;
 	}
 
+	context->flags = flags;
+
 	/* check if we need to start a new search or continue an old one */
 	if ((context->newsearch) ||
 	    (context->prev_case_sens != case_sensitive)) {
@@ -228,6 +877,10 @@ search_text(struct textsearch_context *context,
 			free(context->string);
 		}
 
+		/* abandon any find operation in progress */
+		guit->misc->schedule(-1, textsearch_resume, context);
+		context->position = NULL;
+
 		context->current = NULL;
 		free_matches(context);
 
@@ -237,32 +890,24 @@ search_text(struct textsearch_context *context,
 			context->string[string_len] = '\0';
 		}
 
-		/* indicate find operation starting */
-		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, true, NULL);
-
-
-		/* call content find handler */
-		res = context->c->handler->textsearch_find(context->c,
-							   context,
-							   string,
-							   string_len,
-							   case_sensitive);
-
-		/* indicate find operation finished */
-		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, false, NULL);
-
+		res = textsearch_pattern_compile(&context->pattern,
+						 string,
+						 string_len,
+						 case_sensitive);
 		if (res != NSERROR_OK) {
-			free_matches(context);
 			return res;
 		}
 
 		context->prev_case_sens = case_sensitive;
-
-		/* new search, beginning at the top of the page */
-		context->current = context->found->next;
 		context->newsearch = false;
 
-	} else if (context->current != NULL) {
+		/* indicate find operation starting */
+		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, true, NULL);
+
+		return textsearch_run(context);
+	}
+
+	if (context->current != NULL) {
 		/* continued search in the direction specified */
 		if (forwards) {
 			if (context->current->next)
@@ -273,51 +918,7 @@ search_text(struct textsearch_context *context,
 		}
 	}
 
-	/* update match state */
-	textsearch_broadcast(context,
-			     CONTENT_TEXTSEARCH_MATCH,
-			     (context->current != NULL),
-			     NULL);
-
-	search_show_all(showall, context);
-
-	/* update back state */
-	textsearch_broadcast(context,
-			     CONTENT_TEXTSEARCH_BACK,
-			     ((context->current != NULL) &&
-			      (context->current->prev != NULL)),
-			     NULL);
-
-	/* update forward state */
-	textsearch_broadcast(context,
-			     CONTENT_TEXTSEARCH_FORWARD,
-			     ((context->current != NULL) &&
-			      (context->current->next != NULL)),
-			     NULL);
-
-
-	if (context->current == NULL) {
-		/* no current match */
-		return res;
-	}
-
-	/* call content match bounds handler */
-	res = context->c->handler->textsearch_bounds(context->c,
-					context->current->start_idx,
-					context->current->end_idx,
-					context->current->start_box,
-					context->current->end_box,
-					&bounds);
-	if (res == NSERROR_OK) {
-		msg_data.scroll.area = true;
-		msg_data.scroll.x0 = bounds.x0;
-		msg_data.scroll.y0 = bounds.y0;
-		msg_data.scroll.x1 = bounds.x1;
-		msg_data.scroll.y1 = bounds.y1;
-		content_broadcast(context->c, CONTENT_MSG_SCROLL, &msg_data);
-	}
-
-	return res;
+	return search_update(context, true);
 }
 
 
@@ -358,6 +959,8 @@ content_textsearch_step(struct textsearch_context *textsearch,
 	} else {
 		union content_msg_data msg_data;
 
+		guit->misc->schedule(-1, textsearch_resume, textsearch);
+		textsearch->position = NULL;
 		free_matches(textsearch);
 
 		/* update match state */
@@ -463,6 +1066,14 @@ content_textsearch_create(struct content *c,
 	context->newsearch = true;
 	context->c = c;
 	context->gui_p = gui_data;
+	context->pattern.token = NULL;
+	context->pattern.token_count = 0;
+	context->pattern.fold = false;
+	context->pattern.lead_count = 0;
+	context->flags = 0;
+	context->position = NULL;
+	context->suspended = false;
+	context->deadline = 0;
 
 	*textsearch_out = context;
 
@@ -472,112 +1083,65 @@ content_textsearch_create(struct content *c,
 
 /* exported interface, documented in content/textsearch.h */
 const char *
-content_textsearch_find_pattern(const char *string,
-				int s_len,
-				const char *pattern,
-				int p_len,
-				bool case_sens,
-				unsigned int *m_len)
+content_textsearch_find_match(struct textsearch_context *context,
+			      const char *string,
+			      size_t s_len,
+			      unsigned int *m_len)
 {
-	struct { const char *ss, *s, *p; bool first; } context[16];
-	const char *ep = pattern + p_len;
-	const char *es = string  + s_len;
-	const char *p = pattern - 1;  /* a virtual '*' before the pattern */
-	const char *ss = string;
+	const struct textsearch_pattern *pattern = &context->pattern;
+	const char *es = string + s_len;
 	const char *s = string;
-	bool first = true;
-	int top = 0;
-
-	while (p < ep) {
-		bool matches;
-		if (p < pattern || *p == '*') {
-			char ch;
-
-			/* skip any further asterisks; one is the same as many
-			*/
-			do p++; while (p < ep && *p == '*');
-
-			/* if we're at the end of the pattern, yes, it matches
-			*/
-			if (p >= ep) break;
-
-			/* anything matches a # so continue matching from
-			   here, and stack a context that will try to match
-			   the wildcard against the next character */
-
-			ch = *p;
-			if (ch != '#') {
-				/* scan forwards until we find a match for
-				   this char */
-				if (!case_sens) ch = ascii_to_upper(ch);
-				while (s < es) {
-					if (case_sens) {
-						if (*s == ch) break;
-					} else if (ascii_to_upper(*s) == ch)
-						break;
-					s++;
-				}
-			}
 
-			if (s < es) {
-				/* remember where we are in case the match
-				   fails; we may then resume */
-				if (top < (int)NOF_ELEMENTS(context)) {
-					context[top].ss = ss;
-					context[top].s  = s + 1;
-					context[top].p  = p - 1;
-					/* ptr to last asterisk */
-					context[top].first = first;
-					top++;
-				}
-
-				if (first) {
-					ss = s;
-					/* remember first non-'*' char */
-					first = false;
-				}
-
-				matches = true;
-			} else {
-				matches = false;
-			}
+	if (pattern->token_count == 0) {
+		return NULL;
+	}
 
-		} else if (s < es) {
-			char ch = *p;
-			if (ch == '#')
-				matches = true;
-			else {
-				if (case_sens)
-					matches = (*s == ch);
-				else
-					matches = (ascii_to_upper(*s) == ascii_to_upper(ch));
-			}
-			if (matches && first) {
-				ss = s;  /* remember first non-'*' char */
-				first = false;
-			}
-		} else {
-			matches = false;
+	while (s < es) {
+		const char *match_end;
+		uint32_t ucs4;
+
+		s = textsearch_candidate(pattern, s, es);
+		if (s == NULL) {
+			break;
 		}
 
-		if (matches) {
-			p++; s++;
-		} else {
-			/* doesn't match,
-			 * resume with stacked context if we have one */
-			if (--top < 0)
-				return NULL;  /* no match, give up */
-
-			ss = context[top].ss;
-			s  = context[top].s;
-			p  = context[top].p;
-			first = context[top].first;
+		match_end = textsearch_match_at(pattern, s, es);
+		if (match_end != NULL) {
+			*m_len = match_end - s;
+			return s;
 		}
+
+		s += textsearch_decode(s, es, &ucs4);
 	}
 
-	/* end of pattern reached */
-	*m_len = max(s - ss, 1);
-	return ss;
+	return NULL;
+}
+
+
+/* exported interface, documented in content/textsearch.h */
+void *content_textsearch_position(struct textsearch_context *context)
+{
+	return context->position;
+}
+
+
+/* exported interface, documented in content/textsearch.h */
+bool content_textsearch_expired(struct textsearch_context *context)
+{
+	uint64_t now;
+
+	nsu_getmonotonic_ms(&now);
+
+	return now >= context->deadline;
+}
+
+
+/* exported interface, documented in content/textsearch.h */
+void
+content_textsearch_suspend(struct textsearch_context *context, void *position)
+{
+	context->position = position;
+	context->suspended = true;
 }
 
 
@@ -648,6 +1212,8 @@ nserror content_textsearch_destroy(struct textsearch_context *textsearch)
 {
 	assert(textsearch != NULL);
 
+	guit->misc->schedule(-1, textsearch_resume, textsearch);
+
 	if (textsearch->string != NULL) {
 		/* broadcast recent query string */
 		textsearch_broadcast(textsearch,
@@ -671,6 +1237,7 @@ nserror content_textsearch_destroy(struct textsearch_context *textsearch)
 			     NULL);
 
 	free_matches(textsearch);
+	free(textsearch->pattern.token);
 	free(textsearch);
 
 	return NSERROR_OK;
@@ -74,17 +74,50 @@ bool content_textsearch_ishighlighted(struct textsearch_context *textsearch,
 				      unsigned *end_idx);
 
 /**
- * Find the first occurrence of 'match' in 'string' and return its index
+ * Find the first match of the search pattern within a string
  *
- * \param  string     the string to be searched (unterminated)
+ * The pattern is compiled when the search starts so this may be
+ * called repeatedly by content find handlers.
+ *
+ * \param  context    The search context to match the pattern of
+ * \param  string     the UTF-8 string to be searched (unterminated)
  * \param  s_len      length of the string to be searched
- * \param  pattern    the pattern for which we are searching (unterminated)
- * \param  p_len      length of pattern
- * \param  case_sens  true iff case sensitive match required
  * \param  m_len      accepts length of match in bytes
  * \return pointer to first match, NULL if none
  */
-const char *content_textsearch_find_pattern(const char *string, int s_len, const char *pattern, int p_len, bool case_sens, unsigned int *m_len);
+const char *content_textsearch_find_match(struct textsearch_context *context, const char *string, size_t s_len, unsigned int *m_len);
+
+/**
+ * Get the position a find operation should resume from
+ *
+ * \param context The search context
+ * \return position passed to content_textsearch_suspend() or NULL to
+ *         start from the beginning of the content
+ */
+void *content_textsearch_position(struct textsearch_context *context);
+
+/**
+ * Determine if a find operation has used its time slice
+ *
+ * Content find handlers should check this periodically and suspend
+ * the find operation when it returns true.
+ *
+ * \param context The search context
+ * \return true if the find operation should be suspended
+ */
+bool content_textsearch_expired(struct textsearch_context *context);
+
+/**
+ * Suspend a find operation
+ *
+ * The content find handler will be called again later, once matches
+ * found so far have been reported, and may obtain the position with
+ * content_textsearch_position().
+ *
+ * \param context The search context
+ * \param position content specific position to resume from
+ */
+void content_textsearch_suspend(struct textsearch_context *context, void *position);
 
 /**
  * Add a new entry to the list of matches
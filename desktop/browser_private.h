@@ -160,6 +160,8 @@ struct browser_window {
 	bool throbbing;
 	/** Add loading_content to the window history when it loads. */
 	bool history_add;
+	/** Add current_content to the window history when it is done. */
+	bool history_pending;
 	/** Internal navigation, do not update URL etc */
 	bool internal_nav;
 
@@ -262,9 +264,15 @@ struct browser_window {
 	} selection;
 	bool can_edit;
 
+	/** Whether the frontend is not showing this window */
+	bool hidden;
+
 	/** current javascript context */
 	struct jsheap *jsheap;
 
+	/** Trace track the window's page loads are attributed to */
+	unsigned int trace_track;
+
 	/** cache of the currently displayed status text. */
 	struct {
 		char *text; /**< Current status bar text. */
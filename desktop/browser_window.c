@@ -36,6 +36,7 @@
 #include "utils/corestrings.h"
 #include "utils/messages.h"
 #include "utils/nsoption.h"
+#include "utils/trace.h"
 #include "netsurf/types.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/window.h"
@@ -817,40 +818,12 @@ static void browser_window_update(struct browser_window *bw, bool scroll_to_top)
 
 
 /**
- * handle message for content ready on browser window
+ * Add a browser window's new content to urldb and the window history.
+ *
+ * \param bw The browser window
  */
-static nserror browser_window_content_ready(struct browser_window *bw)
+static void browser_window_content_history(struct browser_window *bw)
 {
-	int width, height;
-	nserror res = NSERROR_OK;
-
-	/* close and release the current window content */
-	if (bw->current_content != NULL) {
-		content_close(bw->current_content);
-		hlcache_handle_release(bw->current_content);
-	}
-
-	bw->current_content = bw->loading_content;
-	bw->loading_content = NULL;
-
-	if (!bw->internal_nav) {
-		/* Transfer the fetch parameters */
-		browser_window__free_fetch_parameters(&bw->current_parameters);
-		bw->current_parameters = bw->loading_parameters;
-		memset(&bw->loading_parameters, 0, sizeof(bw->loading_parameters));
-		/* Transfer the certificate chain */
-		cert_chain_free(bw->current_cert_chain);
-		bw->current_cert_chain = bw->loading_cert_chain;
-		bw->loading_cert_chain = NULL;
-	}
-
-	/* Format the new content to the correct dimensions */
-	browser_window_get_dimensions(bw, &width, &height);
-	width /= bw->scale;
-	height /= bw->scale;
-	content_reformat(bw->current_content, false, width, height);
-
-	/* history */
 	if (bw->history_add && bw->history && !bw->internal_nav) {
 		nsurl *url = hlcache_handle_get_url(bw->current_content);
 
@@ -889,6 +862,48 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 		 */
 		browser_window_history_add(bw, bw->current_content, bw->frag_id);
 	}
+}
+
+
+/**
+ * handle message for content ready on browser window
+ */
+static nserror browser_window_content_ready(struct browser_window *bw)
+{
+	int width, height;
+	nserror res = NSERROR_OK;
+
+	/* close and release the current window content */
+	if (bw->current_content != NULL) {
+		content_close(bw->current_content);
+		hlcache_handle_release(bw->current_content);
+	}
+
+	bw->current_content = bw->loading_content;
+	bw->loading_content = NULL;
+
+	if (!bw->internal_nav) {
+		/* Transfer the fetch parameters */
+		browser_window__free_fetch_parameters(&bw->current_parameters);
+		bw->current_parameters = bw->loading_parameters;
+		memset(&bw->loading_parameters, 0, sizeof(bw->loading_parameters));
+		/* Transfer the certificate chain */
+		cert_chain_free(bw->current_cert_chain);
+		bw->current_cert_chain = bw->loading_cert_chain;
+		bw->loading_cert_chain = NULL;
+	}
+
+	/* Format the new content to the correct dimensions */
+	browser_window_get_dimensions(bw, &width, &height);
+	width /= bw->scale;
+	height /= bw->scale;
+	content_reformat(bw->current_content, false, width, height);
+
+	/* history, once the content is complete if it is partly loaded */
+	bw->history_pending = content_is_partial(bw->current_content);
+	if (bw->history_pending == false) {
+		browser_window_content_history(bw);
+	}
 
 	browser_window_remove_caret(bw, false);
 
@@ -944,6 +959,12 @@ browser_window_content_done(struct browser_window *bw)
 	browser_window_stop_throbber(bw);
 	browser_window_update_favicon(bw->current_content, bw, NULL);
 
+	if (bw->history_pending) {
+		/* The content was displayed before it had all loaded */
+		bw->history_pending = false;
+		browser_window_content_history(bw);
+	}
+
 	if (browser_window_history_get_scroll(bw, &sx, &sy) == NSERROR_OK) {
 		scrollx = (int)((float)content_get_width(bw->current_content) * sx);
 		scrolly = (int)((float)content_get_height(bw->current_content) * sy);
@@ -2590,6 +2611,8 @@ browser_window_redraw(struct browser_window *bw,
 	content_type content_type;
 	struct content_redraw_data data;
 	struct rect content_clip;
+	unsigned int track;
+	uint64_t trace;
 	nserror res;
 
 	if (bw == NULL) {
@@ -2614,7 +2637,7 @@ browser_window_redraw(struct browser_window *bw,
 		knockout_plot_start(ctx, &new_ctx);
 	}
 
-	new_ctx.plot->clip(ctx, clip);
+	new_ctx.plot->clip(&new_ctx, clip);
 
 	/* Handle redraw of any browser window children */
 	if (bw->children) {
@@ -2719,8 +2742,12 @@ browser_window_redraw(struct browser_window *bw,
 	}
 
 	/* Render the content */
+	track = nstrace_enter(bw->trace_track);
+	trace = nstrace_begin();
 	plot_ok &= content_redraw(bw->current_content, &data,
 				  &content_clip, &new_ctx);
+	nstrace_end("redraw", "redraw", trace);
+	nstrace_leave(track);
 
 	/* Back to full clip rect */
 	new_ctx.plot->clip(&new_ctx, clip);
@@ -3207,6 +3234,8 @@ browser_window_initialise_common(enum browser_window_create_flags flags,
 	/* window characteristics */
 	bw->refresh_interval = -1;
 
+	bw->trace_track = nstrace_new_track();
+
 	bw->drag.type = DRAGGING_NONE;
 
 	bw->scroll_x = NULL;
@@ -3511,6 +3540,7 @@ navigate_internal_real(struct browser_window *bw,
 	hlcache_child_context child;
 	nserror res;
 	hlcache_handle *c;
+	unsigned int track;
 
 	NSLOG(netsurf, INFO, "Loading '%s'", nsurl_access(params->url));
 
@@ -3546,6 +3576,8 @@ navigate_internal_real(struct browser_window *bw,
 		fetch_flags |= HLCACHE_RETRIEVE_MAY_DOWNLOAD;
 	}
 
+	/* attribute the fetch and everything it leads to this window */
+	track = nstrace_enter(bw->trace_track);
 	res = hlcache_handle_retrieve(params->url,
 				      fetch_flags | HLCACHE_RETRIEVE_SNIFF_TYPE,
 				      params->referrer,
@@ -3555,6 +3587,7 @@ navigate_internal_real(struct browser_window *bw,
 				      params->parent_charset != NULL ? &child : NULL,
 				      CONTENT_ANY,
 				      &c);
+	nstrace_leave(track);
 
 	switch (res) {
 	case NSERROR_OK:
@@ -3967,6 +4000,24 @@ bool browser_window_has_content(struct browser_window *bw)
 }
 
 
+/* Exported interface, documented in netsurf/browser_window.h */
+void browser_window_set_hidden(struct browser_window *bw, bool hidden)
+{
+	assert(bw != NULL);
+
+	bw->hidden = hidden;
+}
+
+
+/* Exported interface, documented in netsurf/browser_window.h */
+bool browser_window_is_hidden(struct browser_window *bw)
+{
+	assert(bw != NULL);
+
+	return browser_window_get_root(bw)->hidden;
+}
+
+
 /* Exported interface, documented in netsurf/browser_window.h */
 struct hlcache_handle *browser_window_get_content(struct browser_window *bw)
 {
@@ -4745,6 +4796,30 @@ int browser_window_get_cookie_count(
 	return count;
 }
 
+/* Exported interface, documented in browser_window.h */
+nserror browser_window_get_script_memory(
+		const struct browser_window *bw,
+		size_t *used,
+		size_t *limit)
+{
+	if (bw->jsheap == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	js_heap_memory(bw->jsheap, used, limit);
+
+	return NSERROR_OK;
+}
+
+/* Exported interface, documented in browser_window.h */
+nserror browser_window_export_trace(
+		const struct browser_window *bw,
+		const char *path,
+		unsigned int *count)
+{
+	return nstrace_write_file(path, bw->trace_track, count);
+}
+
 /* Exported interface, documented in browser_window.h */
 nserror browser_window_show_cookies(
 		const struct browser_window *bw)
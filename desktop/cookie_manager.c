@@ -752,6 +752,9 @@ static nserror cookie_manager_tree_node_folder_cb(
 
 	case TREE_MSG_NODE_LAUNCH:
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		break;
 	}
 
 	return NSERROR_OK;
@@ -775,6 +778,9 @@ static nserror cookie_manager_tree_node_entry_cb(
 
 	case TREE_MSG_NODE_LAUNCH:
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		break;
 	}
 	return NSERROR_OK;
 }
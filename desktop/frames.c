@@ -254,6 +254,7 @@ nserror browser_window_create_iframes(struct browser_window *bw)
 		/* linking */
 		window->box = cur->box;
 		window->parent = bw;
+		window->trace_track = bw->trace_track;
 		window->box->iframe = window;
 
 		/* iframe dimensions */
@@ -628,6 +629,7 @@ browser_window_create_frameset_internal(struct browser_window *bw,
 
 			/* linking */
 			window->parent = bw;
+			window->trace_track = bw->trace_track;
 
 			if (window->name)
 				NSLOG(netsurf, INFO, "Created frame '%s'",
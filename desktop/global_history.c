@@ -62,6 +62,7 @@ enum global_history_fields {
 struct global_history_folder {
 	treeview_node *folder;
 	struct treeview_field_data data;
+	bool populated; /**< Whether the folder's entry nodes exist */
 };
 
 struct global_history_ctx {
@@ -188,6 +189,10 @@ static nserror global_history_create_dir(enum global_history_folders f)
 		}
 	}
 
+	/* Folders made while loading the history get their entries when
+	 * they are first needed, later folders are only made to hold a
+	 * new entry. */
+	gh_ctx.folders[f].populated = gh_ctx.built;
 	gh_ctx.folders[f].data.field = gh_ctx.fields[N_FIELDS - 1].field;
 	gh_ctx.folders[f].data.value = label;
 	gh_ctx.folders[f].data.value_len = strlen(label);
@@ -198,40 +203,55 @@ static nserror global_history_create_dir(enum global_history_folders f)
 			&gh_ctx.folders[f],
 			gh_ctx.built ? TREE_OPTION_NONE :
 					TREE_OPTION_SUPPRESS_RESIZE |
-					TREE_OPTION_SUPPRESS_REDRAW);
+					TREE_OPTION_SUPPRESS_REDRAW |
+					TREE_OPTION_LAZY);
 
 	return err;
 }
 
 
 /**
- * Get the treeview folder for history entires in a particular slot
+ * Get the folder which holds history entries in a particular slot
  *
- * \param parent	Updated to parent folder.
- * \param slot		Global history slot of entry we want folder node for
- * \return NSERROR_OK on success, appropriate error otherwise
+ * \param slot		Global history slot
+ * \return folder ident, or GH_N_FOLDERS if slot is invalid
  */
-static inline nserror global_history_get_parent_treeview_node(
-		treeview_node **parent, int slot)
+static inline enum global_history_folders global_history_slot_folder(int slot)
 {
-	int folder_index;
-	struct global_history_folder *f;
-	nserror err;
-
 	if (slot < 7) {
-		folder_index = slot;
+		return slot;
 
 	} else if (slot < 14) {
-		folder_index = GH_LAST_WEEK;
+		return GH_LAST_WEEK;
 
 	} else if (slot < 21) {
-		folder_index = GH_2_WEEKS_AGO;
+		return GH_2_WEEKS_AGO;
 
 	} else if (slot < N_DAYS) {
-		folder_index = GH_3_WEEKS_AGO;
+		return GH_3_WEEKS_AGO;
+	}
 
-	} else {
-		/* Slot value is invalid */
+	/* Slot value is invalid */
+	return GH_N_FOLDERS;
+}
+
+
+/**
+ * Get the treeview folder for history entires in a particular slot
+ *
+ * \param parent	Updated to parent folder.
+ * \param slot		Global history slot of entry we want folder node for
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static inline nserror global_history_get_parent_treeview_node(
+		struct global_history_folder **parent, int slot)
+{
+	enum global_history_folders folder_index;
+	struct global_history_folder *f;
+	nserror err;
+
+	folder_index = global_history_slot_folder(slot);
+	if (folder_index == GH_N_FOLDERS) {
 		return NSERROR_BAD_PARAMETER;
 	}
 
@@ -246,8 +266,8 @@ static inline nserror global_history_get_parent_treeview_node(
 		}
 	}
 
-	/* Return the parent treeview folder */
-	*parent = f->folder;
+	/* Return the parent folder */
+	*parent = f;
 	return NSERROR_OK;
 }
 
@@ -320,14 +340,19 @@ static nserror global_history_entry_insert(struct global_history_entry *e,
 {
 	nserror err;
 
-	treeview_node *parent;
+	struct global_history_folder *parent;
 	err = global_history_get_parent_treeview_node(&parent, slot);
 	if (err != NSERROR_OK) {
 		return err;
 	}
 
+	if (parent->populated == false) {
+		/* Node is created when the folder is populated */
+		return NSERROR_OK;
+	}
+
 	err = treeview_create_node_entry(gh_ctx.tree, &(e->entry),
-			parent, TREE_REL_FIRST_CHILD, e->data, e,
+			parent->folder, TREE_REL_FIRST_CHILD, e->data, e,
 			gh_ctx.built ? TREE_OPTION_NONE :
 					TREE_OPTION_SUPPRESS_RESIZE |
 					TREE_OPTION_SUPPRESS_REDRAW);
@@ -501,10 +526,13 @@ static bool global_history_add_entry(nsurl *url,
 
 		/* Delete any existing entry for this URL */
 		e = global_history_find(url);
-		if (e != NULL) {
+		if (e != NULL && e->entry != NULL) {
 			treeview_delete_node(gh_ctx.tree, e->entry,
 					TREE_OPTION_SUPPRESS_REDRAW |
 					TREE_OPTION_SUPPRESS_RESIZE);
+		} else if (e != NULL) {
+			/* Entry has no node yet */
+			global_history_delete_entry_internal(e);
 		}
 	}
 
@@ -622,20 +650,30 @@ static nserror global_history_initialise_time(void)
 
 
 /**
- * Initialise the treeview entries
+ * Create the treeview entry nodes for a folder
  *
+ * \param f		Ident for folder to populate
  * \return NSERROR_OK on success, or appropriate error otherwise
  */
-static nserror global_history_init_entries(void)
+static nserror global_history_populate_folder(enum global_history_folders f)
 {
+	struct global_history_folder *folder = &gh_ctx.folders[f];
 	int i;
 	nserror err;
 
-	/* Itterate over all global history data, inserting it into treeview */
+	if (folder->populated) {
+		return NSERROR_OK;
+	}
+	folder->populated = true;
+
 	for (i = 0; i < N_DAYS; i++) {
 		struct global_history_entry *l = NULL;
 		struct global_history_entry *e = gh_list[i];
 
+		if (global_history_slot_folder(i) != f) {
+			continue;
+		}
+
 		/* Insert in reverse order; find last */
 		while (e != NULL) {
 			l = e;
@@ -644,7 +682,11 @@ static nserror global_history_init_entries(void)
 
 		/* Insert the entries into the treeview */
 		while (l != NULL) {
-			err = global_history_entry_insert(l, i);
+			err = treeview_create_node_entry(gh_ctx.tree,
+					&(l->entry), folder->folder,
+					TREE_REL_FIRST_CHILD, l->data, l,
+					TREE_OPTION_SUPPRESS_RESIZE |
+					TREE_OPTION_SUPPRESS_REDRAW);
 			if (err != NSERROR_OK) {
 				return err;
 			}
@@ -656,14 +698,76 @@ static nserror global_history_init_entries(void)
 }
 
 
+/**
+ * Delete the entries of a folder which was never populated
+ *
+ * \param f		Ident for folder being deleted
+ * \param user		Whether the deletion is by user interaction
+ */
+static void global_history_delete_folder_entries(
+		enum global_history_folders f, bool user)
+{
+	int i;
+
+	for (i = 0; i < N_DAYS; i++) {
+		if (global_history_slot_folder(i) != f) {
+			continue;
+		}
+
+		while (gh_list[i] != NULL) {
+			gh_list[i]->user_delete = user;
+			global_history_delete_entry_internal(gh_list[i]);
+		}
+	}
+}
+
+
+/**
+ * Initialise the treeview folders
+ *
+ * Entry nodes are not created until a folder is populated.
+ *
+ * \return NSERROR_OK on success, or appropriate error otherwise
+ */
+static nserror global_history_init_entries(void)
+{
+	int i;
+	nserror err;
+
+	/* Make a folder for every slot with some history */
+	for (i = 0; i < N_DAYS; i++) {
+		struct global_history_folder *parent;
+
+		if (gh_list[i] == NULL) {
+			continue;
+		}
+
+		err = global_history_get_parent_treeview_node(&parent, i);
+		if (err != NSERROR_OK) {
+			return err;
+		}
+	}
+
+	return NSERROR_OK;
+}
+
+
 static nserror global_history_tree_node_folder_cb(
 		struct treeview_node_msg msg, void *data)
 {
 	struct global_history_folder *f = data;
+	nserror ret = NSERROR_OK;
 
 	switch (msg.msg) {
 	case TREE_MSG_NODE_DELETE:
+		if (f->populated == false) {
+			/* Entries without nodes go with their folder */
+			global_history_delete_folder_entries(
+					f - gh_ctx.folders,
+					msg.data.delete.user);
+		}
 		f->folder = NULL;
+		f->populated = false;
 		break;
 
 	case TREE_MSG_NODE_EDIT:
@@ -671,9 +775,13 @@ static nserror global_history_tree_node_folder_cb(
 
 	case TREE_MSG_NODE_LAUNCH:
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		ret = global_history_populate_folder(f - gh_ctx.folders);
+		break;
 	}
 
-	return NSERROR_OK;
+	return ret;
 }
 
 static nserror
@@ -711,6 +819,9 @@ global_history_tree_node_entry_cb(struct treeview_node_msg msg, void *data)
 				existing, NULL);
 	}
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		break;
 	}
 	return ret;
 }
@@ -912,6 +1023,7 @@ nserror global_history_export(const char *path, const char *title)
 	struct treeview_export_walk_ctx tw;
 	nserror err;
 	FILE *fp;
+	int f;
 
 	fp = fopen(path, "w");
 	if (fp == NULL)
@@ -929,6 +1041,17 @@ nserror global_history_export(const char *path, const char *title)
 	fprintf(fp, "<title>%s</title>\n", title);
 	fputs("</head>\n<body>\n<ul>\n", fp);
 
+	/* Export needs every entry node */
+	for (f = 0; f < GH_N_FOLDERS; f++) {
+		if (gh_ctx.folders[f].folder != NULL) {
+			err = global_history_populate_folder(f);
+			if (err != NSERROR_OK) {
+				fclose(fp);
+				return err;
+			}
+		}
+	}
+
 	tw.fp = fp;
 	err = treeview_walk(gh_ctx.tree, NULL,
 			global_history_export_enter_cb,
@@ -526,6 +526,9 @@ static nserror hotlist_tree_node_folder_cb(
 
 	case TREE_MSG_NODE_LAUNCH:
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		break;
 	}
 
 	return NSERROR_OK;
@@ -617,6 +620,9 @@ hotlist_tree_node_entry_cb(struct treeview_node_msg msg, void *data)
 				existing, NULL);
 	}
 		break;
+
+	case TREE_MSG_NODE_POPULATE:
+		break;
 	}
 	return err;
 }
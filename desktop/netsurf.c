@@ -36,6 +36,7 @@
 #include "utils/string.h"
 #include "utils/utf8.h"
 #include "utils/messages.h"
+#include "utils/trace.h"
 #include "utils/useragent.h"
 #include "content/content_factory.h"
 #include "content/fetchers.h"
@@ -97,6 +98,9 @@
 /** default time quantum with which to calculate bandwidth (ms) */
 #define LLCACHE_STORE_TIME_QUANTUM (100)
 
+/** number of page load trace spans kept when tracing is enabled */
+#define NETSURF_TRACE_EVENTS (64 * 1024)
+
 static void netsurf_lwc_iterator(lwc_string *str, void *pw)
 {
 	NSLOG(netsurf, WARNING, "[%3"PRIu32"] %.*s", str->refcnt,
@@ -160,6 +164,12 @@ nserror netsurf_init(const char *store_path)
 	/* image cache hysteresis is 20% of the image cache size */
 	image_cache_parameters.hysteresis = image_cache_parameters.limit / 5;
 
+	/* decoded animation frames may use half the image cache */
+	if (nsoption_bool(animation_frame_cache)) {
+		image_cache_parameters.frame_limit =
+			image_cache_parameters.limit / 2;
+	}
+
 	/* account for image cache use from total */
 	hlcache_parameters.llcache.limit -= image_cache_parameters.limit;
 
@@ -175,6 +185,14 @@ nserror netsurf_init(const char *store_path)
 		nsoption_charp(disc_cache_path) :
 		store_path;
 
+	/* page load tracing */
+	if (nsoption_bool(trace_enable) ||
+	    nsoption_charp(trace_file) != NULL) {
+		ret = nstrace_init(NETSURF_TRACE_EVENTS);
+		if (ret != NSERROR_OK)
+			return ret;
+	}
+
 	/* image handler bitmap cache */
 	ret = image_cache_init(&image_cache_parameters);
 	if (ret != NSERROR_OK)
@@ -253,6 +271,16 @@ void netsurf_exit(void)
 	/* Now the fetchers are done, our user-agent string can go */
 	free_user_agent_string();
 
+	if (nsoption_charp(trace_file) != NULL) {
+		unsigned int count = 0;
+		nserror res;
+
+		res = nstrace_write_file(nsoption_charp(trace_file), 0, &count);
+		NSLOG(netsurf, INFO, "Wrote %u trace spans to %s: %d",
+		      count, nsoption_charp(trace_file), res);
+	}
+	nstrace_fini();
+
 	/* dump any remaining cache entries */
 	image_cache_fini();
 
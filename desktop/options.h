@@ -123,6 +123,9 @@ NSOPTION_BOOL(background_images, true)
 /** Whether to animate images */
 NSOPTION_BOOL(animate_images, true)
 
+/** Whether to cache decoded animation frames */
+NSOPTION_BOOL(animation_frame_cache, true)
+
 /** Whether to execute javascript */
 NSOPTION_BOOL(enable_javascript, false)
 
@@ -132,6 +135,12 @@ NSOPTION_BOOL(author_level_css, true)
 /** Maximum time (in seconds) to wait for a script to run */
 NSOPTION_INTEGER(script_timeout, 10)
 
+/** Whether to pool small javascript heap allocations */
+NSOPTION_BOOL(js_pool_allocator, true)
+
+/** Maximum memory (in bytes) a javascript heap may use, 0 for no limit */
+NSOPTION_UINT(js_heap_limit, 0)
+
 /** How many days to retain URL data for */
 NSOPTION_INTEGER(expire_url, 28)
 
@@ -180,12 +189,16 @@ NSOPTION_INTEGER(toolbar_status_size, 6667)
 /** default window scale */
 NSOPTION_INTEGER(scale, 100)
 
-/* Whether to reflow web pages while objects are fetching */
+/* Whether to display and reflow web pages while they and their objects are
+ * fetching */
 NSOPTION_BOOL(incremental_reflow, true)
 
 /* Minimum time (in cs) between HTML reflows while objects are fetching */
 NSOPTION_UINT(min_reflow_period, DEFAULT_REFLOW_PERIOD)
 
+/* Time (in ms) HTML box construction runs for before yielding */
+NSOPTION_UINT(box_construct_slice, 6)
+
 /* use core selection menu */
 NSOPTION_BOOL(core_select_menu, false)
 
@@ -294,3 +307,8 @@ NSOPTION_COLOUR(sys_colour_VisitedText, 0x008b1a55)
 NSOPTION_STRING(log_filter, NETSURF_BUILTIN_LOG_FILTER)
 /** Filter for verbose logging */
 NSOPTION_STRING(verbose_filter, NETSURF_BUILTIN_VERBOSE_FILTER)
+
+/** Record page load trace spans */
+NSOPTION_BOOL(trace_enable, false)
+/** File to write all recorded trace spans to on exit, or NULL */
+NSOPTION_STRING(trace_file, NULL)
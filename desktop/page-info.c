@@ -28,6 +28,7 @@
 
 #include "utils/nsurl.h"
 #include "utils/nscolour.h"
+#include "utils/string.h"
 
 #include "netsurf/mouse.h"
 #include "netsurf/layout.h"
@@ -164,6 +165,7 @@ enum pi_entry {
 	PI_ENTRY_DOMAIN,
 	PI_ENTRY_CERT,
 	PI_ENTRY_COOKIES,
+	PI_ENTRY_SCRIPT,
 	PI_ENTRY__COUNT,
 };
 
@@ -230,6 +232,20 @@ struct page_info_entry pi__entries[PI_ENTRY__COUNT] = {
 			},
 		},
 	},
+	[PI_ENTRY_SCRIPT] = {
+		.type = PAGE_INFO_ENTRY_TYPE_ITEM,
+		.u = {
+			.item = {
+				.item = {
+					.style = &pi__item,
+				},
+				.detail = {
+					.style = &pi__item_detail,
+				},
+				.hover_bg = &pi__hover,
+			},
+		},
+	},
 };
 
 /**
@@ -244,8 +260,12 @@ struct page_info {
 
 	browser_window_page_info_state state;
 	unsigned cookies;
+	bool script;
+	size_t script_used;
+	size_t script_limit;
 
 	char cookie_text[64];
+	char script_text[64];
 	struct page_info_entry entries[PI_ENTRY__COUNT];
 
 	int width;
@@ -427,6 +447,25 @@ static nserror page_info__set_text(
 	pi->entries[PI_ENTRY_COOKIES].u.item.item.text = "Cookies: ";
 	pi->entries[PI_ENTRY_COOKIES].u.item.detail.text = pi->cookie_text;
 
+	if (pi->script_limit != 0) {
+		printed = snprintf(pi->script_text, sizeof(pi->script_text),
+				"(%s of %s)",
+				human_friendly_bytesize(pi->script_used),
+				human_friendly_bytesize(pi->script_limit));
+	} else {
+		printed = snprintf(pi->script_text, sizeof(pi->script_text),
+				"(%s in use)",
+				human_friendly_bytesize(pi->script_used));
+	}
+	if (printed < 0) {
+		return NSERROR_UNKNOWN;
+
+	} else if ((unsigned) printed >= sizeof(pi->script_text)) {
+		return NSERROR_NOSPACE;
+	}
+	pi->entries[PI_ENTRY_SCRIPT].u.item.item.text = "Script memory: ";
+	pi->entries[PI_ENTRY_SCRIPT].u.item.detail.text = pi->script_text;
+
 	return page_info__measure_text(pi);
 }
 
@@ -446,6 +485,8 @@ static nserror page_info__create_from_bw(
 	pi->bw = bw;
 	pi->state = browser_window_get_page_info_state(bw);
 	pi->cookies = browser_window_get_cookie_count(bw);
+	pi->script = (browser_window_get_script_memory(bw,
+			&pi->script_used, &pi->script_limit) == NSERROR_OK);
 	pi->domain = nsurl_get_component(url, NSURL_HOST);
 	pi->scheme = nsurl_get_scheme_type(url);
 
@@ -455,14 +496,16 @@ static nserror page_info__create_from_bw(
 /**
  * Check whether an entry is relevant.
  *
- * \param[in] entry   The page info entry to consider.
- * \param[in] scheme  URL scheme that the page info is for.
+ * \param[in] pi     The page info window handle.
+ * \param[in] entry  The page info entry to consider.
  * \return true if the entry should be hidden, otherwise false.
  */
 static inline bool page_info__hide_entry(
-		enum pi_entry entry,
-		enum nsurl_scheme_type scheme)
+		const struct page_info *pi,
+		enum pi_entry entry)
 {
+	enum nsurl_scheme_type scheme = pi->scheme;
+
 	switch (entry) {
 	case PI_ENTRY_CERT:
 		if (scheme != NSURL_SCHEME_HTTPS) {
@@ -475,6 +518,11 @@ static inline bool page_info__hide_entry(
 			return true;
 		}
 		break;
+	case PI_ENTRY_SCRIPT:
+		if (!pi->script) {
+			return true;
+		}
+		break;
 	default:
 		break;
 	}
@@ -498,7 +546,7 @@ static nserror page_info__layout(
 	for (unsigned i = 0; i < PI_ENTRY__COUNT; i++) {
 		struct page_info_entry *entry = pi->entries + i;
 
-		if (page_info__hide_entry(i, pi->scheme)) {
+		if (page_info__hide_entry(pi, i)) {
 			continue;
 		}
 
@@ -647,7 +695,7 @@ nserror page_info_redraw(
 		const struct page_info_entry *entry = pi->entries + i;
 		int cur_x = x + pi->window_padding;
 
-		if (page_info__hide_entry(i, pi->scheme)) {
+		if (page_info__hide_entry(pi, i)) {
 			continue;
 		}
 
@@ -762,7 +810,7 @@ nserror page_info_mouse_action(
 		bool hovering = false;
 		int height;
 
-		if (page_info__hide_entry(i, pi->scheme)) {
+		if (page_info__hide_entry(pi, i)) {
 			continue;
 		}
 
@@ -0,0 +1,1274 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Plot display list implementation.
+ *
+ * Plot operations are recorded into a growable array of entries with
+ * variable length data (text, polygon points and path elements) copied
+ * into a separate data buffer. Each entry carries the clip rectangle in
+ * force when it was plotted, so clip operations are only replayed when
+ * the clip actually changes.
+ *
+ * While recording, a solid rectangle fill which continues the previous
+ * one is merged with it, as is a text run which continues the previous
+ * run in the same style.
+ *
+ * When recording finishes the list is walked backwards keeping a small
+ * set of opaque areas (solid fills and opaque bitmaps). Any entry whose
+ * bounds lie entirely within one of the opaque areas plotted after it
+ * can not be seen and is removed.
+ *
+ * A frontend may supply an extension which records text as its own
+ * entries, for example glyphs it has already rasterised, so the list
+ * can be replayed where the text could not be plotted.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/utils.h"
+#include "utils/log.h"
+#include "utils/errors.h"
+#include "netsurf/inttypes.h"
+#include "netsurf/types.h"
+#include "netsurf/bitmap.h"
+#include "netsurf/layout.h"
+#include "netsurf/plotters.h"
+
+#include "desktop/gui_internal.h"
+#include "desktop/plot_list.h"
+
+/** Number of entries to grow the list by */
+#define PLOT_LIST_ENTRY_CHUNK 256
+
+/** Number of bytes to grow the data buffer by */
+#define PLOT_LIST_DATA_CHUNK 4096
+
+/** Number of opaque areas considered when culling */
+#define PLOT_LIST_OCCLUDERS 32
+
+/** Alignment of variable length data */
+#define PLOT_LIST_DATA_ALIGN 8
+
+/** Offset used for a group with no name */
+#define PLOT_LIST_NO_DATA ((size_t)-1)
+
+typedef enum {
+	PLOT_LIST_ARC,
+	PLOT_LIST_DISC,
+	PLOT_LIST_LINE,
+	PLOT_LIST_RECTANGLE,
+	PLOT_LIST_POLYGON,
+	PLOT_LIST_PATH,
+	PLOT_LIST_BITMAP,
+	PLOT_LIST_TEXT,
+	PLOT_LIST_GROUP_START,
+	PLOT_LIST_GROUP_END,
+	PLOT_LIST_EXT,
+} plot_list_op;
+
+/**
+ * recorded plot operation
+ */
+struct plot_list_entry {
+	plot_list_op op;
+	bool culled; /**< entry is hidden and is not replayed */
+	bool opaque; /**< bounds are completely covered by the plot */
+	bool clip_sensitive; /**< rasterisation depends on the clip */
+	struct rect clip; /**< clip rectangle in force */
+	struct rect bounds; /**< area plotted within clip */
+	union {
+		struct {
+			plot_style_t style;
+			int x;
+			int y;
+			int radius;
+			int angle1;
+			int angle2;
+		} arc; /* also used for disc */
+		struct {
+			plot_style_t style;
+			struct rect r;
+		} rect; /* also used for line */
+		struct {
+			plot_style_t style;
+			size_t data;
+			unsigned int n;
+			float transform[6];
+		} path; /* also used for polygon */
+		struct {
+			struct bitmap *bitmap;
+			int x;
+			int y;
+			int width;
+			int height;
+			colour bg;
+			bitmap_flags_t flags;
+		} bitmap;
+		struct {
+			plot_font_style_t style;
+			int x;
+			int y;
+			size_t data;
+			size_t length;
+		} text;
+		struct {
+			size_t data;
+		} group; /* also used for frontend entries */
+	} u;
+};
+
+/**
+ * plot display list
+ */
+struct plot_list {
+	struct plot_list_entry *entry; /**< recorded entries */
+	unsigned int entry_count; /**< number of recorded entries */
+	unsigned int entry_alloc; /**< size of entry array */
+
+	char *data; /**< variable length data */
+	size_t data_used; /**< bytes of data used */
+	size_t data_alloc; /**< size of data buffer */
+
+	struct rect clip; /**< current clip rectangle */
+	bool clipped; /**< a clip rectangle has been recorded */
+	nserror res; /**< first error while recording */
+
+	const struct plot_list_ext *ext; /**< frontend extension */
+};
+
+
+/**
+ * intersect two rectangles
+ *
+ * \param a first rectangle
+ * \param b second rectangle
+ * \param out receives the intersection
+ * \return true if the intersection is not empty
+ */
+static inline bool
+plot_list_intersect(const struct rect *a, const struct rect *b, struct rect *out)
+{
+	out->x0 = max(a->x0, b->x0);
+	out->y0 = max(a->y0, b->y0);
+	out->x1 = min(a->x1, b->x1);
+	out->y1 = min(a->y1, b->y1);
+
+	return (out->x0 < out->x1) && (out->y0 < out->y1);
+}
+
+
+/**
+ * determine if one rectangle contains another
+ *
+ * \param outer containing rectangle
+ * \param inner contained rectangle
+ * \return true if inner is entirely within outer
+ */
+static inline bool
+plot_list_contains(const struct rect *outer, const struct rect *inner)
+{
+	return (inner->x0 >= outer->x0) && (inner->y0 >= outer->y0) &&
+		(inner->x1 <= outer->x1) && (inner->y1 <= outer->y1);
+}
+
+
+/**
+ * get the recording display list from a redraw context
+ */
+static inline struct plot_list *
+plot_list_from_ctx(const struct redraw_context *ctx)
+{
+	return ctx->priv;
+}
+
+
+/**
+ * add an entry to the list
+ *
+ * The bounds are limited to the current clip and entries which are
+ * entirely clipped are not added.
+ *
+ * \param list display list being recorded
+ * \param op operation being added
+ * \param bounds area affected by the operation or NULL if unknown
+ * \return new entry or NULL if it was not added
+ */
+static struct plot_list_entry *
+plot_list_add(struct plot_list *list,
+	      plot_list_op op,
+	      const struct rect *bounds)
+{
+	struct plot_list_entry *entry;
+	struct rect visible = list->clip;
+
+	if ((bounds != NULL) &&
+	    !plot_list_intersect(bounds, &list->clip, &visible)) {
+		return NULL;
+	}
+
+	if (list->entry_count == list->entry_alloc) {
+		unsigned int alloc = list->entry_alloc + PLOT_LIST_ENTRY_CHUNK;
+
+		entry = realloc(list->entry, alloc * sizeof(*entry));
+		if (entry == NULL) {
+			if (list->res == NSERROR_OK) {
+				list->res = NSERROR_NOMEM;
+			}
+			return NULL;
+		}
+		list->entry = entry;
+		list->entry_alloc = alloc;
+	}
+
+	entry = &list->entry[list->entry_count++];
+	entry->op = op;
+	entry->culled = false;
+	entry->opaque = false;
+	entry->clip_sensitive = false;
+	entry->clip = list->clip;
+	entry->bounds = visible;
+
+	return entry;
+}
+
+
+/**
+ * reserve space for variable length data in the list
+ *
+ * \param list display list being recorded
+ * \param len length of data
+ * \param offset receives offset of the reserved space
+ * \return the reserved space or NULL on failure
+ */
+static char *
+plot_list_reserve_data(struct plot_list *list, size_t len, size_t *offset)
+{
+	size_t start;
+
+	start = (list->data_used + PLOT_LIST_DATA_ALIGN - 1) &
+		~(size_t)(PLOT_LIST_DATA_ALIGN - 1);
+
+	if (start + len > list->data_alloc) {
+		size_t alloc;
+		char *data;
+
+		alloc = (start + len + PLOT_LIST_DATA_CHUNK) &
+			~(size_t)(PLOT_LIST_DATA_CHUNK - 1);
+		data = realloc(list->data, alloc);
+		if (data == NULL) {
+			if (list->res == NSERROR_OK) {
+				list->res = NSERROR_NOMEM;
+			}
+			return NULL;
+		}
+		list->data = data;
+		list->data_alloc = alloc;
+	}
+
+	list->data_used = start + len;
+	*offset = start;
+
+	return list->data + start;
+}
+
+
+/**
+ * copy variable length data into the list
+ *
+ * \param list display list being recorded
+ * \param src data to copy
+ * \param len length of data
+ * \param offset receives offset of the copied data
+ * \return true on success else false
+ */
+static bool
+plot_list_add_data(struct plot_list *list,
+		   const void *src,
+		   size_t len,
+		   size_t *offset)
+{
+	char *data;
+
+	data = plot_list_reserve_data(list, len, offset);
+	if (data == NULL) {
+		return false;
+	}
+	memcpy(data, src, len);
+
+	return true;
+}
+
+
+/**
+ * compute the bounds of a stroked shape
+ *
+ * \param pstyle style of the plot
+ * \param x0 left of the shape
+ * \param y0 top of the shape
+ * \param x1 right of the shape
+ * \param y1 bottom of the shape
+ * \param out receives the bounds
+ */
+static void
+plot_list_stroke_bounds(const plot_style_t *pstyle,
+			int x0, int y0, int x1, int y1,
+			struct rect *out)
+{
+	int width = 1;
+
+	if (pstyle->stroke_type != PLOT_OP_TYPE_NONE) {
+		width += plot_style_fixed_to_int(pstyle->stroke_width);
+	}
+
+	out->x0 = min(x0, x1) - width;
+	out->y0 = min(y0, y1) - width;
+	out->x1 = max(x0, x1) + width + 1;
+	out->y1 = max(y0, y1) + width + 1;
+}
+
+
+/**
+ * determine if two font styles are the same
+ */
+static inline bool
+plot_list_font_style_eq(const plot_font_style_t *a, const plot_font_style_t *b)
+{
+	return (a->families == b->families) &&
+		(a->family == b->family) &&
+		(a->size == b->size) &&
+		(a->weight == b->weight) &&
+		(a->flags == b->flags) &&
+		(a->background == b->background) &&
+		(a->foreground == b->foreground);
+}
+
+
+/**
+ * determine if two plot styles are the same
+ */
+static inline bool
+plot_list_style_eq(const plot_style_t *a, const plot_style_t *b)
+{
+	return (a->stroke_type == b->stroke_type) &&
+		(a->stroke_width == b->stroke_width) &&
+		(a->stroke_colour == b->stroke_colour) &&
+		(a->fill_type == b->fill_type) &&
+		(a->fill_colour == b->fill_colour);
+}
+
+
+/**
+ * get the previous entry if it was plotted with the current clip
+ */
+static inline struct plot_list_entry *
+plot_list_previous(struct plot_list *list, plot_list_op op)
+{
+	struct plot_list_entry *prev;
+
+	if (list->entry_count == 0) {
+		return NULL;
+	}
+
+	prev = &list->entry[list->entry_count - 1];
+	if ((prev->op != op) ||
+	    (prev->clip.x0 != list->clip.x0) ||
+	    (prev->clip.y0 != list->clip.y0) ||
+	    (prev->clip.x1 != list->clip.x1) ||
+	    (prev->clip.y1 != list->clip.y1)) {
+		return NULL;
+	}
+
+	return prev;
+}
+
+
+/**
+ * Sets a clip rectangle for subsequent plot operations.
+ *
+ * \param ctx The current redraw context.
+ * \param clip The rectangle to limit all subsequent plot
+ *              operations within.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_clip(const struct redraw_context *ctx, const struct rect *clip)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+
+	list->clip = *clip;
+	list->clipped = true;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Records an arc
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the arc plot.
+ * \param x The x coordinate of the arc.
+ * \param y The y coordinate of the arc.
+ * \param radius The radius of the arc.
+ * \param angle1 The start angle of the arc.
+ * \param angle2 The finish angle of the arc.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_arc(const struct redraw_context *ctx,
+		   const plot_style_t *pstyle,
+		   int x,
+		   int y,
+		   int radius,
+		   int angle1,
+		   int angle2)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+
+	plot_list_stroke_bounds(pstyle, x - radius, y - radius,
+				x + radius, y + radius, &bounds);
+
+	entry = plot_list_add(list, PLOT_LIST_ARC, &bounds);
+	if (entry != NULL) {
+		entry->u.arc.style = *pstyle;
+		entry->u.arc.x = x;
+		entry->u.arc.y = y;
+		entry->u.arc.radius = radius;
+		entry->u.arc.angle1 = angle1;
+		entry->u.arc.angle2 = angle2;
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a circle
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the circle plot.
+ * \param x The x coordinate of the circle.
+ * \param y The y coordinate of the circle.
+ * \param radius The radius of the circle.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_disc(const struct redraw_context *ctx,
+		    const plot_style_t *pstyle,
+		    int x,
+		    int y,
+		    int radius)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+
+	plot_list_stroke_bounds(pstyle, x - radius, y - radius,
+				x + radius, y + radius, &bounds);
+
+	entry = plot_list_add(list, PLOT_LIST_DISC, &bounds);
+	if (entry != NULL) {
+		entry->u.arc.style = *pstyle;
+		entry->u.arc.x = x;
+		entry->u.arc.y = y;
+		entry->u.arc.radius = radius;
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a line
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the line plot.
+ * \param line A rectangle defining the line to be drawn
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_line(const struct redraw_context *ctx,
+		    const plot_style_t *pstyle,
+		    const struct rect *line)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+
+	plot_list_stroke_bounds(pstyle, line->x0, line->y0,
+				line->x1, line->y1, &bounds);
+
+	entry = plot_list_add(list, PLOT_LIST_LINE, &bounds);
+	if (entry != NULL) {
+		/* patterns start where the line is clipped and diagonal
+		 * lines are stepped from their clipped end points
+		 */
+		entry->clip_sensitive =
+			(pstyle->stroke_type != PLOT_OP_TYPE_SOLID) ||
+			((line->x0 != line->x1) && (line->y0 != line->y1));
+		entry->u.rect.style = *pstyle;
+		entry->u.rect.r = *line;
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a rectangle.
+ *
+ * A solid fill which extends the previous solid fill in the same
+ * colour and clip is merged with it.
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the rectangle plot.
+ * \param rect A rectangle defining the line to be drawn
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_rectangle(const struct redraw_context *ctx,
+			 const plot_style_t *pstyle,
+			 const struct rect *rect)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+	bool solid;
+
+	solid = (pstyle->stroke_type == PLOT_OP_TYPE_NONE) &&
+		(pstyle->fill_type == PLOT_OP_TYPE_SOLID) &&
+		((pstyle->fill_colour & 0xff000000) == 0);
+
+	if (solid) {
+		bounds = *rect;
+
+		entry = plot_list_previous(list, PLOT_LIST_RECTANGLE);
+		if ((entry != NULL) &&
+		    entry->opaque &&
+		    plot_list_style_eq(&entry->u.rect.style, pstyle)) {
+			struct rect *prev = &entry->u.rect.r;
+			bool merged = false;
+
+			if ((prev->y0 == rect->y0) && (prev->y1 == rect->y1) &&
+			    (prev->x1 == rect->x0)) {
+				prev->x1 = rect->x1;
+				merged = true;
+			} else if ((prev->x0 == rect->x0) &&
+				   (prev->x1 == rect->x1) &&
+				   (prev->y1 == rect->y0)) {
+				prev->y1 = rect->y1;
+				merged = true;
+			}
+
+			if (merged) {
+				plot_list_intersect(prev, &list->clip,
+						    &entry->bounds);
+				return list->res;
+			}
+		}
+	} else {
+		plot_list_stroke_bounds(pstyle, rect->x0, rect->y0,
+					rect->x1, rect->y1, &bounds);
+	}
+
+	entry = plot_list_add(list, PLOT_LIST_RECTANGLE, &bounds);
+	if (entry != NULL) {
+		entry->opaque = solid;
+		entry->clip_sensitive =
+			(pstyle->stroke_type == PLOT_OP_TYPE_DOT) ||
+			(pstyle->stroke_type == PLOT_OP_TYPE_DASH);
+		entry->u.rect.style = *pstyle;
+		entry->u.rect.r = *rect;
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a polygon
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the polygon plot.
+ * \param p verticies of polygon
+ * \param n number of verticies.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_polygon(const struct redraw_context *ctx,
+		       const plot_style_t *pstyle,
+		       const int *p,
+		       unsigned int n)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+	unsigned int idx;
+
+	if (n == 0) {
+		return list->res;
+	}
+
+	bounds.x0 = bounds.x1 = p[0];
+	bounds.y0 = bounds.y1 = p[1];
+	for (idx = 1; idx < n; idx++) {
+		bounds.x0 = min(bounds.x0, p[idx * 2]);
+		bounds.y0 = min(bounds.y0, p[idx * 2 + 1]);
+		bounds.x1 = max(bounds.x1, p[idx * 2]);
+		bounds.y1 = max(bounds.y1, p[idx * 2 + 1]);
+	}
+	bounds.x1++;
+	bounds.y1++;
+
+	entry = plot_list_add(list, PLOT_LIST_POLYGON, &bounds);
+	if (entry != NULL) {
+		entry->u.path.style = *pstyle;
+		entry->u.path.n = n;
+		if (!plot_list_add_data(list, p, n * 2 * sizeof(int),
+					&entry->u.path.data)) {
+			list->entry_count--;
+		}
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a path.
+ *
+ * The extent of a path is not computed so it is only culled when its
+ * whole clip rectangle is hidden.
+ *
+ * \param ctx The current redraw context.
+ * \param pstyle Style controlling the path plot.
+ * \param p elements of path
+ * \param n nunber of elements on path
+ * \param transform A transform to apply to the path.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_path(const struct redraw_context *ctx,
+		    const plot_style_t *pstyle,
+		    const float *p,
+		    unsigned int n,
+		    const float transform[6])
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+
+	entry = plot_list_add(list, PLOT_LIST_PATH, NULL);
+	if (entry != NULL) {
+		entry->u.path.style = *pstyle;
+		entry->u.path.n = n;
+		memcpy(entry->u.path.transform, transform,
+		       sizeof(entry->u.path.transform));
+		if (!plot_list_add_data(list, p, n * sizeof(float),
+					&entry->u.path.data)) {
+			list->entry_count--;
+		}
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records a bitmap
+ *
+ * \param ctx The current redraw context.
+ * \param bitmap The bitmap to plot
+ * \param x The x coordinate to plot the bitmap
+ * \param y The y coordiante to plot the bitmap
+ * \param width The width of area to plot the bitmap into
+ * \param height The height of area to plot the bitmap into
+ * \param bg the background colour to alpha blend into
+ * \param flags the flags controlling the type of plot operation
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_bitmap(const struct redraw_context *ctx,
+		      struct bitmap *bitmap,
+		      int x,
+		      int y,
+		      int width,
+		      int height,
+		      colour bg,
+		      bitmap_flags_t flags)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+	struct rect bounds;
+	const struct rect *pbounds = NULL;
+
+	if ((flags & (BITMAPF_REPEAT_X | BITMAPF_REPEAT_Y)) == 0) {
+		bounds.x0 = x;
+		bounds.y0 = y;
+		bounds.x1 = x + width;
+		bounds.y1 = y + height;
+		pbounds = &bounds;
+	}
+
+	entry = plot_list_add(list, PLOT_LIST_BITMAP, pbounds);
+	if (entry != NULL) {
+		entry->opaque = (pbounds != NULL) &&
+			guit->bitmap->get_opaque(bitmap);
+		entry->u.bitmap.bitmap = bitmap;
+		entry->u.bitmap.x = x;
+		entry->u.bitmap.y = y;
+		entry->u.bitmap.width = width;
+		entry->u.bitmap.height = height;
+		entry->u.bitmap.bg = bg;
+		entry->u.bitmap.flags = flags;
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records text.
+ *
+ * A run which starts where the previous run in the same style ended
+ * is appended to it. The extent of text is not computed so it is only
+ * culled when its whole clip rectangle is hidden.
+ *
+ * \param ctx The current redraw context.
+ * \param fstyle plot style for this text
+ * \param x x coordinate
+ * \param y y coordinate
+ * \param text UTF-8 string to plot
+ * \param length length of string, in bytes
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_text(const struct redraw_context *ctx,
+		    const plot_font_style_t *fstyle,
+		    int x,
+		    int y,
+		    const char *text,
+		    size_t length)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+
+	if ((list->ext != NULL) && (list->ext->text != NULL)) {
+		nserror res;
+
+		res = list->ext->text(list, fstyle, x, y, text, length);
+		if ((res != NSERROR_OK) && (list->res == NSERROR_OK)) {
+			list->res = res;
+		}
+		return list->res;
+	}
+
+	entry = plot_list_previous(list, PLOT_LIST_TEXT);
+	if ((entry != NULL) &&
+	    (entry->u.text.y == y) &&
+	    (entry->u.text.x < x) &&
+	    (entry->u.text.data + entry->u.text.length == list->data_used) &&
+	    plot_list_font_style_eq(&entry->u.text.style, fstyle)) {
+		int width;
+		nserror res;
+
+		res = guit->layout->width(fstyle,
+					  list->data + entry->u.text.data,
+					  entry->u.text.length,
+					  &width);
+		if ((res == NSERROR_OK) &&
+		    (entry->u.text.x + width == x) &&
+		    ((list->data_used + length) <= list->data_alloc)) {
+			/* run continues the previous one */
+			memcpy(list->data + list->data_used, text, length);
+			list->data_used += length;
+			entry->u.text.length += length;
+			return list->res;
+		}
+	}
+
+	entry = plot_list_add(list, PLOT_LIST_TEXT, NULL);
+	if (entry != NULL) {
+		entry->u.text.style = *fstyle;
+		entry->u.text.x = x;
+		entry->u.text.y = y;
+		entry->u.text.length = length;
+		if (!plot_list_add_data(list, text, length,
+					&entry->u.text.data)) {
+			list->entry_count--;
+		}
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records the start of a group of objects.
+ *
+ * \param ctx The current redraw context.
+ * \param name name of the group
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+plot_list_plot_group_start(const struct redraw_context *ctx, const char *name)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+	struct plot_list_entry *entry;
+
+	entry = plot_list_add(list, PLOT_LIST_GROUP_START, NULL);
+	if (entry != NULL) {
+		entry->u.group.data = PLOT_LIST_NO_DATA;
+		if ((name != NULL) &&
+		    !plot_list_add_data(list, name, strlen(name) + 1,
+					&entry->u.group.data)) {
+			list->entry_count--;
+		}
+	}
+
+	return list->res;
+}
+
+
+/**
+ * Records the end of the most recently started group.
+ *
+ * \param ctx The current redraw context.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror plot_list_plot_group_end(const struct redraw_context *ctx)
+{
+	struct plot_list *list = plot_list_from_ctx(ctx);
+
+	plot_list_add(list, PLOT_LIST_GROUP_END, NULL);
+
+	return list->res;
+}
+
+
+/**
+ * display list recording plotter operation table
+ */
+static const struct plotter_table plot_list_plotters = {
+	.clip = plot_list_plot_clip,
+	.arc = plot_list_plot_arc,
+	.disc = plot_list_plot_disc,
+	.line = plot_list_plot_line,
+	.rectangle = plot_list_plot_rectangle,
+	.polygon = plot_list_plot_polygon,
+	.path = plot_list_plot_path,
+	.bitmap = plot_list_plot_bitmap,
+	.text = plot_list_plot_text,
+	.group_start = plot_list_plot_group_start,
+	.group_end = plot_list_plot_group_end,
+	.option_knockout = false,
+};
+
+
+/* exported interface documented in desktop/plot_list.h */
+nserror
+plot_list_create(const struct plot_list_ext *ext, struct plot_list **list_out)
+{
+	struct plot_list *list;
+
+	list = calloc(1, sizeof(*list));
+	if (list == NULL) {
+		return NSERROR_NOMEM;
+	}
+	list->ext = ext;
+
+	*list_out = list;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+void plot_list_destroy(struct plot_list *list)
+{
+	if (list == NULL) {
+		return;
+	}
+
+	free(list->entry);
+	free(list->data);
+	free(list);
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+void plot_list_reset(struct plot_list *list)
+{
+	list->entry_count = 0;
+	list->data_used = 0;
+	list->clipped = false;
+	list->res = NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+nserror
+plot_list_record(struct plot_list *list,
+		 const struct redraw_context *ctx,
+		 struct redraw_context *rec_ctx)
+{
+	plot_list_reset(list);
+
+	list->clip.x0 = list->clip.y0 = INT_MIN / 2;
+	list->clip.x1 = list->clip.y1 = INT_MAX / 2;
+
+	*rec_ctx = *ctx;
+	rec_ctx->plot = &plot_list_plotters;
+	rec_ctx->priv = list;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+nserror
+plot_list_add_ext(struct plot_list *list,
+		  const struct rect *bounds,
+		  size_t len,
+		  void **data_out)
+{
+	struct plot_list_entry *entry;
+	size_t offset;
+
+	*data_out = NULL;
+
+	assert(list->ext != NULL);
+
+	entry = plot_list_add(list, PLOT_LIST_EXT, bounds);
+	if (entry == NULL) {
+		return list->res;
+	}
+
+	*data_out = plot_list_reserve_data(list, len, &offset);
+	if (*data_out == NULL) {
+		list->entry_count--;
+		return list->res;
+	}
+	entry->u.group.data = offset;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+nserror plot_list_finish(struct plot_list *list)
+{
+	struct rect occluder[PLOT_LIST_OCCLUDERS];
+	unsigned int occluder_count = 0;
+	unsigned int culled = 0;
+	unsigned int idx;
+
+	for (idx = list->entry_count; idx > 0; idx--) {
+		struct plot_list_entry *entry = &list->entry[idx - 1];
+		unsigned int oidx;
+
+		if ((entry->op == PLOT_LIST_GROUP_START) ||
+		    (entry->op == PLOT_LIST_GROUP_END)) {
+			continue;
+		}
+
+		for (oidx = 0; oidx < occluder_count; oidx++) {
+			if (plot_list_contains(&occluder[oidx],
+					       &entry->bounds)) {
+				entry->culled = true;
+				culled++;
+				break;
+			}
+		}
+
+		if (entry->culled || !entry->opaque) {
+			continue;
+		}
+
+		/* add the visible area to the occluders, replacing the
+		 * smallest one when the set is full
+		 */
+		if (occluder_count < PLOT_LIST_OCCLUDERS) {
+			occluder[occluder_count++] = entry->bounds;
+		} else {
+			unsigned int smallest = 0;
+			long smallest_area = LONG_MAX;
+			long area;
+
+			for (oidx = 0; oidx < occluder_count; oidx++) {
+				area = (long)(occluder[oidx].x1 - occluder[oidx].x0) *
+					(occluder[oidx].y1 - occluder[oidx].y0);
+				if (area < smallest_area) {
+					smallest_area = area;
+					smallest = oidx;
+				}
+			}
+
+			area = (long)(entry->bounds.x1 - entry->bounds.x0) *
+				(entry->bounds.y1 - entry->bounds.y0);
+			if (area > smallest_area) {
+				occluder[smallest] = entry->bounds;
+			}
+		}
+	}
+
+	NSLOG(netsurf, DEEPDEBUG, "%u entries, %u culled, %"PRIsizet" bytes",
+	      list->entry_count, culled, list->data_used);
+
+	return list->res;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+bool plot_list_get_clip(const struct plot_list *list, struct rect *clip)
+{
+	*clip = list->clip;
+
+	return list->clipped;
+}
+
+
+/**
+ * get the tile a coordinate falls in
+ */
+static inline int plot_list_tile(int v, int origin, int size)
+{
+	if (v >= origin) {
+		return (v - origin) / size;
+	}
+	return -1 - ((origin - v - 1) / size);
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+bool plot_list_tileable(const struct plot_list *list, int x, int y, int size)
+{
+	unsigned int idx;
+
+	for (idx = 0; idx < list->entry_count; idx++) {
+		const struct plot_list_entry *entry = &list->entry[idx];
+
+		if (entry->culled || !entry->clip_sensitive) {
+			continue;
+		}
+
+		if ((plot_list_tile(entry->bounds.x0, x, size) !=
+		     plot_list_tile(entry->bounds.x1, x, size)) ||
+		    (plot_list_tile(entry->bounds.y0, y, size) !=
+		     plot_list_tile(entry->bounds.y1, y, size))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * replay a single entry
+ *
+ * \param list display list being replayed
+ * \param entry entry to replay
+ * \param ctx redraw context to plot with
+ * \param dx offset to add to horizontal coordinates
+ * \param dy offset to add to vertical coordinates
+ * \return NSERROR_OK on success else error code
+ */
+static nserror
+plot_list_replay_entry(const struct plot_list *list,
+		       const struct plot_list_entry *entry,
+		       const struct redraw_context *ctx,
+		       int dx, int dy)
+{
+	struct rect r;
+	nserror res;
+
+	switch (entry->op) {
+	case PLOT_LIST_ARC:
+		return ctx->plot->arc(ctx, &entry->u.arc.style,
+				      entry->u.arc.x + dx,
+				      entry->u.arc.y + dy,
+				      entry->u.arc.radius,
+				      entry->u.arc.angle1,
+				      entry->u.arc.angle2);
+
+	case PLOT_LIST_DISC:
+		return ctx->plot->disc(ctx, &entry->u.arc.style,
+				       entry->u.arc.x + dx,
+				       entry->u.arc.y + dy,
+				       entry->u.arc.radius);
+
+	case PLOT_LIST_LINE:
+	case PLOT_LIST_RECTANGLE:
+		r.x0 = entry->u.rect.r.x0 + dx;
+		r.y0 = entry->u.rect.r.y0 + dy;
+		r.x1 = entry->u.rect.r.x1 + dx;
+		r.y1 = entry->u.rect.r.y1 + dy;
+		if (entry->op == PLOT_LIST_LINE) {
+			return ctx->plot->line(ctx, &entry->u.rect.style, &r);
+		}
+		return ctx->plot->rectangle(ctx, &entry->u.rect.style, &r);
+
+	case PLOT_LIST_POLYGON: {
+		const int *p = (const int *)(list->data + entry->u.path.data);
+		unsigned int n = entry->u.path.n;
+		unsigned int idx;
+		int *moved;
+
+		if ((dx == 0) && (dy == 0)) {
+			return ctx->plot->polygon(ctx, &entry->u.path.style,
+						  p, n);
+		}
+
+		moved = malloc(n * 2 * sizeof(int));
+		if (moved == NULL) {
+			return NSERROR_NOMEM;
+		}
+		for (idx = 0; idx < n; idx++) {
+			moved[idx * 2] = p[idx * 2] + dx;
+			moved[idx * 2 + 1] = p[idx * 2 + 1] + dy;
+		}
+		res = ctx->plot->polygon(ctx, &entry->u.path.style, moved, n);
+		free(moved);
+		return res;
+	}
+
+	case PLOT_LIST_PATH: {
+		float transform[6];
+
+		memcpy(transform, entry->u.path.transform, sizeof(transform));
+		transform[4] += dx;
+		transform[5] += dy;
+
+		return ctx->plot->path(ctx, &entry->u.path.style,
+				(const float *)(list->data + entry->u.path.data),
+				entry->u.path.n,
+				transform);
+	}
+
+	case PLOT_LIST_BITMAP:
+		return ctx->plot->bitmap(ctx,
+					 entry->u.bitmap.bitmap,
+					 entry->u.bitmap.x + dx,
+					 entry->u.bitmap.y + dy,
+					 entry->u.bitmap.width,
+					 entry->u.bitmap.height,
+					 entry->u.bitmap.bg,
+					 entry->u.bitmap.flags);
+
+	case PLOT_LIST_TEXT:
+		return ctx->plot->text(ctx, &entry->u.text.style,
+				       entry->u.text.x + dx,
+				       entry->u.text.y + dy,
+				       list->data + entry->u.text.data,
+				       entry->u.text.length);
+
+	case PLOT_LIST_GROUP_START:
+		if (ctx->plot->group_start == NULL) {
+			return NSERROR_OK;
+		}
+		return ctx->plot->group_start(ctx,
+				(entry->u.group.data == PLOT_LIST_NO_DATA) ?
+				NULL : list->data + entry->u.group.data);
+
+	case PLOT_LIST_GROUP_END:
+		if (ctx->plot->group_end == NULL) {
+			return NSERROR_OK;
+		}
+		return ctx->plot->group_end(ctx);
+
+	case PLOT_LIST_EXT:
+		return list->ext->replay(ctx,
+					 list->data + entry->u.group.data,
+					 dx, dy);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/plot_list.h */
+nserror
+plot_list_replay(const struct plot_list *list,
+		 const struct redraw_context *ctx,
+		 int dx, int dy,
+		 const struct rect *clip)
+{
+	struct rect cur_clip = *clip;
+	nserror ffres = NSERROR_OK; /* first failing result */
+	nserror res;
+	unsigned int idx;
+
+	res = ctx->plot->clip(ctx, &cur_clip);
+	if (res != NSERROR_OK) {
+		ffres = res;
+	}
+
+	for (idx = 0; idx < list->entry_count; idx++) {
+		const struct plot_list_entry *entry = &list->entry[idx];
+		struct rect entry_clip;
+		struct rect bounds;
+
+		if (entry->culled) {
+			continue;
+		}
+
+		if ((entry->op != PLOT_LIST_GROUP_START) &&
+		    (entry->op != PLOT_LIST_GROUP_END)) {
+			bounds.x0 = entry->bounds.x0 + dx;
+			bounds.y0 = entry->bounds.y0 + dy;
+			bounds.x1 = entry->bounds.x1 + dx;
+			bounds.y1 = entry->bounds.y1 + dy;
+			if (!plot_list_intersect(&bounds, clip, &bounds)) {
+				/* entry lies outside the area being plotted */
+				continue;
+			}
+
+			entry_clip.x0 = entry->clip.x0 + dx;
+			entry_clip.y0 = entry->clip.y0 + dy;
+			entry_clip.x1 = entry->clip.x1 + dx;
+			entry_clip.y1 = entry->clip.y1 + dy;
+			plot_list_intersect(&entry_clip, clip, &entry_clip);
+
+			if ((entry_clip.x0 != cur_clip.x0) ||
+			    (entry_clip.y0 != cur_clip.y0) ||
+			    (entry_clip.x1 != cur_clip.x1) ||
+			    (entry_clip.y1 != cur_clip.y1)) {
+				cur_clip = entry_clip;
+				res = ctx->plot->clip(ctx, &cur_clip);
+				if ((res != NSERROR_OK) &&
+				    (ffres == NSERROR_OK)) {
+					ffres = res;
+				}
+			}
+		}
+
+		res = plot_list_replay_entry(list, entry, ctx, dx, dy);
+		if ((res != NSERROR_OK) && (ffres == NSERROR_OK)) {
+			ffres = res;
+		}
+	}
+
+	return ffres;
+}
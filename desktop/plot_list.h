@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Plot display list (interface).
+ *
+ * A display list records the plot operations of a redraw so they may
+ * be optimised and replayed, possibly more than once, into any plotter
+ * table.
+ */
+
+#ifndef NETSURF_DESKTOP_PLOT_LIST_H_
+#define NETSURF_DESKTOP_PLOT_LIST_H_
+
+#include "utils/errors.h"
+#include "netsurf/plotters.h"
+
+struct plot_list;
+
+/**
+ * Frontend extension of a display list
+ *
+ * A frontend which can not plot text from the context the list is
+ *  replayed in, such as a thread, may record text as its own entries.
+ */
+struct plot_list_ext {
+	/**
+	 * Record text
+	 *
+	 * Called in place of recording the text. The text is added to
+	 *  the list with plot_list_add_ext().
+	 *
+	 * \param list display list being recorded
+	 * \param fstyle plot style for this text
+	 * \param x x coordinate
+	 * \param y y coordinate
+	 * \param text UTF-8 string to plot
+	 * \param length length of string, in bytes
+	 * \return NSERROR_OK on success else error code
+	 */
+	nserror (*text)(struct plot_list *list,
+			const plot_font_style_t *fstyle,
+			int x, int y,
+			const char *text, size_t length);
+
+	/**
+	 * Replay an entry added with plot_list_add_ext()
+	 *
+	 * \param ctx redraw context to plot with
+	 * \param data the data of the entry
+	 * \param dx offset to add to horizontal coordinates
+	 * \param dy offset to add to vertical coordinates
+	 * \return NSERROR_OK on success else error code
+	 */
+	nserror (*replay)(const struct redraw_context *ctx,
+			const void *data,
+			int dx, int dy);
+};
+
+/**
+ * Create a display list
+ *
+ * \param ext frontend extension or NULL for none
+ * \param list_out receives the new display list
+ * \return NSERROR_OK on success else error code
+ */
+nserror plot_list_create(const struct plot_list_ext *ext,
+		struct plot_list **list_out);
+
+/**
+ * Destroy a display list
+ *
+ * \param list display list to destroy
+ */
+void plot_list_destroy(struct plot_list *list);
+
+/**
+ * Discard the contents of a display list
+ *
+ * The memory used by the list is retained for reuse.
+ *
+ * \param list display list to reset
+ */
+void plot_list_reset(struct plot_list *list);
+
+/**
+ * Start recording into a display list
+ *
+ * Any previous contents of the list are discarded. Plots made
+ * through the recording context are added to the list instead of
+ * being drawn.
+ *
+ * \param list display list to record into
+ * \param ctx the redraw context the list will be replayed into
+ * \param rec_ctx updated to copy of ctx, with plotter table replaced
+ * \return NSERROR_OK on success else error code
+ */
+nserror plot_list_record(struct plot_list *list,
+		const struct redraw_context *ctx,
+		struct redraw_context *rec_ctx);
+
+/**
+ * Add a frontend entry to a display list being recorded
+ *
+ * The entry is clipped and culled like any other and is replayed by
+ *  the replay function of the list extension.
+ *
+ * \param list display list being recorded
+ * \param bounds area affected by the entry
+ * \param len length of the entry data
+ * \param data_out receives space for the entry data, which is only
+ *                 valid until the next plot is recorded, or NULL if
+ *                 the entry is entirely clipped
+ * \return NSERROR_OK on success else error code
+ */
+nserror plot_list_add_ext(struct plot_list *list,
+		const struct rect *bounds,
+		size_t len,
+		void **data_out);
+
+/**
+ * Finish recording into a display list
+ *
+ * Plots which are completely hidden by later opaque plots are
+ * removed.
+ *
+ * \param list display list recorded into
+ * \return NSERROR_OK on success else the first error recorded
+ */
+nserror plot_list_finish(struct plot_list *list);
+
+/**
+ * Get the clip rectangle in force at the end of a recording
+ *
+ * \param list display list recorded into
+ * \param clip updated with the clip rectangle
+ * \return true if a clip was recorded else false
+ */
+bool plot_list_get_clip(const struct plot_list *list, struct rect *clip);
+
+/**
+ * Determine if a display list may be replayed in tiles
+ *
+ * Some plots, such as patterned or diagonal lines, are rasterised
+ * differently depending on where they are clipped. A list can only be
+ * replayed a tile at a time if none of them crosses a tile edge.
+ *
+ * \param list finished display list
+ * \param x horizontal origin of the tiles
+ * \param y vertical origin of the tiles
+ * \param size width and height of a tile
+ * \return true if the tiles will match replaying the whole list
+ */
+bool plot_list_tileable(const struct plot_list *list, int x, int y, int size);
+
+/**
+ * Replay a display list
+ *
+ * Bitmaps, font families and text referenced by the list must remain
+ * valid until it is replayed, so a list may only be reused while the
+ * content it was recorded from is unchanged. A finished list is not
+ * altered by replaying it so it may be replayed from several threads
+ * at once, provided the plotters allow it.
+ *
+ * \param list display list to replay
+ * \param ctx redraw context to plot with
+ * \param dx offset to add to horizontal coordinates
+ * \param dy offset to add to vertical coordinates
+ * \param clip area to plot within, after offsetting
+ * \return NSERROR_OK on success else the first error encountered
+ */
+nserror plot_list_replay(const struct plot_list *list,
+		const struct redraw_context *ctx,
+		int dx, int dy,
+		const struct rect *clip);
+
+#endif
@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "utils/utils.h"
+#include "utils/ascii.h"
 #include "utils/log.h"
 #include "utils/nsurl.h"
 #include "utils/nscolour.h"
@@ -113,6 +114,7 @@ enum treeview_node_flags {
 	TV_NFLAGS_SELECTED = (1 << 1),	/**< Whether node is selected */
 	TV_NFLAGS_SPECIAL  = (1 << 2),	/**< Render as special node */
 	TV_NFLAGS_MATCHED  = (1 << 3),	/**< Whether node matches search */
+	TV_NFLAGS_LAZY     = (1 << 4),	/**< Children not yet populated */
 };
 
 
@@ -136,6 +138,7 @@ struct treeview_node {
 
 	int height;	/**< Includes height of any descendants (pixels) */
 	int inset;	/**< Node's inset depending on tree depth (pixels) */
+	int row;	/**< Row in the tree's row index, if displayed */
 
 	treeview_node *parent; /**< parent node */
 	treeview_node *prev_sib; /**< previous sibling node */
@@ -156,6 +159,7 @@ struct treeview_node {
  */
 struct treeview_node_entry {
 	treeview_node base; /**< Entry class inherits node base class */
+	uint32_t search_id; /**< Id in the search index, or 0 */
 	struct treeview_field fields[FLEX_ARRAY_LEN_DECL];
 };
 
@@ -215,6 +219,40 @@ struct treeview_edit {
 };
 
 
+/**
+ * Entries containing a trigram
+ */
+struct treeview_trigram {
+	uint32_t key; /**< Case folded trigram, or 0 for an unused slot */
+	uint32_t *id; /**< Ids of entries containing the trigram, ascending */
+	uint32_t count; /**< Number of ids */
+	uint32_t alloc; /**< Allocated number of ids */
+};
+
+
+/**
+ * Trigram index over the searchable text of a treeview's entries
+ *
+ * Each entry is given an id when it is indexed.  Ids are not reused, so
+ * deleting an entry just clears its slot, and stale ids are dropped from
+ * a trigram's list the next time it is used.  A changed entry is given
+ * a new id, leaving the ids of the trigrams it no longer contains to go
+ * stale in the same way.  The index only narrows
+ * down the candidates for a search; each candidate is still checked
+ * against the search term.
+ */
+struct treeview_search_index {
+	treeview_node **node; /**< Entry for each id, NULL once deleted */
+	uint32_t count; /**< Number of ids issued, including unused id 0 */
+	uint32_t alloc; /**< Allocated number of ids */
+	uint32_t live; /**< Number of indexed entries still in the tree */
+
+	struct treeview_trigram *slot; /**< Open addressed trigram table */
+	uint32_t n_slots; /**< Size of trigram table, a power of two */
+	uint32_t used; /**< Number of used trigram table slots */
+};
+
+
 /**
  * Treeview search box details
  */
@@ -223,6 +261,30 @@ struct treeview_search {
 	bool active;                /**< Whether the search box has focus. */
 	bool search;                /**< Whether we have a search term. */
 	int height;                 /**< Current search display height. */
+
+	struct treeview_search_index *index; /**< Entry index, or NULL. */
+	char *last;            /**< Term of the last search, or NULL. */
+	uint32_t *match;       /**< Ids of entries which may match last term. */
+	uint32_t n_match;      /**< Number of ids in match list. */
+	uint32_t match_alloc;  /**< Allocated size of match list. */
+};
+
+
+/**
+ * Index of the rows displayed by a treeview in tree mode
+ *
+ * Allows the node at a y position, and the y position of a node, to be
+ * found by binary search rather than a walk over every displayed node.
+ * Expanding or contracting a displayed node splices its descendants'
+ * rows in or out.  Other changes to the tree's layout invalidate the
+ * index, which is then rebuilt the next time it is needed.
+ */
+struct treeview_rows {
+	treeview_node **node; /**< Displayed nodes in display order */
+	int *y; /**< Top of each row, followed by the total height */
+	int count; /**< Number of displayed rows */
+	int alloc; /**< Allocated number of rows */
+	bool valid; /**< Whether the index reflects the tree's layout */
 };
 
 
@@ -246,6 +308,9 @@ struct treeview {
 
 	struct treeview_search search; /**< Treeview search box */
 
+	struct treeview_rows rows; /**< Index of displayed rows */
+	int lazy; /**< Number of folders still to be populated */
+
 	const struct treeview_callback_table *callbacks; /**< For node events */
 
 	struct core_window *cw_h; /**< Core window handle */
@@ -524,6 +589,230 @@ static inline treeview_node * treeview_node_next(treeview_node *node, bool full)
 }
 
 
+/**
+ * Mark a treeview's row index as out of date.
+ *
+ * Must be called whenever nodes are displayed, hidden or change
+ * height.
+ *
+ * \param tree Treeview whose layout has changed
+ */
+static inline void treeview__rows_invalidate(treeview *tree)
+{
+	tree->rows.valid = false;
+}
+
+
+/**
+ * Height of a node's own row
+ *
+ * \param n Displayed node
+ * \return height of the row showing n
+ */
+static inline int treeview__row_height(const treeview_node *n)
+{
+	return (n->type == TREE_NODE_ENTRY) ? n->height : tree_g.line_height;
+}
+
+
+/**
+ * Ensure a treeview's row index has space for a number of rows
+ *
+ * On failure the index keeps its existing arrays and allocation.
+ *
+ * \param rows Row index to grow
+ * \param count Number of rows needed
+ * \return true on success, false on memory exhaustion
+ */
+static bool treeview__rows_reserve(struct treeview_rows *rows, int count)
+{
+	int alloc = (rows->alloc == 0) ? 64 : rows->alloc;
+	treeview_node **node;
+	int *ys;
+
+	if (count <= rows->alloc && rows->y != NULL) {
+		return true;
+	}
+
+	while (alloc < count) {
+		alloc *= 2;
+	}
+
+	node = realloc(rows->node, alloc * sizeof(*node));
+	if (node == NULL) {
+		return false;
+	}
+	rows->node = node;
+
+	ys = realloc(rows->y, (alloc + 1) * sizeof(*ys));
+	if (ys == NULL) {
+		return false;
+	}
+	rows->y = ys;
+
+	/* Only now are both arrays known to hold alloc rows */
+	rows->alloc = alloc;
+
+	return true;
+}
+
+
+/**
+ * Ensure a treeview's row index reflects its current layout
+ *
+ * \param tree Treeview to index
+ * \return true if the index is usable, false if it could not be built
+ */
+static bool treeview__rows_update(const treeview *tree)
+{
+	/* the index is a cache, so may be updated through a const tree */
+	struct treeview_rows *rows = (struct treeview_rows *)&tree->rows;
+	treeview_node *n;
+	int y = 0;
+
+	if (rows->valid) {
+		return true;
+	}
+
+	rows->count = 0;
+
+	for (n = treeview_node_next(tree->root, false); n != NULL;
+	     n = treeview_node_next(n, false)) {
+		if (!treeview__rows_reserve(rows, rows->count + 1)) {
+			rows->count = 0;
+			return false;
+		}
+
+		n->row = rows->count;
+		rows->node[rows->count] = n;
+		rows->y[rows->count] = y;
+		rows->count++;
+
+		y += treeview__row_height(n);
+	}
+
+	if (!treeview__rows_reserve(rows, rows->count)) {
+		rows->count = 0;
+		return false;
+	}
+	rows->y[rows->count] = y;
+
+	rows->valid = true;
+
+	return true;
+}
+
+
+/**
+ * Update a treeview's row index after a node is expanded or contracted
+ *
+ * The rows of the node's previously displayed descendants are replaced
+ * with those of its currently displayed descendants, and the rows below
+ * are moved, without walking the rest of the tree.  Nothing is done if
+ * the index is already stale or the node is not displayed.
+ *
+ * \param tree Treeview containing node
+ * \param node Node whose expansion has changed
+ */
+static void treeview__rows_relayout(treeview *tree, treeview_node *node)
+{
+	struct treeview_rows *rows = &tree->rows;
+	treeview_node *n;
+	int first = node->row + 1;
+	int end;
+	int added = 0;
+	int count;
+	int delta;
+	int row;
+	int y;
+
+	if (!rows->valid || node->row < 0 || node->row >= rows->count ||
+	    rows->node[node->row] != node) {
+		return;
+	}
+
+	/* Descendants follow the node and are inset further than it */
+	for (end = first; end < rows->count; end++) {
+		if (rows->node[end]->inset <= node->inset) {
+			break;
+		}
+	}
+
+	for (n = treeview_node_next(node, false);
+	     n != NULL && n->inset > node->inset;
+	     n = treeview_node_next(n, false)) {
+		added++;
+	}
+
+	count = rows->count - (end - first) + added;
+	if (!treeview__rows_reserve(rows, count)) {
+		treeview__rows_invalidate(tree);
+		return;
+	}
+
+	/* Move the rows below the node's descendants */
+	memmove(rows->node + first + added, rows->node + end,
+			(rows->count - end) * sizeof(*rows->node));
+	memmove(rows->y + first + added, rows->y + end,
+			(rows->count - end + 1) * sizeof(*rows->y));
+
+	/* Index the node's displayed descendants */
+	y = rows->y[node->row] + treeview__row_height(node);
+	row = first;
+	for (n = treeview_node_next(node, false);
+	     n != NULL && n->inset > node->inset;
+	     n = treeview_node_next(n, false)) {
+		n->row = row;
+		rows->node[row] = n;
+		rows->y[row] = y;
+		y += treeview__row_height(n);
+		row++;
+	}
+
+	/* Offset the moved rows */
+	delta = y - rows->y[row];
+	for (; row < count; row++) {
+		rows->node[row]->row = row;
+		rows->y[row] += delta;
+	}
+	rows->y[count] += delta;
+
+	rows->count = count;
+}
+
+
+/**
+ * Find the row at an offset into the displayed rows
+ *
+ * \param tree Treeview with a valid row index
+ * \param offset Offset from the top of the first row
+ * \return index of row containing offset, or row count if there is none
+ */
+static int treeview__rows_find(const treeview *tree, int offset)
+{
+	const struct treeview_rows *rows = &tree->rows;
+	int lo = 0;
+	int hi = rows->count;
+
+	if (offset < 0) {
+		return rows->count;
+	}
+
+	/* Find the first row whose bottom is below offset */
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (rows->y[mid + 1] <= offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+
 /**
  * Find node at given y-position
  *
@@ -535,10 +824,16 @@ static treeview_node * treeview_y_node(treeview *tree, int target_y)
 {
 	int y = treeview__get_search_height(tree);
 	treeview_node *n;
+	int row;
 
 	assert(tree != NULL);
 	assert(tree->root != NULL);
 
+	if (treeview__rows_update(tree)) {
+		row = treeview__rows_find(tree, target_y - y);
+		return (row < tree->rows.count) ? tree->rows.node[row] : NULL;
+	}
+
 	n = treeview_node_next(tree->root, false);
 
 	while (n != NULL) {
@@ -572,6 +867,18 @@ static int treeview_node_y(
 	assert(tree != NULL);
 	assert(tree->root != NULL);
 
+	if (treeview__rows_update(tree)) {
+		const struct treeview_rows *rows = &tree->rows;
+
+		if ((node != NULL) &&
+		    (node->row >= 0) && (node->row < rows->count) &&
+		    (rows->node[node->row] == node)) {
+			return y + rows->y[node->row];
+		}
+		/* node not displayed */
+		return y + rows->y[rows->count];
+	}
+
 	n = treeview_node_next(tree->root, false);
 
 	while (n != NULL && n != node) {
@@ -789,6 +1096,86 @@ static nserror treeview_walk_internal(
 }
 
 
+/**
+ * Ask the client to populate a lazily created folder
+ *
+ * \param tree Treeview containing node
+ * \param node Folder node whose children are needed
+ */
+static void treeview__populate(treeview *tree, treeview_node *node)
+{
+	struct treeview_node_msg msg;
+
+	if ((node->flags & TV_NFLAGS_LAZY) == 0) {
+		return;
+	}
+
+	/* Clear first so the client may add children to the folder */
+	node->flags &= ~TV_NFLAGS_LAZY;
+	tree->lazy--;
+
+	msg.msg = TREE_MSG_NODE_POPULATE;
+	tree->callbacks->folder(msg, node->client_data);
+}
+
+
+/**
+ * context data for populating lazily created folders
+ */
+struct treeview_populate_data {
+	treeview *tree;
+	int populated; /**< Number of folders populated by the walk */
+};
+
+
+/**
+ * Treewalk node callback populating lazily created folders.
+ */
+static nserror
+treeview__populate_walk_cb(treeview_node *n,
+			   void *ctx,
+			   bool *skip_children,
+			   bool *end)
+{
+	struct treeview_populate_data *pd = ctx;
+
+	if (n->flags & TV_NFLAGS_LAZY) {
+		treeview__populate(pd->tree, n);
+		pd->populated++;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Populate every lazily created folder in a treeview
+ *
+ * Used before operations which must see every node in the tree.  Each
+ * folder is populated once, so once none remain this costs nothing.  The
+ * walk has already looked for a folder's children by the time it is
+ * populated, so walks repeat while it populates folders and some remain.
+ *
+ * \param tree Treeview to populate
+ */
+static void treeview__populate_all(treeview *tree)
+{
+	struct treeview_populate_data pd = {
+		.tree = tree,
+	};
+
+	while (tree->lazy > 0) {
+		pd.populated = 0;
+		treeview_walk_internal(tree, tree->root,
+				TREEVIEW_WALK_MODE_LOGICAL_COMPLETE, NULL,
+				treeview__populate_walk_cb, &pd);
+		if (pd.populated == 0) {
+			break;
+		}
+	}
+}
+
+
 /**
  * Data used when doing a treeview walk for search.
  */
@@ -800,6 +1187,35 @@ struct treeview_search_walk_data {
 };
 
 
+/**
+ * Check whether an entry matches a search term.
+ *
+ * \param[in] tree  Treeview the entry belongs to.
+ * \param[in] n     Entry node to check.
+ * \param[in] text  Search term.  (NULL-terminated.)
+ * \return true iff the entry's title or a searchable field contains text.
+ */
+static bool treeview__search_match(
+		const treeview *tree,
+		treeview_node *n,
+		const char *text)
+{
+	struct treeview_node_entry *entry = (struct treeview_node_entry *)n;
+
+	for (int i = 0; i < tree->n_fields - 1; i++) {
+		struct treeview_field *ef = &(tree->fields[i + 1]);
+		if (ef->flags & TREE_FLAG_SEARCHABLE) {
+			if (strcasestr(entry->fields[i].value.data,
+				       text) != NULL) {
+				return true;
+			}
+		}
+	}
+
+	return (strcasestr(n->text.data, text) != NULL);
+}
+
+
 /**
  * Treewalk node callback for handling search.
  *
@@ -828,30 +1244,539 @@ static nserror treeview__search_walk_cb(
 		return NSERROR_OK;
 	}
 
-	struct treeview_node_entry *entry = (struct treeview_node_entry *)n;
-	bool matched = false;
+	if (treeview__search_match(sw->tree, n, sw->text)) {
+		n->flags |= TV_NFLAGS_MATCHED;
+		sw->window_height += n->height;
+	} else {
+		n->flags &= ~TV_NFLAGS_MATCHED;
+	}
 
-	for (int i = 0; i < sw->tree->n_fields; i++) {
-		struct treeview_field *ef = &(sw->tree->fields[i + 1]);
-		if (ef->flags & TREE_FLAG_SEARCHABLE) {
-			if (strcasestr(entry->fields[i].value.data,
-				       sw->text) != NULL) {
-				matched = true;
+	return NSERROR_OK;
+}
+
+
+/**
+ * Get the index key for the trigram at the start of some text.
+ *
+ * \param[in] text  Text with at least three bytes.
+ * \return case folded trigram key, never 0.
+ */
+static inline uint32_t treeview__trigram_key(const char *text)
+{
+	return 0x1000000 |
+		((uint32_t)(uint8_t)ascii_to_lower(text[0]) << 16) |
+		((uint32_t)(uint8_t)ascii_to_lower(text[1]) << 8) |
+		((uint32_t)(uint8_t)ascii_to_lower(text[2]));
+}
+
+
+/**
+ * Find the trigram table slot for a key.
+ *
+ * \param[in] index  Search index.
+ * \param[in] key    Trigram key.
+ * \return the slot holding key, or the unused slot it would go in.
+ */
+static struct treeview_trigram *treeview__trigram_find(
+		const struct treeview_search_index *index,
+		uint32_t key)
+{
+	uint32_t mask = index->n_slots - 1;
+	uint32_t i = key * 2654435761u;
+
+	i = (i ^ (i >> 15)) & mask;
+	while (index->slot[i].key != 0 && index->slot[i].key != key) {
+		i = (i + 1) & mask;
+	}
+
+	return &index->slot[i];
+}
+
+
+/**
+ * Double the size of the trigram table.
+ *
+ * \param[in] index  Search index.
+ * \return true on success, false on memory exhaustion.
+ */
+static bool treeview__trigram_grow(struct treeview_search_index *index)
+{
+	struct treeview_trigram *old = index->slot;
+	uint32_t n_old = index->n_slots;
+	uint32_t i;
+
+	index->slot = calloc(n_old * 2, sizeof(struct treeview_trigram));
+	if (index->slot == NULL) {
+		index->slot = old;
+		return false;
+	}
+	index->n_slots = n_old * 2;
+
+	for (i = 0; i < n_old; i++) {
+		if (old[i].key != 0) {
+			*treeview__trigram_find(index, old[i].key) = old[i];
+		}
+	}
+	free(old);
+
+	return true;
+}
+
+
+/**
+ * Add an entry's id to the lists of the trigrams in some text.
+ *
+ * An entry being indexed has the highest id yet, so it is appended.
+ *
+ * \param[in] index  Search index.
+ * \param[in] id     Id of entry the text belongs to.
+ * \param[in] text   Text to index.
+ * \param[in] len    Byte length of text.
+ * \return true on success, false on memory exhaustion.
+ */
+static bool treeview__search_index_text(
+		struct treeview_search_index *index,
+		uint32_t id,
+		const char *text,
+		size_t len)
+{
+	struct treeview_trigram *t;
+	size_t i;
+
+	for (i = 0; i + 3 <= len; i++) {
+		uint32_t key = treeview__trigram_key(text + i);
+
+		if ((index->used + 1) * 4 > index->n_slots * 3 &&
+		    !treeview__trigram_grow(index)) {
+			return false;
+		}
+
+		t = treeview__trigram_find(index, key);
+		if (t->key == 0) {
+			t->key = key;
+			index->used++;
+		}
+
+		if (t->count > 0 && t->id[t->count - 1] == id) {
+			/* Repeated trigram in the same entry */
+			continue;
+		}
+
+		if (t->count == t->alloc) {
+			uint32_t alloc = (t->alloc == 0) ? 4 : t->alloc * 2;
+			uint32_t *ids = realloc(t->id, alloc * sizeof(*ids));
+			if (ids == NULL) {
+				return false;
+			}
+			t->id = ids;
+			t->alloc = alloc;
+		}
+		t->id[t->count++] = id;
+	}
+
+	return true;
+}
+
+
+/**
+ * Add an entry to a treeview's search index.
+ *
+ * \param[in] tree  Treeview with a search index.
+ * \param[in] n     Entry node to index.
+ * \return true on success, false on memory exhaustion.
+ */
+static bool treeview__search_index_entry(treeview *tree, treeview_node *n)
+{
+	struct treeview_search_index *index = tree->search.index;
+	struct treeview_node_entry *e = (struct treeview_node_entry *)n;
+	int i;
+
+	assert(e->search_id == 0);
+
+	if (index->count == index->alloc) {
+		uint32_t alloc = index->alloc * 2;
+		treeview_node **node = realloc(index->node,
+				alloc * sizeof(*node));
+		if (node == NULL) {
+			return false;
+		}
+		index->node = node;
+		index->alloc = alloc;
+	}
+	e->search_id = index->count++;
+	index->node[e->search_id] = n;
+	index->live++;
+
+	if (!treeview__search_index_text(index, e->search_id,
+			n->text.data, n->text.len)) {
+		return false;
+	}
+
+	for (i = 0; i < tree->n_fields - 1; i++) {
+		if ((tree->fields[i + 1].flags & TREE_FLAG_SEARCHABLE) &&
+		    !treeview__search_index_text(index, e->search_id,
+				e->fields[i].value.data,
+				e->fields[i].value.len)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Discard a treeview's search index and match list.
+ *
+ * Nodes may be left flagged as matching; they are cleared when the
+ * index is next built.
+ *
+ * \param[in] tree  Treeview to discard search index of.
+ */
+static void treeview__search_index_destroy(treeview *tree)
+{
+	struct treeview_search_index *index = tree->search.index;
+	uint32_t i;
+
+	if (index != NULL) {
+		for (i = 0; i < index->n_slots; i++) {
+			free(index->slot[i].id);
+		}
+		free(index->slot);
+		free(index->node);
+		free(index);
+		tree->search.index = NULL;
+	}
+
+	free(tree->search.last);
+	tree->search.last = NULL;
+	free(tree->search.match);
+	tree->search.match = NULL;
+	tree->search.n_match = 0;
+	tree->search.match_alloc = 0;
+}
+
+
+/**
+ * Treewalk node callback for building the search index.
+ *
+ * \param[in]     n              Current node.
+ * \param[in]     ctx            Treeview being indexed.
+ * \param[in,out] skip_children  Flag to allow children to be skipped.
+ * \param[in,out] end            Flag to allow iteration to be finished early.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror treeview__search_index_walk_cb(
+		treeview_node *n,
+		void *ctx,
+		bool *skip_children,
+		bool *end)
+{
+	treeview *tree = ctx;
+
+	if (n->type != TREE_NODE_ENTRY) {
+		return NSERROR_OK;
+	}
+
+	n->flags &= ~TV_NFLAGS_MATCHED;
+	((struct treeview_node_entry *)n)->search_id = 0;
+
+	if (!treeview__search_index_entry(tree, n)) {
+		return NSERROR_NOMEM;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Build a treeview's search index.
+ *
+ * \param[in] tree  Treeview to build search index for.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror treeview__search_index_build(treeview *tree)
+{
+	struct treeview_search_index *index;
+	nserror err;
+
+	treeview__search_index_destroy(tree);
+
+	index = calloc(1, sizeof(*index));
+	if (index == NULL) {
+		return NSERROR_NOMEM;
+	}
+	tree->search.index = index;
+
+	index->alloc = 256;
+	index->node = malloc(index->alloc * sizeof(*index->node));
+	index->n_slots = 1024;
+	index->slot = calloc(index->n_slots, sizeof(*index->slot));
+	if (index->node == NULL || index->slot == NULL) {
+		treeview__search_index_destroy(tree);
+		return NSERROR_NOMEM;
+	}
+
+	/* Id 0 means not indexed */
+	index->node[0] = NULL;
+	index->count = 1;
+
+	err = treeview_walk_internal(tree, tree->root,
+			TREEVIEW_WALK_MODE_LOGICAL_COMPLETE, NULL,
+			treeview__search_index_walk_cb, tree);
+	if (err != NSERROR_OK) {
+		treeview__search_index_destroy(tree);
+		return err;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Ensure the match list can hold a number of ids.
+ *
+ * \param[in] search  Treeview search details.
+ * \param[in] count   Number of ids required.
+ * \return true on success, false on memory exhaustion.
+ */
+static bool treeview__search_match_reserve(
+		struct treeview_search *search,
+		uint32_t count)
+{
+	uint32_t *match;
+
+	if (count <= search->match_alloc) {
+		return true;
+	}
+
+	match = realloc(search->match, count * sizeof(*match));
+	if (match == NULL) {
+		return false;
+	}
+	search->match = match;
+	search->match_alloc = count;
+
+	return true;
+}
+
+
+/**
+ * Update the search index for a created or changed entry.
+ *
+ * If there is a match list, the entry is added to it so the next
+ * search considers it.
+ *
+ * \param[in] tree  Treeview the entry belongs to.
+ * \param[in] n     Entry node that was created or changed.
+ */
+static void treeview__search_index_update(treeview *tree, treeview_node *n)
+{
+	struct treeview_search *search = &tree->search;
+	struct treeview_node_entry *e = (struct treeview_node_entry *)n;
+	uint32_t old_id = e->search_id;
+	uint32_t i;
+
+	if (search->index == NULL) {
+		return;
+	}
+
+	if (old_id != 0) {
+		/* Changed entry; its old id goes stale like a deleted
+		 * entry's, counting towards the index being rebuilt
+		 */
+		search->index->node[old_id] = NULL;
+		search->index->live--;
+		e->search_id = 0;
+	}
+
+	if (!treeview__search_index_entry(tree, n) ||
+	    (search->last != NULL &&
+	     !treeview__search_match_reserve(search, search->n_match + 1))) {
+		/* Fall back to rebuilding index at next search */
+		treeview__search_index_destroy(tree);
+		return;
+	}
+
+	if (search->last == NULL) {
+		return;
+	}
+
+	if (n->flags & TV_NFLAGS_MATCHED) {
+		/* Already in the match list under its old id */
+		for (i = 0; i < search->n_match; i++) {
+			if (search->match[i] == old_id) {
+				search->match[i] = e->search_id;
 				break;
 			}
 		}
+	} else {
+		search->match[search->n_match++] = e->search_id;
 	}
+}
 
-	if (!matched && strcasestr(n->text.data, sw->text) != NULL) {
-		matched = true;
+
+/**
+ * Remove an entry that is being deleted from the search index.
+ *
+ * \param[in] tree  Treeview the entry belongs to.
+ * \param[in] n     Entry node being deleted.
+ */
+static void treeview__search_index_remove(treeview *tree, treeview_node *n)
+{
+	struct treeview_search_index *index = tree->search.index;
+	uint32_t id = ((struct treeview_node_entry *)n)->search_id;
+
+	if (index == NULL || id == 0) {
+		return;
 	}
 
-	if (matched) {
-		n->flags |= TV_NFLAGS_MATCHED;
-		sw->window_height += n->height;
+	index->node[id] = NULL;
+	index->live--;
+}
+
+
+/**
+ * Clear the results of the last indexed search.
+ *
+ * \param[in] tree  Treeview with a search index.
+ */
+static void treeview__search_index_clear(treeview *tree)
+{
+	struct treeview_search *search = &tree->search;
+	uint32_t i;
+
+	for (i = 0; i < search->n_match; i++) {
+		treeview_node *n = search->index->node[search->match[i]];
+		if (n != NULL) {
+			n->flags &= ~TV_NFLAGS_MATCHED;
+		}
+	}
+	search->n_match = 0;
+
+	free(search->last);
+	search->last = NULL;
+}
+
+
+/**
+ * Search treeview for text using its search index.
+ *
+ * When the term contains the last search's term, only entries that
+ * matched last time (or changed since) are checked.  Otherwise for
+ * terms of three or more bytes, only entries on the shortest list of
+ * any of the term's trigrams are checked.
+ *
+ * \param[in]  tree    Treeview to search.
+ * \param[in]  text    UTF-8 string to search for.  (NULL-terminated.)
+ * \param[in]  len     Byte length of UTF-8 string, greater than 0.
+ * \param[out] height  Updated to add height of matching entries.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror treeview__search_indexed(
+		treeview *tree,
+		const char *text,
+		unsigned int len,
+		int *height)
+{
+	struct treeview_search *search = &tree->search;
+	struct treeview_search_index *index = search->index;
+	const uint32_t *cand = NULL;
+	uint32_t n_cand;
+	uint32_t n_match = 0;
+	bool all = false;
+	uint32_t i;
+	char *last;
+
+	/* Rebuild the index once most of its ids are stale, from
+	 * entries being deleted or changed
+	 */
+	if (index != NULL && index->count > index->live * 2 + 1024) {
+		treeview__search_index_destroy(tree);
+		index = NULL;
+	}
+
+	if (index == NULL) {
+		nserror err = treeview__search_index_build(tree);
+		if (err != NSERROR_OK) {
+			return err;
+		}
+		index = search->index;
+	}
+
+	last = strdup(text);
+	if (last == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	if (search->last != NULL && strcasestr(text, search->last) != NULL) {
+		/* Narrowing the last search; check its matches in place */
+		cand = search->match;
+		n_cand = search->n_match;
+
+	} else if (len >= 3) {
+		struct treeview_trigram *best = NULL;
+		uint32_t w = 0;
+
+		for (i = 0; i + 3 <= len; i++) {
+			struct treeview_trigram *t = treeview__trigram_find(
+					index, treeview__trigram_key(text + i));
+			if (best == NULL || t->count < best->count) {
+				best = t;
+			}
+		}
+
+		/* Drop ids of deleted entries from the list */
+		for (i = 0; i < best->count; i++) {
+			if (index->node[best->id[i]] != NULL) {
+				best->id[w++] = best->id[i];
+			}
+		}
+		best->count = w;
+
+		cand = best->id;
+		n_cand = best->count;
+
 	} else {
-		n->flags &= ~TV_NFLAGS_MATCHED;
+		/* Too short for trigrams; check every entry */
+		all = true;
+		n_cand = index->count - 1;
+	}
+
+	if (!treeview__search_match_reserve(search,
+			all ? index->live : n_cand)) {
+		free(last);
+		return NSERROR_NOMEM;
+	}
+
+	/* Clear the old matches, once the list is known to be usable */
+	for (i = 0; i < search->n_match; i++) {
+		treeview_node *n = index->node[search->match[i]];
+		if (n != NULL) {
+			n->flags &= ~TV_NFLAGS_MATCHED;
+		}
+	}
+
+	/* The match list may be cand, but is never written ahead of it */
+	for (i = 0; i < n_cand; i++) {
+		uint32_t id = all ? i + 1 : cand[i];
+		treeview_node *n = index->node[id];
+
+		if (n == NULL || (n->flags & TV_NFLAGS_MATCHED)) {
+			/* Deleted, or already seen in this search */
+			continue;
+		}
+
+		if (treeview__search_match(tree, n, text)) {
+			n->flags |= TV_NFLAGS_MATCHED;
+			*height += n->height;
+			search->match[n_match++] = id;
+		}
 	}
+	search->n_match = n_match;
+
+	free(search->last);
+	search->last = last;
 
 	return NSERROR_OK;
 }
@@ -874,6 +1799,7 @@ static nserror treeview__search(
 	uint32_t height;
 	uint32_t prev_height = treeview__get_display_height(tree);
 	int search_height = treeview__get_search_height(tree);
+	bool walk = true;
 	struct treeview_search_walk_data sw = {
 		.len = len,
 		.text = text,
@@ -892,11 +1818,31 @@ static nserror treeview__search(
 		return NSERROR_OK;
 	}
 
-	err = treeview_walk_internal(tree, tree->root,
-			TREEVIEW_WALK_MODE_LOGICAL_COMPLETE, NULL,
-			treeview__search_walk_cb, &sw);
-	if (err != NSERROR_OK) {
-		return err;
+	if (len > 0) {
+		/* Search must see every node */
+		treeview__populate_all(tree);
+
+		err = treeview__search_indexed(tree, text, len,
+				&sw.window_height);
+		if (err == NSERROR_OK) {
+			walk = false;
+		} else {
+			NSLOG(netsurf, INFO, "Indexed search failed: %d", err);
+			treeview__search_index_destroy(tree);
+			sw.window_height = 0;
+		}
+	} else if (tree->search.index != NULL) {
+		treeview__search_index_clear(tree);
+		walk = false;
+	}
+
+	if (walk) {
+		err = treeview_walk_internal(tree, tree->root,
+				TREEVIEW_WALK_MODE_LOGICAL_COMPLETE, NULL,
+				treeview__search_walk_cb, &sw);
+		if (err != NSERROR_OK) {
+			return err;
+		}
 	}
 
 	if (len > 0) {
@@ -1081,6 +2027,7 @@ static nserror treeview_create_node_root(treeview_node **root)
 
 	n->height = 0;
 	n->inset = tree_g.window_padding - tree_g.step_width;
+	n->row = -1;
 
 	n->text.data = NULL;
 	n->text.len = 0;
@@ -1169,6 +2116,10 @@ treeview_insert_node(
 
 	assert(a->parent != NULL);
 
+	if (a->parent->flags & TV_NFLAGS_EXPANDED) {
+		treeview__rows_invalidate(tree);
+	}
+
 	a->inset = a->parent->inset + tree_g.step_width;
 	if (a->children != NULL) {
 		treeview_walk_internal(tree, a,
@@ -1223,9 +2174,14 @@ treeview_create_node_folder(treeview *tree,
 
 	n->flags = (flags & TREE_OPTION_SPECIAL_DIR) ?
 		TV_NFLAGS_SPECIAL : TV_NFLAGS_NONE;
+	if (flags & TREE_OPTION_LAZY) {
+		n->flags |= TV_NFLAGS_LAZY;
+		tree->lazy++;
+	}
 	n->type = TREE_NODE_FOLDER;
 
 	n->height = tree_g.line_height;
+	n->row = -1;
 
 	n->text.data = field->value;
 	n->text.len = field->value_len;
@@ -1369,6 +2325,7 @@ treeview_update_node_entry(treeview *tree,
 		}
 	}
 
+	treeview__search_index_update(tree, entry);
 	treeview__search_update_display(tree);
 
 	/* Redraw */
@@ -1422,6 +2379,7 @@ treeview_create_node_entry(treeview *tree,
 	n->type = TREE_NODE_ENTRY;
 
 	n->height = tree_g.line_height;
+	n->row = -1;
 
 	assert(fields != NULL);
 	assert(fields[0].field != NULL);
@@ -1449,8 +2407,10 @@ treeview_create_node_entry(treeview *tree,
 		e->fields[i - 1].value.len = fields[i].value_len;
 		e->fields[i - 1].value.width = 0;
 	}
+	e->search_id = 0;
 
 	treeview_insert_node(tree, n, relation, rel);
+	treeview__search_index_update(tree, n);
 
 	if (n->parent->flags & TV_NFLAGS_EXPANDED) {
 		/* Inform front end of change in dimensions */
@@ -1564,11 +2524,17 @@ treeview_walk(treeview *tree,
 /**
  * Unlink a treeview node
  *
+ * \param tree Treeview containing node
  * \param n Node to unlink
  * \return true iff ancestor heights need to be reduced
  */
-static inline bool treeview_unlink_node(treeview_node *n)
+static inline bool treeview_unlink_node(treeview *tree, treeview_node *n)
 {
+	/* Children of contracted folders are not displayed */
+	if ((n->parent == NULL) || (n->parent->flags & TV_NFLAGS_EXPANDED)) {
+		treeview__rows_invalidate(tree);
+	}
+
 	/* Unlink node from tree */
 	if (n->parent != NULL && n->parent->children == n) {
 		/* Node is a first child */
@@ -1712,17 +2678,21 @@ treeview_delete_node_walk_cb(treeview_node *n, void *ctx, bool *end)
 
 	assert(n->children == NULL);
 
-	if (treeview_unlink_node(n))
+	if (treeview_unlink_node(nd->tree, n))
 		nd->h_reduction += (n->type == TREE_NODE_ENTRY) ?
 			n->height : tree_g.line_height;
 
 	/* Handle any special treatment */
 	switch (n->type) {
 	case TREE_NODE_ENTRY:
+		treeview__search_index_remove(nd->tree, n);
 		nd->tree->callbacks->entry(msg, n->client_data);
 		break;
 
 	case TREE_NODE_FOLDER:
+		if (n->flags & TV_NFLAGS_LAZY) {
+			nd->tree->lazy--;
+		}
 		nd->tree->callbacks->folder(msg, n->client_data);
 		break;
 
@@ -1861,7 +2831,8 @@ static nserror treeview_delete_empty_nodes(treeview *tree, bool interaction)
 			while (node->parent != NULL &&
 			       next_sibling == NULL) {
 				if (node->type == TREE_NODE_FOLDER &&
-				    node->children == NULL) {
+				    node->children == NULL &&
+				    !(node->flags & TV_NFLAGS_LAZY)) {
 					/* Delete node */
 					p = node->parent;
 					err = treeview_delete_node_walk_cb(
@@ -1888,7 +2859,8 @@ static nserror treeview_delete_empty_nodes(treeview *tree, bool interaction)
 				break;
 
 			if (node->type == TREE_NODE_FOLDER &&
-			    node->children == NULL) {
+			    node->children == NULL &&
+			    !(node->flags & TV_NFLAGS_LAZY)) {
 				/* Delete node */
 				p = node->parent;
 				err = treeview_delete_node_walk_cb(
@@ -2057,6 +3029,13 @@ treeview_create(treeview **treeout,
 		return error;
 	}
 
+	tree->rows.node = NULL;
+	tree->rows.y = NULL;
+	tree->rows.count = 0;
+	tree->rows.alloc = 0;
+	tree->rows.valid = false;
+	tree->lazy = 0;
+
 	tree->field_width = 0;
 	for (fldidx = 0; fldidx < n_fields; fldidx++) {
 		struct treeview_field *f = &(tree->fields[fldidx]);
@@ -2101,6 +3080,12 @@ treeview_create(treeview **treeout,
 	tree->edit.textarea = NULL;
 	tree->edit.node = NULL;
 
+	tree->search.index = NULL;
+	tree->search.last = NULL;
+	tree->search.match = NULL;
+	tree->search.n_match = 0;
+	tree->search.match_alloc = 0;
+
 	if (flags & TREEVIEW_SEARCHABLE) {
 		tree->search.textarea = treeview__create_textarea(
 				tree, 600, tree_g.line_height,
@@ -2174,6 +3159,13 @@ nserror treeview_destroy(treeview *tree)
 				      TREE_OPTION_SUPPRESS_RESIZE |
 				      TREE_OPTION_SUPPRESS_REDRAW);
 
+	/* Destroy row index */
+	free(tree->rows.node);
+	free(tree->rows.y);
+
+	/* Destroy search index */
+	treeview__search_index_destroy(tree);
+
 	/* Destroy feilds */
 	for (f = 0; f <= tree->n_fields; f++) {
 		lwc_string_unref(tree->fields[f].field);
@@ -2214,6 +3206,8 @@ treeview_node_expand_internal(treeview *tree, treeview_node *node)
 
 	switch (node->type) {
 	case TREE_NODE_FOLDER:
+		treeview__populate(tree, node);
+
 		child = node->children;
 		if (child == NULL) {
 			/* Allow expansion of empty folders */
@@ -2273,6 +3267,8 @@ treeview_node_expand_internal(treeview *tree, treeview_node *node)
 				additional_height_folders;
 	}
 
+	treeview__rows_relayout(tree, node);
+
 	if (tree->search.search &&
 			node->type == TREE_NODE_ENTRY &&
 			node->flags & TV_NFLAGS_MATCHED) {
@@ -2406,6 +3402,8 @@ treeview_node_contract_internal(treeview *tree, treeview_node *node)
 	if (selected)
 		node->flags |= TV_NFLAGS_SELECTED;
 
+	treeview__rows_relayout(tree, node);
+
 	/* Inform front end of change in dimensions */
 	treeview__cw_update_size(tree, -1, treeview__get_display_height(tree));
 
@@ -2471,6 +3469,8 @@ nserror treeview_contract(treeview *tree, bool all)
 			n->flags |= TV_NFLAGS_SELECTED;
 	}
 
+	treeview__rows_invalidate(tree);
+
 	/* Inform front end of change in dimensions */
 	treeview__cw_update_size(tree, -1, tree->root->height);
 
@@ -2536,6 +3536,12 @@ nserror treeview_expand(treeview *tree, bool only_folders)
 	data.tree = tree;
 	data.only_folders = only_folders;
 
+	/* Expansion must reach the children of every folder */
+	treeview__populate_all(tree);
+
+	/* Rebuild the row index once, rather than per expanded node */
+	treeview__rows_invalidate(tree);
+
 	res = treeview_walk_internal(tree, tree->root,
 			TREEVIEW_WALK_MODE_LOGICAL_COMPLETE,
 			NULL, treeview_expand_cb, &data);
@@ -2596,6 +3602,18 @@ static void treeview_redraw_tree(
 		sel_max = tree->drag.prev.y;
 	}
 
+	/* Skip straight to the first row reaching the clip region */
+	if (treeview__rows_update(tree)) {
+		int row = treeview__rows_find(tree, r->y0 - render_y - 1);
+
+		if (row > 0 && row < tree->rows.count) {
+			/* Resume the walk from the node before that row */
+			node = tree->rows.node[row - 1];
+			count = row;
+			render_y += tree->rows.y[row];
+		}
+	}
+
 	while (node != NULL) {
 		struct treeview_node_entry *entry;
 		struct bitmap *furniture;
@@ -3242,7 +4260,7 @@ treeview_node_selection_walk_cb(treeview_node *n,
 				break;
 			}
 
-			if (treeview_unlink_node(n))
+			if (treeview_unlink_node(sw->tree, n))
 				h = n->height;
 
 			/* Reduce ancestor heights */
@@ -4900,9 +5918,27 @@ treeview_mouse_action(treeview *tree, browser_mouse_state mouse, int x, int y)
 			.search_height = search_height,
 		};
 
-		treeview_walk_internal(tree, tree->root,
-				TREEVIEW_WALK_MODE_DISPLAY, NULL,
-				treeview_node_mouse_action_cb, &ma);
+		if ((tree->search.search == false) &&
+		    treeview__rows_update(tree)) {
+			/* Go directly to the row reaching the mouse */
+			bool skip_children = false;
+			bool end = false;
+			int offset = y - search_height - 1;
+			int row;
+
+			row = treeview__rows_find(tree,
+					(offset < 0) ? 0 : offset);
+			if (row < tree->rows.count) {
+				ma.current_y += tree->rows.y[row];
+				treeview_node_mouse_action_cb(
+						tree->rows.node[row], &ma,
+						&skip_children, &end);
+			}
+		} else {
+			treeview_walk_internal(tree, tree->root,
+					TREEVIEW_WALK_MODE_DISPLAY, NULL,
+					treeview_node_mouse_action_cb, &ma);
+		}
 	}
 }
 
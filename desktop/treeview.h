@@ -64,7 +64,8 @@ typedef enum {
 	TREE_OPTION_NONE		= (0),		/* No flags set */
 	TREE_OPTION_SPECIAL_DIR		= (1 << 0),	/* Special folder */
 	TREE_OPTION_SUPPRESS_RESIZE	= (1 << 1),	/* Suppress callback */
-	TREE_OPTION_SUPPRESS_REDRAW	= (1 << 2)	/* Suppress callback */
+	TREE_OPTION_SUPPRESS_REDRAW	= (1 << 2),	/* Suppress callback */
+	TREE_OPTION_LAZY		= (1 << 3)	/* Populate on demand */
 } treeview_node_options_flags;
 
 /**
@@ -85,7 +86,8 @@ typedef enum {
 enum treeview_msg {
 	TREE_MSG_NODE_DELETE,		/**< Node to be deleted */
 	TREE_MSG_NODE_EDIT,		/**< Node to be edited */
-	TREE_MSG_NODE_LAUNCH		/**< Node to be launched */
+	TREE_MSG_NODE_LAUNCH,		/**< Node to be launched */
+	TREE_MSG_NODE_POPULATE		/**< Lazy folder's children needed */
 };
 
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer damage accumulation implementation.
+ *
+ * The cost of redrawing a rectangle is modelled as its area plus a fixed
+ * cost for the content traversal, expressed in pixels. Two rectangles
+ * are merged when their union costs no more than the pair does.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/utils.h"
+
+#include "framebuffer/damage.h"
+
+/**
+ * Fixed cost of a redraw in pixels.
+ *
+ * The time taken to walk the content and set up the plotters for a
+ * redraw, roughly that of plotting a 64 pixel square.
+ */
+#define FB_DAMAGE_REDRAW_COST (64 * 64)
+
+/**
+ * Area of a rectangle.
+ */
+static inline int64_t damage_area(const nsfb_bbox_t *rect)
+{
+	return (int64_t)(rect->x1 - rect->x0) * (rect->y1 - rect->y0);
+}
+
+/**
+ * Union of two rectangles.
+ */
+static inline void
+damage_union(const nsfb_bbox_t *a, const nsfb_bbox_t *b, nsfb_bbox_t *out)
+{
+	out->x0 = min(a->x0, b->x0);
+	out->y0 = min(a->y0, b->y0);
+	out->x1 = max(a->x1, b->x1);
+	out->y1 = max(a->y1, b->y1);
+}
+
+/**
+ * Find whether a rectangle contains another.
+ */
+static inline bool
+damage_contains(const nsfb_bbox_t *outer, const nsfb_bbox_t *inner)
+{
+	return ((outer->x0 <= inner->x0) &&
+		(outer->y0 <= inner->y0) &&
+		(outer->x1 >= inner->x1) &&
+		(outer->y1 >= inner->y1));
+}
+
+/**
+ * Cost of redrawing the union of two rectangles less that of redrawing
+ * them separately.
+ */
+static inline int64_t
+damage_merge_cost(const nsfb_bbox_t *a, const nsfb_bbox_t *b)
+{
+	nsfb_bbox_t u;
+
+	damage_union(a, b, &u);
+
+	return damage_area(&u) - damage_area(a) - damage_area(b) -
+		FB_DAMAGE_REDRAW_COST;
+}
+
+/**
+ * Remove a rectangle from a damage set.
+ */
+static inline void damage_remove(struct fb_damage *damage, unsigned int idx)
+{
+	damage->count--;
+	damage->rect[idx] = damage->rect[damage->count];
+}
+
+
+/* exported interface documented in framebuffer/damage.h */
+void fb_damage_clear(struct fb_damage *damage)
+{
+	damage->count = 0;
+}
+
+
+/* exported interface documented in framebuffer/damage.h */
+void fb_damage_add(struct fb_damage *damage, const nsfb_bbox_t *area)
+{
+	nsfb_bbox_t rect = *area;
+	unsigned int idx;
+	unsigned int best;
+	int64_t best_cost;
+	int64_t cost;
+
+	if ((rect.x1 <= rect.x0) || (rect.y1 <= rect.y0)) {
+		return;
+	}
+
+	for (;;) {
+		best = damage->count;
+		best_cost = INT64_MAX;
+
+		for (idx = 0; idx < damage->count; idx++) {
+			if (damage_contains(&damage->rect[idx], &rect)) {
+				/* already damaged */
+				return;
+			}
+
+			cost = damage_merge_cost(&damage->rect[idx], &rect);
+			if (cost < best_cost) {
+				best = idx;
+				best_cost = cost;
+			}
+		}
+
+		if ((best == damage->count) ||
+		    ((best_cost > 0) && (damage->count < FB_DAMAGE_MAX))) {
+			/* cheaper to redraw separately and there is room */
+			break;
+		}
+
+		/* merge with the cheapest rectangle and try the union
+		 * against the remainder, which it may now cover
+		 */
+		damage_union(&damage->rect[best], &rect, &rect);
+		damage_remove(damage, best);
+	}
+
+	damage->rect[damage->count++] = rect;
+}
+
+
+/* exported interface documented in framebuffer/damage.h */
+void
+fb_damage_translate(struct fb_damage *damage,
+		    int dx, int dy,
+		    int width, int height)
+{
+	struct fb_damage moved = *damage;
+	nsfb_bbox_t rect;
+	unsigned int idx;
+
+	/* clipping may leave one rectangle inside another so the moved
+	 * rectangles are added back rather than updated in place
+	 */
+	fb_damage_clear(damage);
+
+	for (idx = 0; idx < moved.count; idx++) {
+		rect.x0 = max(moved.rect[idx].x0 + dx, 0);
+		rect.y0 = max(moved.rect[idx].y0 + dy, 0);
+		rect.x1 = min(moved.rect[idx].x1 + dx, width);
+		rect.y1 = min(moved.rect[idx].y1 + dy, height);
+
+		fb_damage_add(damage, &rect);
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer damage accumulation interface.
+ *
+ * Areas of a window needing redraw are collected into a small set of
+ * rectangles until the window is next redrawn. Each rectangle costs a
+ * traversal of the content to redraw, so a new area is merged with an
+ * existing rectangle whenever redrawing their union is expected to be
+ * cheaper than redrawing both separately.
+ */
+
+#ifndef NETSURF_FB_DAMAGE_H
+#define NETSURF_FB_DAMAGE_H
+
+#include <stdbool.h>
+#include <libnsfb.h>
+
+/** maximum number of separate rectangles in a damage set */
+#define FB_DAMAGE_MAX 8
+
+/**
+ * A set of damaged rectangles.
+ *
+ * The rectangles are in window co-ordinates and none contains another.
+ */
+struct fb_damage {
+	unsigned int count; /**< number of rectangles */
+	nsfb_bbox_t rect[FB_DAMAGE_MAX]; /**< the rectangles */
+};
+
+/**
+ * Empty a damage set.
+ *
+ * \param damage The damage set to empty.
+ */
+void fb_damage_clear(struct fb_damage *damage);
+
+/**
+ * Add an area to a damage set.
+ *
+ * \param damage The damage set to add to.
+ * \param area The area to add, which is ignored if empty.
+ */
+void fb_damage_add(struct fb_damage *damage, const nsfb_bbox_t *area);
+
+/**
+ * Move a damage set.
+ *
+ * Used when the contents of a window are copied to a new position so
+ * the pending damage follows the pixels it applies to. Rectangles are
+ * clipped to the window and dropped if they leave it entirely.
+ *
+ * \param damage The damage set to move.
+ * \param dx The horizontal distance to move by.
+ * \param dy The vertical distance to move by.
+ * \param width The width of the window.
+ * \param height The height of the window.
+ */
+void fb_damage_translate(struct fb_damage *damage, int dx, int dy, int width, int height);
+
+/**
+ * Find whether a damage set is empty.
+ *
+ * \param damage The damage set to check.
+ * \return true if there is no damage in the set else false.
+ */
+static inline bool fb_damage_empty(const struct fb_damage *damage)
+{
+	return damage->count == 0;
+}
+
+#endif
@@ -35,6 +35,7 @@
 #include "framebuffer/gui.h"
 #include "framebuffer/font.h"
 #include "framebuffer/findfile.h"
+#include "framebuffer/glyph_cache.h"
 
 /* glyph cache minimum size */
 #define CACHE_MIN_SIZE (100 * 1024)
@@ -317,6 +318,8 @@ bool fb_font_finalise(void)
 {
 	int i, j;
 
+	fb_glyph_cache_finalise();
+
         FTC_Manager_Done(ft_cmanager);
         FT_Done_FreeType(library);
 
@@ -398,24 +401,23 @@ static void fb_fill_scalar(const plot_font_style_t *fstyle, FTC_Scaler srec)
 	srec->x_res = srec->y_res = browser_get_dpi();
 }
 
-/* exported interface documented in framebuffer/freetype_font.h */
-FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4)
+/**
+ * Look up a glyph in the freetype cache.
+ */
+static FT_Glyph fb_lookup_glyph(FTC_Scaler srec, uint32_t ucs4)
 {
         FT_UInt glyph_index;
-        FTC_ScalerRec srec;
         FT_Glyph glyph;
         FT_Error error;
         fb_faceid_t *fb_face; 
 
-        fb_fill_scalar(fstyle, &srec);
+        fb_face = (fb_faceid_t *)srec->face_id;
 
-        fb_face = (fb_faceid_t *)srec.face_id;
-
-        glyph_index = FTC_CMapCache_Lookup(ft_cmap_cache, srec.face_id,
+        glyph_index = FTC_CMapCache_Lookup(ft_cmap_cache, srec->face_id,
 			fb_face->cidx, ucs4);
 
         error = FTC_ImageCache_LookupScaler(ft_image_cache, 
-                                            &srec, 
+                                            srec, 
                                             FT_LOAD_RENDER | 
                                             FT_LOAD_FORCE_AUTOHINT | 
                                             ft_load_type, 
@@ -428,6 +430,87 @@ FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4)
         return glyph;
 }
 
+/* exported interface documented in framebuffer/freetype_font.h */
+FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4)
+{
+        FTC_ScalerRec srec;
+
+        fb_fill_scalar(fstyle, &srec);
+
+        return fb_lookup_glyph(&srec, ucs4);
+}
+
+/**
+ * Rasterise a glyph for the glyph cache.
+ */
+static nserror
+fb_render_glyph(const void *face,
+		int size,
+		int resolution,
+		uint32_t ucs4,
+		struct fb_glyph_bitmap *bitmap)
+{
+        FTC_ScalerRec srec;
+        FT_Glyph glyph;
+        FT_BitmapGlyph bglyph;
+
+        srec.face_id = (FTC_FaceID)face;
+        srec.width = srec.height = size;
+        srec.pixel = 0;
+        srec.x_res = srec.y_res = resolution;
+
+        glyph = fb_lookup_glyph(&srec, ucs4);
+        if (glyph == NULL)
+                return NSERROR_NOT_FOUND;
+
+        memset(bitmap, 0, sizeof(*bitmap));
+        bitmap->advance = glyph->advance.x >> 16;
+
+        if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
+                bglyph = (FT_BitmapGlyph)glyph;
+
+                bitmap->left = bglyph->left;
+                bitmap->top = bglyph->top;
+                bitmap->width = bglyph->bitmap.width;
+                bitmap->rows = bglyph->bitmap.rows;
+                bitmap->pitch = bglyph->bitmap.pitch;
+                bitmap->buffer = bglyph->bitmap.buffer;
+                bitmap->mono = (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO);
+        }
+
+        return NSERROR_OK;
+}
+
+/**
+ * Get the glyph cache strike for a plot style.
+ */
+static struct fb_glyph_strike *fb_font_strike(const plot_font_style_t *fstyle)
+{
+        FTC_ScalerRec srec;
+
+        fb_fill_scalar(fstyle, &srec);
+
+        return fb_glyph_strike_get(srec.face_id,
+                                   srec.width,
+                                   srec.x_res,
+                                   fb_render_glyph);
+}
+
+/* exported interface documented in framebuffer/freetype_font.h */
+nserror
+fb_font_run(const plot_font_style_t *fstyle,
+	    const char *string, size_t length,
+	    const struct fb_glyph_run **run_out)
+{
+        struct fb_glyph_strike *strike;
+
+        strike = fb_font_strike(fstyle);
+        if (strike == NULL)
+                return NSERROR_NOMEM;
+
+        return fb_glyph_run(strike, string, length, run_out);
+}
+
 
 /* exported interface documented in framebuffer/freetype_font.h */
 nserror
@@ -437,18 +520,23 @@ fb_font_width(const plot_font_style_t *fstyle,
 {
         uint32_t ucs4;
         size_t nxtchr = 0;
-        FT_Glyph glyph;
+        struct fb_glyph_strike *strike;
+        const struct fb_glyph *glyph;
+
+        strike = fb_font_strike(fstyle);
+        if (strike == NULL)
+                return NSERROR_NOMEM;
 
         *width = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
                 nxtchr = utf8_next(string, length, nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
+                glyph = fb_glyph_get(strike, ucs4);
                 if (glyph == NULL)
                         continue;
 
-                *width += glyph->advance.x >> 16;
+                *width += glyph->advance;
         }
 	return NSERROR_OK;
 }
@@ -462,18 +550,23 @@ fb_font_position(const plot_font_style_t *fstyle,
 {
         uint32_t ucs4;
         size_t nxtchr = 0;
-        FT_Glyph glyph;
+        struct fb_glyph_strike *strike;
+        const struct fb_glyph *glyph;
         int prev_x = 0;
 
+        strike = fb_font_strike(fstyle);
+        if (strike == NULL)
+                return NSERROR_NOMEM;
+
         *actual_x = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
+                glyph = fb_glyph_get(strike, ucs4);
                 if (glyph == NULL)
                         continue;
 
-                *actual_x += glyph->advance.x >> 16;
+                *actual_x += glyph->advance;
                 if (*actual_x > x)
                         break;
 
@@ -521,13 +614,18 @@ fb_font_split(const plot_font_style_t *fstyle,
         size_t nxtchr = 0;
         int last_space_x = 0;
         int last_space_idx = 0;
-        FT_Glyph glyph;
+        struct fb_glyph_strike *strike;
+        const struct fb_glyph *glyph;
+
+        strike = fb_font_strike(fstyle);
+        if (strike == NULL)
+                return NSERROR_NOMEM;
 
         *actual_x = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
+                glyph = fb_glyph_get(strike, ucs4);
                 if (glyph == NULL)
                         continue;
 
@@ -536,7 +634,7 @@ fb_font_split(const plot_font_style_t *fstyle,
                         last_space_idx = nxtchr;
                 }
 
-                *actual_x += glyph->advance.x >> 16;
+                *actual_x += glyph->advance;
                 if (*actual_x > x && last_space_idx != 0) {
                         /* string has exceeded available width and we've
                          * found a space; return previous space */
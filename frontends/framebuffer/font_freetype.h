@@ -27,4 +27,17 @@ extern int ft_load_type;
 
 FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4);
 
+struct fb_glyph_run;
+
+/**
+ * Get the run of glyphs of a string from the glyph cache.
+ *
+ * \param[in] fstyle plot style for this text
+ * \param[in] string UTF-8 string to lay out
+ * \param[in] length length of string, in bytes
+ * \param[out] run_out updated with the run
+ * \return NSERROR_OK and run_out updated or appropriate error code on faliure
+ */
+nserror fb_font_run(const plot_font_style_t *fstyle, const char *string, size_t length, const struct fb_glyph_run **run_out);
+
 #endif /* NETSURF_FB_FONT_FREETYPE_H */
@@ -40,11 +40,30 @@
 #include "framebuffer/framebuffer.h"
 #include "framebuffer/font.h"
 #include "framebuffer/bitmap.h"
+#include "framebuffer/glyph_cache.h"
 
 /* netsurf framebuffer library handle */
 static nsfb_t *nsfb;
 
 
+/**
+ * Get the surface a plot operation renders into.
+ *
+ * A redraw context may carry its own surface as its private context,
+ * otherwise the current framebuffer surface is used.
+ *
+ * \param ctx The current redraw context.
+ * \return The surface to plot into.
+ */
+static inline nsfb_t *framebuffer_plot_surface(const struct redraw_context *ctx)
+{
+	if (ctx->priv != NULL) {
+		return ctx->priv;
+	}
+	return nsfb;
+}
+
+
 /**
  * \brief Sets a clip rectangle for subsequent plot operations.
  *
@@ -56,13 +75,14 @@ static nsfb_t *nsfb;
 static nserror
 framebuffer_plot_clip(const struct redraw_context *ctx, const struct rect *clip)
 {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
 	nsfb_bbox_t nsfb_clip;
 	nsfb_clip.x0 = clip->x0;
 	nsfb_clip.y0 = clip->y0;
 	nsfb_clip.x1 = clip->x1;
 	nsfb_clip.y1 = clip->y1;
 
-	if (!nsfb_plot_set_clip(nsfb, &nsfb_clip)) {
+	if (!nsfb_plot_set_clip(fb, &nsfb_clip)) {
 		return NSERROR_INVALID;
 	}
 	return NSERROR_OK;
@@ -90,7 +110,9 @@ framebuffer_plot_arc(const struct redraw_context *ctx,
 	       const plot_style_t *style,
 	       int x, int y, int radius, int angle1, int angle2)
 {
-	if (!nsfb_plot_arc(nsfb, x, y, radius, angle1, angle2, style->fill_colour)) {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
+
+	if (!nsfb_plot_arc(fb, x, y, radius, angle1, angle2, style->fill_colour)) {
 		return NSERROR_INVALID;
 	}
 	return NSERROR_OK;
@@ -114,6 +136,7 @@ framebuffer_plot_disc(const struct redraw_context *ctx,
 		const plot_style_t *style,
 		int x, int y, int radius)
 {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
 	nsfb_bbox_t ellipse;
 	ellipse.x0 = x - radius;
 	ellipse.y0 = y - radius;
@@ -121,11 +144,11 @@ framebuffer_plot_disc(const struct redraw_context *ctx,
 	ellipse.y1 = y + radius;
 
 	if (style->fill_type != PLOT_OP_TYPE_NONE) {
-		nsfb_plot_ellipse_fill(nsfb, &ellipse, style->fill_colour);
+		nsfb_plot_ellipse_fill(fb, &ellipse, style->fill_colour);
 	}
 
 	if (style->stroke_type != PLOT_OP_TYPE_NONE) {
-		nsfb_plot_ellipse(nsfb, &ellipse, style->stroke_colour);
+		nsfb_plot_ellipse(fb, &ellipse, style->stroke_colour);
 	}
 	return NSERROR_OK;
 }
@@ -147,6 +170,7 @@ framebuffer_plot_line(const struct redraw_context *ctx,
 		const plot_style_t *style,
 		const struct rect *line)
 {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
 	nsfb_bbox_t rect;
 	nsfb_plot_pen_t pen;
 
@@ -169,7 +193,7 @@ framebuffer_plot_line(const struct redraw_context *ctx,
 
 		pen.stroke_colour = style->stroke_colour;
 		pen.stroke_width = plot_style_fixed_to_int(style->stroke_width);
-		nsfb_plot_line(nsfb, &rect, &pen);
+		nsfb_plot_line(fb, &rect, &pen);
 	}
 
 	return NSERROR_OK;
@@ -194,6 +218,7 @@ framebuffer_plot_rectangle(const struct redraw_context *ctx,
 		     const plot_style_t *style,
 		     const struct rect *nsrect)
 {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
 	nsfb_bbox_t rect;
 	bool dotted = false;
 	bool dashed = false;
@@ -204,7 +229,7 @@ framebuffer_plot_rectangle(const struct redraw_context *ctx,
 	rect.y1 = nsrect->y1;
 
 	if (style->fill_type != PLOT_OP_TYPE_NONE) {
-		nsfb_plot_rectangle_fill(nsfb, &rect, style->fill_colour);
+		nsfb_plot_rectangle_fill(fb, &rect, style->fill_colour);
 	}
 
 	if (style->stroke_type != PLOT_OP_TYPE_NONE) {
@@ -216,7 +241,7 @@ framebuffer_plot_rectangle(const struct redraw_context *ctx,
 			dashed = true;
 		}
 
-		nsfb_plot_rectangle(nsfb, &rect,
+		nsfb_plot_rectangle(fb, &rect,
 				plot_style_fixed_to_int(style->stroke_width),
 				style->stroke_colour, dotted, dashed);
 	}
@@ -244,7 +269,9 @@ framebuffer_plot_polygon(const struct redraw_context *ctx,
 		   const int *p,
 		   unsigned int n)
 {
-	if (!nsfb_plot_polygon(nsfb, p, n, style->fill_colour)) {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
+
+	if (!nsfb_plot_polygon(fb, p, n, style->fill_colour)) {
 		return NSERROR_INVALID;
 	}
 	return NSERROR_OK;
@@ -309,6 +336,7 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 		  colour bg,
 		  bitmap_flags_t flags)
 {
+	nsfb_t *fb = framebuffer_plot_surface(ctx);
 	nsfb_bbox_t loc;
 	nsfb_bbox_t clipbox;
 	bool repeat_x = (flags & BITMAPF_REPEAT_X);
@@ -333,13 +361,13 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 		loc.x1 = loc.x0 + width;
 		loc.y1 = loc.y0 + height;
 
-		if (!nsfb_plot_copy(bm, NULL, nsfb, &loc)) {
+		if (!nsfb_plot_copy(bm, NULL, fb, &loc)) {
 			return NSERROR_INVALID;
 		}
 		return NSERROR_OK;
 	}
 
-	nsfb_plot_get_clip(nsfb, &clipbox);
+	nsfb_plot_get_clip(fb, &clipbox);
 	nsfb_get_geometry(bm, &bmwidth, &bmheight, &bmformat);
 	nsfb_get_buffer(bm, &bmptr, &bmstride);
 
@@ -347,7 +375,7 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 	 * of the area.  Can only be done when image is fully opaque. */
 	if ((bmwidth == 1) && (bmheight == 1)) {
 		if ((*(nsfb_colour_t *)bmptr & 0xff000000) != 0) {
-			if (!nsfb_plot_rectangle_fill(nsfb, &clipbox,
+			if (!nsfb_plot_rectangle_fill(fb, &clipbox,
 						      *(nsfb_colour_t *)bmptr)) {
 				return NSERROR_INVALID;
 			}
@@ -362,7 +390,7 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 		if (framebuffer_bitmap_get_opaque(bm)) {
 			/** TODO: Currently using top left pixel. Maybe centre
 			 *        pixel or average value would be better. */
-			if (!nsfb_plot_rectangle_fill(nsfb, &clipbox,
+			if (!nsfb_plot_rectangle_fill(fb, &clipbox,
 						      *(nsfb_colour_t *)bmptr)) {
 				return NSERROR_INVALID;
 			}
@@ -387,7 +415,7 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 	loc.y1 = loc.y0 + height;
 
 	/* plot tiling across and down to extents */
-	nsfb_plot_bitmap_tiles(nsfb, &loc,
+	nsfb_plot_bitmap_tiles(fb, &loc,
 			repeat_x ? ((clipbox.x1 - x) + width  - 1) / width  : 1,
 			repeat_y ? ((clipbox.y1 - y) + height - 1) / height : 1,
 			(nsfb_colour_t *)bmptr, bmwidth, bmheight,
@@ -398,89 +426,57 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 
 
 #ifdef FB_USE_FREETYPE
-/**
- * Text plotting.
- *
- * \param ctx The current redraw context.
- * \param fstyle plot style for this text
- * \param x x coordinate
- * \param y y coordinate
- * \param text UTF-8 string to plot
- * \param length length of string, in bytes
- * \return NSERROR_OK on success else error code.
- */
-static nserror
-framebuffer_plot_text(const struct redraw_context *ctx,
-		const struct plot_font_style *fstyle,
-		int x,
-		int y,
-		const char *text,
-		size_t length)
+/* exported interface documented in framebuffer/framebuffer.h */
+nserror
+framebuffer_text_glyphs(const struct plot_font_style *fstyle,
+			int x,
+			int y,
+			const char *text,
+			size_t length,
+			framebuffer_glyph_cb cb,
+			void *pw)
 {
-	uint32_t ucs4;
-	size_t nxtchr = 0;
-	FT_Glyph glyph;
-	FT_BitmapGlyph bglyph;
+	const struct fb_glyph_run *run;
+	const struct fb_glyph *glyph;
 	nsfb_bbox_t loc;
+	unsigned int idx;
+	nserror res;
 
-	while (nxtchr < length) {
-		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
-		nxtchr = utf8_next(text, length, nxtchr);
-
-		glyph = fb_getglyph(fstyle, ucs4);
-		if (glyph == NULL)
-			continue;
-
-		if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
-			bglyph = (FT_BitmapGlyph)glyph;
-
-			loc.x0 = x + bglyph->left;
-			loc.y0 = y - bglyph->top;
-			loc.x1 = loc.x0 + bglyph->bitmap.width;
-			loc.y1 = loc.y0 + bglyph->bitmap.rows;
-
-			/* now, draw to our target surface */
-			if (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
-			    nsfb_plot_glyph1(nsfb,
-					     &loc,
-					     bglyph->bitmap.buffer,
-					     bglyph->bitmap.pitch,
-					     fstyle->foreground);
-			} else {
-			    nsfb_plot_glyph8(nsfb,
-					     &loc,
-					     bglyph->bitmap.buffer,
-					     bglyph->bitmap.pitch,
-					     fstyle->foreground);
-			}
-		}
-		x += glyph->advance.x >> 16;
+	/* the glyphs come straight from the glyph cache atlas */
+	res = fb_font_run(fstyle, text, length, &run);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (idx = 0; idx < run->count; idx++) {
+		glyph = run->glyphs[idx].glyph;
+
+		loc.x0 = x + run->glyphs[idx].x + glyph->left;
+		loc.y0 = y - glyph->top;
+		loc.x1 = loc.x0 + glyph->width;
+		loc.y1 = loc.y0 + glyph->rows;
 
+		res = cb(pw, &loc, glyph->data, glyph->pitch,
+			 fstyle->foreground, false);
+		if (res != NSERROR_OK) {
+			return res;
+		}
 	}
-	return NSERROR_OK;
 
+	return NSERROR_OK;
 }
 
 #else
 
-/**
- * Text plotting.
- *
- * \param ctx The current redraw context.
- * \param fstyle plot style for this text
- * \param x x coordinate
- * \param y y coordinate
- * \param text UTF-8 string to plot
- * \param length length of string, in bytes
- * \return NSERROR_OK on success else error code.
- */
-static nserror
-framebuffer_plot_text(const struct redraw_context *ctx,
-		const struct plot_font_style *fstyle,
-		int x,
-		int y,
-		const char *text,
-		size_t length)
+/* exported interface documented in framebuffer/framebuffer.h */
+nserror
+framebuffer_text_glyphs(const struct plot_font_style *fstyle,
+			int x,
+			int y,
+			const char *text,
+			size_t length,
+			framebuffer_glyph_cb cb,
+			void *pw)
 {
     enum fb_font_style style = fb_get_font_style(fstyle);
     int size = fb_get_font_size(fstyle);
@@ -491,6 +487,7 @@ framebuffer_plot_text(const struct redraw_context *ctx,
     int p = FB_FONT_PITCH * size;
     int w = FB_FONT_WIDTH * size;
     int h = FB_FONT_HEIGHT * size;
+    nserror res;
 
     y -= ((h * 3) / 4);
     /* the coord is the bottom-left of the pixels offset by 1 to make
@@ -510,7 +507,10 @@ framebuffer_plot_text(const struct redraw_context *ctx,
 	loc.y1 = loc.y0 + h;
 
 	chrp = fb_get_glyph(ucs4, style, size);
-	nsfb_plot_glyph1(nsfb, &loc, chrp, p, fstyle->foreground);
+	res = cb(pw, &loc, chrp, p, fstyle->foreground, true);
+	if (res != NSERROR_OK) {
+		return res;
+	}
 
 	x += w;
 
@@ -521,6 +521,61 @@ framebuffer_plot_text(const struct redraw_context *ctx,
 #endif
 
 
+/**
+ * Plot a glyph into a surface.
+ *
+ * \param pw The surface to plot into.
+ * \param loc The location of the glyph.
+ * \param pixel The glyph data.
+ * \param pitch The length of a row of glyph data in bytes.
+ * \param c The glyph colour.
+ * \param mono true if the glyph data is one bit per pixel.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+framebuffer_plot_glyph(void *pw,
+		       const nsfb_bbox_t *loc,
+		       const uint8_t *pixel,
+		       int pitch,
+		       nsfb_colour_t c,
+		       bool mono)
+{
+	nsfb_bbox_t gloc = *loc;
+
+	if (mono) {
+		nsfb_plot_glyph1(pw, &gloc, pixel, pitch, c);
+	} else {
+		nsfb_plot_glyph8(pw, &gloc, pixel, pitch, c);
+	}
+	return NSERROR_OK;
+}
+
+
+/**
+ * Text plotting.
+ *
+ * \param ctx The current redraw context.
+ * \param fstyle plot style for this text
+ * \param x x coordinate
+ * \param y y coordinate
+ * \param text UTF-8 string to plot
+ * \param length length of string, in bytes
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+framebuffer_plot_text(const struct redraw_context *ctx,
+		const struct plot_font_style *fstyle,
+		int x,
+		int y,
+		const char *text,
+		size_t length)
+{
+	return framebuffer_text_glyphs(fstyle, x, y, text, length,
+				       framebuffer_plot_glyph,
+				       framebuffer_plot_surface(ctx));
+}
+
+
 /** framebuffer plot operation table */
 const struct plotter_table fb_plotters = {
 	.clip = framebuffer_plot_clip,
@@ -37,4 +37,35 @@ bool framebuffer_set_cursor(struct fbtk_bitmap *bm);
  */
 nsfb_t *framebuffer_set_surface(nsfb_t *new_nsfb);
 
+/**
+ * Glyph plotting callback.
+ *
+ * \param pw The private word passed to framebuffer_text_glyphs().
+ * \param loc The location of the glyph.
+ * \param pixel The glyph data.
+ * \param pitch The length of a row of glyph data in bytes.
+ * \param c The glyph colour.
+ * \param mono true if the glyph data is one bit per pixel, otherwise
+ *             it is eight bits of coverage per pixel.
+ * \return NSERROR_OK on success else error code.
+ */
+typedef nserror (*framebuffer_glyph_cb)(void *pw, const nsfb_bbox_t *loc, const uint8_t *pixel, int pitch, nsfb_colour_t c, bool mono);
+
+/**
+ * Lay out a string of text as glyphs.
+ *
+ * The glyph data passed to the callback is only valid until the
+ * callback returns.
+ *
+ * \param fstyle plot style for the text
+ * \param x x coordinate
+ * \param y y coordinate
+ * \param text UTF-8 string to lay out
+ * \param length length of string, in bytes
+ * \param cb The callback to plot each glyph.
+ * \param pw The private word passed to the callback.
+ * \return NSERROR_OK on success else the error from the callback.
+ */
+nserror framebuffer_text_glyphs(const struct plot_font_style *fstyle, int x, int y, const char *text, size_t length, framebuffer_glyph_cb cb, void *pw);
+
 #endif
@@ -0,0 +1,636 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer glyph cache implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/utils.h"
+#include "utils/log.h"
+#include "utils/utf8.h"
+
+#include "framebuffer/glyph_cache.h"
+
+/** width and height of an atlas page */
+#define ATLAS_SIZE 256
+
+/** maximum number of atlas pages before the cache is flushed */
+#define ATLAS_PAGES 16
+
+/** number of glyphs allocated together */
+#define GLYPH_CHUNK 256
+
+/** number of characters with directly indexed glyphs */
+#define LATIN1_COUNT 256
+
+/** number of run cache slots, must be a power of two */
+#define RUN_SLOTS 1024
+
+/** longest string whose run is cached */
+#define RUN_MAX_TEXT 256
+
+/** total size of cached runs */
+#define RUN_BUDGET (2 * 1024 * 1024)
+
+/** a block of glyphs */
+struct glyph_chunk {
+	struct glyph_chunk *next;
+	unsigned int used;
+	struct fb_glyph glyphs[GLYPH_CHUNK];
+};
+
+/** glyph data too large for, or which did not fit in, the atlas */
+struct glyph_block {
+	struct glyph_block *next;
+	uint8_t data[];
+};
+
+/** glyphs of one face at one size and resolution */
+struct fb_glyph_strike {
+	struct fb_glyph_strike *next;
+
+	const void *face;
+	int size;
+	int resolution;
+	fb_glyph_render_cb render;
+
+	/** directly indexed glyphs, NULL where not yet rasterised */
+	const struct fb_glyph *latin1[LATIN1_COUNT];
+
+	/** open addressed table of other glyphs, zero keys are empty */
+	uint32_t *keys;
+	const struct fb_glyph **values;
+	unsigned int alloc;
+	unsigned int count;
+};
+
+/** a cached run */
+struct run_entry {
+	struct fb_glyph_strike *strike; /**< strike of the run, NULL if empty */
+	uint32_t hash;
+	size_t length;
+	struct fb_glyph_place *glyphs; /**< allocation holding the glyphs and text */
+	char *text; /**< the string, stored after the glyphs */
+	size_t size; /**< size of the allocation */
+	struct fb_glyph_run run;
+};
+
+/** placeholder for characters without a glyph */
+static const struct fb_glyph glyph_missing;
+
+static struct fb_glyph_strike *strikes;
+
+static uint8_t *atlas[ATLAS_PAGES];
+static unsigned int atlas_page;
+static int shelf_x;
+static int shelf_y;
+static int shelf_h;
+/** the atlas is full and must be flushed */
+static bool atlas_full;
+
+static struct glyph_chunk *chunks;
+static struct glyph_block *blocks;
+
+static struct run_entry runs[RUN_SLOTS];
+static size_t run_bytes;
+static unsigned int run_evict;
+
+/** uncached run */
+static struct fb_glyph_run scratch_run;
+static struct fb_glyph_place *places;
+static size_t places_alloc;
+
+static unsigned int stat_rendered;
+static unsigned int stat_run_hits;
+static unsigned int stat_run_misses;
+
+/**
+ * Allocate space for glyph coverage.
+ *
+ * Space is taken from the atlas where possible. Once the atlas is full
+ * a separate block is allocated and the cache is marked for flushing,
+ * so glyphs already in use remain valid.
+ *
+ * \param width The coverage width.
+ * \param rows The coverage height.
+ * \param pitch Updated with the coverage row length.
+ * \return The coverage space or NULL on memory exhaustion.
+ */
+static uint8_t *glyph_data_alloc(int width, int rows, int *pitch)
+{
+	struct glyph_block *block;
+
+	if ((width <= ATLAS_SIZE) && (rows <= ATLAS_SIZE) && !atlas_full) {
+		if (shelf_x + width > ATLAS_SIZE) {
+			/* start a new shelf */
+			shelf_y += shelf_h;
+			shelf_x = 0;
+			shelf_h = 0;
+		}
+		if (shelf_y + rows > ATLAS_SIZE) {
+			/* start a new page */
+			atlas_page++;
+			shelf_x = 0;
+			shelf_y = 0;
+			shelf_h = 0;
+		}
+		if (atlas_page < ATLAS_PAGES) {
+			if (atlas[atlas_page] == NULL) {
+				atlas[atlas_page] = malloc(ATLAS_SIZE * ATLAS_SIZE);
+			}
+			if (atlas[atlas_page] != NULL) {
+				uint8_t *data;
+				data = atlas[atlas_page] +
+					(shelf_y * ATLAS_SIZE) + shelf_x;
+				shelf_x += width;
+				if (rows > shelf_h) {
+					shelf_h = rows;
+				}
+				*pitch = ATLAS_SIZE;
+				return data;
+			}
+		}
+		atlas_full = true;
+	}
+
+	block = malloc(sizeof(*block) + (width * rows));
+	if (block == NULL) {
+		return NULL;
+	}
+	block->next = blocks;
+	blocks = block;
+
+	*pitch = width;
+	return block->data;
+}
+
+
+/**
+ * Rasterise a glyph and add it to the cache.
+ *
+ * \param strike The strike the glyph belongs to.
+ * \param ucs4 The character to rasterise.
+ * \return The glyph, glyph_missing if there is none, or NULL on memory
+ *         exhaustion.
+ */
+static const struct fb_glyph *
+glyph_render(struct fb_glyph_strike *strike, uint32_t ucs4)
+{
+	struct fb_glyph_bitmap bitmap;
+	struct fb_glyph *glyph;
+	uint8_t *data;
+	int row;
+	int col;
+
+	if (strike->render(strike->face,
+			   strike->size,
+			   strike->resolution,
+			   ucs4,
+			   &bitmap) != NSERROR_OK) {
+		return &glyph_missing;
+	}
+	stat_rendered++;
+
+	if ((chunks == NULL) || (chunks->used == GLYPH_CHUNK)) {
+		struct glyph_chunk *chunk;
+		chunk = malloc(sizeof(*chunk));
+		if (chunk == NULL) {
+			return NULL;
+		}
+		chunk->next = chunks;
+		chunk->used = 0;
+		chunks = chunk;
+	}
+	glyph = &chunks->glyphs[chunks->used];
+
+	glyph->left = bitmap.left;
+	glyph->top = bitmap.top;
+	glyph->advance = bitmap.advance;
+	glyph->width = 0;
+	glyph->rows = 0;
+	glyph->pitch = 0;
+	glyph->data = NULL;
+
+	if ((bitmap.width > 0) && (bitmap.rows > 0)) {
+		data = glyph_data_alloc(bitmap.width, bitmap.rows, &glyph->pitch);
+		if (data == NULL) {
+			return NULL;
+		}
+		for (row = 0; row < bitmap.rows; row++) {
+			const uint8_t *src = bitmap.buffer + (row * bitmap.pitch);
+			uint8_t *dst = data + (row * glyph->pitch);
+
+			if (bitmap.mono) {
+				for (col = 0; col < bitmap.width; col++) {
+					dst[col] = (src[col >> 3] &
+						    (0x80 >> (col & 7))) ? 0xff : 0;
+				}
+			} else {
+				memcpy(dst, src, bitmap.width);
+			}
+		}
+		glyph->width = bitmap.width;
+		glyph->rows = bitmap.rows;
+		glyph->data = data;
+	}
+
+	chunks->used++;
+
+	return glyph;
+}
+
+
+/**
+ * Find the slot of a character in a strike's hash table.
+ */
+static unsigned int strike_slot(struct fb_glyph_strike *strike, uint32_t ucs4)
+{
+	unsigned int slot = (ucs4 * 0x9e3779b9) & (strike->alloc - 1);
+
+	while ((strike->keys[slot] != 0) && (strike->keys[slot] != ucs4)) {
+		slot = (slot + 1) & (strike->alloc - 1);
+	}
+
+	return slot;
+}
+
+
+/**
+ * Add a glyph to a strike's hash table.
+ *
+ * \return NSERROR_OK on success else NSERROR_NOMEM.
+ */
+static nserror
+strike_insert(struct fb_glyph_strike *strike,
+	      uint32_t ucs4,
+	      const struct fb_glyph *glyph)
+{
+	unsigned int slot;
+
+	if ((strike->count + 1) * 2 > strike->alloc) {
+		unsigned int alloc = (strike->alloc == 0) ? 64 : strike->alloc * 2;
+		uint32_t *keys = strike->keys;
+		const struct fb_glyph **values = strike->values;
+		unsigned int old_alloc = strike->alloc;
+		unsigned int idx;
+
+		strike->keys = calloc(alloc, sizeof(*keys));
+		strike->values = malloc(alloc * sizeof(*values));
+		if ((strike->keys == NULL) || (strike->values == NULL)) {
+			free(strike->keys);
+			free(strike->values);
+			strike->keys = keys;
+			strike->values = values;
+			return NSERROR_NOMEM;
+		}
+		strike->alloc = alloc;
+
+		for (idx = 0; idx < old_alloc; idx++) {
+			if (keys[idx] != 0) {
+				slot = strike_slot(strike, keys[idx]);
+				strike->keys[slot] = keys[idx];
+				strike->values[slot] = values[idx];
+			}
+		}
+		free(keys);
+		free(values);
+	}
+
+	slot = strike_slot(strike, ucs4);
+	strike->keys[slot] = ucs4;
+	strike->values[slot] = glyph;
+	strike->count++;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Get a glyph from a strike, distinguishing missing glyphs.
+ *
+ * \return The glyph, glyph_missing if there is none, or NULL on memory
+ *         exhaustion.
+ */
+static const struct fb_glyph *
+strike_glyph(struct fb_glyph_strike *strike, uint32_t ucs4)
+{
+	const struct fb_glyph *glyph;
+	unsigned int slot;
+
+	if (ucs4 < LATIN1_COUNT) {
+		glyph = strike->latin1[ucs4];
+		if (glyph == NULL) {
+			glyph = glyph_render(strike, ucs4);
+			strike->latin1[ucs4] = glyph;
+		}
+		return glyph;
+	}
+
+	if (strike->alloc != 0) {
+		slot = strike_slot(strike, ucs4);
+		if (strike->keys[slot] == ucs4) {
+			return strike->values[slot];
+		}
+	}
+
+	glyph = glyph_render(strike, ucs4);
+	if ((glyph != NULL) && (strike_insert(strike, ucs4, glyph) != NSERROR_OK)) {
+		return NULL;
+	}
+
+	return glyph;
+}
+
+
+/**
+ * Remove a run from the cache.
+ */
+static void run_discard(struct run_entry *entry)
+{
+	if (entry->strike != NULL) {
+		free(entry->glyphs);
+		run_bytes -= entry->size;
+		entry->strike = NULL;
+	}
+}
+
+
+/**
+ * Discard all glyphs and runs.
+ */
+static void glyph_cache_flush(void)
+{
+	unsigned int idx;
+
+	NSLOG(netsurf, DEBUG,
+	      "Flushing glyph cache, %u glyphs rendered, run hits %u misses %u",
+	      stat_rendered, stat_run_hits, stat_run_misses);
+
+	for (idx = 0; idx < RUN_SLOTS; idx++) {
+		run_discard(&runs[idx]);
+	}
+
+	while (strikes != NULL) {
+		struct fb_glyph_strike *strike = strikes;
+		strikes = strike->next;
+		free(strike->keys);
+		free(strike->values);
+		free(strike);
+	}
+
+	while (chunks != NULL) {
+		struct glyph_chunk *chunk = chunks;
+		chunks = chunk->next;
+		free(chunk);
+	}
+
+	while (blocks != NULL) {
+		struct glyph_block *block = blocks;
+		blocks = block->next;
+		free(block);
+	}
+
+	/* the atlas pages are reused */
+	atlas_page = 0;
+	shelf_x = 0;
+	shelf_y = 0;
+	shelf_h = 0;
+	atlas_full = false;
+}
+
+
+/* exported interface documented in framebuffer/glyph_cache.h */
+struct fb_glyph_strike *
+fb_glyph_strike_get(const void *face,
+		    int size,
+		    int resolution,
+		    fb_glyph_render_cb render)
+{
+	struct fb_glyph_strike **prev;
+	struct fb_glyph_strike *strike;
+
+	if (atlas_full) {
+		glyph_cache_flush();
+	}
+
+	for (prev = &strikes; *prev != NULL; prev = &(*prev)->next) {
+		strike = *prev;
+		if ((strike->face == face) &&
+		    (strike->size == size) &&
+		    (strike->resolution == resolution) &&
+		    (strike->render == render)) {
+			/* keep the most recently used strike first */
+			*prev = strike->next;
+			strike->next = strikes;
+			strikes = strike;
+			return strike;
+		}
+	}
+
+	strike = calloc(1, sizeof(*strike));
+	if (strike == NULL) {
+		return NULL;
+	}
+	strike->face = face;
+	strike->size = size;
+	strike->resolution = resolution;
+	strike->render = render;
+
+	strike->next = strikes;
+	strikes = strike;
+
+	return strike;
+}
+
+
+/* exported interface documented in framebuffer/glyph_cache.h */
+const struct fb_glyph *
+fb_glyph_get(struct fb_glyph_strike *strike, uint32_t ucs4)
+{
+	const struct fb_glyph *glyph;
+
+	glyph = strike_glyph(strike, ucs4);
+	if (glyph == &glyph_missing) {
+		return NULL;
+	}
+	return glyph;
+}
+
+
+/**
+ * Lay out the glyphs of a string into the scratch run.
+ *
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+run_layout(struct fb_glyph_strike *strike, const char *text, size_t length)
+{
+	const struct fb_glyph *glyph;
+	size_t nxtchr = 0;
+	size_t count = 0;
+	uint32_t ucs4;
+	int x = 0;
+
+	while (nxtchr < length) {
+		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
+		nxtchr = utf8_next(text, length, nxtchr);
+
+		glyph = strike_glyph(strike, ucs4);
+		if (glyph == NULL) {
+			return NSERROR_NOMEM;
+		}
+		if (glyph == &glyph_missing) {
+			continue;
+		}
+
+		if (glyph->data != NULL) {
+			if (count == places_alloc) {
+				size_t alloc = (places_alloc == 0) ? 64 : places_alloc * 2;
+				struct fb_glyph_place *nplaces;
+				nplaces = realloc(places, alloc * sizeof(*nplaces));
+				if (nplaces == NULL) {
+					return NSERROR_NOMEM;
+				}
+				places = nplaces;
+				places_alloc = alloc;
+			}
+			places[count].glyph = glyph;
+			places[count].x = x;
+			count++;
+		}
+
+		x += glyph->advance;
+	}
+
+	scratch_run.advance = x;
+	scratch_run.count = count;
+	scratch_run.glyphs = places;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Hash a string for the run cache.
+ */
+static uint32_t
+run_hash(const struct fb_glyph_strike *strike, const char *text, size_t length)
+{
+	uint32_t z = 0x811c9dc5 ^ (uint32_t)(uintptr_t)strike;
+	size_t idx;
+
+	for (idx = 0; idx < length; idx++) {
+		z ^= (uint8_t)text[idx];
+		z *= 0x01000193;
+	}
+
+	return z;
+}
+
+
+/* exported interface documented in framebuffer/glyph_cache.h */
+nserror
+fb_glyph_run(struct fb_glyph_strike *strike,
+	     const char *text,
+	     size_t length,
+	     const struct fb_glyph_run **run_out)
+{
+	struct run_entry *entry;
+	size_t glyphs;
+	size_t size;
+	uint32_t hash;
+	nserror res;
+
+	if (length > RUN_MAX_TEXT) {
+		res = run_layout(strike, text, length);
+		*run_out = &scratch_run;
+		return res;
+	}
+
+	hash = run_hash(strike, text, length);
+	entry = &runs[hash & (RUN_SLOTS - 1)];
+	if ((entry->strike == strike) &&
+	    (entry->hash == hash) &&
+	    (entry->length == length) &&
+	    (memcmp(entry->text, text, length) == 0)) {
+		stat_run_hits++;
+		*run_out = &entry->run;
+		return NSERROR_OK;
+	}
+	stat_run_misses++;
+
+	res = run_layout(strike, text, length);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+	*run_out = &scratch_run;
+
+	glyphs = scratch_run.count * sizeof(struct fb_glyph_place);
+	size = glyphs + length;
+
+	run_discard(entry);
+	while (run_bytes + size > RUN_BUDGET) {
+		run_discard(&runs[run_evict]);
+		run_evict = (run_evict + 1) & (RUN_SLOTS - 1);
+	}
+
+	entry->glyphs = malloc(size);
+	if (entry->glyphs == NULL) {
+		/* the uncached run is still usable */
+		return NSERROR_OK;
+	}
+	entry->text = (char *)entry->glyphs + glyphs;
+	memcpy(entry->glyphs, places, glyphs);
+	memcpy(entry->text, text, length);
+	entry->run.advance = scratch_run.advance;
+	entry->run.count = scratch_run.count;
+	entry->run.glyphs = entry->glyphs;
+	entry->strike = strike;
+	entry->hash = hash;
+	entry->length = length;
+	entry->size = size;
+	run_bytes += size;
+
+	*run_out = &entry->run;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in framebuffer/glyph_cache.h */
+void fb_glyph_cache_finalise(void)
+{
+	unsigned int idx;
+
+	glyph_cache_flush();
+
+	for (idx = 0; idx < ATLAS_PAGES; idx++) {
+		free(atlas[idx]);
+		atlas[idx] = NULL;
+	}
+
+	free(places);
+	places = NULL;
+	places_alloc = 0;
+}
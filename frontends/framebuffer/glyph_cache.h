@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer glyph cache interface.
+ *
+ * Rendered glyphs are packed into 8 bit coverage atlas pages and
+ * grouped into strikes, one for each face, size and resolution. The
+ * Latin-1 glyphs of a strike are found by direct index and all others
+ * through a hash table, so a glyph is rasterised at most once.
+ *
+ * Text is plotted a run at a time. A run holds the position of each
+ * glyph of a string and the most recently plotted runs are kept, so a
+ * repeated string is plotted straight from the atlas without being
+ * decoded or looked up again.
+ *
+ * Everything is discarded when the atlas fills, so a strike is only
+ * valid until the next call to fb_glyph_strike_get().
+ */
+
+#ifndef NETSURF_FB_GLYPH_CACHE_H
+#define NETSURF_FB_GLYPH_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/errors.h"
+
+struct fb_glyph_strike;
+
+/**
+ * A rasterised glyph, as supplied to the cache.
+ */
+struct fb_glyph_bitmap {
+	int left; /**< offset of the bitmap from the pen position */
+	int top; /**< offset of the bitmap top above the baseline */
+	int width; /**< bitmap width in pixels */
+	int rows; /**< bitmap height in pixels */
+	int pitch; /**< length of a bitmap row in bytes */
+	int advance; /**< pen advance in pixels */
+	const uint8_t *buffer; /**< glyph data */
+	bool mono; /**< glyph data is one bit per pixel */
+};
+
+/**
+ * A cached glyph.
+ */
+struct fb_glyph {
+	int left; /**< offset of the coverage from the pen position */
+	int top; /**< offset of the coverage top above the baseline */
+	int width; /**< coverage width in pixels */
+	int rows; /**< coverage height in pixels */
+	int pitch; /**< length of a coverage row in bytes */
+	int advance; /**< pen advance in pixels */
+	const uint8_t *data; /**< 8 bit coverage */
+};
+
+/**
+ * A glyph placed in a run.
+ */
+struct fb_glyph_place {
+	const struct fb_glyph *glyph; /**< the glyph */
+	int x; /**< offset of the pen position from the start of the run */
+};
+
+/**
+ * A run of glyphs.
+ *
+ * Only glyphs with coverage are placed.
+ */
+struct fb_glyph_run {
+	int advance; /**< total pen advance in pixels */
+	unsigned int count; /**< number of placed glyphs */
+	const struct fb_glyph_place *glyphs; /**< the placed glyphs */
+};
+
+/**
+ * Glyph rasteriser.
+ *
+ * \param face The face of the strike.
+ * \param size The size of the strike.
+ * \param resolution The resolution of the strike.
+ * \param ucs4 The character to rasterise.
+ * \param bitmap Updated with the rasterised glyph, whose data need only
+ *               remain valid until the rasteriser is next called.
+ * \return NSERROR_OK on success else error code if the face has no
+ *         glyph for the character.
+ */
+typedef nserror (*fb_glyph_render_cb)(const void *face,
+				      int size,
+				      int resolution,
+				      uint32_t ucs4,
+				      struct fb_glyph_bitmap *bitmap);
+
+/**
+ * Get the strike for a face, size and resolution.
+ *
+ * \param face The face, which is only compared by address.
+ * \param size The glyph size.
+ * \param resolution The glyph resolution.
+ * \param render The rasteriser for glyphs of the strike.
+ * \return The strike or NULL on memory exhaustion.
+ */
+struct fb_glyph_strike *fb_glyph_strike_get(const void *face, int size, int resolution, fb_glyph_render_cb render);
+
+/**
+ * Get a glyph from a strike, rasterising it if necessary.
+ *
+ * \param strike The strike to get the glyph from.
+ * \param ucs4 The character to get the glyph of.
+ * \return The glyph or NULL if it is unavailable.
+ */
+const struct fb_glyph *fb_glyph_get(struct fb_glyph_strike *strike, uint32_t ucs4);
+
+/**
+ * Get the run of glyphs of a string.
+ *
+ * Characters without a glyph are skipped.
+ *
+ * \param strike The strike to use.
+ * \param text UTF-8 string.
+ * \param length length of string, in bytes.
+ * \param run_out Updated with the run, which is valid until the next
+ *                call to fb_glyph_run() or fb_glyph_strike_get().
+ * \return NSERROR_OK on success else error code.
+ */
+nserror fb_glyph_run(struct fb_glyph_strike *strike, const char *text, size_t length, const struct fb_glyph_run **run_out);
+
+/**
+ * Discard all cached glyphs and runs.
+ */
+void fb_glyph_cache_finalise(void);
+
+#endif
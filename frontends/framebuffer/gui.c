@@ -34,6 +34,7 @@
 #include "utils/filepath.h"
 #include "utils/log.h"
 #include "utils/messages.h"
+#include "utils/trace.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/keypress.h"
 #include "desktop/browser_history.h"
@@ -56,6 +57,8 @@
 #include "framebuffer/bitmap.h"
 #include "framebuffer/local_history.h"
 #include "framebuffer/corewindow.h"
+#include "framebuffer/tiled.h"
+#include "framebuffer/damage.h"
 
 
 #define NSFB_TOOLBAR_DEFAULT_LAYOUT "blfsrutc"
@@ -74,10 +77,7 @@ struct browser_widget_s {
 	int scrollx, scrolly; /**< scroll offsets. */
 
 	/* Pending window redraw state. */
-	bool redraw_required; /**< flag indicating the foreground loop
-			       * needs to redraw the browser widget.
-			       */
-	bbox_t redraw_box; /**< Area requiring redraw. */
+	struct fb_damage damage; /**< Areas requiring redraw. */
 	bool pan_required; /**< flag indicating the foreground loop
 			    * needs to pan the window.
 			    */
@@ -96,6 +96,14 @@ static struct gui_drag {
 	bool grabbed_pointer;
 } gui_drag;
 
+/** browser window redraw statistics */
+static struct {
+	uint32_t requested; /**< areas queued for redraw */
+	uint32_t drawn; /**< areas queued before the last frame */
+	uint32_t performed; /**< content redraws done */
+	uint32_t frames; /**< frames drawn */
+} fb_redraw_stats;
+
 
 /**
  * Cause an abnormal program termination.
@@ -130,19 +138,14 @@ static void
 fb_queue_redraw(struct fbtk_widget_s *widget, int x0, int y0, int x1, int y1)
 {
 	struct browser_widget_s *bwidget = fbtk_get_userpw(widget);
+	bbox_t box = { x0, y0, x1, y1 };
 
-	bwidget->redraw_box.x0 = min(bwidget->redraw_box.x0, x0);
-	bwidget->redraw_box.y0 = min(bwidget->redraw_box.y0, y0);
-	bwidget->redraw_box.x1 = max(bwidget->redraw_box.x1, x1);
-	bwidget->redraw_box.y1 = max(bwidget->redraw_box.y1, y1);
+	fb_redraw_stats.requested++;
 
-	if (fbtk_clip_to_widget(widget, &bwidget->redraw_box)) {
-		bwidget->redraw_required = true;
+	if (fbtk_clip_to_widget(widget, &box)) {
+		/* merged with the pending damage, drawn at the next frame */
+		fb_damage_add(&bwidget->damage, &box);
 		fbtk_request_redraw(widget);
-	} else {
-		bwidget->redraw_box.y0 = bwidget->redraw_box.x0 = INT_MAX;
-		bwidget->redraw_box.y1 = bwidget->redraw_box.x1 = -(INT_MAX);
-		bwidget->redraw_required = false;
 	}
 }
 
@@ -259,6 +262,14 @@ fb_pan(fbtk_widget_t *widget,
 		return;
 	}
 
+	/* pending damage moves with the pixels copied below, the newly
+	 * exposed strips span the window so are unaffected by the copy
+	 * along the other axis
+	 */
+	fb_damage_translate(&bwidget->damage,
+			    -bwidget->panx, -bwidget->pany,
+			    width, height);
+
 	if (bwidget->pany < 0) {
 		/* pan up by less then viewport height */
 		srcbox.x0 = x;
@@ -347,40 +358,58 @@ fb_pan(fbtk_widget_t *widget,
 static void
 fb_redraw(fbtk_widget_t *widget,
 	  struct browser_widget_s *bwidget,
-	  struct browser_window *bw)
+	  struct browser_window *bw,
+	  const bbox_t *area)
 {
 	int x;
 	int y;
 	int caret_x, caret_y, caret_h;
+	bbox_t redraw_box;
 	struct rect clip;
 	struct redraw_context ctx = {
 		.interactive = true,
 		.background_images = true,
 		.plot = &fb_plotters
 	};
+	struct redraw_context tiled_ctx;
+	bool tiled = false;
 	nsfb_t *nsfb = fbtk_get_nsfb(widget);
 
 	x = fbtk_get_absx(widget);
 	y = fbtk_get_absy(widget);
 
 	/* adjust clipping co-ordinates according to window location */
-	bwidget->redraw_box.y0 += y;
-	bwidget->redraw_box.y1 += y;
-	bwidget->redraw_box.x0 += x;
-	bwidget->redraw_box.x1 += x;
+	redraw_box.y0 = area->y0 + y;
+	redraw_box.y1 = area->y1 + y;
+	redraw_box.x0 = area->x0 + x;
+	redraw_box.x1 = area->x1 + x;
 
-	nsfb_claim(nsfb, &bwidget->redraw_box);
+	nsfb_claim(nsfb, &redraw_box);
 
 	/* redraw bounding box is relative to window */
-	clip.x0 = bwidget->redraw_box.x0;
-	clip.y0 = bwidget->redraw_box.y0;
-	clip.x1 = bwidget->redraw_box.x1;
-	clip.y1 = bwidget->redraw_box.y1;
+	clip.x0 = redraw_box.x0;
+	clip.y0 = redraw_box.y0;
+	clip.x1 = redraw_box.x1;
+	clip.y1 = redraw_box.y1;
+
+	if (nsoption_bool(fb_tiled_render) &&
+	    fb_tiled_begin(nsfb, &redraw_box, &ctx, &tiled_ctx)) {
+		tiled = true;
+	}
 
+	fb_redraw_stats.performed++;
 	browser_window_redraw(bw,
 			x - bwidget->scrollx,
 			y - bwidget->scrolly,
-			&clip, &ctx);
+			&clip, tiled ? &tiled_ctx : &ctx);
+
+	if (tiled && (fb_tiled_end() != NSERROR_OK)) {
+		/* the redraw could not be recorded so plot it directly */
+		browser_window_redraw(bw,
+				x - bwidget->scrollx,
+				y - bwidget->scrolly,
+				&clip, &ctx);
+	}
 
 	if (fbtk_get_caret(widget, &caret_x, &caret_y, &caret_h)) {
 		/* This widget has caret, so render it */
@@ -399,11 +428,7 @@ fb_redraw(fbtk_widget_t *widget,
 		nsfb_plot_line(nsfb, &line, &pen);
 	}
 
-	nsfb_update(fbtk_get_nsfb(widget), &bwidget->redraw_box);
-
-	bwidget->redraw_box.y0 = bwidget->redraw_box.x0 = INT_MAX;
-	bwidget->redraw_box.y1 = bwidget->redraw_box.x1 = INT_MIN;
-	bwidget->redraw_required = false;
+	nsfb_update(fbtk_get_nsfb(widget), &redraw_box);
 }
 
 static int
@@ -411,6 +436,7 @@ fb_browser_window_redraw(fbtk_widget_t *widget, fbtk_callback_info *cbi)
 {
 	struct gui_window *gw = cbi->context;
 	struct browser_widget_s *bwidget;
+	unsigned int idx;
 
 	bwidget = fbtk_get_userpw(widget);
 	if (bwidget == NULL) {
@@ -423,15 +449,19 @@ fb_browser_window_redraw(fbtk_widget_t *widget, fbtk_callback_info *cbi)
 		fb_pan(widget, bwidget, gw->bw);
 	}
 
-	if (bwidget->redraw_required) {
-		fb_redraw(widget, bwidget, gw->bw);
-	} else {
-		bwidget->redraw_box.x0 = 0;
-		bwidget->redraw_box.y0 = 0;
-		bwidget->redraw_box.x1 = fbtk_get_width(widget);
-		bwidget->redraw_box.y1 = fbtk_get_height(widget);
-		fb_redraw(widget, bwidget, gw->bw);
+	if (fb_damage_empty(&bwidget->damage)) {
+		/* redraw requested for the widget, not an area of it */
+		bbox_t box = {
+			0, 0, fbtk_get_width(widget), fbtk_get_height(widget)
+		};
+		fb_damage_add(&bwidget->damage, &box);
 	}
+
+	for (idx = 0; idx < bwidget->damage.count; idx++) {
+		fb_redraw(widget, bwidget, gw->bw, &bwidget->damage.rect[idx]);
+	}
+	fb_damage_clear(&bwidget->damage);
+
 	return 0;
 }
 
@@ -613,10 +643,38 @@ static bool nslog_stream_configure(FILE *fptr)
 	return true;
 }
 
+/**
+ * Draw a frame, redrawing all the areas queued since the last one.
+ */
+static void framebuffer_frame(void)
+{
+	uint32_t performed = fb_redraw_stats.performed;
+	uint64_t trace;
+
+	trace = nstrace_begin();
+	fbtk_redraw(fbtk);
+	nstrace_end("redraw", "frame", trace);
+
+	fb_redraw_stats.frames++;
+
+	nstrace_counter("redraw", "requested",
+			fb_redraw_stats.requested - fb_redraw_stats.drawn);
+	nstrace_counter("redraw", "performed",
+			fb_redraw_stats.performed - performed);
+	fb_redraw_stats.drawn = fb_redraw_stats.requested;
+}
+
 static void framebuffer_run(void)
 {
 	nsfb_event_t event;
 	int timeout; /* timeout in miliseconds */
+	int frame_interval = 0; /* minimum time between frames in ms */
+	uint64_t next_frame = 0; /* time the next frame may be drawn */
+	uint64_t now;
+
+	if (nsoption_int(fb_frame_rate) > 0) {
+		frame_interval = 1000 / nsoption_int(fb_frame_rate);
+	}
 
 	while (fb_complete != true) {
 		/* run the scheduler and discover how long to wait for
@@ -624,11 +682,19 @@ static void framebuffer_run(void)
 		 */
 		timeout = schedule_run();
 
-		/* if redraws are pending do not wait for event,
-		 * return immediately
+		/* if redraws are pending only wait for an event until
+		 * the next frame is due, so redraws requested meanwhile
+		 * are drawn together
 		 */
-		if (fbtk_get_redraw_pending(fbtk))
-			timeout = 0;
+		if (fbtk_get_redraw_pending(fbtk)) {
+			nsu_getmonotonic_ms(&now);
+			if (now >= next_frame) {
+				timeout = 0;
+			} else if ((timeout < 0) ||
+				   (next_frame - now < (uint64_t)timeout)) {
+				timeout = next_frame - now;
+			}
+		}
 
 		if (fbtk_event(fbtk, &event, timeout)) {
 			if ((event.type == NSFB_EVENT_CONTROL) &&
@@ -636,7 +702,13 @@ static void framebuffer_run(void)
 				fb_complete = true;
 		}
 
-		fbtk_redraw(fbtk);
+		if (fbtk_get_redraw_pending(fbtk)) {
+			nsu_getmonotonic_ms(&now);
+			if (now >= next_frame) {
+				framebuffer_frame();
+				next_frame = now + frame_interval;
+			}
+		}
 	}
 }
 
@@ -644,8 +716,15 @@ static void gui_quit(void)
 {
 	NSLOG(netsurf, INFO, "gui_quit");
 
+	NSLOG(netsurf, INFO, "%u redraws requested, %u performed in %u frames",
+	      fb_redraw_stats.requested,
+	      fb_redraw_stats.performed,
+	      fb_redraw_stats.frames);
+
 	urldb_save_cookies(nsoption_charp(cookie_jar));
 
+	fb_tiled_finalise();
+
 	framebuffer_finalise();
 }
 
@@ -2253,6 +2332,11 @@ main(int argc, char** argv)
 
 	fbtk_enable_oskb(fbtk);
 
+	if (nsoption_bool(fb_tiled_render) &&
+	    (fb_tiled_init(nsoption_int(fb_render_threads)) != NSERROR_OK)) {
+		NSLOG(netsurf, INFO, "Tiled rendering unavailable");
+	}
+
 	urldb_load_cookies(nsoption_charp(cookie_file));
 
 	/* create an initial browser window */
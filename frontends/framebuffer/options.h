@@ -42,6 +42,17 @@ NSOPTION_STRING(fb_toolbar_layout, NULL)
 /** enable on screen keyboard */
 NSOPTION_BOOL(fb_osk, false)
 
+/***** rendering options *****/
+
+/** rasterise redraws in tiles on a pool of threads */
+NSOPTION_BOOL(fb_tiled_render, false)
+/** number of rasterising threads, zero for one per processor */
+NSOPTION_INTEGER(fb_render_threads, 0)
+/** check each tiled redraw against direct rasterisation */
+NSOPTION_BOOL(fb_tiled_check, false)
+/** maximum redraw frames per second, zero for unlimited */
+NSOPTION_INTEGER(fb_frame_rate, 60)
+
 /***** font options *****/
 
 /** render all fonts monochrome */
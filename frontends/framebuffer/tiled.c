@@ -0,0 +1,702 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer tiled rendering implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef FB_USE_THREADS
+#include <pthread.h>
+#endif
+
+#include <libnsfb.h>
+#include <libnsfb_plot.h>
+
+#include "utils/utils.h"
+#include "utils/log.h"
+#include "utils/nsoption.h"
+#include "utils/trace.h"
+#include "netsurf/types.h"
+#include "netsurf/plotters.h"
+#include "netsurf/bitmap.h"
+#include "desktop/plot_list.h"
+
+#include "framebuffer/gui.h"
+#include "framebuffer/fbtk.h"
+#include "framebuffer/framebuffer.h"
+#include "framebuffer/tiled.h"
+
+/** width and height of a tile in pixels */
+#define TILE_SIZE 128
+
+/** maximum number of rasterising threads */
+#define TILED_MAX_THREADS 64
+
+/**
+ * a glyph recorded in the display list, followed by its rows of data
+ */
+struct fb_tiled_glyph {
+	nsfb_bbox_t loc;
+	int pitch; /**< length of a row of glyph data */
+	nsfb_colour_t c;
+	bool mono;
+};
+
+/** a recorded redraw */
+struct fb_tiled_frame {
+	nsfb_t *nsfb; /**< surface being redrawn */
+	nsfb_bbox_t area; /**< area being redrawn */
+	enum nsfb_format_e format; /**< surface format */
+	int bpp; /**< bytes per pixel */
+	uint8_t *ptr; /**< surface buffer */
+	int linelen; /**< surface buffer row length in bytes */
+
+	struct plot_list *list; /**< recorded plot operations */
+
+	unsigned int columns; /**< number of tile columns */
+	unsigned int rows; /**< number of tile rows */
+};
+
+/** a rasterising thread */
+struct fb_tiled_worker {
+	nsfb_t *surface; /**< tile surface */
+#ifdef FB_USE_THREADS
+	pthread_t thread;
+#endif
+};
+
+/** the redraw being recorded or rasterised */
+static struct fb_tiled_frame frame;
+
+/** rasterising threads, the first is the main thread */
+static struct fb_tiled_worker *workers = NULL;
+static int worker_count = 0;
+
+/** format of the tile surfaces */
+static enum nsfb_format_e surface_format = NSFB_FMT_ANY;
+
+#ifdef FB_USE_THREADS
+static pthread_mutex_t tiled_lock = PTHREAD_MUTEX_INITIALIZER;
+/** signalled when a redraw is ready to be rasterised */
+static pthread_cond_t tiled_start = PTHREAD_COND_INITIALIZER;
+/** signalled when the last tile of a redraw has been rasterised */
+static pthread_cond_t tiled_done = PTHREAD_COND_INITIALIZER;
+static unsigned int tiled_generation = 0;
+static unsigned int tiled_next = 0;
+static unsigned int tiled_count = 0;
+static unsigned int tiled_finished = 0;
+static bool tiled_quit = false;
+#endif
+
+
+/**
+ * Record a glyph.
+ *
+ * The glyph data is copied as it is only valid during the callback.
+ */
+static nserror
+fb_tiled_record_glyph(void *pw,
+		      const nsfb_bbox_t *loc,
+		      const uint8_t *pixel,
+		      int pitch,
+		      nsfb_colour_t c,
+		      bool mono)
+{
+	struct plot_list *list = pw;
+	struct fb_tiled_glyph *glyph;
+	struct rect bounds;
+	int rows = loc->y1 - loc->y0;
+	int len = abs(pitch);
+	uint8_t *data;
+	void *entry;
+	nserror res;
+	int row;
+
+	if ((rows <= 0) || (loc->x1 <= loc->x0)) {
+		return NSERROR_OK;
+	}
+
+	bounds.x0 = loc->x0;
+	bounds.y0 = loc->y0;
+	bounds.x1 = loc->x1;
+	bounds.y1 = loc->y1;
+
+	res = plot_list_add_ext(list, &bounds,
+				sizeof(*glyph) + (rows * len), &entry);
+	if ((res != NSERROR_OK) || (entry == NULL)) {
+		return res;
+	}
+
+	glyph = entry;
+	glyph->loc = *loc;
+	glyph->pitch = len;
+	glyph->c = c;
+	glyph->mono = mono;
+
+	data = (uint8_t *)(glyph + 1);
+	for (row = 0; row < rows; row++) {
+		memcpy(data + (row * len), pixel + (row * pitch), len);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Record text.
+ *
+ * The text is laid out on the main thread and recorded as glyphs, as
+ * the font code may not be used from the rasterising threads.
+ *
+ * \param list The display list being recorded.
+ * \param fstyle plot style for this text
+ * \param x x coordinate
+ * \param y y coordinate
+ * \param text UTF-8 string to plot
+ * \param length length of string, in bytes
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+fb_tiled_record_text(struct plot_list *list,
+		     const plot_font_style_t *fstyle,
+		     int x,
+		     int y,
+		     const char *text,
+		     size_t length)
+{
+	return framebuffer_text_glyphs(fstyle, x, y, text, length,
+				       fb_tiled_record_glyph, list);
+}
+
+
+/**
+ * Replay a recorded glyph.
+ *
+ * \param ctx The redraw context to plot with.
+ * \param data The recorded glyph.
+ * \param dx The horizontal offset to apply.
+ * \param dy The vertical offset to apply.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+fb_tiled_replay_glyph(const struct redraw_context *ctx,
+		      const void *data,
+		      int dx, int dy)
+{
+	const struct fb_tiled_glyph *glyph = data;
+	nsfb_bbox_t loc;
+
+	loc.x0 = glyph->loc.x0 + dx;
+	loc.y0 = glyph->loc.y0 + dy;
+	loc.x1 = glyph->loc.x1 + dx;
+	loc.y1 = glyph->loc.y1 + dy;
+
+	if (glyph->mono) {
+		nsfb_plot_glyph1(ctx->priv, &loc,
+				 (const uint8_t *)(glyph + 1),
+				 glyph->pitch, glyph->c);
+	} else {
+		nsfb_plot_glyph8(ctx->priv, &loc,
+				 (const uint8_t *)(glyph + 1),
+				 glyph->pitch, glyph->c);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/** display list extension recording text as glyphs */
+static const struct plot_list_ext fb_tiled_ext = {
+	.text = fb_tiled_record_text,
+	.replay = fb_tiled_replay_glyph,
+};
+
+
+/**
+ * Copy an area between the screen and a surface.
+ *
+ * \param surface The surface holding the area at its origin.
+ * \param box The area on the screen.
+ * \param to_screen true to copy the area to the screen.
+ */
+static void
+fb_tiled_copy(nsfb_t *surface, const nsfb_bbox_t *box, bool to_screen)
+{
+	size_t len = (box->x1 - box->x0) * frame.bpp;
+	uint8_t *screen;
+	uint8_t *tile;
+	int linelen;
+	int y;
+
+	nsfb_get_buffer(surface, &tile, &linelen);
+
+	screen = frame.ptr + (box->y0 * frame.linelen) + (box->x0 * frame.bpp);
+	for (y = box->y0; y < box->y1; y++) {
+		if (to_screen) {
+			memcpy(screen, tile, len);
+		} else {
+			memcpy(tile, screen, len);
+		}
+		screen += frame.linelen;
+		tile += linelen;
+	}
+}
+
+
+/**
+ * Rasterise one tile of the recorded redraw.
+ *
+ * \param worker The rasterising thread.
+ * \param tile The index of the tile.
+ */
+static void fb_tiled_render_tile(struct fb_tiled_worker *worker, unsigned int tile)
+{
+	struct redraw_context ctx = {
+		.interactive = true,
+		.background_images = true,
+		.plot = &fb_plotters,
+		.priv = worker->surface,
+	};
+	nsfb_bbox_t box; /* tile on the screen */
+	struct rect clip; /* tile on the tile surface */
+
+	box.x0 = frame.area.x0 + (tile % frame.columns) * TILE_SIZE;
+	box.y0 = frame.area.y0 + (tile / frame.columns) * TILE_SIZE;
+	box.x1 = min(box.x0 + TILE_SIZE, frame.area.x1);
+	box.y1 = min(box.y0 + TILE_SIZE, frame.area.y1);
+
+	/* operations blend with what is already on the screen */
+	fb_tiled_copy(worker->surface, &box, false);
+
+	clip.x0 = 0;
+	clip.y0 = 0;
+	clip.x1 = box.x1 - box.x0;
+	clip.y1 = box.y1 - box.y0;
+	plot_list_replay(frame.list, &ctx, -box.x0, -box.y0, &clip);
+
+	fb_tiled_copy(worker->surface, &box, true);
+}
+
+
+#ifdef FB_USE_THREADS
+/**
+ * Rasterise tiles of the current redraw until none remain.
+ *
+ * \note Called and returns with the tiled lock held.
+ *
+ * \param worker The rasterising thread.
+ */
+static void fb_tiled_run(struct fb_tiled_worker *worker)
+{
+	unsigned int tile;
+
+	while (tiled_next < tiled_count) {
+		tile = tiled_next++;
+		pthread_mutex_unlock(&tiled_lock);
+
+		fb_tiled_render_tile(worker, tile);
+
+		pthread_mutex_lock(&tiled_lock);
+		tiled_finished++;
+		if (tiled_finished == tiled_count) {
+			pthread_cond_signal(&tiled_done);
+		}
+	}
+}
+
+
+/**
+ * Rasterising thread entry point.
+ */
+static void *fb_tiled_worker_main(void *pw)
+{
+	struct fb_tiled_worker *worker = pw;
+	unsigned int generation = 0;
+
+	pthread_mutex_lock(&tiled_lock);
+	while (!tiled_quit) {
+		if (generation == tiled_generation) {
+			pthread_cond_wait(&tiled_start, &tiled_lock);
+			continue;
+		}
+		generation = tiled_generation;
+		fb_tiled_run(worker);
+	}
+	pthread_mutex_unlock(&tiled_lock);
+
+	return NULL;
+}
+
+
+/**
+ * Rasterise all the tiles of the recorded redraw.
+ */
+static void fb_tiled_render(void)
+{
+	pthread_mutex_lock(&tiled_lock);
+	tiled_count = frame.columns * frame.rows;
+	tiled_next = 0;
+	tiled_finished = 0;
+	tiled_generation++;
+	pthread_cond_broadcast(&tiled_start);
+
+	/* the main thread rasterises tiles too */
+	fb_tiled_run(&workers[0]);
+
+	while (tiled_finished < tiled_count) {
+		pthread_cond_wait(&tiled_done, &tiled_lock);
+	}
+	pthread_mutex_unlock(&tiled_lock);
+}
+#endif
+
+
+/**
+ * Ensure the tile surfaces match the format of the screen.
+ *
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror fb_tiled_surfaces(enum nsfb_format_e format)
+{
+	int idx;
+
+	if (format == surface_format) {
+		return NSERROR_OK;
+	}
+
+	for (idx = 0; idx < worker_count; idx++) {
+		if (workers[idx].surface != NULL) {
+			nsfb_free(workers[idx].surface);
+			workers[idx].surface = NULL;
+		}
+	}
+	surface_format = NSFB_FMT_ANY;
+
+	for (idx = 0; idx < worker_count; idx++) {
+		nsfb_t *surface;
+
+		surface = nsfb_new(NSFB_SURFACE_RAM);
+		if (surface == NULL) {
+			return NSERROR_NOMEM;
+		}
+		if ((nsfb_set_geometry(surface, TILE_SIZE, TILE_SIZE, format) == -1) ||
+		    (nsfb_init(surface) == -1)) {
+			nsfb_free(surface);
+			return NSERROR_INIT_FAILED;
+		}
+		workers[idx].surface = surface;
+	}
+	surface_format = format;
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Start checking a tiled redraw.
+ *
+ * \return A surface holding the screen contents of the redrawn area
+ *         before rasterisation or NULL if the check is not possible.
+ */
+static nsfb_t *fb_tiled_check_begin(void)
+{
+	nsfb_t *surface;
+
+	surface = nsfb_new(NSFB_SURFACE_RAM);
+	if (surface == NULL) {
+		return NULL;
+	}
+	if ((nsfb_set_geometry(surface,
+			       frame.area.x1 - frame.area.x0,
+			       frame.area.y1 - frame.area.y0,
+			       frame.format) == -1) ||
+	    (nsfb_init(surface) == -1)) {
+		nsfb_free(surface);
+		return NULL;
+	}
+
+	fb_tiled_copy(surface, &frame.area, false);
+
+	return surface;
+}
+
+
+/**
+ * Finish checking a tiled redraw.
+ *
+ * The recorded redraw is replayed directly onto the surface holding
+ * the original screen contents, which must then match the screen the
+ * tiles were copied to.
+ *
+ * \param surface The surface from fb_tiled_check_begin().
+ */
+static void fb_tiled_check_end(nsfb_t *surface)
+{
+	struct redraw_context ctx = {
+		.interactive = true,
+		.background_images = true,
+		.plot = &fb_plotters,
+		.priv = surface,
+	};
+	size_t len = (frame.area.x1 - frame.area.x0) * frame.bpp;
+	struct rect clip;
+	uint8_t *screen;
+	uint8_t *direct;
+	int linelen;
+	int y;
+
+	clip.x0 = 0;
+	clip.y0 = 0;
+	clip.x1 = frame.area.x1 - frame.area.x0;
+	clip.y1 = frame.area.y1 - frame.area.y0;
+	plot_list_replay(frame.list, &ctx,
+			 -frame.area.x0, -frame.area.y0, &clip);
+
+	nsfb_get_buffer(surface, &direct, &linelen);
+	screen = frame.ptr + (frame.area.y0 * frame.linelen) +
+		(frame.area.x0 * frame.bpp);
+	for (y = frame.area.y0; y < frame.area.y1; y++) {
+		if (memcmp(screen, direct, len) != 0) {
+			NSLOG(netsurf, WARNING,
+			      "Tiled redraw of %d,%d %d,%d differs from direct at row %d",
+			      frame.area.x0, frame.area.y0,
+			      frame.area.x1, frame.area.y1, y);
+			break;
+		}
+		screen += frame.linelen;
+		direct += linelen;
+	}
+
+	nsfb_free(surface);
+}
+
+
+/* exported interface documented in framebuffer/tiled.h */
+bool
+fb_tiled_begin(nsfb_t *nsfb,
+	       const nsfb_bbox_t *area,
+	       const struct redraw_context *ctx,
+	       struct redraw_context *rec_ctx)
+{
+	enum nsfb_format_e format;
+	int width;
+	int height;
+
+	if (workers == NULL) {
+		return false;
+	}
+
+	nsfb_get_geometry(nsfb, &width, &height, &format);
+
+	/* tiles are copied to and from the screen a row at a time */
+	switch (format) {
+	case NSFB_FMT_XBGR8888:
+	case NSFB_FMT_XRGB8888:
+	case NSFB_FMT_ABGR8888:
+	case NSFB_FMT_ARGB8888:
+		frame.bpp = 4;
+		break;
+
+	case NSFB_FMT_RGB888:
+		frame.bpp = 3;
+		break;
+
+	case NSFB_FMT_ARGB1555:
+	case NSFB_FMT_RGB565:
+		frame.bpp = 2;
+		break;
+
+	default:
+		return false;
+	}
+
+	if (fb_tiled_surfaces(format) != NSERROR_OK) {
+		NSLOG(netsurf, INFO, "Unable to create tile surfaces");
+		return false;
+	}
+
+	frame.nsfb = nsfb;
+	frame.format = format;
+	nsfb_get_buffer(nsfb, &frame.ptr, &frame.linelen);
+
+	frame.area.x0 = max(area->x0, 0);
+	frame.area.y0 = max(area->y0, 0);
+	frame.area.x1 = min(area->x1, width);
+	frame.area.y1 = min(area->y1, height);
+
+	return (plot_list_record(frame.list, ctx, rec_ctx) == NSERROR_OK);
+}
+
+
+/* exported interface documented in framebuffer/tiled.h */
+nserror fb_tiled_end(void)
+{
+	struct redraw_context ctx = {
+		.interactive = true,
+		.background_images = true,
+		.plot = &fb_plotters,
+		.priv = frame.nsfb,
+	};
+	nsfb_t *check = NULL;
+	struct rect clip;
+	uint64_t trace;
+	nserror res;
+
+	res = plot_list_finish(frame.list);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	if ((frame.area.x0 >= frame.area.x1) ||
+	    (frame.area.y0 >= frame.area.y1)) {
+		return NSERROR_OK;
+	}
+
+	trace = nstrace_begin();
+
+	if (!plot_list_tileable(frame.list,
+				frame.area.x0, frame.area.y0, TILE_SIZE)) {
+		/* rasterise straight onto the screen */
+		clip.x0 = frame.area.x0;
+		clip.y0 = frame.area.y0;
+		clip.x1 = frame.area.x1;
+		clip.y1 = frame.area.y1;
+		plot_list_replay(frame.list, &ctx, 0, 0, &clip);
+	} else {
+		frame.columns = (frame.area.x1 - frame.area.x0 + TILE_SIZE - 1) / TILE_SIZE;
+		frame.rows = (frame.area.y1 - frame.area.y0 + TILE_SIZE - 1) / TILE_SIZE;
+
+		if (nsoption_bool(fb_tiled_check)) {
+			check = fb_tiled_check_begin();
+		}
+
+#ifdef FB_USE_THREADS
+		fb_tiled_render();
+#endif
+
+		if (check != NULL) {
+			fb_tiled_check_end(check);
+		}
+	}
+
+	/* the screen clip is left as it would have been set by the last
+	 * recorded clip operation
+	 */
+	if (plot_list_get_clip(frame.list, &clip)) {
+		fb_plotters.clip(&ctx, &clip);
+	}
+
+	nstrace_end("redraw", "rasterise", trace);
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in framebuffer/tiled.h */
+nserror fb_tiled_init(int threads)
+{
+#ifdef FB_USE_THREADS
+	int idx;
+
+	if (workers != NULL) {
+		/* already initialised */
+		return NSERROR_OK;
+	}
+
+	if (threads <= 0) {
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+	if (threads > TILED_MAX_THREADS) {
+		threads = TILED_MAX_THREADS;
+	}
+
+	if (plot_list_create(&fb_tiled_ext, &frame.list) != NSERROR_OK) {
+		return NSERROR_NOMEM;
+	}
+
+	workers = calloc(threads, sizeof(*workers));
+	if (workers == NULL) {
+		plot_list_destroy(frame.list);
+		frame.list = NULL;
+		return NSERROR_NOMEM;
+	}
+	worker_count = 1;
+
+	/* the first worker is the main thread */
+	for (idx = 1; idx < threads; idx++) {
+		if (pthread_create(&workers[idx].thread, NULL,
+				   fb_tiled_worker_main, &workers[idx]) != 0) {
+			NSLOG(netsurf, INFO, "Unable to create thread %d", idx);
+			break;
+		}
+		worker_count++;
+	}
+
+	NSLOG(netsurf, INFO, "Tiled rendering with %d threads", worker_count);
+
+	return NSERROR_OK;
+#else
+	NSLOG(netsurf, INFO, "Tiled rendering requires thread support");
+
+	return NSERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/* exported interface documented in framebuffer/tiled.h */
+void fb_tiled_finalise(void)
+{
+	int idx;
+
+	if (workers == NULL) {
+		return;
+	}
+
+#ifdef FB_USE_THREADS
+	pthread_mutex_lock(&tiled_lock);
+	tiled_quit = true;
+	pthread_cond_broadcast(&tiled_start);
+	pthread_mutex_unlock(&tiled_lock);
+
+	for (idx = 1; idx < worker_count; idx++) {
+		pthread_join(workers[idx].thread, NULL);
+	}
+#endif
+
+	for (idx = 0; idx < worker_count; idx++) {
+		if (workers[idx].surface != NULL) {
+			nsfb_free(workers[idx].surface);
+		}
+	}
+	free(workers);
+	workers = NULL;
+	worker_count = 0;
+	surface_format = NSFB_FMT_ANY;
+
+	plot_list_destroy(frame.list);
+	memset(&frame, 0, sizeof(frame));
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer tiled rendering interface.
+ *
+ * A redraw is recorded into a plot display list rather than being
+ * rasterised as it is plotted, with text recorded as the glyphs laid
+ * out by the main thread. The display list is then replayed for each
+ * tile of the redrawn area in turn, with the tiles shared between a
+ * pool of threads, and each finished tile is copied to the screen.
+ *
+ * Tiles are rasterised by the normal framebuffer plotters into a
+ * surface of the screen's own format, so the result is the same as
+ * plotting straight to the screen. Redraws containing an operation
+ * whose rasterisation depends on where it is clipped (diagonal or
+ * patterned lines) which crosses a tile boundary are rasterised
+ * directly instead.
+ */
+
+#ifndef NETSURF_FB_TILED_H
+#define NETSURF_FB_TILED_H
+
+/**
+ * Initialise tiled rendering.
+ *
+ * \param threads The number of threads to rasterise with, including
+ *                the calling thread, or zero for one per processor.
+ * \return NSERROR_OK on success else error code.
+ */
+nserror fb_tiled_init(int threads);
+
+/**
+ * Finalise tiled rendering, stopping the rasterising threads.
+ */
+void fb_tiled_finalise(void);
+
+/**
+ * Begin recording a redraw.
+ *
+ * \param nsfb The surface the redraw will be rendered to.
+ * \param area The area of the surface being redrawn.
+ * \param ctx The redraw context the redraw would be plotted with.
+ * \param rec_ctx Updated with the context to record the redraw with.
+ * \return true if the redraw should be plotted with rec_ctx or false
+ *         if tiled rendering is unavailable for the surface.
+ */
+bool fb_tiled_begin(nsfb_t *nsfb, const nsfb_bbox_t *area, const struct redraw_context *ctx, struct redraw_context *rec_ctx);
+
+/**
+ * Rasterise a recorded redraw.
+ *
+ * \return NSERROR_OK on success else error code if the redraw could not
+ *         be recorded, in which case it must be plotted directly.
+ */
+nserror fb_tiled_end(void);
+
+#endif
@@ -167,6 +167,31 @@ nsgtk_tab_label_setup(GtkWidget *page,
 }
 
 
+/**
+ * Mark the browser windows of all tabs other than the selected one hidden
+ *
+ * \param notebook The notebook containing the tabs
+ * \param selpage The notebook page selected
+ */
+static void
+nsgtk_tab_update_hidden(GtkNotebook *notebook, GtkWidget *selpage)
+{
+	gint pagec = gtk_notebook_get_n_pages(notebook);
+	gint pagen;
+
+	for (pagen = 0; pagen < pagec; pagen++) {
+		GtkWidget *page = gtk_notebook_get_nth_page(notebook, pagen);
+		struct gui_window *gw;
+
+		gw = g_object_get_data(G_OBJECT(page), "gui_window");
+		if (gw != NULL) {
+			browser_window_set_hidden(nsgtk_get_browser_window(gw),
+						  page != selpage);
+		}
+	}
+}
+
+
 /**
  * The before switch-page gtk signal handler
  *
@@ -214,6 +239,7 @@ nsgtk_tab_switch_page_after(GtkNotebook *notebook,
 	/* check if trying to select the "add page" tab */
 	if (selpage != addpage) {
 		NSLOG(netsurf, INFO, "sel %d", selpagenum);
+		nsgtk_tab_update_hidden(notebook, selpage);
 		menubar = nsgtk_scaffolding_menu_bar(nsgtk_scaffolding_from_notebook(notebook));
 		gw = g_object_get_data(G_OBJECT(selpage), "gui_window");
 		if (gw != NULL) {
@@ -655,6 +655,37 @@ monkey_window_handle_exec(int argc, char **argv)
 }
 
 
+static void
+monkey_window_handle_trace(int argc, char **argv)
+{
+	struct gui_window *gw;
+	unsigned int count = 0;
+	nserror res;
+
+	/* `WINDOW TRACE` _%id%_ _%path%_ */
+	if (argc != 4) {
+		moutf(MOUT_ERROR, "WINDOW TRACE ARGS BAD\n");
+		return;
+	}
+
+	gw = monkey_find_window_by_num(atoi(argv[2]));
+
+	if (gw == NULL) {
+		moutf(MOUT_ERROR, "WINDOW NUM BAD");
+		return;
+	}
+
+	res = browser_window_export_trace(gw->bw, argv[3], &count);
+	if (res != NSERROR_OK) {
+		moutf(MOUT_ERROR, "WINDOW TRACE FAILED %s",
+		      messages_get_errorcode(res));
+	} else {
+		moutf(MOUT_WINDOW, "TRACE WIN %d EVENTS %u",
+		      atoi(argv[2]), count);
+	}
+}
+
+
 static void
 monkey_window_handle_click(int argc, char **argv)
 {
@@ -719,6 +750,8 @@ monkey_window_handle_command(int argc, char **argv)
 		monkey_window_handle_exec(argc, argv);
 	} else if (strcmp(argv[1], "CLICK") == 0) {
 		monkey_window_handle_click(argc, argv);
+	} else if (strcmp(argv[1], "TRACE") == 0) {
+		monkey_window_handle_trace(argc, argv);
 	} else {
 		moutf(MOUT_ERROR, "WINDOW COMMAND UNKNOWN %s\n", argv[1]);
 	}
@@ -27,6 +27,7 @@
 #include <signal.h>
 
 #include "utils/config.h"
+#include "utils/utils.h"
 #include "utils/sys_time.h"
 #include "utils/log.h"
 #include "utils/messages.h"
@@ -50,6 +51,13 @@
 #include "monkey/bitmap.h"
 #include "monkey/layout.h"
 
+#include "messages/de.inc"
+#include "messages/en.inc"
+#include "messages/fr.inc"
+#include "messages/it.inc"
+#include "messages/nl.inc"
+#include "messages/zh_CN.inc"
+
 /** maximum number of languages in language vector */
 #define LANGV_SIZE 32
 /** maximum length of all strings in language vector */
@@ -176,6 +184,50 @@ static const char * const *get_languagev(void)
 	return &langv[0];
 }
 
+/**
+ * Messages compiled into the browser, one table per language.
+ */
+static const struct messages_table *monkey_messages[] = {
+	&messages_de,
+	&messages_en,
+	&messages_fr,
+	&messages_it,
+	&messages_nl,
+	&messages_zh_CN,
+};
+
+/**
+ * select the compiled messages for the preferred language
+ *
+ * A language from the environment matches a table if the table's
+ * language is the same or is the language without its territory,
+ * codeset or modifier, e.g. en_GB.UTF-8 matches en. English is used
+ * when no preferred language has a table.
+ */
+static const struct messages_table *monkey_messages_table(void)
+{
+	const char * const *langv;
+	const char *language;
+	size_t len;
+	size_t tidx;
+
+	for (langv = get_languagev(); *langv != NULL; langv++) {
+		for (tidx = 0; tidx < NOF_ELEMENTS(monkey_messages); tidx++) {
+			language = monkey_messages[tidx]->language;
+			len = strlen(language);
+			if ((strncmp(*langv, language, len) == 0) &&
+			    (((*langv)[len] == 0) ||
+			     ((*langv)[len] == '_') ||
+			     ((*langv)[len] == '.') ||
+			     ((*langv)[len] == '@'))) {
+				return monkey_messages[tidx];
+			}
+		}
+	}
+
+	return &messages_en;
+}
+
 /**
  * Create an array of valid paths to search for resources.
  *
@@ -388,7 +440,6 @@ signal_handler(int sig)
 int
 main(int argc, char **argv)
 {
-	char *messages;
 	char *options;
 	char buf[PATH_MAX];
 	nserror ret;
@@ -439,15 +490,13 @@ main(int argc, char **argv)
 	free(options);
 	nsoption_commandline(&argc, argv, nsoptions);
 
-	messages = filepath_find(respaths, "Messages");
-	ret = messages_add_from_file(messages);
+	ret = messages_set_table(monkey_messages_table());
 	if (ret != NSERROR_OK) {
 		NSLOG(netsurf, INFO, "Messages failed to load");
 	}
 
 	/* common initialisation */
 	ret = netsurf_init(NULL);
-	free(messages);
 	if (ret != NSERROR_OK) {
 		die("NetSurf failed to initialise");
 	}
@@ -290,6 +290,28 @@ nserror browser_window_get_extents(struct browser_window *bw, bool scaled,
  */
 bool browser_window_has_content(struct browser_window *bw);
 
+/**
+ * Set whether a browser window is hidden from the user.
+ *
+ * Frontends should mark a window hidden when, for example, it is in a
+ * tab which is not being shown so the core can reduce the work done
+ * for it, such as running its script timers less often.
+ *
+ * \param bw      browser window
+ * \param hidden  true if the window is hidden, false if it is shown
+ */
+void browser_window_set_hidden(struct browser_window *bw, bool hidden);
+
+/**
+ * Find out if a browser window is hidden from the user.
+ *
+ * A frame is hidden if the window containing it is hidden.
+ *
+ * \param bw	  browser window
+ * \return true if the browser window is hidden, else false.
+ */
+bool browser_window_is_hidden(struct browser_window *bw);
+
 /**
  * Get a cache handle for the content within a browser window.
  */
@@ -796,6 +818,40 @@ nserror browser_window_get_ssl_chain(struct browser_window *bw, struct cert_chai
 int browser_window_get_cookie_count(
 		const struct browser_window *bw);
 
+/**
+ * Get the memory used by javascript for the current page.
+ *
+ * If the browser window has no javascript heap, this will return
+ * NSERROR_NOT_FOUND
+ *
+ * \param bw  A browser window.
+ * \param used  Updated with the number of bytes in use.
+ * \param limit  Updated with the limit in bytes, or 0 if unlimited.
+ * \return NSERROR_OK on success, appropriate error code otherwise.
+ */
+nserror browser_window_get_script_memory(
+		const struct browser_window *bw,
+		size_t *used,
+		size_t *limit);
+
+/**
+ * Export the page load trace recorded for a browser window.
+ *
+ * The spans recorded while loading, laying out and redrawing pages in
+ * the window are written in the Chrome trace event format, which can be
+ * loaded into about:tracing or Perfetto.
+ *
+ * \param bw  A browser window.
+ * \param path  Path of file to write.
+ * \param count  Updated with the number of spans written, may be NULL.
+ * \return NSERROR_OK on success, NSERROR_INIT_FAILED if tracing is not
+ *         enabled, or appropriate error code otherwise.
+ */
+nserror browser_window_export_trace(
+		const struct browser_window *bw,
+		const char *path,
+		unsigned int *count);
+
 /**
  * Open cookie viewer for the current page.
  *
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Test framebuffer damage accumulation.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "framebuffer/damage.h"
+
+/** width of the window the damage is recorded in */
+#define WIN_WIDTH 800
+/** height of the window the damage is recorded in */
+#define WIN_HEIGHT 800
+
+/** pixels which have been damaged */
+static bool damaged[WIN_HEIGHT][WIN_WIDTH];
+
+/** the damage set under test */
+static struct fb_damage damage;
+
+static void damage_setup(void)
+{
+	fb_damage_clear(&damage);
+	memset(damaged, 0, sizeof(damaged));
+}
+
+static void damage_teardown(void)
+{
+}
+
+/**
+ * Add an area to the damage set and note its pixels as damaged.
+ */
+static void add(int x0, int y0, int x1, int y1)
+{
+	nsfb_bbox_t area = { x0, y0, x1, y1 };
+	int x;
+	int y;
+
+	fb_damage_add(&damage, &area);
+
+	for (y = y0; y < y1; y++) {
+		for (x = x0; x < x1; x++) {
+			damaged[y][x] = true;
+		}
+	}
+}
+
+/**
+ * Check the damage set covers every damaged pixel, holds no more than
+ * the maximum number of rectangles and has none inside another.
+ */
+static void check_invariants(void)
+{
+	unsigned int idx;
+	unsigned int other;
+	const nsfb_bbox_t *a;
+	const nsfb_bbox_t *b;
+	int x;
+	int y;
+
+	ck_assert(damage.count <= FB_DAMAGE_MAX);
+
+	for (idx = 0; idx < damage.count; idx++) {
+		a = &damage.rect[idx];
+		ck_assert(a->x0 < a->x1);
+		ck_assert(a->y0 < a->y1);
+
+		for (other = 0; other < damage.count; other++) {
+			b = &damage.rect[other];
+			if (other == idx) {
+				continue;
+			}
+			ck_assert(!((a->x0 <= b->x0) && (a->y0 <= b->y0) &&
+				    (a->x1 >= b->x1) && (a->y1 >= b->y1)));
+		}
+	}
+
+	for (y = 0; y < WIN_HEIGHT; y++) {
+		for (x = 0; x < WIN_WIDTH; x++) {
+			bool covered = false;
+
+			if (!damaged[y][x]) {
+				continue;
+			}
+			for (idx = 0; idx < damage.count; idx++) {
+				a = &damage.rect[idx];
+				if ((x >= a->x0) && (x < a->x1) &&
+				    (y >= a->y0) && (y < a->y1)) {
+					covered = true;
+					break;
+				}
+			}
+			ck_assert(covered);
+		}
+	}
+}
+
+
+START_TEST(damage_empty_test)
+{
+	add(10, 10, 10, 20);
+	add(10, 20, 30, 20);
+	add(30, 30, 20, 40);
+
+	ck_assert(fb_damage_empty(&damage));
+}
+END_TEST
+
+START_TEST(damage_contained_test)
+{
+	add(0, 0, 100, 100);
+	add(10, 10, 20, 20);
+
+	ck_assert_int_eq(damage.count, 1);
+	ck_assert_int_eq(damage.rect[0].x1, 100);
+	check_invariants();
+}
+END_TEST
+
+START_TEST(damage_separate_test)
+{
+	/* far apart, their union would cost far more than both */
+	add(0, 0, 10, 10);
+	add(300, 200, 310, 210);
+
+	ck_assert_int_eq(damage.count, 2);
+	check_invariants();
+}
+END_TEST
+
+START_TEST(damage_adjacent_test)
+{
+	/* side by side, their union costs no more than both */
+	add(0, 0, 100, 50);
+	add(100, 0, 200, 50);
+
+	ck_assert_int_eq(damage.count, 1);
+	ck_assert_int_eq(damage.rect[0].x0, 0);
+	ck_assert_int_eq(damage.rect[0].x1, 200);
+	check_invariants();
+}
+END_TEST
+
+START_TEST(damage_cover_test)
+{
+	/* a rectangle covering existing ones replaces them */
+	add(0, 0, 10, 10);
+	add(300, 200, 310, 210);
+	add(0, 0, WIN_WIDTH, WIN_HEIGHT);
+
+	ck_assert_int_eq(damage.count, 1);
+	check_invariants();
+}
+END_TEST
+
+START_TEST(damage_full_test)
+{
+	unsigned int idx;
+	bool merged = false;
+
+	/* squares down the diagonal, each pair far enough apart that
+	 * their union costs more than both, fill the set
+	 */
+	for (idx = 0; idx < FB_DAMAGE_MAX; idx++) {
+		add(idx * 110, idx * 110, idx * 110 + 10, idx * 110 + 10);
+	}
+	ck_assert_int_eq(damage.count, FB_DAMAGE_MAX);
+
+	/* once full a new area is merged with the existing rectangle
+	 * cheapest to merge it with, here the one at the origin
+	 */
+	add(700, 0, 710, 10);
+
+	ck_assert_int_eq(damage.count, FB_DAMAGE_MAX);
+	for (idx = 0; idx < damage.count; idx++) {
+		if ((damage.rect[idx].x0 == 0) &&
+		    (damage.rect[idx].y0 == 0) &&
+		    (damage.rect[idx].x1 == 710) &&
+		    (damage.rect[idx].y1 == 10)) {
+			merged = true;
+		}
+	}
+	ck_assert(merged);
+	check_invariants();
+}
+END_TEST
+
+START_TEST(damage_random_test)
+{
+	int idx;
+	int x;
+	int y;
+
+	srand(_i + 1);
+	for (idx = 0; idx < 200; idx++) {
+		x = rand() % (WIN_WIDTH - 1);
+		y = rand() % (WIN_HEIGHT - 1);
+		add(x, y,
+		    x + 1 + rand() % (WIN_WIDTH - x - 1),
+		    y + 1 + rand() % ((WIN_HEIGHT - y - 1) / 4 + 1));
+		check_invariants();
+	}
+}
+END_TEST
+
+START_TEST(damage_translate_test)
+{
+	add(0, 0, 10, 10);
+	add(700, 700, 710, 710);
+
+	/* the second rectangle is clipped to the window */
+	fb_damage_translate(&damage, 95, 95, WIN_WIDTH, WIN_HEIGHT);
+
+	ck_assert_int_eq(damage.count, 2);
+
+	/* the first rectangle leaves the window */
+	fb_damage_translate(&damage, -200, 0, WIN_WIDTH, WIN_HEIGHT);
+
+	ck_assert_int_eq(damage.count, 1);
+	ck_assert_int_eq(damage.rect[0].x0, 595);
+	ck_assert_int_eq(damage.rect[0].y0, 795);
+	ck_assert_int_eq(damage.rect[0].x1, 600);
+	ck_assert_int_eq(damage.rect[0].y1, WIN_HEIGHT);
+}
+END_TEST
+
+
+static Suite *fbdamage_suite(void)
+{
+	Suite *s;
+	TCase *tc_damage;
+
+	s = suite_create("Framebuffer damage");
+
+	tc_damage = tcase_create("Accumulation");
+
+	tcase_add_checked_fixture(tc_damage, damage_setup, damage_teardown);
+
+	tcase_add_test(tc_damage, damage_empty_test);
+	tcase_add_test(tc_damage, damage_contained_test);
+	tcase_add_test(tc_damage, damage_separate_test);
+	tcase_add_test(tc_damage, damage_adjacent_test);
+	tcase_add_test(tc_damage, damage_cover_test);
+	tcase_add_test(tc_damage, damage_full_test);
+	tcase_add_loop_test(tc_damage, damage_random_test, 0, 16);
+	tcase_add_test(tc_damage, damage_translate_test);
+
+	suite_add_tcase(s, tc_damage);
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	SRunner *sr;
+
+	sr = srunner_create(fbdamage_suite());
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
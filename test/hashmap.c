@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <check.h>
 #include <limits.h>
 
@@ -181,6 +182,18 @@ basic_fixture_create(void)
 	ck_assert_int_eq(values, 0);
 }
 
+static void
+open_fixture_create(void)
+{
+	corestring_create();
+
+	test_hashmap = hashmap_create_open(&test_params, 0);
+
+	ck_assert(test_hashmap != NULL);
+	ck_assert_int_eq(keys, 0);
+	ck_assert_int_eq(values, 0);
+}
+
 static void
 basic_fixture_teardown(void)
 {
@@ -299,6 +312,29 @@ static TCase *basic_api_case_create(void)
 	return tc;
 }
 
+static TCase *open_api_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Open addressing API");
+
+	tcase_add_unchecked_fixture(tc,
+				    open_fixture_create,
+				    basic_fixture_teardown);
+
+	tcase_add_test(tc, empty_hashmap_create_destroy);
+	tcase_add_test(tc, check_not_present);
+	tcase_add_test(tc, insert_works);
+	tcase_add_test(tc, remove_not_present);
+	tcase_add_test(tc, insert_then_remove);
+	tcase_add_test(tc, insert_then_lookup);
+
+	tcase_add_test(tc, iterate_empty);
+	tcase_add_test(tc, iterate_one);
+	tcase_add_test(tc, iterate_one_and_stop);
+
+	return tc;
+}
+
 /* Chain verification test suite */
 
 typedef struct {
@@ -341,6 +377,18 @@ chain_fixture_create(void)
 	
 }
 
+static void
+open_chain_fixture_create(void)
+{
+	case_pair *chain_case = chain_pairs;
+	open_fixture_create();
+
+	while (chain_case->url != NULL) {
+		ck_assert(nsurl_create(chain_case->url, &chain_case->nsurl) == NSERROR_OK);
+		chain_case++;
+	}
+}
+
 static void
 chain_fixture_teardown(void)
 {
@@ -479,12 +527,18 @@ END_TEST
 
 #define CHAIN_TEST_MALLOC_COUNT_MAX 60
 
-START_TEST(chain_add_all_remove_all_alloc)
+/* The open addressing map allocates no entries and the test cases fit
+ * in its initial table.
+ */
+#define OPEN_TEST_MALLOC_COUNT_MAX 48
+
+static void
+add_all_remove_all_alloc(unsigned int limit, unsigned int count_max)
 {
 	bool failed = false;
 	case_pair *chain_case;
 		
-	malloc_limit(_i);
+	malloc_limit(limit);
 
 	for (chain_case = chain_pairs;
 	     chain_case->url != NULL;
@@ -513,12 +567,22 @@ START_TEST(chain_add_all_remove_all_alloc)
 	ck_assert_int_eq(keys, 0);
 	ck_assert_int_eq(values, 0);
 	
-	if (_i < CHAIN_TEST_MALLOC_COUNT_MAX) {
+	if (limit < count_max) {
 		ck_assert(failed);
 	} else {
 		ck_assert(!failed);
 	}
-	
+}
+
+START_TEST(chain_add_all_remove_all_alloc)
+{
+	add_all_remove_all_alloc(_i, CHAIN_TEST_MALLOC_COUNT_MAX);
+}
+END_TEST
+
+START_TEST(open_add_all_remove_all_alloc)
+{
+	add_all_remove_all_alloc(_i, OPEN_TEST_MALLOC_COUNT_MAX);
 }
 END_TEST
 
@@ -541,6 +605,189 @@ static TCase *chain_case_create(void)
 	return tc;
 }
 
+static TCase *open_chain_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Open addressing collision tests");
+
+	tcase_add_unchecked_fixture(tc,
+				    open_chain_fixture_create,
+				    chain_fixture_teardown);
+
+	tcase_add_test(tc, chain_add_remove_all);
+	tcase_add_test(tc, chain_add_all_remove_all);
+	tcase_add_test(tc, chain_add_all_twice_remove_all);
+	tcase_add_test(tc, chain_add_all_twice_remove_all_iterate);
+
+	tcase_add_loop_test(tc, open_add_all_remove_all_alloc, 0, OPEN_TEST_MALLOC_COUNT_MAX + 1);
+
+	return tc;
+}
+
+/* Large map tests, which also report throughput */
+
+/** Number of keys in the large map tests */
+#define MANY_KEYS 50000
+
+static nsurl *many_keys[MANY_KEYS];
+
+static uint32_t
+many_key_hash(void *key)
+{
+	return nsurl_hash((nsurl *)key);
+}
+
+static hashmap_parameters_t many_params = {
+	.key_clone = key_clone,
+	.key_hash = many_key_hash,
+	.key_eq = key_eq,
+	.key_destroy = key_destroy,
+	.value_alloc = value_alloc,
+	.value_destroy = value_destroy,
+};
+
+static void
+many_fixture_create(void)
+{
+	char url[64];
+	int idx;
+
+	corestring_create();
+
+	for (idx = 0; idx < MANY_KEYS; idx++) {
+		snprintf(url, sizeof(url), "http://host%d.example.com/%d.html",
+			 idx % 97, idx);
+		ck_assert(nsurl_create(url, &many_keys[idx]) == NSERROR_OK);
+	}
+}
+
+static void
+many_fixture_teardown(void)
+{
+	int idx;
+
+	for (idx = 0; idx < MANY_KEYS; idx++) {
+		nsurl_unref(many_keys[idx]);
+		many_keys[idx] = NULL;
+	}
+
+	ck_assert_int_eq(keys, 0);
+	ck_assert_int_eq(values, 0);
+
+	corestring_teardown();
+}
+
+static double
+elapsed_ms(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) * 1000.0 +
+		(now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Insert many keys, look them all up, remove half and check the rest
+ *
+ * \param hashmap The map to exercise
+ * \param name The map's name for the throughput report
+ */
+static void
+many_exercise(hashmap_t *hashmap, const char *name)
+{
+	struct timespec start;
+	double insert_ms, lookup_ms, remove_ms;
+	hashmap_test_value_t *value;
+	int idx;
+
+	ck_assert(hashmap != NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (idx = 0; idx < MANY_KEYS; idx++) {
+		ck_assert(hashmap_insert(hashmap, many_keys[idx]) != NULL);
+	}
+	insert_ms = elapsed_ms(&start);
+
+	ck_assert_int_eq(hashmap_count(hashmap), MANY_KEYS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (idx = 0; idx < MANY_KEYS; idx++) {
+		value = hashmap_lookup(hashmap, many_keys[idx]);
+		ck_assert(value != NULL);
+		ck_assert(nsurl_compare(value->key, many_keys[idx],
+					NSURL_COMPLETE));
+	}
+	lookup_ms = elapsed_ms(&start);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (idx = 1; idx < MANY_KEYS; idx += 2) {
+		ck_assert(hashmap_remove(hashmap, many_keys[idx]) == true);
+	}
+	remove_ms = elapsed_ms(&start);
+
+	ck_assert_int_eq(hashmap_count(hashmap), MANY_KEYS / 2);
+
+	for (idx = 0; idx < MANY_KEYS; idx++) {
+		value = hashmap_lookup(hashmap, many_keys[idx]);
+		if ((idx & 1) == 0) {
+			ck_assert(value != NULL);
+		} else {
+			ck_assert(value == NULL);
+		}
+	}
+
+	iteration_counter = 0;
+	iteration_stop = 0;
+	ck_assert(hashmap_iterate(hashmap, hashmap_test_iterator_cb, &iteration_ctx) == false);
+	ck_assert_int_eq(iteration_counter, MANY_KEYS / 2);
+
+	fprintf(stderr, "%s: %d keys insert %.1fms lookup %.1fms remove %.1fms\n",
+		name, MANY_KEYS, insert_ms, lookup_ms, remove_ms);
+
+	hashmap_destroy(hashmap);
+
+	ck_assert_int_eq(keys, 0);
+	ck_assert_int_eq(values, 0);
+}
+
+START_TEST(many_chained)
+{
+	many_exercise(hashmap_create(&many_params), "chained");
+}
+END_TEST
+
+START_TEST(many_open)
+{
+	many_exercise(hashmap_create_open(&many_params, 0), "open");
+}
+END_TEST
+
+START_TEST(many_open_sized)
+{
+	many_exercise(hashmap_create_open(&many_params, MANY_KEYS), "open sized");
+}
+END_TEST
+
+static TCase *many_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Large map tests");
+
+	tcase_add_unchecked_fixture(tc,
+				    many_fixture_create,
+				    many_fixture_teardown);
+
+	tcase_set_timeout(tc, 60);
+
+	tcase_add_test(tc, many_chained);
+	tcase_add_test(tc, many_open);
+	tcase_add_test(tc, many_open_sized);
+
+	return tc;
+}
+
 /*
  * hashmap test suite creation
  */
@@ -551,6 +798,9 @@ static Suite *hashmap_suite_create(void)
 
 	suite_add_tcase(s, basic_api_case_create());
 	suite_add_tcase(s, chain_case_create());
+	suite_add_tcase(s, open_api_case_create());
+	suite_add_tcase(s, open_chain_case_create());
+	suite_add_tcase(s, many_case_create());
 
 	return s;
 }
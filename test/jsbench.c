@@ -0,0 +1,277 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Javascript bytecode cache microbenchmark.
+ *
+ * Each script named on the command line is compiled from source
+ * repeatedly as js_exec() did before the bytecode cache, then through
+ * the cache, where every pass after the first loads cached bytecode,
+ * and finally as a built in script is on each new thread.
+ *
+ * Finally the cost of a cache hit on a small script is measured with
+ * only that script cached and while cycling through many, which shows
+ * whether finding an entry depends on how many there are.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "duktape.h"
+#include "bytecode.h"
+
+#define PASSES 200
+
+/** number of small scripts the cache is filled with */
+#define FILL_SCRIPTS 1000
+
+/** smallest size of each small script */
+#define FILL_SCRIPT_SIZE 1100
+
+/* duktape is configured to call this to check for script timeouts */
+duk_bool_t dukky_check_timeout(void *udata)
+{
+	return 0;
+}
+
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+
+/**
+ * Read a whole file.
+ */
+static uint8_t *load(const char *path, size_t *len)
+{
+	FILE *fh;
+	long size;
+	uint8_t *data;
+
+	fh = fopen(path, "rb");
+	if (fh == NULL) {
+		fprintf(stderr, "Unable to open %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	fseek(fh, 0, SEEK_END);
+	size = ftell(fh);
+	fseek(fh, 0, SEEK_SET);
+
+	data = malloc(size);
+	if ((data == NULL) || (fread(data, 1, size, fh) != (size_t)size)) {
+		fprintf(stderr, "Unable to read %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	fclose(fh);
+
+	*len = size;
+	return data;
+}
+
+
+/** ways of compiling a script */
+enum bench_mode {
+	BENCH_SOURCE, /**< from source every time */
+	BENCH_CACHED, /**< through the bytecode cache */
+	BENCH_BUILTIN, /**< as a built in script */
+};
+
+/**
+ * Time compiling a script.
+ *
+ * \param ctx The context to compile in.
+ * \param name The name of the script.
+ * \param src The script source.
+ * \param len The length of the source.
+ * \param mode How to compile the script.
+ * \return The mean time per compile in us.
+ */
+static double
+bench_compile(duk_context *ctx,
+	      const char *name,
+	      const uint8_t *src,
+	      size_t len,
+	      enum bench_mode mode)
+{
+	struct dukky_bytecode *builtin = NULL;
+	double start;
+	int pass;
+
+	start = now();
+	for (pass = 0; pass < PASSES; pass++) {
+		duk_int_t res;
+
+		if (mode == BENCH_CACHED) {
+			res = dukky_bytecode_compile(ctx, src, len, name);
+		} else if (mode == BENCH_BUILTIN) {
+			res = dukky_bytecode_compile_builtin(ctx, &builtin,
+							     src, len, name);
+		} else {
+			duk_push_string(ctx, name);
+			res = duk_pcompile_lstring_filename(ctx,
+					DUK_COMPILE_EVAL,
+					(const char *)src, len);
+		}
+		if (res != 0) {
+			fprintf(stderr, "Unable to compile %s: %s\n",
+				name, duk_safe_to_string(ctx, -1));
+			exit(EXIT_FAILURE);
+		}
+		duk_pop(ctx);
+	}
+	dukky_bytecode_free_builtin(builtin);
+
+	return (now() - start) * 1e6 / PASSES;
+}
+
+
+/**
+ * Compile a script through the bytecode cache, discarding the result.
+ */
+static void
+prime(duk_context *ctx, const char *name, const uint8_t *src, size_t len)
+{
+	if (dukky_bytecode_compile(ctx, src, len, name) != 0) {
+		fprintf(stderr, "Unable to compile %s: %s\n",
+			name, duk_safe_to_string(ctx, -1));
+		exit(EXIT_FAILURE);
+	}
+	duk_pop(ctx);
+}
+
+
+/**
+ * Generate a small script distinct from all others.
+ */
+static size_t fill_script(int idx, char *name, size_t namelen, char *src)
+{
+	size_t len = 0;
+
+	snprintf(name, namelen, "fill%d.js", idx);
+	while (len < FILL_SCRIPT_SIZE) {
+		len += snprintf(src + len, FILL_SCRIPT_SIZE * 2 - len,
+				"var v%d_%zu = %zu;\n", idx, len, len);
+	}
+
+	return len;
+}
+
+
+/**
+ * Time cache hits cycling through a number of small scripts.
+ *
+ * Every script is compiled once beforehand so only hits are timed.
+ *
+ * \param ctx The context to compile in.
+ * \param count The number of scripts.
+ * \return The mean time per hit in us.
+ */
+static double bench_hits(duk_context *ctx, int count)
+{
+	char name[32];
+	char src[FILL_SCRIPT_SIZE * 2];
+	size_t len;
+	double start;
+	double elapsed = 0;
+	int pass;
+	int idx;
+
+	dukky_bytecode_finalise();
+	for (idx = 0; idx < count; idx++) {
+		len = fill_script(idx, name, sizeof(name), src);
+		prime(ctx, name, (uint8_t *)src, len);
+	}
+
+	for (pass = 0; pass < PASSES; pass++) {
+		for (idx = 0; idx < count; idx++) {
+			len = fill_script(idx, name, sizeof(name), src);
+			start = now();
+			prime(ctx, name, (uint8_t *)src, len);
+			elapsed += now() - start;
+		}
+	}
+
+	return elapsed * 1e6 / (PASSES * count);
+}
+
+
+int main(int argc, char **argv)
+{
+	duk_context *ctx;
+	uint8_t *src;
+	size_t len;
+	double direct;
+	double cached;
+	double builtin;
+	int arg;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s script.js...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ctx = duk_create_heap_default();
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	printf("%-24s %10s %12s %12s %12s\n", "script", "bytes",
+	       "compile", "cached", "builtin");
+
+	for (arg = 1; arg < argc; arg++) {
+		src = load(argv[arg], &len);
+
+		direct = bench_compile(ctx, argv[arg], src, len,
+				       BENCH_SOURCE);
+
+		/* compile once so every timed pass is a cache hit */
+		dukky_bytecode_finalise();
+		prime(ctx, argv[arg], src, len);
+		cached = bench_compile(ctx, argv[arg], src, len,
+				       BENCH_CACHED);
+
+		/* includes the first pass compiling from source */
+		builtin = bench_compile(ctx, argv[arg], src, len,
+					BENCH_BUILTIN);
+
+		printf("%-24s %10zu %9.1f us %9.1f us %9.1f us\n",
+		       argv[arg], len, direct, cached, builtin);
+
+		free(src);
+	}
+
+	printf("hit with %4d scripts cached %9.1f us\n", 1,
+	       bench_hits(ctx, 1));
+	printf("hit with %4d scripts cached %9.1f us\n", FILL_SCRIPTS,
+	       bench_hits(ctx, FILL_SCRIPTS));
+
+	dukky_bytecode_finalise();
+	duk_destroy_heap(ctx);
+
+	return EXIT_SUCCESS;
+}
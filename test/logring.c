@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Test binary log ring recording and decoding.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "utils/errors.h"
+#include "utils/log_ring.h"
+
+/** Prefix of every decoded line after the timestamp */
+#define LINE_PREFIX "[INFO test] test.c:42 test_func: "
+
+/** Call site used for all test messages */
+static int test_site;
+
+static void test_describe(const void *site, struct nslog_ring_site *desc)
+{
+	ck_assert(site == &test_site);
+
+	desc->level = "INFO";
+	desc->category = "test";
+	desc->category_len = 4;
+	desc->file = "test.c";
+	desc->file_len = 6;
+	desc->func = "test_func";
+	desc->func_len = 9;
+	desc->line = 42;
+}
+
+static void test_log(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	nslog_ring_record(&test_site, fmt, ap);
+	va_end(ap);
+}
+
+/** Expected messages */
+static char expected[8][512];
+static int n_expected;
+
+/** Record a message and what it should decode as */
+#define TEST_LOG(fmt, ...) do {						\
+		test_log(fmt, __VA_ARGS__);				\
+		snprintf(expected[n_expected++], sizeof(expected[0]),	\
+			 fmt, __VA_ARGS__);				\
+	} while (0)
+
+/**
+ * Write and decode the ring, then compare against the expected messages.
+ */
+static void check_decode(int first)
+{
+	char line[1024];
+	FILE *bin;
+	FILE *text;
+	int idx = first;
+
+	bin = tmpfile();
+	text = tmpfile();
+	ck_assert(bin != NULL && text != NULL);
+
+	ck_assert_int_eq(nslog_ring_write(bin, test_describe), NSERROR_OK);
+	rewind(bin);
+	ck_assert_int_eq(nslog_ring_decode(bin, text), NSERROR_OK);
+	rewind(text);
+
+	while (fgets(line, sizeof(line), text) != NULL) {
+		char *msg = strstr(line, ") ");
+
+		ck_assert(msg != NULL);
+		msg += 2;
+		line[strlen(line) - 1] = 0;
+
+		ck_assert_int_lt(idx, n_expected);
+		ck_assert_int_eq(strncmp(msg, LINE_PREFIX,
+					 strlen(LINE_PREFIX)), 0);
+		ck_assert_str_eq(msg + strlen(LINE_PREFIX), expected[idx]);
+		idx++;
+	}
+	ck_assert_int_eq(idx, n_expected);
+
+	fclose(text);
+	fclose(bin);
+}
+
+static void ring_setup(void)
+{
+	n_expected = 0;
+	ck_assert_int_eq(nslog_ring_init(4), NSERROR_OK);
+}
+
+static void ring_teardown(void)
+{
+	nslog_ring_fini();
+}
+
+
+START_TEST(logring_format_test)
+{
+	TEST_LOG("%d %u %x %ld %lld %zu %c %hhd %%",
+		 -3, 4000000000u, 255, -1L, 1LL << 40, (size_t)7, 'q', 300);
+	TEST_LOG("%-5s|%.*s|%5.2f|%e", "ab", 3, "abcdef", 3.14159, 1e10);
+	TEST_LOG("%*d|%-*.*s|%08.3f", 6, 42, 8, 2, "hello", -2.5);
+	TEST_LOG("%s", "no conversions follow");
+
+	check_decode(0);
+}
+END_TEST
+
+START_TEST(logring_wrap_test)
+{
+	int i;
+
+	for (i = 0; i < 7; i++) {
+		TEST_LOG("message %d of %s", i, "seven");
+	}
+
+	/* Only the newest four records remain */
+	check_decode(3);
+}
+END_TEST
+
+START_TEST(logring_truncate_test)
+{
+	char big[400];
+	char line[1024];
+	FILE *bin;
+	FILE *text;
+
+	memset(big, 'x', sizeof(big) - 1);
+	big[sizeof(big) - 1] = 0;
+
+	test_log("%s then %d", big, 5);
+
+	bin = tmpfile();
+	text = tmpfile();
+	ck_assert(bin != NULL && text != NULL);
+
+	ck_assert_int_eq(nslog_ring_write(bin, test_describe), NSERROR_OK);
+	rewind(bin);
+	ck_assert_int_eq(nslog_ring_decode(bin, text), NSERROR_OK);
+	rewind(text);
+
+	/* String is cut short and arguments that did not fit are elided */
+	ck_assert(fgets(line, sizeof(line), text) != NULL);
+	ck_assert(strstr(line, "xxxx then ...\n") != NULL);
+	ck_assert(strlen(line) < sizeof(big));
+
+	fclose(text);
+	fclose(bin);
+}
+END_TEST
+
+START_TEST(logring_long_spec_test)
+{
+	char fmt[128];
+	char line[1024];
+	FILE *bin;
+	FILE *text;
+
+	/* flags far longer than a conversion is rebuilt in */
+	fmt[0] = '%';
+	memset(fmt + 1, '-', 100);
+	strcpy(fmt + 101, "d end");
+
+	test_log(fmt, 5);
+
+	bin = tmpfile();
+	text = tmpfile();
+	ck_assert(bin != NULL && text != NULL);
+
+	ck_assert_int_eq(nslog_ring_write(bin, test_describe), NSERROR_OK);
+	rewind(bin);
+	ck_assert_int_eq(nslog_ring_decode(bin, text), NSERROR_OK);
+	rewind(text);
+
+	/* The conversion is elided rather than overflowing */
+	ck_assert(fgets(line, sizeof(line), text) != NULL);
+	ck_assert(strstr(line, LINE_PREFIX "...\n") != NULL);
+
+	fclose(text);
+	fclose(bin);
+}
+END_TEST
+
+START_TEST(logring_invalid_test)
+{
+	FILE *bin;
+
+	bin = tmpfile();
+	ck_assert(bin != NULL);
+
+	fputs("not a log ring", bin);
+	rewind(bin);
+	ck_assert_int_eq(nslog_ring_decode(bin, stdout), NSERROR_INVALID);
+
+	fclose(bin);
+}
+END_TEST
+
+
+static Suite *logring_suite(void)
+{
+	Suite *s;
+	TCase *tc_ring;
+
+	s = suite_create("logring");
+
+	tc_ring = tcase_create("Ring");
+	tcase_add_checked_fixture(tc_ring, ring_setup, ring_teardown);
+
+	tcase_add_test(tc_ring, logring_format_test);
+	tcase_add_test(tc_ring, logring_wrap_test);
+	tcase_add_test(tc_ring, logring_truncate_test);
+	tcase_add_test(tc_ring, logring_long_spec_test);
+	tcase_add_test(tc_ring, logring_invalid_test);
+
+	suite_add_tcase(s, tc_ring);
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	SRunner *sr;
+
+	sr = srunner_create(logring_suite());
+
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
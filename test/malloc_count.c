@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * heap allocation counter.
+ *
+ * This library is preloaded into the browser by the page load benchmark
+ * to count heap allocations. When the MALLOC_COUNT_FILE environment
+ * variable names a file the counters are kept in a shared mapping of it
+ * so they can be read while the browser runs. The file holds three
+ * native endian 64bit values: the number of allocations, the number of
+ * bytes requested and the number of frees.
+ */
+
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* the C library allocator the counting wrappers pass through to */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+struct malloc_count {
+	uint64_t allocs; /**< number of allocations */
+	uint64_t bytes; /**< number of bytes requested */
+	uint64_t frees; /**< number of frees */
+};
+
+static struct malloc_count local_count;
+static struct malloc_count *count = &local_count;
+
+__attribute__((constructor))
+static void malloc_count_init(void)
+{
+	const char *path;
+	void *map;
+	int fd;
+
+	path = getenv("MALLOC_COUNT_FILE");
+	if (path == NULL) {
+		return;
+	}
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1) {
+		return;
+	}
+
+	if (ftruncate(fd, sizeof(struct malloc_count)) == 0) {
+		map = mmap(NULL, sizeof(struct malloc_count),
+			   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map != MAP_FAILED) {
+			*(struct malloc_count *)map = local_count;
+			count = map;
+		}
+	}
+
+	close(fd);
+}
+
+static inline void count_alloc(size_t size)
+{
+	__atomic_fetch_add(&count->allocs, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&count->bytes, size, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size)
+{
+	count_alloc(size);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	count_alloc(nmemb * size);
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	count_alloc(size);
+	return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+	if (ptr != NULL) {
+		__atomic_fetch_add(&count->frees, 1, __ATOMIC_RELAXED);
+	}
+	__libc_free(ptr);
+}
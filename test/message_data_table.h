@@ -0,0 +1,848 @@
+/* This message table is automatically generated from resources/FatMessages
+ * at build-time.  Please go and edit that instead of this.
+ */
+
+#include "utils/messages_table.h"
+
+static const uint16_t test_data_table_seeds[] = {
+	7, 1, 12, 2, 0, 17, 3, 0, 0, 0, 4, 5,
+	0, 0, 0, 6, 2, 0, 15, 1, 4, 11, 7, 0,
+	2, 8, 0, 7, 0, 0, 2, 12, 3, 6, 1, 1,
+	13, 15, 0, 0, 9, 18, 25, 7, 0, 12, 0, 15,
+	14, 16, 5, 0, 0, 5, 5, 0, 1, 16, 0, 12,
+	15, 0, 0, 7, 8, 4, 4, 7, 12, 3, 3, 4,
+	0, 1, 1, 2, 26, 0, 10, 1, 2, 1, 6, 17,
+	11, 0, 7, 3, 7, 0, 6, 15, 0, 0, 0, 19,
+	3, 0, 0, 7, 1, 5, 5, 0, 1, 0, 0, 11,
+	45, 2, 4, 10, 3, 0, 0, 25, 0, 0, 4, 1,
+	0, 15, 0, 32, 19, 18, 20, 0, 0, 0, 4, 14,
+	0, 4, 18, 0, 5, 12, 7, 11, 10, 3, 2, 1,
+	1, 0, 0, 3, 7, 3, 6, 14, 4, 10, 45, 1,
+	5, 1, 0, 14, 3, 0, 22, 0, 12, 4, 0, 0,
+	11, 0, 0, 27, 0, 8, 0, 11, 4, 11, 0, 0,
+	21, 22, 2, 0, 3, 9, 1, 19, 11, 0, 0, 0,
+	9, 9, 0, 15, 0, 2, 59, 23, 31, 17, 0, 5,
+	3, 30, 0, 4, 7, 27, 0, 0, 0, 39, 63, 2,
+	4, 0, 0, 5, 0, 14, 0, 5, 2, 2, 6, 17,
+	0, 31, 0, 0, 58, 1, 29, 23, 10, 83, 0, 3,
+	1, 0, 9, 1, 0, 0, 1, 2, 0, 0, 5, 0,
+	0, 0, 38, 0, 2, 4, 1, 0, 5, 18, 0, 2,
+	0, 0, 22, 10, 65, 0, 23, 61, 1, 9, 0, 0,
+	11, 36, 15, 12, 0, 2, 7, 1, 28, 0, 0, 1,
+	12, 2, 13, 6, 12, 73, 39, 1, 18, 0, 1, 32,
+	0, 0, 0, 12, 0, 32, 69, 3, 31, 9, 22, 35,
+	1, 23, 23, 8, 240, 0, 31, 6, 1, 0, 10, 13,
+	30, 64, 12, 1, 34, 0, 0, 21, 1, 58, 0, 6,
+	0, 117, 18, 0, 41, 119, 21, 0, 0, 0, 66, 39,
+	13, 16, 113, 65, 94, 45, 14, 18, 10, 120, 8, 102,
+	0, 5, 0, 0, 0, 42, 10, 239, 70, 0, 32, 0,
+	0, 164, 465, 14, 60, 0, 5, 0, 29, 12, 878, 1,
+	73, 457, 1530, 0, 0, 44, 42, 146, 0, 3, 0, 19,
+	13, 13,
+};
+
+static const struct messages_table_entry test_data_table_entries[] = {
+	{ "Pt", "pt" },
+	{ "Friday", "Friday" },
+	{ "EditFolder", "Rename directory" },
+	{ "HTTP501", "Not implemented" },
+	{ "Images", "Images" },
+	{ "HTTP505", "HTTP version not supported" },
+	{ "TreeviewLabelDomain", "Domain" },
+	{ "HTTP407", "Proxy authentication required" },
+	{ "preferencesStartupPageTooltip", "The default startup page" },
+	{ "SetPassword", "Set password" },
+	{ "ClipboardUTF8", "Write text as UTF-8" },
+	{ "preferencesControlLoad", "Load and display" },
+	{ "FetchesMax", "Maximum fetches" },
+	{ "DefaultScale", "Default page scaling" },
+	{ "HotlistDownloads", "Download the latest version" },
+	{ "SSLCertErrUnknown", "An unknown error occurred while processing the certificate." },
+	{ "preferencesAppearance", "<b>Appearance</b>" },
+	{ "DownloadU", "%s of unknown  \342\200\242  %s/s  \342\200\242  %s total" },
+	{ "gtkStop", "Stop" },
+	{ "preferencesAppearanceBackground", "No background images in output" },
+	{ "TreeviewLabelPath", "Path" },
+	{ "gtkTools", "_Tools" },
+	{ "PrivacyTitle", "Privacy error" },
+	{ "FontSize", "Font size" },
+	{ "ScrollLeft", "Click the arrow to scroll left" },
+	{ "ObjSave", "Save" },
+	{ "LoginTitle", "Authentication Requested" },
+	{ "Toolbars", "Toolbars" },
+	{ "ScrollH", "Drag the bar to scroll horizontally" },
+	{ "obj", "object" },
+	{ "HTTP417", "Expectation failed" },
+	{ "No", "No" },
+	{ "gtkFailed", "Download failed" },
+	{ "ToolAddress", "Address bar" },
+	{ "TrueColour", "True colour" },
+	{ "Days", "days" },
+	{ "preferencesAppearanceScale", "Scale output" },
+	{ "HTTP305", "Use proxy" },
+	{ "SaveURL", "Save location" },
+	{ "Date3Days", "Three days ago" },
+	{ "Fonts", "Fonts" },
+	{ "TreeExport", "Export..." },
+	{ "TreeviewLabelLastVisit", "Last visit" },
+	{ "PasteNS", "Paste" },
+	{ "PrintNS", "Print..." },
+	{ "ThemeInstDown", "Please wait for the theme to download." },
+	{ "EiBytes", " EiB" },
+	{ "Thursday", "Thursday" },
+	{ "con_content", "Content" },
+	{ "OpenURL", "Open URL" },
+	{ "TreeVersion1", "RFC 2109" },
+	{ "SSL_Certificate_ValidFrom", "Valid from: %s" },
+	{ "HTTP414", "Request-URI too long" },
+	{ "Monday", "Monday" },
+	{ "gtkMenuBar", "_Menu Bar" },
+	{ "gtkShowBookMarks", "_Show Bookmarks\342\200\246" },
+	{ "gtkReload", "_Reload" },
+	{ "Backtoprevious", "Back" },
+	{ "Realm", "Realm" },
+	{ "preferencesFontsPreview", "_Preview" },
+	{ "Timeout", "This site took too long to respond" },
+	{ "ScrollPUp", "Click to scroll up one page" },
+	{ "FormTextbox", "Click to edit this field" },
+	{ "LinkText", "Text" },
+	{ "gtkProgressBar", "%.0f%% of %u files" },
+	{ "Theme", "Theme" },
+	{ "preferencesProxyPortTooltip", "Port number to connect to on proxy server." },
+	{ "FormRadio", "Click to choose this option" },
+	{ "preferencesImageLoadBoth", "foreground and background images" },
+	{ "CloseWindow", "Close window" },
+	{ "HTTP301", "Moved permanently" },
+	{ "SSLCertErrChainSelfSigned", "The certificate chain is self signed." },
+	{ "CookieManagerHTTPS", "Secure hosts via https only" },
+	{ "CacheDisc", "Disc cache" },
+	{ "preferencesContentTabtitle", "Content" },
+	{ "gtkDetails", "Details" },
+	{ "gtkQuit", "Quit NetSurf\?" },
+	{ "ToolThrob", "Throbber" },
+	{ "PrintSheetFilled", "sheet is filled" },
+	{ "gtkSaveConfirm", "File saved" },
+	{ "ConfirmOverwrite", "Request confirmation when overwriting" },
+	{ "GIFTitle", "%s (GIF image %lux%lu pixels)" },
+	{ "con_rendering", "Rendering" },
+	{ "preferencesStartupPage", "Page:" },
+	{ "SearchError", "Invalid Search." },
+	{ "gtkAbout", "_About\342\200\246" },
+	{ "gtkToolbars", "_Toolbars" },
+	{ "ShowCookiesNS", "Show cookies" },
+	{ "SSLCertErrBadSig", "The certificate is improperly signed." },
+	{ "TreeComment", "Comment: %s" },
+	{ "LoginAgain", "The credentials for the site %s and realm \"%s\" were rejected." },
+	{ "SuppressImages", "Suppress images" },
+	{ "preferencesTabLocLeft", "Left" },
+	{ "gtkCopy", "_Copy" },
+	{ "Download", "%s of %s  \342\200\242  %s/s  \342\200\242  %s remaining" },
+	{ "gtkFindMatchCase", "Match Case" },
+	{ "TreeVersion0", "Netscape" },
+	{ "NoURLError", "Please enter a URL" },
+	{ "preferencesMarginsMeasurements", "measurements in mm" },
+	{ "TreeLastUsed", "Last used: %s" },
+	{ "OpenFile", "Open local file..." },
+	{ "SaveText", "Webpage" },
+	{ "TreeviewLabelDomainFolder", "Domain folder" },
+	{ "preferencesDeveloperViewEditor", "Editor" },
+	{ "CaseSens", "Case Sensitive" },
+	{ "gtkFileError", "File error: %s" },
+	{ "Tuesday", "Tuesday" },
+	{ "TreeviewLabelURL", "URL" },
+	{ "FileName", "Name" },
+	{ "Duration", "Duration" },
+	{ "preferencesTabLocTop", "Top" },
+	{ "FetchErrorDescription", "An error occurred when connecting to %s" },
+	{ "JPEGTitle", "%s (JPEG image %lux%lu pixels)" },
+	{ "NoNameError", "Please enter a name" },
+	{ "gtkUnknownFile", "" },
+	{ "preferencesProxyTypeDirect", "Direct connection" },
+	{ "OptionNoWindow", "Do not open window on startup" },
+	{ "Use", "Use" },
+	{ "preferencesButtonTypeText", "Text only" },
+	{ "HTTP400", "Bad request" },
+	{ "preferencesControl", "<b>Control</b>" },
+	{ "Utilities", "Utilities" },
+	{ "Date3Week", "Three weeks ago" },
+	{ "SaveComplete", "Save complete..." },
+	{ "SSLCertErrTooYoung", "The certificate is not yet valid." },
+	{ "preferencesAppearanceScalefit", "Scale output to fit page" },
+	{ "SaveCompNS", "Complete..." },
+	{ "SSL_Certificate_Serial", "Serial: %ld" },
+	{ "PrivacyDescription", "A privacy error occurred while communicating with %s this may be a site configuration error or an attempt to steal private information (passwords, messages or credit cards)" },
+	{ "preferencesFetchingCachedTooltip", "Number of connections to keep in case they are needed again." },
+	{ "FastScrolling", "Fast scrolling" },
+	{ "gtkForegroundImages", "_Foreground Images" },
+	{ "preferencesControlHigh", "High quality image scaling" },
+	{ "Date2Days", "Two days ago" },
+	{ "SearchWeb", "Web search" },
+	{ "Preferences", "Preferences" },
+	{ "NewWindowNS", "New window" },
+	{ "con_fonts", "Fonts" },
+	{ "TreeviewLabelPeriod", "Period" },
+	{ "DownloadNotify", "Notify on completion" },
+	{ "preferencesProxyNoproxyTooltip", "Comma separated list of host names that should not be proxied." },
+	{ "FormButton", "Warning: button can not be activated" },
+	{ "FormCheckbox", "Click to check this option" },
+	{ "con_secure", "Security" },
+	{ "HTTP302", "Found" },
+	{ "NetSurf", "NetSurf" },
+	{ "preferencesURLbar", "<b>URLbar</b>" },
+	{ "ToolStatus", "Status bar" },
+	{ "Saturday", "Saturday" },
+	{ "gtkSourceTabError", "Error handling source data " },
+	{ "Stopped", "Stopped" },
+	{ "Loading", "Loading" },
+	{ "New", "New" },
+	{ "Toolbar", "Toolbar" },
+	{ "TreeviewLabelVersion", "Version" },
+	{ "TreeviewLabelLastUsed", "Last used" },
+	{ "HTTP504", "Gateway timeout" },
+	{ "preferencesFetchingMax", "Maximum fetchers" },
+	{ "con_memory", "Memory" },
+	{ "Form_Reset", "Reset" },
+	{ "ContentLanguage", "Content language" },
+	{ "BackImg", "Background images" },
+	{ "Collapse", "Collapse" },
+	{ "SnapshotWindow", "Snapshot window" },
+	{ "gtkBackgroundImages", "_Background Images" },
+	{ "FitPage", "Fit page" },
+	{ "Login", "Login" },
+	{ "LinkNewTab", "Open link in new tab" },
+	{ "WindowSave", "Set as default position" },
+	{ "NotCSS", "Warning: stylesheet is not CSS" },
+	{ "All", "All" },
+	{ "EditTitle", "Edit title" },
+	{ "preferencesDownloadsRemove", "Remove download from list when complete" },
+	{ "SendReferer", "Send site referral information" },
+	{ "ProxyNone", "No proxy" },
+	{ "preferencesHistoryShow", "Local history shows URL in tooltip" },
+	{ "Date4Days", "Four days ago" },
+	{ "ThemeInvalid", "The downloaded theme is invalid or requires a newer version of NetSurf." },
+	{ "RemoveHotlist", "Are you sure you wish to remove this address from the hotlist\?" },
+	{ "Help", "Help" },
+	{ "ScrollUp", "Click the arrow to scroll up" },
+	{ "FormReset", "Reset form (not implemented)" },
+	{ "Right", "Right" },
+	{ "SaveSource", "Source" },
+	{ "CompressPDF", "Compress PDF" },
+	{ "TreeDelete", "Delete" },
+	{ "CookieManagerSession", "Session" },
+	{ "TextNS", "Text..." },
+	{ "ObjInfo", "Info" },
+	{ "preferencesDownloadsConfirm", "Confirm before overwriting files" },
+	{ "gtkSavelink", "Save Lin_k" },
+	{ "Sticky", "Sticky" },
+	{ "Window", "Window" },
+	{ "FontSerif", "Serif" },
+	{ "TreeExpires", "Expires: %s" },
+	{ "SSLError", "NetSurf failed to verify the authenticity of an SSL certificate. Please verify the details presented below." },
+	{ "Replace", "Replace file" },
+	{ "preferencesAnimation", "<b>Animation</b>" },
+	{ "gtkCustomize", "Customise\342\200\246" },
+	{ "Back", "Back one page" },
+	{ "GiBytes", " GiB" },
+	{ "SaveObject", "Object" },
+	{ "ProgressU", "%s" },
+	{ "Folder", "Directory" },
+	{ "Bytes", " B" },
+	{ "TreeVisited", "Visited: %s" },
+	{ "CSSBase", "Base stylesheet failed to load" },
+	{ "TreeDefault", "Set as default" },
+	{ "gtkCustomizeToolbarTitle", "Customise Toolbar" },
+	{ "RecPercent", "Received %s (%u%%)" },
+	{ "gtkWorking", " Working " },
+	{ "Form_None", "" },
+	{ "ScrollRight", "Click the arrow to scroll right" },
+	{ "gtkNextTab", "_Next tab" },
+	{ "gtkcompleteSave", "Export complete page as a folder" },
+	{ "ProxyType", "Proxy type" },
+	{ "HTTP205", "Reset content" },
+	{ "NoDirError", "%s is not a directory" },
+	{ "preferencesCacheMaintenance", "Maintenance" },
+	{ "preferencesAppearanceTabtitle", "Appearance" },
+	{ "EncNotRec", "Encoding type not recognised." },
+	{ "DateYesterday", "Yesterday" },
+	{ "ScrollPDown", "Click to scroll down one page" },
+	{ "Progress", "%s of %s" },
+	{ "OptDefault", "Save as default" },
+	{ "gtkFile", "_File" },
+	{ "FrameNewWin", "Show in new window" },
+	{ "TreeviewLabelVisits", "Visits" },
+	{ "ScrollV", "Drag the bar to scroll vertically" },
+	{ "gtkHelp", "_Help" },
+	{ "AbortDownload", "Are you sure you wish to abort this download\?" },
+	{ "preferencesFetchingPerhostTooltip", "Maximum number of item fetches per web server." },
+	{ "gtkThemeFolderInstructions", "To Install a theme, create a directory full of appropriately-named images as a subdirectory of gtk/res/themes/" },
+	{ "preferencesProxyUsername", "Username" },
+	{ "Redraw", "Redraw page" },
+	{ "PrintSheetsFilled", "sheets are filled" },
+	{ "Form_Submit", "Submit" },
+	{ "HistGlobalNS", "Show global history" },
+	{ "preferencesFonttypeSans", "Sans-serif" },
+	{ "CopyNS", "Copy" },
+	{ "AnimSpeedFrames", "seconds between frames" },
+	{ "Downloads", "Downloads" },
+	{ "Tree", "Tree" },
+	{ "HTTP204", "No content" },
+	{ "preferencesStartupPageDefault", "Use Default Page" },
+	{ "AnimDisable", "Disable animations" },
+	{ "HTTP503", "Service unavailable" },
+	{ "gtkDownloads", "_Downloads..." },
+	{ "Cookies", "Cookies" },
+	{ "gtkUnknownHost", "an unknown host" },
+	{ "FetchErrorCode", "Error code" },
+	{ "Printing", "Printing page" },
+	{ "TreeDomain", "Domain: %s%s" },
+	{ "NetSurfCopyright", "\302\251 2003-2023 The NetSurf Developers" },
+	{ "Clipboard", "Clipboard" },
+	{ "HTTP411", "Length required" },
+	{ "preferencesProxyHost", "Host" },
+	{ "HotlistAdd", "Add to hotlist" },
+	{ "BadObject", "Warning: bad object type" },
+	{ "About", "About" },
+	{ "HTTP300", "Multiple choices" },
+	{ "gtkTabs", "_Tabs" },
+	{ "CopyURL", "Copy URL to clipboard" },
+	{ "gtkPrint", "Print\342\200\246" },
+	{ "ScrollPRight", "Click to scroll right one page" },
+	{ "GlobalHistory", "Global history" },
+	{ "EncodingUnk", "Unknown" },
+	{ "ProxyNoAuth", "Simple proxy" },
+	{ "Object", "Object" },
+	{ "gtkThemeAdd", "Theme added successfully" },
+	{ "preferencesGenerationCompressed", "Output is compressed" },
+	{ "PNGTitle", "%s (PNG image %lux%lu pixels)" },
+	{ "CutNS", "Cut" },
+	{ "None", "None" },
+	{ "ThemeInstActive", "A theme is currently being downloaded or installed. Please wait for it to finish or cancel it before installing more themes." },
+	{ "preferencesSearchURLBar", "Search from URL bar" },
+	{ "FormFile", "Drop a file here to upload it" },
+	{ "Yes", "Yes" },
+	{ "Backtosafety", "Back to safety" },
+	{ "DeleteCookies", "Delete all cookies" },
+	{ "MM", "mm" },
+	{ "TiBytes", " TiB" },
+	{ "gtkImages", "_Images" },
+	{ "ScaleQuality", "Higher quality scaling" },
+	{ "ResolutionY", "Vertical resolution" },
+	{ "ImgStyle1", "Direct to screen" },
+	{ "SSLCertErrHostnameMismatch", "The certificate is for a different host than the server." },
+	{ "gtkNavigate", "_Navigate" },
+	{ "TreeLoadError", "The tree was unable to be correctly loaded." },
+	{ "preferencesSearch", "<b>Search</b>" },
+	{ "gtkSourceSave", "Save source" },
+	{ "TreeUnknown", "Unknown" },
+	{ "CookieManagerHTTP", "HTTP connections only" },
+	{ "OverwriteFile", "A file with that name already exists and would be lost." },
+	{ "con_general", "General" },
+	{ "FileSize", "Size" },
+	{ "FileError", "File does not exist:" },
+	{ "Scaling", "Scaling" },
+	{ "FileParent", "^ Up to parent directory" },
+	{ "TreeviewLabelSerial", "Serial" },
+	{ "Appearance", "Appearance" },
+	{ "FileTime", "Time" },
+	{ "Export", "Export" },
+	{ "gtkProgressBarPulse", "Downloading %u files" },
+	{ "gtkSavePage", "Complete Page\342\200\246" },
+	{ "ThemeInstall", "Would you like to install the theme '%s' by %s\?" },
+	{ "Open", "Open" },
+	{ "gtkDrawFile", "Drawfile\342\200\246" },
+	{ "gtkCanceled", " Canceled " },
+	{ "EnableJS", "Enable JavaScript" },
+	{ "con_lang", "Language" },
+	{ "Abort", "Abort" },
+	{ "gtkFindHighlightAll", "Highlight All" },
+	{ "ScrollPLeft", "Click to scroll left one page" },
+	{ "gtkPDF", "PDF\342\200\246" },
+	{ "Scale", "Scale" },
+	{ "Minimum", "Minimum" },
+	{ "gtkNewTab", "New _Tab" },
+	{ "HTTP201", "Created" },
+	{ "PiBytes", " PiB" },
+	{ "BadBMP", "Reading BMP failed." },
+	{ "gtkSizeInfo", "%s of %s" },
+	{ "Enable", "Enable" },
+	{ "preferencesAnimationEnable", "Enable" },
+	{ "BMPTitle", "%s (BMP image %lux%lu pixels)" },
+	{ "Display", "Display" },
+	{ "Password", "Password" },
+	{ "ShowCookies", "Show cookies..." },
+	{ "History", "History" },
+	{ "HTTP409", "Conflict" },
+	{ "HTTP406", "Not acceptable" },
+	{ "preferencesTitle", "Netsurf Preferences" },
+	{ "Left", "Left" },
+	{ "TreeviewLabelFolder", "Folder" },
+	{ "gtkCut", "Cu_t" },
+	{ "SearchProvider", "Search provider" },
+	{ "Cancel", "Cancel" },
+	{ "TreeHeaders", " (from headers)" },
+	{ "preferencesProxyTypeNLTM", "Manual with - authentication" },
+	{ "HTTP307", "Temporary redirect" },
+	{ "gtkBack", "_Back" },
+	{ "preferencesHistoryRemember", "Remember browsing history for up to" },
+	{ "SSLCertErrSelfSigned", "The certificate is self signed." },
+	{ "CSSGeneric", "Error processing CSS" },
+	{ "CacheNative", "Cache native versions" },
+	{ "CloseTab", "Close tab" },
+	{ "FetchesHost", "Fetches per host" },
+	{ "SearchURL", "Search from URL bar" },
+	{ "ViewCertificatesNotPossible", "Certificate information is not available for viewing" },
+	{ "preferencesCacheDisc", "Disc cache size" },
+	{ "preferencesControlDisable", "Disable plug-ins" },
+	{ "ResetUsage", "Reset statistics" },
+	{ "gtkOverwriteTitle", "File exists" },
+	{ "ThemeApplyErr", "An error occurred whilst trying to apply the downloaded theme." },
+	{ "FetchFailed", "Unable to fetch document" },
+	{ "MBytes", " MB" },
+	{ "SSLCertErrRevoked", "The certificate has been revoked by the issuer." },
+	{ "SelectMClick", "Click on entry to select it, multiple options can be selected" },
+	{ "preferencesControlEnable", "Enable JavaScript" },
+	{ "gtkOpenFile", "_Open File" },
+	{ "preferencesFontsSizeTooltip", "The base-line font size to use." },
+	{ "HTTP200", "OK" },
+	{ "SaveError", "The file could not be saved due to an error:" },
+	{ "FetchesCached", "Cached connections" },
+	{ "ResolutionX", "Horizontal resolution" },
+	{ "Not2xx", "Server returned an error" },
+	{ "InvalidURL", "The address <em>%s</em> could not be understood." },
+	{ "SaveDraw", "Webpage" },
+	{ "preferencesProxyHostTooltip", "Host name of your proxy server." },
+	{ "DontReplace", "Don't replace" },
+	{ "gtkDebugDomTree", "Debug _DOM tree" },
+	{ "NewTab", "New tab" },
+	{ "Stop", "Stop loading this page" },
+	{ "preferencesThemeTypeDefault", "Default" },
+	{ "HTTP403", "Forbidden" },
+	{ "Date5Days", "Five days ago" },
+	{ "FontFantasy", "Fantasy" },
+	{ "ScrollDown", "Click the arrow to scroll down" },
+	{ "SelSave", "Save" },
+	{ "gtkPrevTab", "_Previous tab" },
+	{ "gtkOpenwin", "Open Link in New _Window" },
+	{ "FrameDrag", "Resizing frames" },
+	{ "preferencesFontsDefault", "Default" },
+	{ "OptionNoQuit", "Do not quit when last window closed" },
+	{ "HTTP405", "Method not allowed" },
+	{ "LinkNewWin", "Open link in new window" },
+	{ "SelectClick", "Click on entry to select it" },
+	{ "HotlistContact", "Contact the NetSurf developers" },
+	{ "gtkFindClose", "Close Find Bar" },
+	{ "con_image", "Images" },
+	{ "gtkSaveCancelled", "File not saved" },
+	{ "gtkAddThemeTitle", "Select folder containing theme images" },
+	{ "gtkPreferences", "P_references" },
+	{ "preferencesGenerationPassword", "Output has a password" },
+	{ "LinkDload", "Download target" },
+	{ "BadRedirect", "Bad redirect URL" },
+	{ "Date6Days", "Six days ago" },
+	{ "SSL_Certificate_Accept", "Accept" },
+	{ "Fetching", "Fetching" },
+	{ "preferencesStartup", "<b>Startup</b>" },
+	{ "Edit", "Edit" },
+	{ "TreeValue", "Value: %s" },
+	{ "TreePersistent", "Persistent: %s" },
+	{ "BadSprite", "Invalid or corrupt Sprite data." },
+	{ "TreeviewLabelPersistent", "Persistent" },
+	{ "preferencesFonttypeMonospace", "Monospace" },
+	{ "TreeviewLabelValidUntil", "Valid until" },
+	{ "PDFNS", "PDF..." },
+	{ "Behaviour", "Behaviour" },
+	{ "KiBytes", " KiB" },
+	{ "gtkToggleDebugging", "T_oggle debug rendering" },
+	{ "preferencesMargins", "<b>Margins</b>" },
+	{ "ObjShow", "Show object" },
+	{ "preferencesFetchingPerhost", "Fetches per host" },
+	{ "preferencesFetchingCached", "Cached connections" },
+	{ "MiBytes", " MiB" },
+	{ "RenderAll", "Buffer all rendering" },
+	{ "TimeoutTitle", "Connection timed out" },
+	{ "ScaleNorm", "Normal" },
+	{ "preferencesGeneralReferral", "Enable referral submission" },
+	{ "gtkSaveWindowSize", "S_ave Window Size" },
+	{ "BadURL", "The given URL was not able to be parsed" },
+	{ "preferencesFonttypeCursive", "Cursive" },
+	{ "TreeClear", "Clear default" },
+	{ "Size", "Size" },
+	{ "HotlistShowNS", "Show hotlist" },
+	{ "Forward", "Forward one page" },
+	{ "Home", "Home page" },
+	{ "gtkOverwrite", "A file named \"%s\" already exists.  Do you want to replace it\?" },
+	{ "ContextMenu", "Context menu" },
+	{ "TimeoutDescription", " A connection to %s could not be established. The site may be temporarily unavailable or too busy to respond." },
+	{ "TabbedBrowsing", "Tabbed browsing" },
+	{ "Sunday", "Sunday" },
+	{ "gtkLocalHistory", "_Local History\342\200\246" },
+	{ "NotFavIco", "Favicon not supported" },
+	{ "preferencesURLbarDisplay", "Display recently visited URLs as you type" },
+	{ "NoMemory", "NetSurf is running out of memory. Please free some memory and try again." },
+	{ "Date1Week", "A week ago" },
+	{ "gtkQuitMenu", "_Quit" },
+	{ "gtkFind", "_Find\342\200\246" },
+	{ "gtkToolBar", "_Button Bar" },
+	{ "preferencesLanguagePreferredTooltip", "The preferred language for web pages" },
+	{ "preferencesGeneration", "<b>Generation</b>" },
+	{ "ImgStyle0", "Use OS" },
+	{ "URLSuggest", "Recent URLs" },
+	{ "WindowReset", "Reset default position" },
+	{ "Top", "Top" },
+	{ "ScaleInc", "Increase" },
+	{ "FontFamilies", "Font families" },
+	{ "DateToday", "Today" },
+	{ "Form_Drop", "Click to select file" },
+	{ "Formatting", "Formatting" },
+	{ "SettingsSave", "Save settings" },
+	{ "Host", "Host" },
+	{ "SettingsEdit", "Edit preferences" },
+	{ "Encoding1", "detected" },
+	{ "DownloadDir", "Initial download location" },
+	{ "preferencesDeveloperViewWindow", "Window" },
+	{ "AboutDesc", "NetSurf is a small and fast web browser." },
+	{ "gtkSpeed", "Speed" },
+	{ "gtkPostScript", "PostScript\342\200\246" },
+	{ "preferencesSearchProvider", "Provider:" },
+	{ "preferencesTools", "<b>Tools</b>" },
+	{ "PrintError", "An error occurred when printing:" },
+	{ "gtkScaleView", "_Scale View" },
+	{ "con_cache", "Cache" },
+	{ "NewFolder", "Create new directory" },
+	{ "Date2Week", "Two weeks ago" },
+	{ "HTTP401", "Unauthorized" },
+	{ "gtkPageSource", "Page S_ource" },
+	{ "FileOpenError", "could not open file '%s'" },
+	{ "preferencesButtonTypeSmall", "Small Icons" },
+	{ "preferencesGeneral", "<b>General</b>" },
+	{ "preferencesAppearanceImages", "No images in output" },
+	{ "Browser", "Browser" },
+	{ "preferencesTabsSwitch", "Switch to newly opened tabs immediately" },
+	{ "SSL_Certificate_ValidTo", "Valid until: %s" },
+	{ "Form_Many", "(Many)" },
+	{ "FindTextNS", "Find text..." },
+	{ "HTTP415", "Unsupported media type" },
+	{ "Tabs", "Tabs" },
+	{ "preferencesProxyTypeBasic", "Manual with basic authentication" },
+	{ "TreeNewLink", "New address" },
+	{ "HotlistDocumentation", "Documentation" },
+	{ "NotFound", "Not found" },
+	{ "ScreenOwn", "Own screen" },
+	{ "gtkplainSave", "Save plain text" },
+	{ "HTTP410", "Gone" },
+	{ "ToolButtons", "Buttons" },
+	{ "Selecting", "Selecting" },
+	{ "preferencesFetching", "<b>Fetching</b>" },
+	{ "CacheMemory", "Memory cache" },
+	{ "gtkView", "_View" },
+	{ "FontSans", "Sans-serif" },
+	{ "DomainAll", "(All domains)" },
+	{ "gtkCloseWindow", "_Close Window" },
+	{ "HTTP416", "Requested range not satisfiable" },
+	{ "preferencesStartupPageCurrent", "Use Current Page" },
+	{ "SelectFile", "Select file..." },
+	{ "preferencesDownloadsLocationTooltip", "The default location downloaded files are put" },
+	{ "gtkExport", "Export" },
+	{ "ObjError", "Error loading object: %s" },
+	{ "gtkForward", "_Forward" },
+	{ "Info", "Info" },
+	{ "preferencesLanguagePreferred", "Preferred language:" },
+	{ "preferencesDownloads", "<b>Downloads</b>" },
+	{ "TreePath", "Path: %s%s" },
+	{ "ScaleDec", "Decrease" },
+	{ "gtkNewWindow", "_New Window" },
+	{ "CookieManagerSecure", "Secure hosts only" },
+	{ "FileDirectory", "Directory" },
+	{ "TabLast", "Open new tabs after all existing tabs" },
+	{ "preferencesCacheExpire", "Expire cache entries after" },
+	{ "TreeUnused", "Unused" },
+	{ "preferencesCacheDays", "days" },
+	{ "HelpCredits", "Credits" },
+	{ "Animations", "Animations" },
+	{ "Close", "Close" },
+	{ "gtkGlobalHistory", "_Global History\342\200\246" },
+	{ "con_theme", "Themes" },
+	{ "gtkStartDownload", "Download file\?" },
+	{ "SSLCertErrCertMissing", "The certificate was missing from the chain." },
+	{ "BadGIF", "Reading GIF failed." },
+	{ "Page", "Page" },
+	{ "NoDiscSpace", "Not enough space available on disc." },
+	{ "HotlistHomepage", "NetSurf homepage" },
+	{ "preferencesButtonTypeLargeText", "Large Icons and Text" },
+	{ "gtkBookmarklink", "Bookmark _Link" },
+	{ "Link", "Link" },
+	{ "Redirecting", "Redirecting..." },
+	{ "ProxyNTLM", "NTLM authentication" },
+	{ "TreeVisits", "Visits: %i" },
+	{ "WebPTitle", "%s (WebP image %lux%lu pixels)" },
+	{ "TreeHotlist", "NetSurf hotlist" },
+	{ "gtkFindPlaceholder", "Find in page" },
+	{ "HistLocalNS", "Show local history" },
+	{ "preferencesTabs", "<b>Tabs</b>" },
+	{ "DefaultFonts", "Font Families" },
+	{ "con_connect", "Connection" },
+	{ "ICOTitle", "%s (ICO image %lux%lu pixels)" },
+	{ "MiscError", "An unexpected error occurred:" },
+	{ "SSL_Certificate_Reject", "Reject" },
+	{ "TreeviewLabelExpires", "Expires" },
+	{ "styl", "stylesheet" },
+	{ "preferencesProxyUsernameTooltip", "Username to access the proxy." },
+	{ "ContentBlocking", "Content blocking" },
+	{ "FetchErrorTitle", "Error occurred fetching page" },
+	{ "HomePageDefault", "Use default page" },
+	{ "HTTP303", "See other" },
+	{ "HTTP206", "Partial content" },
+	{ "FetchFailedToFinish", "The fetch for this request failed to complete" },
+	{ "RenderAnims", "Buffer animations" },
+	{ "preferencesThemes", "<b>Themes</b>" },
+	{ "gtkHome", "_Home" },
+	{ "TreeImport", "Imported URL" },
+	{ "Choices", "Choices..." },
+	{ "HomePageCurrent", "Use current page" },
+	{ "preferencesAnimationMinimum", "Minimum time between frames:" },
+	{ "HistoryAge", "Keep history for" },
+	{ "Done", "Done" },
+	{ "ErrorPage", "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.01//EN\" \"http://www.w3.org/TR/html4/strict.dtd\"><html><head><meta http-equiv=\"Content-Type\" content=\"text/html; charset=UTF-8\"><title>Page error</title></head><body><h1>Sorry, NetSurf was unable to display this page</h1><p><strong>%s</strong></p></body></html>" },
+	{ "kBytes", " kB" },
+	{ "preferencesDownloadsLocation", "Location:" },
+	{ "gtkDelete", "_Delete" },
+	{ "preferencesImageLoadFore", "foreground images" },
+	{ "preferencesControlHide", "Hide Adverts" },
+	{ "Sprite", "Sprite" },
+	{ "TreeviewLabelType", "Type" },
+	{ "preferencesGeneralDNT", "Enable sending \"Do Not Track\" request" },
+	{ "HelpLicence", "Licence" },
+	{ "gtkPrintPreview", "Print Preview\342\200\246" },
+	{ "gtkOpentab", "Open Link in New _Tab" },
+	{ "Settings", "Settings" },
+	{ "gtkProgress", "Progress" },
+	{ "preferencesToolbarButtons", "Buttons:" },
+	{ "Unwritten", "Writing data to file failed." },
+	{ "ExternalApp", "Open in external application" },
+	{ "ProxyBasic", "Basic authentication" },
+	{ "SelectAllNS", "Select all" },
+	{ "Frame", "Frame" },
+	{ "Username", "Username" },
+	{ "FontCursive", "Cursive" },
+	{ "OSPointers", "Use OS mouse pointers when possible" },
+	{ "SSLCerts", "SSL certificates" },
+	{ "HotlistDefaultFolderName", "Unsorted entries" },
+	{ "TabSwitchNew", "When a new tab is opened immediately switch to it" },
+	{ "Copies", "Copies" },
+	{ "Languages", "Language" },
+	{ "gtkDownloadsRunning", "There are still downloads running, if you quit now these will be canceled and the files deleted." },
+	{ "SaveAsNS", "Save as" },
+	{ "TreeviewLabelIssuer", "Issuer" },
+	{ "preferencesSearchProviderTooltip", "The default web search provider" },
+	{ "AnimSpeedLimit", "Limit speed to" },
+	{ "gtkZoomNormal", "_Normal size" },
+	{ "con_advanced", "Advanced" },
+	{ "FontMono", "Monospaced" },
+	{ "FileType", "Type" },
+	{ "EmptyError", "file is empty." },
+	{ "HTTP0", "OK" },
+	{ "SaveLink", "Link" },
+	{ "SaveAs", "Save as..." },
+	{ "NeedRestart", "These options will not take effect until the next time NetSurf is started" },
+	{ "gtkError", " Error " },
+	{ "preferencesHistory", "<b>History</b>" },
+	{ "preferencesAnimationMinimumTooltip", "Do not update animations any more often than this." },
+	{ "preferencesDeveloperView", "Open developer views in a" },
+	{ "SSLCertErrTooOld", "The certificate has expired." },
+	{ "gtkAddBookMarks", "_Add to Bookmarks\342\200\246" },
+	{ "SaveSelection", "Selection" },
+	{ "NewFolderName", "New folder" },
+	{ "ObjReload", "Reload" },
+	{ "gtkDebugBoxTree", "Debug _box tree" },
+	{ "gtkThemeDup", "Theme is already included" },
+	{ "styls", "stylesheets" },
+	{ "preferencesNetworkTabtitle", "Network" },
+	{ "gtkSave", "Save file as\342\200\246" },
+	{ "FileIndex", "Index of %s" },
+	{ "Resolution", "Resolution" },
+	{ "preferencesFetchingMaxTooltip", "Maximum number of concurrent items to fetch at once." },
+	{ "HTTP502", "Bad gateway" },
+	{ "HTTP404", "Not found" },
+	{ "Screen", "Screen" },
+	{ "PDF", "PDF" },
+	{ "SelectClose", "Click to close the select menu" },
+	{ "gtkCustomizeToolbarInstructions", "Drag toolbar items into and out of the toolbar." },
+	{ "gtkProgressBarPulseSingle", "Downloading %u file" },
+	{ "ScrollBoth", "Move your mouse while keeping the button pressed to scroll the content" },
+	{ "Folders", "Directories" },
+	{ "TreeviewLabelContent", "Content" },
+	{ "gtkCopylink", "Copy link loc_ation" },
+	{ "TreeAdded", "Added: %s" },
+	{ "TreeSecure", "Secure hosts only: %s" },
+	{ "preferencesTabLocRight", "Right" },
+	{ "preferencesFonttypeFantasy", "Fantasy" },
+	{ "gtkFindForward", "Find _Next Occurrence" },
+	{ "ScaleNS", "Scale" },
+	{ "LinkNew", "New window" },
+	{ "Domains", "Domains" },
+	{ "gtkUnknownSize", "unknown" },
+	{ "gtkSelectAll", "Select _All" },
+	{ "NewLink", "Create new address" },
+	{ "HTTP412", "Precondition failed" },
+	{ "LinkSave", "Save" },
+	{ "Scaled", "Scaled" },
+	{ "gtkOpenMenu", "Open Menu" },
+	{ "LoadError", "The file could not be loaded due to an error:" },
+	{ "FileNext", "Next page >" },
+	{ "preferencesDeveloperViewTab", "Tab" },
+	{ "UpLevel", "Up one level" },
+	{ "preferencesPDFTabtitle", "PDF" },
+	{ "TryAgain", "Try Again" },
+	{ "FormBadSubmit", "Warning: form can not be submitted" },
+	{ "HTTP413", "Request entity too large" },
+	{ "EditLink", "Edit address" },
+	{ "gtkPlainText", "Plain Text\342\200\246" },
+	{ "FilePrevious", "< Previous page" },
+	{ "preferencesProxyTypeManual", "Manual with no authentication" },
+	{ "gtkUserInformation", "User _information\342\200\246" },
+	{ "preferencesFonttypeSerif", "Serif" },
+	{ "preferencesProxyType", "Proxy type" },
+	{ "ObjDraw", "Draw" },
+	{ "ThemeInstallErr", "An error occurred whilst trying to install the downloaded theme." },
+	{ "preferencesProxyPassword", "Password" },
+	{ "Remove", "Remove address" },
+	{ "gtkRemaining", "Remaining" },
+	{ "ClearNS", "Clear selection" },
+	{ "BlockAds", "Hide advertisements" },
+	{ "EditToolbar", "Edit toolbar" },
+	{ "Hotlist", "Hotlist" },
+	{ "preferencesCache", "<b>Cache</b>" },
+	{ "NoTitle", "<No title>" },
+	{ "PNGError", "Error converting PNG." },
+	{ "SSL_Certificate_Type", "Type: %i" },
+	{ "preferencesProxy", "<b>HTTP Proxy</b>" },
+	{ "Proxy", "HTTP proxy" },
+	{ "FetchFile", "fetching file" },
+	{ "WindowSize", "Copy window position" },
+	{ "URIError", "NetSurf was unable to parse this URI file due to a syntax error." },
+	{ "gtkInfo", "%s from %s is %s in size" },
+	{ "SSL_Certificate_Issuer", "Issuer: %s" },
+	{ "ShowAll", "Show All" },
+	{ "SSL_Certificate_Version", "Version: %ld" },
+	{ "HotlistSaveError", "The hotlist was unable to be correctly saved." },
+	{ "Source", "Source..." },
+	{ "preferencesImageLoadNone", "no images" },
+	{ "preferencesImageLoadBack", "background images" },
+	{ "TreeVersion", "Version: %s" },
+	{ "HTTP202", "Accepted" },
+	{ "TreeviewLabelRestrictions", "Restrictions" },
+	{ "WindowStagr", "Stagger window position" },
+	{ "Margins", "Margins" },
+	{ "Processing", "Processing" },
+	{ "MousePointers", "Mouse pointers" },
+	{ "gtkPaste", "_Paste" },
+	{ "gtkContents", "_Contents\342\200\246" },
+	{ "Received", "Received %s" },
+	{ "gtkZoomPlus", "Zoom _in" },
+	{ "Printer", "Printer" },
+	{ "LoginDescription", "The site %s with realm \"%s\" is requesting credentials for access." },
+	{ "ForeImg", "Foreground images" },
+	{ "Expand", "Expand" },
+	{ "Default", "Default" },
+	{ "gtkFullScreen", "_Fullscreen" },
+	{ "Downloaded", "%s complete  \342\200\242  average %s/s  \342\200\242  %s total" },
+	{ "con_search", "Search" },
+	{ "CopyClip", "Copy to clipboard" },
+	{ "Links", "Addresses" },
+	{ "GBytes", " GB" },
+	{ "SSLCertErrOk", "The certificate has no errors." },
+	{ "Selection", "Selection" },
+	{ "TreeLast", "Last visited: %s" },
+	{ "Scripting", "Scripting" },
+	{ "TreeVersion2", "RFC 2965" },
+	{ "Render", "Render" },
+	{ "gtkCloseTab", "_Close tab" },
+	{ "Navigate", "Navigate" },
+	{ "gtkFindBack", "Find Previous Occurrence" },
+	{ "TreeviewLabelName", "Name" },
+	{ "Wednesday", "Wednesday" },
+	{ "Prev", "Previous" },
+	{ "FrameOnly", "Show only this frame" },
+	{ "HomePageURL", "URL" },
+	{ "preferencesFonts", "<b>Fonts</b>" },
+	{ "TreeviewLabelValidFrom", "Valid from" },
+	{ "SpriteTitle", "%s (Sprite image %lux%lu pixels)" },
+	{ "DontRemove", "Don't remove" },
+	{ "con_home", "Home page" },
+	{ "gtkDeveloper", "De_veloper" },
+	{ "SSLCertErrBadIssuer", "The issuer of this certificate is not known. This may occur if the browser cannot access the certificate authority (CA) bundle." },
+	{ "TreeviewLabelTitle", "Title" },
+	{ "gtkOpenLocation", "_Open Location\342\200\246" },
+	{ "preferencesProxyNoproxy", "No Proxy For" },
+	{ "preferencesFontsSize", "Size" },
+	{ "preferencesCacheMemory", "Memory cache size" },
+	{ "Miscellaneous", "Miscellaneous" },
+	{ "gtkOverwriteInfo", "The file already exists in \"%s\".  Replacing it will overwrite its contents." },
+	{ "HTTP203", "Non-authoritative information" },
+	{ "HTTP408", "Request timeout" },
+	{ "HTTP500", "Internal server error" },
+	{ "Proceed", "Proceed" },
+	{ "gtkThemeFolderSub", "Select a subdirectory of the themes folder" },
+	{ "con_inter", "Interface" },
+	{ "preferencesMainTabtitle", "Main" },
+	{ "FormSubmit", "Send form to %s" },
+	{ "preferencesButtonTypeLarge", "Large Icons" },
+	{ "preferencesTabsAlways", "Always show tab bar" },
+	{ "gtkComplete", " Complete " },
+	{ "FrameNewTab", "Show in new tab" },
+	{ "preferencesLanguage", "<b>Language</b>" },
+	{ "gtkStatusBar", "_Status Bar" },
+	{ "Quit", "Quit" },
+	{ "Encoding2", "from <meta>" },
+	{ "ImgStyle2", "Dithered" },
+	{ "SelectMenu", "Select" },
+	{ "FormSelect", "Click to choose a form item" },
+	{ "HTTP402", "Payment required" },
+	{ "preferencesTabsPosition", "Position:" },
+	{ "DirectoryError", "directory '%s' already exists" },
+	{ "Encoding0", "from HTTP headers" },
+	{ "View", "Display" },
+	{ "ViewCertificates", "View certificate details" },
+	{ "preferencesTabLocBottom", "Bottom" },
+	{ "gtkGuide", "User _guide\342\200\246" },
+	{ "HTTP304", "Not modified" },
+	{ "TabLinkOpen", "Open links in tabs instead of new windows" },
+	{ "QuitDownload", "One or more downloads are still in progress. Are you sure you wish to quit\?" },
+	{ "objs", "objects" },
+	{ "ImgStyle3", "Error diffused" },
+	{ "RemoveBackground", "Remove background" },
+	{ "gtkEdit", "_Edit" },
+	{ "gtkZoomMinus", "Zoom _out" },
+	{ "preferencesThemesAdd", "Add Theme..." },
+	{ "Next", "Next" },
+	{ "TreeLaunch", "Visit URL" },
+	{ "OK", "OK" },
+	{ "MNGError", "Error converting MNG/PNG/JNG: %i" },
+	{ "TreeSession", "Session end" },
+	{ "FormTextarea", "Click to edit the text" },
+	{ "preferencesControlPrevent", "Prevent pop-up windows" },
+	{ "gtkShowCookies", "Show _Cookies\342\200\246" },
+	{ "FileDate", "Date" },
+	{ "SSL_Certificate_Subject", "Subject: %s" },
+	{ "ObjPrint", "Print" },
+	{ "HomePageBlank", "Use blank page" },
+	{ "DPI", "DPI" },
+	{ "Bottom", "Bottom" },
+	{ "preferencesToolbar", "<b>Toolbar</b>" },
+	{ "preferencesProxyTypeSystem", "System settings" },
+	{ "preferencesProxyTypeTooltip", "The type of HTTP proxy server." },
+	{ "preferencesPrivacyTabtitle", "Privacy" },
+	{ "BadICO", "Reading ICO failed." },
+	{ "preferencesHistoryDays", "days" },
+	{ "TreeNewFolder", "New directory" },
+	{ "preferencesTabsNewly", "Newly opened tabs are blank" },
+	{ "ParsingFail", "Parsing the document failed." },
+};
+
+static const struct messages_table test_data_table = {
+	.language = "en",
+	.count = 795,
+	.bucket_count = 398,
+	.seeds = test_data_table_seeds,
+	.entries = test_data_table_entries,
+};
@@ -32,8 +32,10 @@
 #include "utils/errors.h"
 #include "utils/log.h"
 #include "utils/messages.h"
+#include "utils/messages_table.h"
 
 #include "test/message_data_inline.h"
+#include "test/message_data_table.h"
 
 #define NELEMS(x)  (sizeof(x) / sizeof((x)[0]))
 
@@ -44,6 +46,21 @@ struct message_test_vec_s {
 	const char *res;
 };
 
+struct message_table_test_vec_s {
+	const char *key;
+	const char *res;
+};
+
+struct message_table_test_vec_s message_table_test_vec[] = {
+	{ "OK", "OK" },
+	{ "NoMemory", "NetSurf is running out of memory. Please free some memory and try again." },
+	{ "NotFound", "Not found" },
+	{ "Stopped", "Stopped" },
+	{ "FetchErrorDescription", "An error occurred when connecting to %s" },
+	{ "DefinitelyNotAKey", "DefinitelyNotAKey" },
+	{ "", "" },
+};
+
 struct message_test_vec_s message_errorcode_test_vec[] = {
 	{ NSERROR_OK, "OK" },
 	{ NSERROR_NOMEM, "NetSurf is running out of memory. Please free some memory and try again." },
@@ -129,6 +146,82 @@ START_TEST(message_get_buff_test)
 }
 END_TEST
 
+START_TEST(message_table_load_test)
+{
+	nserror res;
+
+	res = messages_set_table(NULL);
+	ck_assert_int_eq(res, NSERROR_BAD_PARAMETER);
+
+	res = messages_set_table(&test_data_table);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	/* cleanup */
+	messages_destroy();
+}
+END_TEST
+
+START_TEST(message_table_get_test)
+{
+	nserror res;
+	const struct message_table_test_vec_s *tst = &message_table_test_vec[_i];
+
+	res = messages_set_table(&test_data_table);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	ck_assert_str_eq(messages_get(tst->key), tst->res);
+
+	/* cleanup */
+	messages_destroy();
+}
+END_TEST
+
+START_TEST(message_table_all_test)
+{
+	nserror res;
+	uint32_t idx;
+	const struct messages_table_entry *entry;
+
+	res = messages_set_table(&test_data_table);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	/* every message must be found in its own slot */
+	for (idx = 0; idx < test_data_table.count; idx++) {
+		entry = &test_data_table.entries[idx];
+		ck_assert(messages_get(entry->key) == entry->value);
+	}
+
+	/* cleanup */
+	messages_destroy();
+}
+END_TEST
+
+START_TEST(message_table_override_test)
+{
+	nserror res;
+	char *buf;
+
+	res = messages_set_table(&test_data_table);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	res = messages_add_key_value("NotFound", "Overridden");
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	ck_assert_str_eq(messages_get("NotFound"), "Overridden");
+	ck_assert_str_eq(messages_get("Stopped"), "Stopped");
+
+	buf = messages_get_buff("NoMemory");
+	ck_assert_str_eq(buf, "NetSurf is running out of memory. Please free some memory and try again.");
+	free(buf);
+
+	/* cleanup */
+	messages_destroy();
+
+	ck_assert_str_eq(messages_get("Stopped"), "Stopped");
+	ck_assert_str_eq(messages_get("NoMemory"), "NoMemory");
+}
+END_TEST
+
 
 static TCase *message_session_case_create(void)
 {
@@ -145,12 +238,28 @@ static TCase *message_session_case_create(void)
 }
 
 
+static TCase *message_table_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Compiled message table");
+
+	tcase_add_test(tc, message_table_load_test);
+	tcase_add_loop_test(tc, message_table_get_test,
+			    0, NELEMS(message_table_test_vec));
+	tcase_add_test(tc, message_table_all_test);
+	tcase_add_test(tc, message_table_override_test);
+
+	return tc;
+}
+
+
 static Suite *message_suite_create(void)
 {
 	Suite *s;
 	s = suite_create("message");
 
 	suite_add_tcase(s, message_session_case_create());
+	suite_add_tcase(s, message_table_case_create());
 
 	return s;
 }
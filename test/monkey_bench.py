@@ -0,0 +1,382 @@
+#!/usr/bin/python3
+#
+# Copyright 2026 The NetSurf Browser Project
+#
+# This file is part of NetSurf, http://www.netsurf-browser.org/
+#
+# NetSurf is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# NetSurf is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+benchmarks page loading in monkey using an offline corpus
+
+The corpus is served from a local HTTP server, or through file: URLs, so
+no network access is needed. Each page is loaded repeatedly, both cold
+(in a new browser with an empty cache) and warm (in a new window of a
+browser which still has it open in another window). The time spent in each stage of
+loading is taken from the browser's page load trace.
+"""
+
+# pylint: disable=locally-disabled, missing-docstring
+
+import functools
+import getopt
+import http.server
+import json
+import os
+import shutil
+import statistics
+import struct
+import sys
+import tempfile
+import threading
+import time
+import yaml
+
+from monkeyfarmer import Browser
+
+
+# trace spans reported as each stage, by category and name
+STAGES = {
+    "parse_ms":    ("html", "parse"),
+    "selctx_ms":   ("css", "selection context"),
+    "select_ms":   ("css", "select"),
+    "box_ms":      ("html", "box construct"),
+    "layout_ms":   ("layout", "layout"),
+    "redraw_ms":   ("redraw", "redraw"),
+}
+
+# values reported for each run, in reporting order
+RESULTS = ["load_ms", "fetch_ms"] + list(STAGES.keys()) + [
+    "peak_rss_kb", "allocs", "alloc_bytes"]
+
+
+class CorpusHandler(http.server.SimpleHTTPRequestHandler):
+
+    # pylint: disable=locally-disabled, invalid-name
+
+    def end_headers(self):
+        # allow warm loads to be satisfied from the cache
+        self.send_header("Cache-Control", "max-age=3600")
+        super().end_headers()
+
+    def log_message(self, *args):
+        # pylint: disable=locally-disabled, arguments-differ
+        pass
+
+
+class CorpusServer:
+
+    def __init__(self, root):
+        handler = functools.partial(CorpusHandler, directory=root)
+        self.server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), handler)
+        self.thread = threading.Thread(target=self.server.serve_forever, daemon=True)
+        self.thread.start()
+
+    def url(self, path):
+        return "http://127.0.0.1:{}/{}".format(self.server.server_address[1], path)
+
+    def close(self):
+        self.server.shutdown()
+        self.server.server_close()
+
+
+class AllocCounter:
+
+    def __init__(self, path):
+        self.path = path
+
+    def read(self):
+        try:
+            with open(self.path, "rb") as stream:
+                allocs, nbytes, _frees = struct.unpack("=QQQ", stream.read(24))
+        except (OSError, struct.error):
+            return None
+        return (allocs, nbytes)
+
+
+def print_usage():
+    print('Usage:')
+    print('  ' + sys.argv[0] + ' -m <path to monkey> [-c <corpus>] [-n <runs>] [-o <output>]'
+          ' [-p <allocation counter>] [-w <wrapper arguments>] [-f]')
+
+
+def parse_argv(argv):
+
+    # pylint: disable=locally-disabled, unused-variable
+
+    args = {
+        "monkey": '',
+        "corpus": os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               "bench", "corpus.yaml"),
+        "runs": 5,
+        "output": None,
+        "preload": None,
+        "wrapper": None,
+        "file": False,
+    }
+    try:
+        opts, rest = getopt.getopt(argv, "hm:c:n:o:p:w:f",
+                                   ["monkey=", "corpus=", "runs=", "output=",
+                                    "preload=", "wrapper=", "file"])
+    except getopt.GetoptError:
+        print_usage()
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == '-h':
+            print_usage()
+            sys.exit()
+        elif opt in ("-m", "--monkey"):
+            args["monkey"] = arg
+        elif opt in ("-c", "--corpus"):
+            args["corpus"] = arg
+        elif opt in ("-n", "--runs"):
+            args["runs"] = int(arg)
+        elif opt in ("-o", "--output"):
+            args["output"] = arg
+        elif opt in ("-p", "--preload"):
+            args["preload"] = os.path.abspath(arg)
+        elif opt in ("-w", "--wrapper"):
+            if args["wrapper"] is None:
+                args["wrapper"] = []
+            args["wrapper"].extend(arg.split())
+        elif opt in ("-f", "--file"):
+            args["file"] = True
+
+    if args["monkey"] == '' or args["runs"] < 1:
+        print_usage()
+        sys.exit(2)
+
+    return args
+
+
+def load_corpus(path):
+    with open(path, 'r') as stream:
+        corpus = yaml.load(stream, Loader=yaml.SafeLoader)
+    corpus["root"] = os.path.join(os.path.dirname(os.path.abspath(path)),
+                                  corpus.get("root", "."))
+    return corpus
+
+
+def interval_union(intervals):
+    total = 0
+    end = None
+    for (start, stop) in sorted(intervals):
+        if end is None or start > end:
+            total += stop - start
+            end = stop
+        elif stop > end:
+            total += stop - end
+            end = stop
+    return total
+
+
+def trace_stages(path):
+    with open(path, 'r') as stream:
+        events = json.load(stream)["traceEvents"]
+
+    result = {key: 0.0 for key in STAGES}
+    fetches = {}
+    for event in events:
+        if event["ph"] == "X":
+            for (key, span) in STAGES.items():
+                if (event["cat"], event["name"]) == span:
+                    result[key] += event["dur"] / 1000
+        elif event.get("cat") == "fetch" and event["name"] == "fetch":
+            # fetches overlap so report the time any was in progress
+            fetch = fetches.setdefault(event["id"], [None, None])
+            fetch[0 if event["ph"] == "b" else 1] = event["ts"]
+
+    result["fetch_ms"] = interval_union(
+        [tuple(f) for f in fetches.values() if None not in f]) / 1000
+
+    return result
+
+
+def peak_rss(browser):
+    try:
+        with open("/proc/{}/status".format(browser.farmer.monkey.pid), 'r') as stream:
+            for line in stream:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return None
+
+
+class Bench:
+
+    def __init__(self, args, corpus, workdir):
+        self.args = args
+        self.corpus = corpus
+        self.workdir = workdir
+        self.server = None
+        self.counter = None
+        if not args["file"]:
+            self.server = CorpusServer(corpus["root"])
+
+    def url(self, page):
+        if self.server is None:
+            return "file://" + os.path.join(self.corpus["root"], page["path"])
+        return self.server.url(page["path"])
+
+    def launch(self, tag):
+        cache = os.path.join(self.workdir, "cache-" + tag)
+        os.makedirs(cache)
+
+        monkey_cmd = [self.args["monkey"],
+                      "--trace_enable=1",
+                      "--disc_cache_path=" + cache]
+        monkey_env = os.environ.copy()
+        monkey_env['LANGUAGE'] = 'en'
+        self.counter = None
+        if self.args["preload"] is not None:
+            count_file = os.path.join(self.workdir, "allocs-" + tag)
+            monkey_env['LD_PRELOAD'] = self.args["preload"]
+            monkey_env['MALLOC_COUNT_FILE'] = count_file
+            self.counter = AllocCounter(count_file)
+
+        browser = Browser(monkey_cmd=monkey_cmd,
+                          monkey_env=monkey_env,
+                          quiet=True,
+                          wrapper=self.args["wrapper"])
+        assert browser.started
+        return browser
+
+    def run_once(self, browser, page, tag, keep=False):
+        before = self.counter.read() if self.counter is not None else None
+
+        win = browser.new_window()
+        start = time.time()
+        win.load_page(self.url(page))
+        load_ms = (time.time() - start) * 1000
+        win.redraw()
+
+        trace = os.path.join(self.workdir, "trace-{}.json".format(tag))
+        assert win.trace(trace) is not None, "unable to write trace"
+
+        result = trace_stages(trace)
+        result["load_ms"] = load_ms
+        result["peak_rss_kb"] = peak_rss(browser)
+        result["allocs"] = None
+        result["alloc_bytes"] = None
+        if before is not None:
+            after = self.counter.read()
+            result["allocs"] = after[0] - before[0]
+            result["alloc_bytes"] = after[1] - before[1]
+
+        if keep:
+            return (result, win)
+
+        win.kill()
+        win.wait_until_dead()
+        return result
+
+    def run_cold(self, page):
+        results = []
+        for run in range(self.args["runs"]):
+            tag = "{}-cold-{}".format(page["name"], run)
+            browser = self.launch(tag)
+            results.append(self.run_once(browser, page, tag))
+            assert browser.quit_and_wait()
+        return results
+
+    def run_warm(self, page):
+        results = []
+        tag = "{}-warm".format(page["name"])
+        browser = self.launch(tag)
+        # prime the cache and keep the page open, as when navigating
+        # within a site, so its stylesheets and selection context live on
+        (_prime, primed) = self.run_once(browser, page, tag + "-prime", keep=True)
+        for run in range(self.args["runs"]):
+            results.append(self.run_once(browser, page, "{}-{}".format(tag, run)))
+        primed.kill()
+        primed.wait_until_dead()
+        assert browser.quit_and_wait()
+        return results
+
+    def close(self):
+        if self.server is not None:
+            self.server.close()
+
+
+def summarise(samples):
+    summary = {}
+    for key in RESULTS:
+        values = [s[key] for s in samples if s[key] is not None]
+        if not values:
+            summary[key] = None
+            continue
+        summary[key] = {
+            "min": min(values),
+            "median": statistics.median(values),
+            "mean": statistics.mean(values),
+            "max": max(values),
+        }
+    return summary
+
+
+def print_report(report):
+    columns = ["load_ms", "fetch_ms", "parse_ms", "selctx_ms", "box_ms", "layout_ms",
+               "redraw_ms", "peak_rss_kb", "allocs"]
+    print("Medians over {} runs".format(report["runs"]))
+    print("{:<10} {:<5}".format("page", "mode") +
+          "".join(" {:>12}".format(c) for c in columns))
+    for (name, page) in report["pages"].items():
+        for mode in ("cold", "warm"):
+            line = "{:<10} {:<5}".format(name, mode)
+            for column in columns:
+                value = page[mode]["summary"][column]
+                if value is None:
+                    line += " {:>12}".format("-")
+                else:
+                    line += " {:>12.1f}".format(value["median"])
+            print(line)
+
+
+def main(argv):
+    args = parse_argv(argv)
+    corpus = load_corpus(args["corpus"])
+
+    report = {
+        "corpus": corpus["title"],
+        "source": "file" if args["file"] else "http",
+        "runs": args["runs"],
+        "pages": {},
+    }
+
+    workdir = tempfile.mkdtemp(prefix="nsbench-")
+    bench = Bench(args, corpus, workdir)
+    try:
+        for page in corpus["pages"]:
+            print("Benchmarking: {}".format(page["name"]))
+            cold = bench.run_cold(page)
+            warm = bench.run_warm(page)
+            report["pages"][page["name"]] = {
+                "cold": {"summary": summarise(cold), "samples": cold},
+                "warm": {"summary": summarise(warm), "samples": warm},
+            }
+    finally:
+        bench.close()
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    print_report(report)
+
+    if args["output"] is not None:
+        with open(args["output"], 'w') as stream:
+            json.dump(report, stream, indent=2, sort_keys=True)
+            stream.write("\n")
+
+
+# Some python weirdness to get to main().
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -220,6 +220,7 @@ class Browser:
         self.started = False
         self.stopped = False
         self.launchurl = None
+        self.errors = []
         now = time.time()
         timeout = now + 1
 
@@ -263,6 +264,9 @@ class Browser:
         else:
             pass
 
+    def handle_ERROR(self, *args):
+        self.errors.append(" ".join(args))
+
     def handle_WINDOW(self, action, _win, winid, *args):
         if action == "NEW":
             new_win = BrowserWindow(self, winid, *args)
@@ -406,6 +410,7 @@ class BrowserWindow:
         self.plotting = False
         self.log_entries = []
         self.page_info_state = "UNKNOWN"
+        self.trace_events = None
 
     def kill(self):
         self.browser.farmer.tell_monkey("WINDOW DESTROY %s" % self.winid)
@@ -526,6 +531,9 @@ class BrowserWindow:
     def handle_window_PAGE_STATUS(self, _status, status):
         self.page_info_state = status
 
+    def handle_window_TRACE(self, _events, events):
+        self.trace_events = int(events)
+
     def load_page(self, url=None, referer=None):
         if url is not None:
             self.go(url, referer)
@@ -555,6 +563,14 @@ class BrowserWindow:
             self.browser.farmer.loop(once=True)
         return self.plotted
 
+    def trace(self, path):
+        self.trace_events = None
+        errors = len(self.browser.errors)
+        self.browser.farmer.tell_monkey("WINDOW TRACE %s %s" % (self.winid, path))
+        while self.trace_events is None and len(self.browser.errors) == errors:
+            self.browser.farmer.loop(once=True)
+        return self.trace_events
+
     def clear_log(self):
         self.log_entries = []
 
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Framebuffer text plotting microbenchmark.
+ *
+ * Plots the words of a page of text into a 32bpp buffer, first a glyph
+ * at a time as the framebuffer plotted text before the glyph cache, then
+ * a run at a time through the glyph cache with the cache emptied before
+ * each pass (cold) and with it kept (warm).
+ *
+ * Glyphs are looked up in a freetype cache set up as the framebuffer
+ * font code does, so the per glyph figures include the same cache
+ * lookups as the framebuffer made for every character.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include <ft2build.h>
+#include FT_CACHE_H
+
+#include "utils/errors.h"
+#include "utils/utf8.h"
+#include "framebuffer/glyph_cache.h"
+
+/* utf8 conversion refers to the gui tables */
+struct netsurf_table *guit = NULL;
+
+#define TARGET_WIDTH 1024
+#define TARGET_HEIGHT 768
+#define LINE_HEIGHT 16
+#define PASSES 200
+
+/** font size in 26.6 points */
+#define FONT_SIZE (12 * 64)
+/** font resolution in dots per inch */
+#define FONT_DPI 90
+
+static const char *page_text =
+	"NetSurf is a free, open source web browser. It is written in C "
+	"and released under the GNU Public Licence version 2. NetSurf has "
+	"its own layout and rendering engine entirely written from scratch. "
+	"It is small and capable of handling many of the web standards in "
+	"use today. Caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9\x65, "
+	"\xe2\x80\x9cquoted\xe2\x80\x9d text \xe2\x80\x94 and na\xc3\xafve "
+	"r\xc3\xa9sum\xc3\xa9s. The framebuffer frontend plots directly to "
+	"a memory surface and is used on embedded systems where every "
+	"cycle spent drawing text is a cycle not spent on layout, so the "
+	"same words are drawn again and again as pages scroll.";
+
+/** a word placed on the page */
+struct word {
+	const char *text;
+	size_t length;
+	int x;
+	int y;
+};
+
+static struct word *words;
+static size_t word_count;
+
+static uint32_t target[TARGET_WIDTH * TARGET_HEIGHT];
+static uint32_t reference[TARGET_WIDTH * TARGET_HEIGHT];
+
+static FT_Library library;
+static FTC_Manager ft_cmanager;
+static FTC_CMapCache ft_cmap_cache;
+static FTC_ImageCache ft_image_cache;
+static const char *font_file =
+	"/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+
+
+static FT_Error
+bench_face_requester(FTC_FaceID face_id,
+		     FT_Library lib,
+		     FT_Pointer request_data,
+		     FT_Face *face)
+{
+	FT_Error error;
+
+	error = FT_New_Face(lib, (const char *)face_id, 0, face);
+	if (error == 0) {
+		error = FT_Select_Charmap(*face, FT_ENCODING_UNICODE);
+	}
+	return error;
+}
+
+
+/**
+ * Look up a glyph as the framebuffer font code does.
+ */
+static FT_Glyph bench_lookup(uint32_t ucs4)
+{
+	FTC_ScalerRec srec;
+	FT_UInt glyph_index;
+	FT_Glyph glyph;
+
+	srec.face_id = (FTC_FaceID)font_file;
+	srec.width = srec.height = FONT_SIZE;
+	srec.pixel = 0;
+	srec.x_res = srec.y_res = FONT_DPI;
+
+	glyph_index = FTC_CMapCache_Lookup(ft_cmap_cache, srec.face_id, 0, ucs4);
+
+	if (FTC_ImageCache_LookupScaler(ft_image_cache, &srec,
+					FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT,
+					glyph_index, &glyph, NULL) != 0) {
+		return NULL;
+	}
+
+	return glyph;
+}
+
+
+/**
+ * Glyph cache rasteriser.
+ */
+static nserror
+bench_render(const void *face,
+	     int size,
+	     int resolution,
+	     uint32_t ucs4,
+	     struct fb_glyph_bitmap *bitmap)
+{
+	FT_BitmapGlyph bglyph;
+	FT_Glyph glyph;
+
+	glyph = bench_lookup(ucs4);
+	if (glyph == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	memset(bitmap, 0, sizeof(*bitmap));
+	bitmap->advance = glyph->advance.x >> 16;
+
+	if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
+		bglyph = (FT_BitmapGlyph)glyph;
+		bitmap->left = bglyph->left;
+		bitmap->top = bglyph->top;
+		bitmap->width = bglyph->bitmap.width;
+		bitmap->rows = bglyph->bitmap.rows;
+		bitmap->pitch = bglyph->bitmap.pitch;
+		bitmap->buffer = bglyph->bitmap.buffer;
+		bitmap->mono = (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Blend 8 bit coverage into the target as nsfb_plot_glyph8 does.
+ */
+static void
+blend(int x0, int y0, int width, int rows, const uint8_t *data, int pitch)
+{
+	const uint32_t fg = 0x102030;
+	int x;
+	int y;
+
+	for (y = 0; y < rows; y++) {
+		uint32_t *dst;
+
+		if ((y0 + y < 0) || (y0 + y >= TARGET_HEIGHT)) {
+			continue;
+		}
+		dst = target + ((y0 + y) * TARGET_WIDTH);
+		for (x = 0; x < width; x++) {
+			uint32_t a = data[y * pitch + x];
+			uint32_t b;
+			uint32_t rb;
+			uint32_t g;
+
+			if ((a == 0) || (x0 + x < 0) || (x0 + x >= TARGET_WIDTH)) {
+				continue;
+			}
+			if (a == 0xff) {
+				dst[x0 + x] = fg;
+				continue;
+			}
+			b = dst[x0 + x];
+			rb = ((fg & 0xff00ff) * a + (b & 0xff00ff) * (0xff - a)) >> 8;
+			g = ((fg & 0x00ff00) * a + (b & 0x00ff00) * (0xff - a)) >> 8;
+			dst[x0 + x] = (rb & 0xff00ff) | (g & 0x00ff00);
+		}
+	}
+}
+
+
+/**
+ * Plot a word a glyph at a time.
+ */
+static void plot_glyphs(const struct word *word)
+{
+	FT_BitmapGlyph bglyph;
+	FT_Glyph glyph;
+	size_t nxtchr = 0;
+	uint32_t ucs4;
+	int x = word->x;
+
+	while (nxtchr < word->length) {
+		ucs4 = utf8_to_ucs4(word->text + nxtchr, word->length - nxtchr);
+		nxtchr = utf8_next(word->text, word->length, nxtchr);
+
+		glyph = bench_lookup(ucs4);
+		if (glyph == NULL) {
+			continue;
+		}
+		if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
+			bglyph = (FT_BitmapGlyph)glyph;
+			blend(x + bglyph->left, word->y - bglyph->top,
+			      bglyph->bitmap.width, bglyph->bitmap.rows,
+			      bglyph->bitmap.buffer, bglyph->bitmap.pitch);
+		}
+		x += glyph->advance.x >> 16;
+	}
+}
+
+
+/**
+ * Plot a word as a run from the glyph cache.
+ */
+static void plot_run(const struct word *word)
+{
+	struct fb_glyph_strike *strike;
+	const struct fb_glyph_run *run;
+	unsigned int idx;
+
+	strike = fb_glyph_strike_get(font_file, FONT_SIZE, FONT_DPI,
+				     bench_render);
+	if ((strike == NULL) ||
+	    (fb_glyph_run(strike, word->text, word->length, &run) != NSERROR_OK)) {
+		fprintf(stderr, "Unable to plot run\n");
+		exit(EXIT_FAILURE);
+	}
+	for (idx = 0; idx < run->count; idx++) {
+		const struct fb_glyph *glyph = run->glyphs[idx].glyph;
+		blend(word->x + run->glyphs[idx].x + glyph->left,
+		      word->y - glyph->top,
+		      glyph->width, glyph->rows, glyph->data, glyph->pitch);
+	}
+}
+
+
+/**
+ * Place the words of the text on the page, repeating it to fill the page.
+ */
+static void place_words(void)
+{
+	size_t len = strlen(page_text);
+	size_t alloc = 0;
+	size_t start = 0;
+	size_t end;
+	int x = 0;
+	int y = LINE_HEIGHT;
+
+	while (y < TARGET_HEIGHT) {
+		struct word *nwords;
+		FT_Glyph glyph;
+		size_t nxtchr;
+		int width = 0;
+
+		end = start;
+		while ((end < len) && (page_text[end] != ' ')) {
+			end++;
+		}
+
+		for (nxtchr = start; nxtchr < end; ) {
+			uint32_t ucs4 = utf8_to_ucs4(page_text + nxtchr,
+						     end - nxtchr);
+			nxtchr = utf8_next(page_text, end, nxtchr);
+			glyph = bench_lookup(ucs4);
+			if (glyph != NULL) {
+				width += glyph->advance.x >> 16;
+			}
+		}
+		if (x + width > TARGET_WIDTH) {
+			x = 0;
+			y += LINE_HEIGHT;
+			continue;
+		}
+
+		if (word_count == alloc) {
+			alloc = (alloc == 0) ? 256 : alloc * 2;
+			nwords = realloc(words, alloc * sizeof(*words));
+			if (nwords == NULL) {
+				exit(EXIT_FAILURE);
+			}
+			words = nwords;
+		}
+		words[word_count].text = page_text + start;
+		words[word_count].length = end - start;
+		words[word_count].x = x;
+		words[word_count].y = y;
+		word_count++;
+
+		x += width + LINE_HEIGHT / 4;
+		start = (end < len) ? end + 1 : 0;
+	}
+}
+
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+
+/**
+ * Time plotting every word on the page.
+ *
+ * \param name The name to report.
+ * \param plot The function to plot a word with.
+ * \param cold Empty the glyph cache before each pass.
+ */
+static void
+bench(const char *name, void (*plot)(const struct word *word), bool cold)
+{
+	double start;
+	double elapsed = 0;
+	size_t idx;
+	int pass;
+
+	for (pass = 0; pass < PASSES; pass++) {
+		if (cold) {
+			fb_glyph_cache_finalise();
+		}
+		start = now();
+		for (idx = 0; idx < word_count; idx++) {
+			plot(&words[idx]);
+		}
+		elapsed += now() - start;
+	}
+
+	printf("%-12s %10.1f ns/word %10.3f ms/page\n", name,
+	       (elapsed * 1e9) / ((double)PASSES * word_count),
+	       (elapsed * 1e3) / PASSES);
+}
+
+
+/**
+ * Count the pixels which differ from the reference plot.
+ */
+static size_t differences(void)
+{
+	size_t count = 0;
+	size_t idx;
+
+	for (idx = 0; idx < TARGET_WIDTH * TARGET_HEIGHT; idx++) {
+		if (target[idx] != reference[idx]) {
+			count++;
+		}
+	}
+	return count;
+}
+
+
+int main(int argc, char **argv)
+{
+	size_t idx;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "f:")) != -1) {
+		switch (opt) {
+		case 'f':
+			font_file = optarg;
+			break;
+
+		default:
+			fprintf(stderr, "Usage: %s [-f font]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if ((FT_Init_FreeType(&library) != 0) ||
+	    (FTC_Manager_New(library, 1, 0, 0, bench_face_requester,
+			     NULL, &ft_cmanager) != 0) ||
+	    (FTC_CMapCache_New(ft_cmanager, &ft_cmap_cache) != 0) ||
+	    (FTC_ImageCache_New(ft_cmanager, &ft_image_cache) != 0)) {
+		fprintf(stderr, "Unable to initialise freetype\n");
+		return EXIT_FAILURE;
+	}
+	if (bench_lookup('a') == NULL) {
+		fprintf(stderr, "Unable to load %s\n", font_file);
+		return EXIT_FAILURE;
+	}
+
+	place_words();
+	printf("%s: %zu words per page, %d passes\n",
+	       font_file, word_count, PASSES);
+
+	/* both methods must plot the same pixels */
+	memset(target, 0xff, sizeof(target));
+	for (idx = 0; idx < word_count; idx++) {
+		plot_glyphs(&words[idx]);
+	}
+	memcpy(reference, target, sizeof(target));
+
+	memset(target, 0xff, sizeof(target));
+	for (idx = 0; idx < word_count; idx++) {
+		plot_run(&words[idx]);
+	}
+	if (differences() != 0) {
+		fprintf(stderr, "%zu pixels differ\n", differences());
+		return EXIT_FAILURE;
+	}
+
+	bench("per glyph", plot_glyphs, false);
+	bench("cache cold", plot_run, true);
+	bench("cache warm", plot_run, false);
+
+	fb_glyph_cache_finalise();
+	FTC_Manager_Done(ft_cmanager);
+	FT_Done_FreeType(library);
+	free(words);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Compact a stylesheet into C source.
+ *
+ * Comments and whitespace the CSS tokeniser would discard are removed
+ * and the result is written out as a C array, so the browser can build
+ * the stylesheet in and tokenise as little as possible at run time.
+ *
+ * The original stylesheet is written out too, as a second array with
+ * "_stock" appended to its name, so the browser can tell whether the
+ * copy of the stylesheet the frontend has is the one it was built with.
+ *
+ * Whitespace is only removed next to characters which can never be
+ * part of a descendant combinator or an expression, so the compacted
+ * stylesheet parses to the same rules as the original.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+static char *read_file(const char *fname, size_t *len_out)
+{
+	FILE *inf;
+	char *buf = NULL;
+	size_t len = 0;
+	size_t alloc = 0;
+	size_t rd;
+
+	inf = fopen(fname, "rb");
+	if (inf == NULL) {
+		perror("Opening for read");
+		return NULL;
+	}
+
+	do {
+		if (len == alloc) {
+			char *nbuf;
+			alloc += 16384;
+			nbuf = realloc(buf, alloc);
+			if (nbuf == NULL) {
+				free(buf);
+				fclose(inf);
+				return NULL;
+			}
+			buf = nbuf;
+		}
+		rd = fread(buf + len, 1, alloc - len, inf);
+		len += rd;
+	} while (rd != 0);
+
+	fclose(inf);
+
+	*len_out = len;
+	return buf;
+}
+
+static bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/* characters whitespace either side of may be dropped */
+static bool is_separator(char c)
+{
+	return c == '{' || c == '}' || c == ';' || c == ',' || c == '>';
+}
+
+/**
+ * Compact a stylesheet in place.
+ *
+ * \param src The stylesheet source
+ * \param len The source length
+ * \return The compacted length
+ */
+static size_t compact(char *src, size_t len)
+{
+	size_t in = 0;
+	size_t out = 0;
+	bool space = false;
+
+	while (in < len) {
+		char c = src[in];
+
+		if (c == '/' && in + 1 < len && src[in + 1] == '*') {
+			/* comments separate tokens but are not whitespace
+			 * so one which is all that keeps two tokens apart
+			 * is kept, emptied, rather than made a space
+			 */
+			in += 2;
+			while (in + 1 < len &&
+			       !(src[in] == '*' && src[in + 1] == '/')) {
+				in++;
+			}
+			in += 2;
+			if (!space && out > 0 && in < len &&
+			    !is_space(src[in]) &&
+			    !is_separator(src[out - 1]) &&
+			    !is_separator(src[in])) {
+				memcpy(src + out, "/**/", 4);
+				out += 4;
+			}
+			continue;
+		}
+
+		if (is_space(c)) {
+			in++;
+			space = true;
+			continue;
+		}
+
+		if (space) {
+			if (out > 0 &&
+			    !is_separator(src[out - 1]) &&
+			    !is_separator(c)) {
+				src[out++] = ' ';
+			}
+			space = false;
+		}
+
+		if (c == ';' && in + 1 < len) {
+			/* a declaration's terminator is implied by a
+			 * closing brace */
+			size_t next = in + 1;
+
+			while (next < len && is_space(src[next])) {
+				next++;
+			}
+			if (next < len && src[next] == '}') {
+				in++;
+				continue;
+			}
+		}
+
+		if (c == '"' || c == '\'') {
+			/* strings are copied verbatim */
+			src[out++] = src[in++];
+			while (in < len && src[in] != c) {
+				if (src[in] == '\\' && in + 1 < len) {
+					src[out++] = src[in++];
+				}
+				src[out++] = src[in++];
+			}
+			if (in < len) {
+				src[out++] = src[in++];
+			}
+			continue;
+		}
+
+		src[out++] = src[in++];
+	}
+
+	return out;
+}
+
+/**
+ * Write data out as a C array.
+ *
+ * \param outf The file to write to
+ * \param name The name of the array
+ * \param data The data
+ * \param len The data length
+ */
+static void write_array(FILE *outf, const char *name, const char *data, size_t len)
+{
+	size_t idx;
+
+	fprintf(outf, "static const unsigned char %s[] = {\n", name);
+	for (idx = 0; idx < len; idx++) {
+		if ((idx % 12) == 0) {
+			fprintf(outf, " ");
+		}
+		fprintf(outf, " 0x%02x,", (unsigned char)data[idx]);
+		if ((idx % 12) == 11) {
+			fprintf(outf, "\n");
+		}
+	}
+	if ((len % 12) != 0) {
+		fprintf(outf, "\n");
+	}
+	fprintf(outf, "};\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *aryname = NULL;
+	char *stockname;
+	char *src;
+	size_t srclen;
+	size_t len;
+	FILE *outf;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		switch (opt) {
+		case 'n':
+			aryname = optarg;
+			break;
+
+		default: /* '?' */
+			fprintf(stderr, "Usage: %s -n name infile outfile\n",
+				argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if ((aryname == NULL) || ((optind + 2) != argc)) {
+		fprintf(stderr, "Usage: %s -n name infile outfile\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	src = read_file(argv[optind], &srclen);
+	if (src == NULL) {
+		exit(EXIT_FAILURE);
+	}
+
+	stockname = malloc(strlen(aryname) + sizeof("_stock"));
+	if (stockname == NULL) {
+		exit(EXIT_FAILURE);
+	}
+	sprintf(stockname, "%s_stock", aryname);
+
+	outf = fopen(argv[optind + 1], "w");
+	if (outf == NULL) {
+		perror("Opening for write");
+		exit(EXIT_FAILURE);
+	}
+
+	fprintf(outf, "/* %s: stock stylesheet */\n", argv[optind]);
+	write_array(outf, stockname, src, srclen);
+
+	len = compact(src, srclen);
+
+	fprintf(outf, "/* %s: %lu bytes compacted to %lu */\n",
+		argv[optind], (unsigned long)srclen, (unsigned long)len);
+	write_array(outf, aryname, src, len);
+
+	fclose(outf);
+
+	free(stockname);
+	free(src);
+
+	return 0;
+}
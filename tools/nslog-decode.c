@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Decode a binary log ring, as written by the browser's -B switch, into
+ * the same text the normal logging produces.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "utils/errors.h"
+#include "utils/log_ring.h"
+
+int main(int argc, char **argv)
+{
+	FILE *in;
+	FILE *out = stdout;
+	nserror res;
+
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Usage: %s logfile [outfile]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	in = fopen(argv[1], "rb");
+	if (in == NULL) {
+		perror("Opening for read");
+		return EXIT_FAILURE;
+	}
+
+	if (argc == 3) {
+		out = fopen(argv[2], "w");
+		if (out == NULL) {
+			perror("Opening for write");
+			fclose(in);
+			return EXIT_FAILURE;
+		}
+	}
+
+	res = nslog_ring_decode(in, out);
+	if (res == NSERROR_INVALID) {
+		fprintf(stderr, "%s: not a valid log ring\n", argv[1]);
+	} else if (res != NSERROR_OK) {
+		fprintf(stderr, "%s: unable to decode\n", argv[1]);
+	}
+
+	fclose(in);
+	if (out != stdout) {
+		fclose(out);
+	}
+
+	return (res == NSERROR_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
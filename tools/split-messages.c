@@ -9,13 +9,16 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include <zlib.h>
 
 #include "utils/errors.h"
+#include "utils/messages_table.h"
 
 enum out_fmt {
 	      OUTPUTFMT_NONE = 0,
 	      OUTPUTFMT_MESSAGES,
+	      OUTPUTFMT_TABLE,
 };
 
 /**
@@ -39,6 +42,10 @@ struct param {
 	enum out_fmt format;
 	char *infilename;
 	char *outfilename;
+	/**
+	 * name of the generated table
+	 */
+	char *tablename;
 };
 
 struct trnsltn_entry {
@@ -51,14 +58,15 @@ struct trnsltn_entry {
 static nserror usage(int argc, char **argv)
 {
 	fprintf(stderr,
-		"Usage: %s -l lang [-z] [-d lang] [-W warning] [-o <file>] [-i <file>] [-p platform] [-f format] [<file> [<file>]]\n"
+		"Usage: %s -l lang [-z] [-d lang] [-W warning] [-o <file>] [-i <file>] [-p platform] [-f format] [-n name] [<file> [<file>]]\n"
 		"Options:\n"
 		"  -z           Gzip output\n"
 		"  -l lang      Language to select for\n"
 		"  -d lang      Fallback language [default: en]\n"
 		"  -W warning   Warnings generated none, all [default: none]\n"
 		"  -p platform  Platform to select for any, gtk, ami [default: any]\n"
-		"  -f format    Output format [default: messages]\n"
+		"  -f format    Output format messages, table [default: messages]\n"
+		"  -n name      Name of the generated table [default: messages_table]\n"
 		"  -i filename  Input file\n"
 		"  -o filename  Output file\n",
 		argv[0]);
@@ -76,7 +84,7 @@ static nserror process_cmdline(int argc, char **argv, struct param *param)
 
 	memset(param, 0, sizeof(*param));
 
-	while ((opt = getopt(argc, argv, "zl:d:W:o:i:p:f:")) != -1) {
+	while ((opt = getopt(argc, argv, "zl:d:W:o:i:p:f:n:")) != -1) {
 		switch (opt) {
 		case 'z':
 			param->compress = 1;
@@ -109,6 +117,8 @@ static nserror process_cmdline(int argc, char **argv, struct param *param)
 		case 'f':
 			if (strcmp(optarg, "messages") == 0) {
 				param->format = OUTPUTFMT_MESSAGES;
+			} else if (strcmp(optarg, "table") == 0) {
+				param->format = OUTPUTFMT_TABLE;
 			} else {
 				fprintf(stderr,
 					"output format %s not supported",
@@ -118,6 +128,10 @@ static nserror process_cmdline(int argc, char **argv, struct param *param)
 			}
 			break;
 
+		case 'n':
+			param->tablename = strdup(optarg);
+			break;
+
 		default:
 			usage(argc, argv);
 			return NSERROR_BAD_PARAMETER;
@@ -169,6 +183,10 @@ static nserror process_cmdline(int argc, char **argv, struct param *param)
 		param->format = OUTPUTFMT_MESSAGES;
 	}
 
+	if (param->tablename == NULL) {
+		param->tablename = strdup("messages_table");
+	}
+
 	return NSERROR_OK;
 }
 
@@ -523,6 +541,308 @@ message_write(struct param *param, struct trnsltn_entry *tlist)
 	return NSERROR_OK;
 }
 
+/**
+ * a message being placed in a compiled table
+ */
+struct table_entry {
+	struct trnsltn_entry *tran; /**< the translation */
+	uint32_t hash; /**< hash of the key */
+	unsigned int order; /**< position in the translation list */
+	uint32_t bucket; /**< bucket the key hashes to */
+};
+
+/**
+ * a bucket of messages being placed in a compiled table
+ */
+struct table_bucket {
+	struct table_entry *entries; /**< first message in the bucket */
+	unsigned int count; /**< number of messages in the bucket */
+	uint32_t bucket; /**< bucket index */
+};
+
+
+/**
+ * order table entries by hash and then by translation list position
+ */
+static int table_entry_hash_cmp(const void *a, const void *b)
+{
+	const struct table_entry *ea = a;
+	const struct table_entry *eb = b;
+
+	if (ea->hash != eb->hash) {
+		return (ea->hash < eb->hash) ? -1 : 1;
+	}
+	return (ea->order < eb->order) ? -1 : (ea->order > eb->order);
+}
+
+
+/**
+ * order table entries by bucket
+ */
+static int table_entry_bucket_cmp(const void *a, const void *b)
+{
+	const struct table_entry *ea = a;
+	const struct table_entry *eb = b;
+
+	return (ea->bucket < eb->bucket) ? -1 : (ea->bucket > eb->bucket);
+}
+
+
+/**
+ * order buckets by decreasing size so the largest are placed first
+ */
+static int table_bucket_cmp(const void *a, const void *b)
+{
+	const struct table_bucket *ba = a;
+	const struct table_bucket *bb = b;
+
+	if (ba->count != bb->count) {
+		return (ba->count > bb->count) ? -1 : 1;
+	}
+	return (ba->bucket < bb->bucket) ? -1 : (ba->bucket > bb->bucket);
+}
+
+
+/**
+ * try to place every message of a bucket with a seed
+ *
+ * \return 1 if all the messages were placed in free slots else 0 and
+ *         the slots are unchanged.
+ */
+static int
+table_bucket_place(struct table_bucket *bucket,
+		   uint16_t seed,
+		   struct table_entry **slots,
+		   uint32_t count)
+{
+	unsigned int idx;
+	uint32_t slot;
+
+	for (idx = 0; idx < bucket->count; idx++) {
+		slot = messages_table_slot(bucket->entries[idx].hash, seed, count);
+		if (slots[slot] != NULL) {
+			/* undo the placements already made */
+			while (idx > 0) {
+				idx--;
+				slot = messages_table_slot(bucket->entries[idx].hash,
+							   seed, count);
+				slots[slot] = NULL;
+			}
+			return 0;
+		}
+		slots[slot] = &bucket->entries[idx];
+	}
+
+	return 1;
+}
+
+
+/**
+ * write a string as a C string literal
+ */
+static void table_write_string(FILE *outf, const char *str)
+{
+	const unsigned char *c;
+
+	fputc('"', outf);
+	for (c = (const unsigned char *)str; *c != 0; c++) {
+		if ((*c == '"') || (*c == '\\') || (*c == '?')) {
+			/* question marks are escaped to avoid trigraphs */
+			fprintf(outf, "\\%c", *c);
+		} else if ((*c < 0x20) || (*c >= 0x7f)) {
+			fprintf(outf, "\\%03o", *c);
+		} else {
+			fputc(*c, outf);
+		}
+	}
+	fputc('"', outf);
+}
+
+
+/**
+ * write output as a compiled message table
+ *
+ * The messages are placed with a minimal perfect hash (hash and
+ * displace) and written out as C source defining the table.
+ */
+static nserror
+table_write(struct param *param, struct trnsltn_entry *tlist)
+{
+	struct table_entry *entries;
+	struct table_bucket *buckets;
+	struct table_entry **slots;
+	uint16_t *seeds;
+	struct trnsltn_entry *tran;
+	uint32_t count = 0;
+	uint32_t bucket_count;
+	uint32_t idx;
+	uint32_t used;
+	unsigned int seed;
+	FILE *outf;
+	nserror res = NSERROR_OK;
+
+	for (tran = tlist; tran != NULL; tran = tran->next) {
+		count++;
+	}
+
+	entries = calloc(count + 1, sizeof(*entries));
+	if (entries == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	for (tran = tlist, idx = 0; tran != NULL; tran = tran->next, idx++) {
+		entries[idx].tran = tran;
+		entries[idx].hash = messages_table_hash(tran->key);
+		entries[idx].order = idx;
+	}
+
+	/* remove duplicate keys, the last definition is kept as it
+	 * would be when a messages file is loaded.
+	 */
+	qsort(entries, count, sizeof(*entries), table_entry_hash_cmp);
+	used = 0;
+	for (idx = 0; idx < count; idx++) {
+		if ((used > 0) && (entries[used - 1].hash == entries[idx].hash)) {
+			if (strcmp(entries[used - 1].tran->key,
+				   entries[idx].tran->key) != 0) {
+				fprintf(stderr,
+					"keys \"%s\" and \"%s\" have the same hash\n",
+					entries[used - 1].tran->key,
+					entries[idx].tran->key);
+				free(entries);
+				return NSERROR_INVALID;
+			}
+			entries[used - 1] = entries[idx];
+			continue;
+		}
+		entries[used++] = entries[idx];
+	}
+	count = used;
+
+	/* two messages per bucket on average keeps the seed search short */
+	bucket_count = (count / 2) + 1;
+
+	buckets = calloc(bucket_count, sizeof(*buckets));
+	seeds = calloc(bucket_count, sizeof(*seeds));
+	slots = calloc(count + 1, sizeof(*slots));
+	if ((buckets == NULL) || (seeds == NULL) || (slots == NULL)) {
+		free(slots);
+		free(seeds);
+		free(buckets);
+		free(entries);
+		return NSERROR_NOMEM;
+	}
+
+	for (idx = 0; idx < count; idx++) {
+		entries[idx].bucket = entries[idx].hash % bucket_count;
+	}
+	qsort(entries, count, sizeof(*entries), table_entry_bucket_cmp);
+
+	for (idx = 0; idx < bucket_count; idx++) {
+		buckets[idx].bucket = idx;
+	}
+	for (idx = 0; idx < count; idx++) {
+		struct table_bucket *bucket = &buckets[entries[idx].bucket];
+		if (bucket->count == 0) {
+			bucket->entries = &entries[idx];
+		}
+		bucket->count++;
+	}
+	qsort(buckets, bucket_count, sizeof(*buckets), table_bucket_cmp);
+
+	for (idx = 0; idx < bucket_count; idx++) {
+		if (buckets[idx].count == 0) {
+			break;
+		}
+		for (seed = 0; seed <= UINT16_MAX; seed++) {
+			if (table_bucket_place(&buckets[idx], seed, slots, count)) {
+				break;
+			}
+		}
+		if (seed > UINT16_MAX) {
+			fprintf(stderr, "Unable to place messages of bucket %u\n",
+				buckets[idx].bucket);
+			free(slots);
+			free(seeds);
+			free(buckets);
+			free(entries);
+			return NSERROR_INVALID;
+		}
+		seeds[buckets[idx].bucket] = seed;
+	}
+
+	outf = fopen(param->outfilename, "w");
+	if (outf == NULL) {
+		perror("Unable to open output file");
+		free(slots);
+		free(seeds);
+		free(buckets);
+		free(entries);
+		return NSERROR_PERMISSION;
+	}
+
+	fprintf(outf,
+		"/* This message table is automatically generated from %s\n"
+		" * at build-time.  Please go and edit that instead of this.\n"
+		" */\n\n"
+		"#include \"utils/messages_table.h\"\n\n",
+		param->infilename);
+
+	fprintf(outf, "static const uint16_t %s_seeds[] = {", param->tablename);
+	for (idx = 0; idx < bucket_count; idx++) {
+		if ((idx % 12) == 0) {
+			fprintf(outf, "\n\t");
+		} else {
+			fprintf(outf, " ");
+		}
+		fprintf(outf, "%u,", seeds[idx]);
+	}
+	fprintf(outf, "\n};\n\n");
+
+	if (count > 0) {
+		fprintf(outf,
+			"static const struct messages_table_entry %s_entries[] = {\n",
+			param->tablename);
+		for (idx = 0; idx < count; idx++) {
+			fprintf(outf, "\t{ ");
+			table_write_string(outf, slots[idx]->tran->key);
+			fprintf(outf, ", ");
+			table_write_string(outf, slots[idx]->tran->value);
+			fprintf(outf, " },\n");
+		}
+		fprintf(outf, "};\n\n");
+	}
+
+	fprintf(outf,
+		"static const struct messages_table %s = {\n"
+		"\t.language = \"%s\",\n"
+		"\t.count = %u,\n"
+		"\t.bucket_count = %u,\n"
+		"\t.seeds = %s_seeds,\n",
+		param->tablename,
+		param->selected,
+		count,
+		bucket_count,
+		param->tablename);
+	if (count > 0) {
+		fprintf(outf, "\t.entries = %s_entries,\n", param->tablename);
+	} else {
+		fprintf(outf, "\t.entries = NULL,\n");
+	}
+	fprintf(outf, "};\n");
+
+	if (fclose(outf) != 0) {
+		unlink(param->outfilename);
+		res = NSERROR_NOSPACE;
+	}
+	free(slots);
+	free(seeds);
+	free(buckets);
+	free(entries);
+
+	return res;
+}
+
 int main(int argc, char **argv)
 {
 	nserror res;
@@ -547,6 +867,10 @@ int main(int argc, char **argv)
 	case OUTPUTFMT_MESSAGES:
 		res = message_write(&param, translations);
 		break;
+
+	case OUTPUTFMT_TABLE:
+		res = table_write(&param, translations);
+		break;
 	}
 
 	if (res != NSERROR_OK) {
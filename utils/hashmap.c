@@ -37,6 +37,31 @@ typedef struct hashmap_entry_s {
 	uint32_t key_hash;
 } hashmap_entry_t;
 
+/**
+ * Open addressing hashmaps have entries in slots of a single table.
+ */
+typedef struct hashmap_slot_s {
+	void *key;
+	void *value;
+	uint32_t key_hash;
+	/**
+	 * One more than the distance of the slot from the entry's home
+	 * slot, or zero if the slot is empty.
+	 */
+	uint32_t distance;
+} hashmap_slot_t;
+
+/**
+ * The smallest number of slots in an open addressing hashmap.
+ */
+#define OPEN_HASHMAP_MIN_SLOTS (16)
+
+/**
+ * The largest proportion of slots, in eighths, which may be in use
+ * before an open addressing hashmap is grown.
+ */
+#define OPEN_HASHMAP_MAX_LOAD (7)
+
 /**
  * The content of a hashmap
  */
@@ -56,12 +81,295 @@ struct hashmap_s {
 	 */
 	uint32_t bucket_count;
 
+	/**
+	 * The slots of an open addressing map, NULL for a chained map
+	 */
+	hashmap_slot_t *slots;
+
+	/**
+	 * The number of slots in an open addressing map, a power of two
+	 */
+	uint32_t slot_count;
+
+	/**
+	 * The shift which takes a scrambled hash to a home slot
+	 */
+	uint32_t slot_shift;
+
 	/**
 	 * The number of entries in this map
 	 */
 	size_t entry_count;
 };
 
+
+/**
+ * Find the home slot of a hash in an open addressing map.
+ *
+ * Fibonacci hashing spreads hashes with poor low bits over the table.
+ */
+static inline uint32_t
+open_home(hashmap_t *hashmap, uint32_t hash)
+{
+	return (uint32_t)(hash * 2654435769u) >> hashmap->slot_shift;
+}
+
+/**
+ * Find the slot holding a key in an open addressing map.
+ *
+ * \return The slot, or NULL if the key is not in the map
+ */
+static hashmap_slot_t *
+open_find(hashmap_t *hashmap, void *key, uint32_t hash)
+{
+	uint32_t mask = hashmap->slot_count - 1;
+	uint32_t idx = open_home(hashmap, hash);
+	uint32_t distance = 1;
+
+	for (;;) {
+		hashmap_slot_t *slot = &hashmap->slots[idx];
+
+		/* Robin hood placement means the key cannot be further
+		 * from home than the entry in this slot.
+		 */
+		if (slot->distance < distance) {
+			return NULL;
+		}
+		if (slot->key_hash == hash &&
+		    hashmap->params->key_eq(key, slot->key)) {
+			return slot;
+		}
+		idx = (idx + 1) & mask;
+		distance++;
+	}
+}
+
+/**
+ * Place a new entry in an open addressing map which has room for it.
+ *
+ * Entries closer to their home slot are displaced by those further
+ * from theirs, which keeps all probe sequences short.
+ */
+static void
+open_place(hashmap_t *hashmap, void *key, void *value, uint32_t hash)
+{
+	uint32_t mask = hashmap->slot_count - 1;
+	uint32_t idx = open_home(hashmap, hash);
+	hashmap_slot_t entry = {
+		.key = key,
+		.value = value,
+		.key_hash = hash,
+		.distance = 1,
+	};
+
+	for (;;) {
+		hashmap_slot_t *slot = &hashmap->slots[idx];
+
+		if (slot->distance == 0) {
+			*slot = entry;
+			return;
+		}
+		if (slot->distance < entry.distance) {
+			hashmap_slot_t displaced = *slot;
+			*slot = entry;
+			entry = displaced;
+		}
+		idx = (idx + 1) & mask;
+		entry.distance++;
+	}
+}
+
+/**
+ * Change the number of slots in an open addressing map.
+ *
+ * \return true on success, false if allocation failed and the map is
+ *         unchanged.
+ */
+static bool
+open_resize(hashmap_t *hashmap, uint32_t slot_count)
+{
+	hashmap_slot_t *old_slots = hashmap->slots;
+	uint32_t old_count = hashmap->slot_count;
+	hashmap_slot_t *slots;
+	uint32_t shift = 32;
+	uint32_t idx;
+
+	slots = malloc(slot_count * sizeof(hashmap_slot_t));
+	if (slots == NULL) {
+		return false;
+	}
+	memset(slots, 0, slot_count * sizeof(hashmap_slot_t));
+
+	while ((1u << (32 - shift)) < slot_count) {
+		shift--;
+	}
+
+	hashmap->slots = slots;
+	hashmap->slot_count = slot_count;
+	hashmap->slot_shift = shift;
+
+	for (idx = 0; idx < old_count; idx++) {
+		hashmap_slot_t *slot = &old_slots[idx];
+		if (slot->distance != 0) {
+			open_place(hashmap, slot->key, slot->value,
+				   slot->key_hash);
+		}
+	}
+
+	free(old_slots);
+
+	return true;
+}
+
+/* Exported function, documented in hashmap.h */
+hashmap_t *
+hashmap_create_open(hashmap_parameters_t *params, size_t capacity)
+{
+	uint32_t slot_count = OPEN_HASHMAP_MIN_SLOTS;
+	hashmap_t *ret;
+
+	while (((size_t)slot_count * OPEN_HASHMAP_MAX_LOAD) / 8 < capacity) {
+		if (slot_count >= (1u << 30)) {
+			return NULL;
+		}
+		slot_count <<= 1;
+	}
+
+	ret = malloc(sizeof(hashmap_t));
+	if (ret == NULL) {
+		return NULL;
+	}
+
+	ret->params = params;
+	ret->buckets = NULL;
+	ret->bucket_count = 0;
+	ret->slots = NULL;
+	ret->slot_count = 0;
+	ret->entry_count = 0;
+
+	if (open_resize(ret, slot_count) == false) {
+		free(ret);
+		return NULL;
+	}
+
+	return ret;
+}
+
+static void
+open_destroy(hashmap_t *hashmap)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx < hashmap->slot_count; idx++) {
+		hashmap_slot_t *slot = &hashmap->slots[idx];
+		if (slot->distance != 0) {
+			hashmap->params->value_destroy(slot->value);
+			hashmap->params->key_destroy(slot->key);
+		}
+	}
+
+	free(hashmap->slots);
+	free(hashmap);
+}
+
+static void *
+open_insert(hashmap_t *hashmap, void *key)
+{
+	uint32_t hash = hashmap->params->key_hash(key);
+	hashmap_slot_t *slot = open_find(hashmap, key, hash);
+	void *new_key, *new_value;
+
+	if (slot == NULL &&
+	    (hashmap->entry_count + 1) * 8 >
+	    (size_t)hashmap->slot_count * OPEN_HASHMAP_MAX_LOAD) {
+		/* Grow before cloning so failure leaves nothing to undo */
+		if (hashmap->slot_count >= (1u << 31) ||
+		    open_resize(hashmap, hashmap->slot_count << 1) == false) {
+			return NULL;
+		}
+	}
+
+	new_key = hashmap->params->key_clone(key);
+	if (new_key == NULL) {
+		/* Allocation failed */
+		return NULL;
+	}
+
+	new_value = hashmap->params->value_alloc(new_key);
+	if (new_value == NULL) {
+		/* Allocation failed */
+		hashmap->params->key_destroy(new_key);
+		return NULL;
+	}
+
+	if (slot != NULL) {
+		/* This key is already here */
+		hashmap->params->value_destroy(slot->value);
+		hashmap->params->key_destroy(slot->key);
+		slot->value = new_value;
+		slot->key = new_key;
+		return new_value;
+	}
+
+	open_place(hashmap, new_key, new_value, hash);
+
+	hashmap->entry_count++;
+
+	return new_value;
+}
+
+static bool
+open_remove(hashmap_t *hashmap, void *key)
+{
+	uint32_t hash = hashmap->params->key_hash(key);
+	hashmap_slot_t *slot = open_find(hashmap, key, hash);
+	uint32_t mask = hashmap->slot_count - 1;
+	uint32_t idx;
+
+	if (slot == NULL) {
+		return false;
+	}
+
+	hashmap->params->value_destroy(slot->value);
+	hashmap->params->key_destroy(slot->key);
+
+	/* Shift the following entries back towards their home slots
+	 * so no tombstone is needed.
+	 */
+	idx = slot - hashmap->slots;
+	for (;;) {
+		hashmap_slot_t *next = &hashmap->slots[(idx + 1) & mask];
+
+		if (next->distance <= 1) {
+			break;
+		}
+		hashmap->slots[idx] = *next;
+		hashmap->slots[idx].distance--;
+		idx = (idx + 1) & mask;
+	}
+	memset(&hashmap->slots[idx], 0, sizeof(hashmap_slot_t));
+
+	hashmap->entry_count--;
+
+	return true;
+}
+
+static bool
+open_iterate(hashmap_t *hashmap, hashmap_iteration_cb_t cb, void *ctx)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx < hashmap->slot_count; idx++) {
+		hashmap_slot_t *slot = &hashmap->slots[idx];
+		/* If the callback returns true, we early-exit */
+		if (slot->distance != 0 && cb(slot->key, slot->value, ctx)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /* Exported function, documented in hashmap.h */
 hashmap_t *
 hashmap_create(hashmap_parameters_t *params)
@@ -73,6 +381,8 @@ hashmap_create(hashmap_parameters_t *params)
 
 	ret->params = params;
 	ret->bucket_count = DEFAULT_HASHMAP_BUCKETS;
+	ret->slots = NULL;
+	ret->slot_count = 0;
 	ret->entry_count = 0;
 	ret->buckets = malloc(ret->bucket_count * sizeof(hashmap_entry_t *));
 
@@ -93,6 +403,11 @@ hashmap_destroy(hashmap_t *hashmap)
 	uint32_t bucket;
 	hashmap_entry_t *entry;
 
+	if (hashmap->slots != NULL) {
+		open_destroy(hashmap);
+		return;
+	}
+
 	for (bucket = 0; bucket < hashmap->bucket_count; bucket++) {
 		for (entry = hashmap->buckets[bucket];
 		     entry != NULL;) {
@@ -113,7 +428,14 @@ void *
 hashmap_lookup(hashmap_t *hashmap, void *key)
 {
 	uint32_t hash = hashmap->params->key_hash(key);
-	hashmap_entry_t *entry = hashmap->buckets[hash % hashmap->bucket_count];
+	hashmap_entry_t *entry;
+
+	if (hashmap->slots != NULL) {
+		hashmap_slot_t *slot = open_find(hashmap, key, hash);
+		return (slot != NULL) ? slot->value : NULL;
+	}
+
+	entry = hashmap->buckets[hash % hashmap->bucket_count];
 
 	for(;entry != NULL; entry = entry->next) {
 		if (entry->key_hash == hash) {
@@ -130,11 +452,19 @@ hashmap_lookup(hashmap_t *hashmap, void *key)
 void *
 hashmap_insert(hashmap_t *hashmap, void *key)
 {
-	uint32_t hash = hashmap->params->key_hash(key);
-	uint32_t bucket = hash % hashmap->bucket_count;
-	hashmap_entry_t *entry = hashmap->buckets[bucket];
+	uint32_t hash;
+	uint32_t bucket;
+	hashmap_entry_t *entry;
 	void *new_key, *new_value;
 
+	if (hashmap->slots != NULL) {
+		return open_insert(hashmap, key);
+	}
+
+	hash = hashmap->params->key_hash(key);
+	bucket = hash % hashmap->bucket_count;
+	entry = hashmap->buckets[bucket];
+
 	for(;entry != NULL; entry = entry->next) {
 		if (entry->key_hash == hash) {
 			if (hashmap->params->key_eq(key, entry->key)) {
@@ -205,9 +535,15 @@ err:
 bool
 hashmap_remove(hashmap_t *hashmap, void *key)
 {
-	uint32_t hash = hashmap->params->key_hash(key);
-	
-	hashmap_entry_t *entry = hashmap->buckets[hash % hashmap->bucket_count];
+	uint32_t hash;
+	hashmap_entry_t *entry;
+
+	if (hashmap->slots != NULL) {
+		return open_remove(hashmap, key);
+	}
+
+	hash = hashmap->params->key_hash(key);
+	entry = hashmap->buckets[hash % hashmap->bucket_count];
 
 	for(;entry != NULL; entry = entry->next) {
 		if (entry->key_hash == hash) {
@@ -232,6 +568,10 @@ hashmap_remove(hashmap_t *hashmap, void *key)
 bool
 hashmap_iterate(hashmap_t *hashmap, hashmap_iteration_cb_t cb, void *ctx)
 {
+	if (hashmap->slots != NULL) {
+		return open_iterate(hashmap, cb, ctx);
+	}
+
 	for (uint32_t bucket = 0;
 	     bucket < hashmap->bucket_count;
 	     bucket++) {
@@ -19,6 +19,7 @@
 #ifndef NETSURF_HASHMAP_H
 #define NETSURF_HASHMAP_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -121,6 +122,21 @@ typedef struct {
  */
 hashmap_t* hashmap_create(hashmap_parameters_t *params);
 
+/**
+ * Create an open addressing hashmap
+ *
+ * The map keeps its entries in a single table, using robin hood
+ * hashing, rather than in separately allocated bucket chains. The table
+ * is grown as entries are added so the map suits large numbers of
+ * entries. Other than creation the map is used exactly as one made by
+ * hashmap_create().
+ *
+ * \param params The hashmap parameters for this map
+ * \param capacity The number of entries to allocate space for initially,
+ *                 or zero for a small default.
+ */
+hashmap_t* hashmap_create_open(hashmap_parameters_t *params, size_t capacity);
+
 /**
  * Destroy a hashmap
  *
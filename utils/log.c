@@ -26,6 +26,10 @@
 #include "desktop/version.h"
 
 #include "utils/log.h"
+#include "utils/log_ring.h"
+
+/** Number of records in the binary log ring */
+#define NSLOG_RING_RECORDS 16384
 
 /** flag to enable verbose logging */
 bool verbose_log = false;
@@ -33,6 +37,9 @@ bool verbose_log = false;
 /** The stream to which logging is sent */
 static FILE *logfile;
 
+/** File the binary log ring is written to, or NULL if not in use */
+static const char *ring_filename;
+
 /** Subtract the `struct timeval' values X and Y
  *
  * \param result The timeval structure to store the result in
@@ -127,6 +134,64 @@ netsurf_render_log(void *_ctx,
 	fputc('\n', logfile);
 }
 
+/**
+ * Record a log message in the binary log ring.
+ *
+ * The entry context is static data for the call site so its address
+ * is used to identify the call site.
+ */
+static void
+netsurf_ring_log(void *_ctx,
+		 nslog_entry_context_t *ctx,
+		 const char *fmt,
+		 va_list args)
+{
+	nslog_ring_record(ctx, fmt, args);
+}
+
+/**
+ * Describe a call site recorded in the binary log ring.
+ */
+static void
+netsurf_ring_describe(const void *site, struct nslog_ring_site *desc)
+{
+	const nslog_entry_context_t *ctx = site;
+
+	desc->level = nslog_short_level_name(ctx->level);
+	desc->category = ctx->category->name;
+	desc->category_len = ctx->category->namelen;
+	desc->file = ctx->filename;
+	desc->file_len = ctx->filenamelen;
+	desc->func = ctx->funcname;
+	desc->func_len = ctx->funcnamelen;
+	desc->line = ctx->lineno;
+}
+
+/**
+ * Write the binary log ring to its file and stop using it.
+ */
+static void netsurf_ring_finalise(void)
+{
+	const char *filename = ring_filename;
+	FILE *fp;
+	nserror res = NSERROR_SAVE_FAILED;
+
+	fp = fopen(filename, "wb");
+	if (fp != NULL) {
+		res = nslog_ring_write(fp, netsurf_ring_describe);
+		fclose(fp);
+	}
+
+	nslog_set_render_callback(netsurf_render_log, NULL);
+	nslog_ring_fini();
+	ring_filename = NULL;
+
+	if (res != NSERROR_OK) {
+		NSLOG(netsurf, ERROR, "Unable to write log ring to %s",
+		      filename);
+	}
+}
+
 /* exported interface documented in utils/log.h */
 nserror
 nslog_set_filter(const char *filter)
@@ -233,6 +298,37 @@ nserror nslog_init(nslog_ensure_t *ensure, int *pargc, char **argv)
 			/* ensure we actually show logging */
 			verbose_log = true;
 		}
+	} else if (((*pargc) > 2) &&
+		   (argv[1][0] == '-') &&
+		   (argv[1][1] == 'B') &&
+		   (argv[1][2] == 0)) {
+		int argcmv;
+
+		/* verbose logging recorded to binary ring, written to
+		 * file when logging is finalised
+		 */
+		logfile = stderr;
+		ring_filename = argv[2];
+
+		/* remove -B and filename from argv list */
+		for (argcmv = 3; argcmv < (*pargc); argcmv++) {
+			argv[argcmv - 2] = argv[argcmv];
+		}
+		(*pargc) -= 2;
+
+#ifdef WITH_NSLOG
+		ret = nslog_ring_init(NSLOG_RING_RECORDS);
+#else
+		/* the binary ring needs call site details from nslog */
+		ret = NSERROR_NOT_IMPLEMENTED;
+#endif
+		if (ret != NSERROR_OK) {
+			ring_filename = NULL;
+			verbose_log = false;
+		} else {
+			/* ensure we actually record logging */
+			verbose_log = true;
+		}
 	} else {
 		/* default is logging to stderr */
 		logfile = stderr;
@@ -254,7 +350,10 @@ nserror nslog_init(nslog_ensure_t *ensure, int *pargc, char **argv)
 			     NETSURF_BUILTIN_LOG_FILTER) != NSERROR_OK) {
 		ret = NSERROR_INIT_FAILED;
 		verbose_log = false;
-	} else if (nslog_set_render_callback(netsurf_render_log, NULL) != NSLOG_NO_ERROR) {
+	} else if (nslog_set_render_callback(
+			   (ring_filename != NULL) ?
+			   netsurf_ring_log : netsurf_render_log,
+			   NULL) != NSLOG_NO_ERROR) {
 		ret = NSERROR_INIT_FAILED;
 		verbose_log = false;
 	} else if (nslog_uncork() != NSLOG_NO_ERROR) {
@@ -306,6 +405,9 @@ nslog_finalise(void)
 		logfile = stderr;
 	}
 #ifdef WITH_NSLOG
+	if (ring_filename != NULL) {
+		netsurf_ring_finalise();
+	}
 	nslog_cleanup();
 #endif
 }
@@ -0,0 +1,996 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Binary log ring implementation.
+ *
+ * Records are claimed by atomically incrementing the ring head, so
+ * recording never takes a lock.  The head and sequence numbers are
+ * native word sized so they can be updated atomically on every target
+ * without library support; once the head wraps, which on 32 bit targets
+ * takes four billion records, only the records since are written out.
+ * A record's sequence number is cleared while it is being filled and
+ * set to its ring position plus one once complete, which lets the
+ * writer skip records that are incomplete or were overwritten while
+ * being copied.
+ *
+ * The written form is little endian throughout:
+ *
+ *     header:  u32 magic, u32 version, u64 start time, u32 site count,
+ *              u32 record count
+ *     site:    string level, string category, string file,
+ *              string function, u32 line, string format
+ *     record:  u32 site index, u64 time, u32 length, argument data
+ *
+ * where a string is a u32 length followed by that many bytes, and times
+ * are in microseconds.  Argument data is a tag byte per argument the
+ * format consumes; integers, doubles and pointers are followed by eight
+ * bytes, strings by a u16 length and the string bytes.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/sys_time.h"
+#include "utils/log_ring.h"
+
+/** Magic number at the start of a written ring, "NSLR" */
+#define RING_MAGIC 0x524c534e
+
+/** Version of the written ring format */
+#define RING_VERSION 1
+
+/** Longest flags or width of a conversion that is decoded */
+#define RING_SPEC_MAX 16
+
+/** Bytes of argument data held in each record */
+#define RING_PAYLOAD 232
+
+/** Argument tags */
+#define RING_ARG_INT 'i'
+#define RING_ARG_DOUBLE 'f'
+#define RING_ARG_POINTER 'p'
+#define RING_ARG_STRING 's'
+#define RING_ARG_NULL 'n'
+
+/** Length modifier of a conversion */
+enum ring_length {
+	RING_LEN_NONE,
+	RING_LEN_CHAR,
+	RING_LEN_SHORT,
+	RING_LEN_LONG,
+	RING_LEN_LLONG,
+	RING_LEN_INTMAX,
+	RING_LEN_SIZE,
+	RING_LEN_PTRDIFF,
+	RING_LEN_LDOUBLE,
+};
+
+/** A parsed format conversion */
+struct ring_spec {
+	const char *flags;	/**< Flag characters */
+	size_t flags_len;	/**< Number of flag characters */
+	const char *width;	/**< Width digits, or "*" */
+	size_t width_len;	/**< Length of width */
+	const char *prec;	/**< Precision digits or "*", NULL if none */
+	size_t prec_len;	/**< Length of precision */
+	enum ring_length length; /**< Length modifier */
+	char conv;		/**< Conversion character */
+	size_t len;		/**< Length of conversion after the '%' */
+};
+
+/** A log record */
+struct ring_record {
+	unsigned long seq;	/**< Ring position plus one, 0 if incomplete */
+	uint64_t time;		/**< Time logged, in microseconds */
+	const void *site;	/**< Call site */
+	const char *fmt;	/**< Format string */
+	uint16_t len;		/**< Bytes of argument data */
+	uint8_t payload[RING_PAYLOAD]; /**< Argument data */
+};
+
+/** Argument data being built for a record */
+struct ring_writer {
+	uint8_t *buf;	/**< Argument data */
+	size_t len;	/**< Bytes used */
+	bool full;	/**< No further arguments can be stored */
+};
+
+/** The log ring */
+static struct {
+	struct ring_record *record; /**< Records, or NULL if no ring */
+	unsigned long mask;	/**< Number of records minus one */
+	unsigned long head;	/**< Ring position of next record */
+	uint64_t start;		/**< Time ring was created */
+} ring;
+
+
+/**
+ * Get the time in microseconds.
+ */
+static uint64_t ring_time(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+/**
+ * Parse a format conversion.
+ *
+ * \param s Format string following a '%'.
+ * \param spec Updated with the parsed conversion.  A conv of 0 indicates
+ *             the format ended.
+ */
+static void ring_parse_spec(const char *s, struct ring_spec *spec)
+{
+	const char *p = s;
+
+	spec->flags = p;
+	while (*p != 0 && strchr("-+ #0'", *p) != NULL) {
+		p++;
+	}
+	spec->flags_len = p - spec->flags;
+
+	spec->width = p;
+	if (*p == '*') {
+		p++;
+	} else {
+		while (*p >= '0' && *p <= '9') {
+			p++;
+		}
+	}
+	spec->width_len = p - spec->width;
+
+	spec->prec = NULL;
+	spec->prec_len = 0;
+	if (*p == '.') {
+		p++;
+		spec->prec = p;
+		if (*p == '*') {
+			p++;
+		} else {
+			while (*p >= '0' && *p <= '9') {
+				p++;
+			}
+		}
+		spec->prec_len = p - spec->prec;
+	}
+
+	spec->length = RING_LEN_NONE;
+	switch (*p) {
+	case 'h':
+		p++;
+		spec->length = RING_LEN_SHORT;
+		if (*p == 'h') {
+			p++;
+			spec->length = RING_LEN_CHAR;
+		}
+		break;
+
+	case 'l':
+		p++;
+		spec->length = RING_LEN_LONG;
+		if (*p == 'l') {
+			p++;
+			spec->length = RING_LEN_LLONG;
+		}
+		break;
+
+	case 'q':
+		p++;
+		spec->length = RING_LEN_LLONG;
+		break;
+
+	case 'j':
+		p++;
+		spec->length = RING_LEN_INTMAX;
+		break;
+
+	case 'z':
+		p++;
+		spec->length = RING_LEN_SIZE;
+		break;
+
+	case 't':
+		p++;
+		spec->length = RING_LEN_PTRDIFF;
+		break;
+
+	case 'L':
+		p++;
+		spec->length = RING_LEN_LDOUBLE;
+		break;
+	}
+
+	spec->conv = *p;
+	if (*p != 0) {
+		p++;
+	}
+	spec->len = p - s;
+}
+
+
+/**
+ * Parse the value of a numeric width or precision.
+ */
+static int ring_spec_number(const char *s, size_t len)
+{
+	int value = 0;
+
+	while (len-- > 0) {
+		value = value * 10 + (*s++ - '0');
+	}
+
+	return value;
+}
+
+
+/**
+ * Fetch a signed integer argument.
+ */
+static int64_t ring_arg_signed(va_list *ap, enum ring_length length)
+{
+	switch (length) {
+	case RING_LEN_CHAR:
+		return (signed char)va_arg(*ap, int);
+	case RING_LEN_SHORT:
+		return (short)va_arg(*ap, int);
+	case RING_LEN_LONG:
+		return va_arg(*ap, long);
+	case RING_LEN_LLONG:
+		return va_arg(*ap, long long);
+	case RING_LEN_INTMAX:
+		return va_arg(*ap, intmax_t);
+	case RING_LEN_SIZE:
+		return (ptrdiff_t)va_arg(*ap, size_t);
+	case RING_LEN_PTRDIFF:
+		return va_arg(*ap, ptrdiff_t);
+	default:
+		return va_arg(*ap, int);
+	}
+}
+
+
+/**
+ * Fetch an unsigned integer argument.
+ */
+static uint64_t ring_arg_unsigned(va_list *ap, enum ring_length length)
+{
+	switch (length) {
+	case RING_LEN_CHAR:
+		return (unsigned char)va_arg(*ap, unsigned int);
+	case RING_LEN_SHORT:
+		return (unsigned short)va_arg(*ap, unsigned int);
+	case RING_LEN_LONG:
+		return va_arg(*ap, unsigned long);
+	case RING_LEN_LLONG:
+		return va_arg(*ap, unsigned long long);
+	case RING_LEN_INTMAX:
+		return va_arg(*ap, uintmax_t);
+	case RING_LEN_SIZE:
+		return va_arg(*ap, size_t);
+	case RING_LEN_PTRDIFF:
+		return (size_t)va_arg(*ap, ptrdiff_t);
+	default:
+		return va_arg(*ap, unsigned int);
+	}
+}
+
+
+/**
+ * Store a tagged eight byte value.
+ */
+static void ring_put_value(struct ring_writer *w, uint8_t tag, uint64_t v)
+{
+	int i;
+
+	if (w->full || RING_PAYLOAD - w->len < 9) {
+		w->full = true;
+		return;
+	}
+
+	w->buf[w->len++] = tag;
+	for (i = 0; i < 8; i++) {
+		w->buf[w->len++] = v >> (i * 8);
+	}
+}
+
+
+/**
+ * Store a string, truncated to fit the record if necessary.
+ *
+ * \param w Argument data being built.
+ * \param s String to store.
+ * \param prec Maximum length of string, or negative for no maximum.
+ */
+static void ring_put_string(struct ring_writer *w, const char *s, int prec)
+{
+	size_t avail;
+	size_t len = 0;
+
+	if (w->full || RING_PAYLOAD - w->len < 1) {
+		w->full = true;
+		return;
+	}
+
+	if (s == NULL) {
+		w->buf[w->len++] = RING_ARG_NULL;
+		return;
+	}
+
+	if (RING_PAYLOAD - w->len < 3) {
+		w->full = true;
+		return;
+	}
+	avail = RING_PAYLOAD - w->len - 3;
+
+	while (len < avail && (prec < 0 || len < (size_t)prec) &&
+	       s[len] != 0) {
+		len++;
+	}
+
+	w->buf[w->len++] = RING_ARG_STRING;
+	w->buf[w->len++] = len & 0xff;
+	w->buf[w->len++] = len >> 8;
+	memcpy(w->buf + w->len, s, len);
+	w->len += len;
+}
+
+
+/* exported interface documented in utils/log_ring.h */
+nserror nslog_ring_init(unsigned int records)
+{
+	unsigned long size = 1;
+
+	while (size < records) {
+		size <<= 1;
+	}
+
+	nslog_ring_fini();
+
+	ring.record = calloc(size, sizeof(struct ring_record));
+	if (ring.record == NULL) {
+		return NSERROR_NOMEM;
+	}
+	ring.mask = size - 1;
+	ring.head = 0;
+	ring.start = ring_time();
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in utils/log_ring.h */
+void nslog_ring_fini(void)
+{
+	free(ring.record);
+	ring.record = NULL;
+}
+
+
+/* exported interface documented in utils/log_ring.h */
+void nslog_ring_record(const void *site, const char *fmt, va_list args)
+{
+	struct ring_record *rec;
+	struct ring_writer w;
+	struct ring_spec spec;
+	const char *p;
+	unsigned long pos;
+	va_list ap;
+
+	if (ring.record == NULL) {
+		return;
+	}
+
+	pos = __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+	rec = &ring.record[pos & ring.mask];
+
+	/* Mark record incomplete while it is filled */
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	rec->time = ring_time();
+	rec->site = site;
+	rec->fmt = fmt;
+
+	w.buf = rec->payload;
+	w.len = 0;
+	w.full = false;
+
+	va_copy(ap, args);
+	for (p = strchr(fmt, '%'); p != NULL && !w.full; p = strchr(p, '%')) {
+		int prec = -1;
+		double d;
+		uint64_t v;
+
+		ring_parse_spec(p + 1, &spec);
+		p += 1 + spec.len;
+
+		if (spec.conv == '%') {
+			continue;
+		}
+
+		if (spec.width_len == 1 && spec.width[0] == '*') {
+			ring_put_value(&w, RING_ARG_INT, va_arg(ap, int));
+		}
+		if (spec.prec != NULL) {
+			if (spec.prec_len == 1 && spec.prec[0] == '*') {
+				prec = va_arg(ap, int);
+				ring_put_value(&w, RING_ARG_INT, prec);
+			} else {
+				prec = ring_spec_number(spec.prec,
+						spec.prec_len);
+			}
+		}
+
+		switch (spec.conv) {
+		case 'd':
+		case 'i':
+			ring_put_value(&w, RING_ARG_INT,
+				       ring_arg_signed(&ap, spec.length));
+			break;
+
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			ring_put_value(&w, RING_ARG_INT,
+				       ring_arg_unsigned(&ap, spec.length));
+			break;
+
+		case 'c':
+			ring_put_value(&w, RING_ARG_INT, va_arg(ap, int));
+			break;
+
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (spec.length == RING_LEN_LDOUBLE) {
+				d = va_arg(ap, long double);
+			} else {
+				d = va_arg(ap, double);
+			}
+			memcpy(&v, &d, sizeof(v));
+			ring_put_value(&w, RING_ARG_DOUBLE, v);
+			break;
+
+		case 's':
+			ring_put_string(&w, va_arg(ap, const char *), prec);
+			break;
+
+		case 'p':
+			ring_put_value(&w, RING_ARG_POINTER,
+				       (uintptr_t)va_arg(ap, void *));
+			break;
+
+		case 'n':
+			(void)va_arg(ap, void *);
+			break;
+
+		default:
+			/* Unknown conversion, so the arguments can't be
+			 * followed any further */
+			w.full = true;
+			break;
+		}
+	}
+	va_end(ap);
+
+	rec->len = w.len;
+
+	__atomic_store_n(&rec->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * Write a little endian u32.
+ */
+static bool ring_write_u32(FILE *fp, uint32_t v)
+{
+	uint8_t b[4] = { v, v >> 8, v >> 16, v >> 24 };
+
+	return fwrite(b, sizeof(b), 1, fp) == 1;
+}
+
+
+/**
+ * Write a little endian u64.
+ */
+static bool ring_write_u64(FILE *fp, uint64_t v)
+{
+	return ring_write_u32(fp, v) && ring_write_u32(fp, v >> 32);
+}
+
+
+/**
+ * Write a length prefixed string.
+ */
+static bool ring_write_str(FILE *fp, const char *s, size_t len)
+{
+	if (s == NULL) {
+		len = 0;
+	}
+
+	return ring_write_u32(fp, len) &&
+		(len == 0 || fwrite(s, len, 1, fp) == 1);
+}
+
+
+/* exported interface documented in utils/log_ring.h */
+nserror nslog_ring_write(FILE *fp, nslog_ring_describe_t *describe)
+{
+	struct ring_record *snap;
+	uint32_t *site_idx;
+	uint32_t *table;
+	struct ring_record **sites;
+	uint32_t table_size = 16;
+	uint32_t n_sites = 0;
+	uint32_t count = 0;
+	unsigned long head;
+	unsigned long pos;
+	uint32_t i;
+	bool ok;
+
+	if (ring.record == NULL) {
+		return NSERROR_INIT_FAILED;
+	}
+
+	/* Copy the complete records, oldest first */
+	head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+	pos = (head > ring.mask) ? head - ring.mask - 1 : 0;
+
+	snap = malloc((head - pos + 1) * sizeof(*snap));
+	if (snap == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	for (; pos < head; pos++) {
+		struct ring_record *rec = &ring.record[pos & ring.mask];
+
+		if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+			continue;
+		}
+		snap[count] = *rec;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&rec->seq, __ATOMIC_RELAXED) != pos + 1) {
+			/* Overwritten while being copied */
+			continue;
+		}
+		count++;
+	}
+
+	/* Find the distinct call site and format pairs */
+	while (table_size < count * 2) {
+		table_size *= 2;
+	}
+	site_idx = malloc((count + 1) * sizeof(*site_idx));
+	sites = malloc((count + 1) * sizeof(*sites));
+	table = calloc(table_size, sizeof(*table));
+	if (site_idx == NULL || sites == NULL || table == NULL) {
+		free(table);
+		free(sites);
+		free(site_idx);
+		free(snap);
+		return NSERROR_NOMEM;
+	}
+
+	for (i = 0; i < count; i++) {
+		uint32_t h = ((uintptr_t)snap[i].site ^
+			      ((uintptr_t)snap[i].fmt >> 4)) * 2654435761u;
+
+		h = (h ^ (h >> 15)) & (table_size - 1);
+		while (table[h] != 0 &&
+		       (sites[table[h] - 1]->site != snap[i].site ||
+			sites[table[h] - 1]->fmt != snap[i].fmt)) {
+			h = (h + 1) & (table_size - 1);
+		}
+		if (table[h] == 0) {
+			sites[n_sites++] = &snap[i];
+			table[h] = n_sites;
+		}
+		site_idx[i] = table[h] - 1;
+	}
+
+	ok = ring_write_u32(fp, RING_MAGIC) &&
+		ring_write_u32(fp, RING_VERSION) &&
+		ring_write_u64(fp, ring.start) &&
+		ring_write_u32(fp, n_sites) &&
+		ring_write_u32(fp, count);
+
+	for (i = 0; ok && i < n_sites; i++) {
+		struct nslog_ring_site desc;
+
+		memset(&desc, 0, sizeof(desc));
+		describe(sites[i]->site, &desc);
+
+		ok = ring_write_str(fp, desc.level,
+				    desc.level ? strlen(desc.level) : 0) &&
+			ring_write_str(fp, desc.category, desc.category_len) &&
+			ring_write_str(fp, desc.file, desc.file_len) &&
+			ring_write_str(fp, desc.func, desc.func_len) &&
+			ring_write_u32(fp, desc.line) &&
+			ring_write_str(fp, sites[i]->fmt,
+				       strlen(sites[i]->fmt));
+	}
+
+	for (i = 0; ok && i < count; i++) {
+		ok = ring_write_u32(fp, site_idx[i]) &&
+			ring_write_u64(fp, snap[i].time) &&
+			ring_write_u32(fp, snap[i].len) &&
+			(snap[i].len == 0 ||
+			 fwrite(snap[i].payload, snap[i].len, 1, fp) == 1);
+	}
+
+	free(table);
+	free(sites);
+	free(site_idx);
+	free(snap);
+
+	return ok ? NSERROR_OK : NSERROR_SAVE_FAILED;
+}
+
+
+/** A call site read back from a written ring */
+struct ring_decode_site {
+	char *level;
+	char *category;
+	char *file;
+	char *func;
+	uint32_t line;
+	char *fmt;
+};
+
+
+/**
+ * Read a little endian u32.
+ */
+static uint32_t ring_read_u32(FILE *fp, bool *ok)
+{
+	uint8_t b[4];
+
+	if (*ok == false || fread(b, sizeof(b), 1, fp) != 1) {
+		*ok = false;
+		return 0;
+	}
+
+	return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+
+/**
+ * Read a little endian u64.
+ */
+static uint64_t ring_read_u64(FILE *fp, bool *ok)
+{
+	uint64_t lo = ring_read_u32(fp, ok);
+
+	return lo | ((uint64_t)ring_read_u32(fp, ok) << 32);
+}
+
+
+/**
+ * Read a length prefixed string into a new NULL terminated buffer.
+ */
+static char *ring_read_str(FILE *fp, bool *ok)
+{
+	uint32_t len = ring_read_u32(fp, ok);
+	char *s;
+
+	if (*ok == false || len > 65536) {
+		*ok = false;
+		return NULL;
+	}
+
+	s = malloc(len + 1);
+	if (s == NULL || (len > 0 && fread(s, len, 1, fp) != 1)) {
+		free(s);
+		*ok = false;
+		return NULL;
+	}
+	s[len] = 0;
+
+	return s;
+}
+
+
+/**
+ * Fetch a tagged eight byte value from argument data.
+ */
+static bool ring_get_value(const uint8_t *buf, size_t len, size_t *off,
+			   uint8_t tag, uint64_t *v)
+{
+	int i;
+
+	if (*off + 9 > len || buf[*off] != tag) {
+		return false;
+	}
+
+	*v = 0;
+	for (i = 0; i < 8; i++) {
+		*v |= (uint64_t)buf[*off + 1 + i] << (i * 8);
+	}
+	*off += 9;
+
+	return true;
+}
+
+
+/**
+ * Output one conversion using its recorded argument.
+ *
+ * The conversion is rebuilt with any '*' width or precision replaced
+ * by its recorded value and the length modifier replaced with one
+ * matching the recorded value.
+ *
+ * \return true on success, false if the argument data is exhausted or
+ *         the conversion is too long to rebuild.
+ */
+static bool ring_decode_arg(FILE *out, const struct ring_spec *spec,
+			    const uint8_t *buf, size_t len, size_t *off)
+{
+	char f[64];
+	int n;
+	int prec = -1;
+	uint64_t v;
+	double d;
+
+	/* the rebuilt conversion must fit in f */
+	if (spec->flags_len > RING_SPEC_MAX || spec->width_len > RING_SPEC_MAX) {
+		return false;
+	}
+
+	n = snprintf(f, sizeof(f), "%%%.*s",
+		     (int)spec->flags_len, spec->flags);
+
+	if (spec->width_len == 1 && spec->width[0] == '*') {
+		if (!ring_get_value(buf, len, off, RING_ARG_INT, &v)) {
+			return false;
+		}
+		n += snprintf(f + n, sizeof(f) - n, "%d", (int)v);
+	} else {
+		n += snprintf(f + n, sizeof(f) - n, "%.*s",
+			      (int)spec->width_len, spec->width);
+	}
+
+	if (spec->prec != NULL) {
+		if (spec->prec_len == 1 && spec->prec[0] == '*') {
+			if (!ring_get_value(buf, len, off, RING_ARG_INT, &v)) {
+				return false;
+			}
+			prec = (int)v;
+		} else {
+			prec = ring_spec_number(spec->prec, spec->prec_len);
+		}
+	}
+
+	if (spec->conv == 's') {
+		size_t slen;
+
+		if (*off < len && buf[*off] == RING_ARG_NULL) {
+			(*off)++;
+			snprintf(f + n, sizeof(f) - n, "s");
+			fprintf(out, f, "(null)");
+			return true;
+		}
+		if (*off + 3 > len || buf[*off] != RING_ARG_STRING) {
+			return false;
+		}
+		slen = buf[*off + 1] | (buf[*off + 2] << 8);
+		if (*off + 3 + slen > len) {
+			return false;
+		}
+
+		/* Any precision was applied when the string was stored */
+		snprintf(f + n, sizeof(f) - n, ".*s");
+		fprintf(out, f, (int)slen, buf + *off + 3);
+		*off += 3 + slen;
+		return true;
+	}
+
+	if (prec >= 0) {
+		n += snprintf(f + n, sizeof(f) - n, ".%d", prec);
+	}
+	if (n >= (int)sizeof(f) - 4) {
+		return false;
+	}
+
+	switch (spec->conv) {
+	case 'd':
+	case 'i':
+		if (!ring_get_value(buf, len, off, RING_ARG_INT, &v)) {
+			return false;
+		}
+		snprintf(f + n, sizeof(f) - n, "ll%c", spec->conv);
+		fprintf(out, f, (long long)(int64_t)v);
+		break;
+
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		if (!ring_get_value(buf, len, off, RING_ARG_INT, &v)) {
+			return false;
+		}
+		snprintf(f + n, sizeof(f) - n, "ll%c", spec->conv);
+		fprintf(out, f, (unsigned long long)v);
+		break;
+
+	case 'c':
+		if (!ring_get_value(buf, len, off, RING_ARG_INT, &v)) {
+			return false;
+		}
+		snprintf(f + n, sizeof(f) - n, "c");
+		fprintf(out, f, (int)v);
+		break;
+
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		if (!ring_get_value(buf, len, off, RING_ARG_DOUBLE, &v)) {
+			return false;
+		}
+		memcpy(&d, &v, sizeof(d));
+		snprintf(f + n, sizeof(f) - n, "%c", spec->conv);
+		fprintf(out, f, d);
+		break;
+
+	case 'p':
+		if (!ring_get_value(buf, len, off, RING_ARG_POINTER, &v)) {
+			return false;
+		}
+		snprintf(f + n, sizeof(f) - n, "p");
+		fprintf(out, f, (void *)(uintptr_t)v);
+		break;
+
+	case 'n':
+		break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Output a recorded log message.
+ */
+static void ring_decode_message(FILE *out, const char *fmt,
+				const uint8_t *buf, size_t len)
+{
+	struct ring_spec spec;
+	const char *p = fmt;
+	const char *pc;
+	size_t off = 0;
+
+	while ((pc = strchr(p, '%')) != NULL) {
+		fwrite(p, 1, pc - p, out);
+
+		ring_parse_spec(pc + 1, &spec);
+		p = pc + 1 + spec.len;
+
+		if (spec.conv == '%') {
+			fputc('%', out);
+		} else if (!ring_decode_arg(out, &spec, buf, len, &off)) {
+			/* Record ran out of space for arguments */
+			fputs("...", out);
+			return;
+		}
+	}
+
+	fputs(p, out);
+}
+
+
+/* exported interface documented in utils/log_ring.h */
+nserror nslog_ring_decode(FILE *in, FILE *out)
+{
+	struct ring_decode_site *sites = NULL;
+	uint8_t payload[RING_PAYLOAD];
+	uint32_t n_sites = 0;
+	uint32_t count;
+	uint64_t start;
+	nserror res = NSERROR_OK;
+	bool ok = true;
+	uint32_t i;
+
+	if (ring_read_u32(in, &ok) != RING_MAGIC ||
+	    ring_read_u32(in, &ok) != RING_VERSION) {
+		return NSERROR_INVALID;
+	}
+	start = ring_read_u64(in, &ok);
+	n_sites = ring_read_u32(in, &ok);
+	count = ring_read_u32(in, &ok);
+	if (ok == false || n_sites > count) {
+		return NSERROR_INVALID;
+	}
+
+	sites = calloc((size_t)n_sites + 1, sizeof(*sites));
+	if (sites == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	for (i = 0; ok && i < n_sites; i++) {
+		sites[i].level = ring_read_str(in, &ok);
+		sites[i].category = ring_read_str(in, &ok);
+		sites[i].file = ring_read_str(in, &ok);
+		sites[i].func = ring_read_str(in, &ok);
+		sites[i].line = ring_read_u32(in, &ok);
+		sites[i].fmt = ring_read_str(in, &ok);
+	}
+
+	for (i = 0; ok && i < count; i++) {
+		struct ring_decode_site *site;
+		uint32_t idx = ring_read_u32(in, &ok);
+		uint64_t time = ring_read_u64(in, &ok);
+		uint32_t len = ring_read_u32(in, &ok);
+
+		if (ok == false || idx >= n_sites || len > RING_PAYLOAD ||
+		    (len > 0 && fread(payload, len, 1, in) != 1)) {
+			ok = false;
+			break;
+		}
+		site = &sites[idx];
+
+		time = (time > start) ? time - start : 0;
+		fprintf(out, "(%ld.%06ld) [%s %s] %s:%u %s: ",
+			(long)(time / 1000000),
+			(long)(time % 1000000),
+			site->level,
+			site->category,
+			site->file,
+			site->line,
+			site->func);
+		ring_decode_message(out, site->fmt, payload, len);
+		fputc('\n', out);
+	}
+
+	if (ok == false) {
+		res = NSERROR_INVALID;
+	}
+
+	for (i = 0; i < n_sites; i++) {
+		free(sites[i].level);
+		free(sites[i].category);
+		free(sites[i].file);
+		free(sites[i].func);
+		free(sites[i].fmt);
+	}
+	free(sites);
+
+	return res;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Binary log ring interface.
+ *
+ * Log messages are recorded unformatted into a preallocated ring of
+ * fixed size records.  Each record holds a timestamp, the call site, the
+ * format string and the arguments the format consumes.  No formatting is
+ * done when a message is logged.  When the ring is full the oldest
+ * records are overwritten.
+ *
+ * The ring is written out in a self describing binary form, which can be
+ * turned into the same text the normal logging produces with
+ * nslog_ring_decode(), either in the browser or with the nslog-decode
+ * tool.
+ */
+
+#ifndef NETSURF_UTILS_LOG_RING_H
+#define NETSURF_UTILS_LOG_RING_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "utils/errors.h"
+
+/**
+ * Description of a logging call site.
+ *
+ * Filled in when the ring is written, for each call site it references.
+ */
+struct nslog_ring_site {
+	const char *level;	/**< Short name of message level */
+	const char *category;	/**< Category name */
+	int category_len;	/**< Length of category name */
+	const char *file;	/**< Source file name */
+	int file_len;		/**< Length of source file name */
+	const char *func;	/**< Function name */
+	int func_len;		/**< Length of function name */
+	int line;		/**< Source line number */
+};
+
+/**
+ * Describe a call site.
+ *
+ * \param site The call site passed to nslog_ring_record().
+ * \param desc Description to fill in.
+ */
+typedef void (nslog_ring_describe_t)(const void *site,
+		struct nslog_ring_site *desc);
+
+/**
+ * Create the log ring.
+ *
+ * \param records Number of records in ring, rounded up to a power of two.
+ * \return NSERROR_OK on success else NSERROR_NOMEM.
+ */
+nserror nslog_ring_init(unsigned int records);
+
+/**
+ * Destroy the log ring, discarding any records.
+ */
+void nslog_ring_fini(void);
+
+/**
+ * Record a log message in the ring.
+ *
+ * Safe to call from several threads at once.  The site and format
+ * string must stay valid until the ring is written, which is the case
+ * for the static call site data and literal format strings used by the
+ * logging macros.  Strings consumed by the format are copied, and may be
+ * truncated to fit the record.
+ *
+ * \param site Call site identifier.
+ * \param fmt printf style format string.
+ * \param args Arguments consumed by the format.
+ */
+void nslog_ring_record(const void *site, const char *fmt, va_list args);
+
+/**
+ * Write the ring's records, oldest first.
+ *
+ * \param fp File to write to.
+ * \param describe Function to describe each referenced call site.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror nslog_ring_write(FILE *fp, nslog_ring_describe_t *describe);
+
+/**
+ * Decode a written ring into text log lines.
+ *
+ * \param in File holding output of nslog_ring_write().
+ * \param out File to write log text to.
+ * \return NSERROR_OK on success, NSERROR_INVALID if in is not a valid log
+ *         ring, or NSERROR_NOMEM on memory exhaustion.
+ */
+nserror nslog_ring_decode(FILE *in, FILE *out);
+
+#endif
@@ -38,6 +38,7 @@
 #include "utils/messages.h"
 #include "utils/utils.h"
 #include "utils/hashtable.h"
+#include "utils/messages_table.h"
 
 /** Messages are stored in a fixed-size hash table. */
 #define HASH_SIZE 101
@@ -47,46 +48,40 @@
  */
 static struct hash_table *messages_hash = NULL;
 
+/**
+ * The compiled message table underlying the standard Messages hash
+ */
+static const struct messages_table *messages_table = NULL;
+
 
 /**
- * Create a message context
+ * English fallbacks for some formatted messages.
  *
- * generate a message context populated with english fallbacks for
- *   some formatted messages.
+ * These are used when no loaded messages provide the key.
+ */
+static const struct messages_table_entry messages_fallback[] = {
+	{ "LoginDescription",
+	  "The site %s is requesting your username and password. "
+	  "The realm is \"%s\""},
+	{ "PrivacyDescription",
+	  "A privacy error occurred while communicating with %s this "
+	  "may be a site configuration error or an attempt to steal "
+	  "private information (passwords, messages or credit cards)"},
+	{ "TimeoutDescription",
+	  "A connection to %s could not be established. The site may "
+	  "be temporarily unavailable or too busy to respond."},
+	{ "FetchErrorDescription",
+	  "An error occurred when connecting to %s"},
+	{ NULL, NULL}
+};
+
+
+/**
+ * Create a message context
  */
 static struct hash_table *messages_create_ctx(int hash_size)
 {
-	struct hash_table *nctx;
-	const struct {
-		const char *key;
-		const char *value;
-	} fallback[] = {
-		{ "LoginDescription",
-		  "The site %s is requesting your username and password. "
-		  "The realm is \"%s\""},
-		{ "PrivacyDescription",
-		  "A privacy error occurred while communicating with %s this "
-		  "may be a site configuration error or an attempt to steal "
-		  "private information (passwords, messages or credit cards)"},
-		{ "TimeoutDescription",
-		  "A connection to %s could not be established. The site may "
-		  "be temporarily unavailable or too busy to respond."},
-		{ "FetchErrorDescription",
-		  "An error occurred when connecting to %s"},
-		{ NULL, NULL}
-	};
-	nctx = hash_create(hash_size);
-
-	if (nctx != NULL) {
-		int floop;
-		for (floop = 0; fallback[floop].key != NULL; floop++) {
-			hash_add(nctx,
-				 fallback[floop].key,
-				 fallback[floop].value);
-		}
-	}
-
-	return nctx;
+	return hash_create(hash_size);
 }
 
 /**
@@ -144,27 +139,91 @@ static nserror messages_load_ctx(const char *path, struct hash_table **ctx)
 
 
 /**
- * Fast lookup of a message by key.
+ * Look up a message in a compiled message table.
+ *
+ * \param  table  compiled message table
+ * \param  key    key of message
+ * \return value of message, or NULL if not found
+ */
+static const char *
+messages_table_get(const struct messages_table *table, const char *key)
+{
+	const struct messages_table_entry *entry;
+	uint32_t hash;
+	uint32_t slot;
+
+	if (table->count == 0) {
+		return NULL;
+	}
+
+	hash = messages_table_hash(key);
+	slot = messages_table_slot(hash,
+				   table->seeds[hash % table->bucket_count],
+				   table->count);
+	entry = &table->entries[slot];
+
+	if (strcmp(entry->key, key) != 0) {
+		return NULL;
+	}
+
+	return entry->value;
+}
+
+
+/**
+ * Look up a message by key.
+ *
+ * Messages added to the hash take precedence over the compiled table
+ * which takes precedence over the fallbacks.
  *
  * \param  key  key of message
  * \param  ctx  context of messages file to look up in
- * \return value of message, or key if not found
+ * \return value of message, or NULL if not found
  */
 static const char *
-messages_get_ctx(const char *key, struct hash_table *ctx)
+messages_lookup(const char *key, struct hash_table *ctx)
 {
 	const char *r = NULL;
-
-	assert(key != NULL);
+	int floop;
 
 	/* allow attempts to retrieve messages before context is set up. */
 	if (ctx != NULL) {
 		r = hash_get(ctx, key);
 	}
 
-	/* If called with no context or unable to retrive a value
-	 * return the key.
-	 */
+	if ((r == NULL) && (messages_table != NULL)) {
+		r = messages_table_get(messages_table, key);
+	}
+
+	for (floop = 0;
+	     (r == NULL) && (messages_fallback[floop].key != NULL);
+	     floop++) {
+		if (strcmp(messages_fallback[floop].key, key) == 0) {
+			r = messages_fallback[floop].value;
+		}
+	}
+
+	return r;
+}
+
+
+/**
+ * Fast lookup of a message by key.
+ *
+ * \param  key  key of message
+ * \param  ctx  context of messages file to look up in
+ * \return value of message, or key if not found
+ */
+static const char *
+messages_get_ctx(const char *key, struct hash_table *ctx)
+{
+	const char *r;
+
+	assert(key != NULL);
+
+	r = messages_lookup(key, ctx);
+
+	/* If unable to retrive a value return the key. */
 	if (r == NULL) {
 		r = key;
 	}
@@ -216,6 +275,22 @@ nserror messages_add_key_value(const char *key, const char *value)
 }
 
 
+/* exported interface documented in messages.h */
+nserror messages_set_table(const struct messages_table *table)
+{
+	if (table == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	NSLOG(netsurf, INFO, "Using %u compiled messages for language %s",
+	      table->count, table->language);
+
+	messages_table = table;
+
+	return NSERROR_OK;
+}
+
+
 /* exported interface documented in messages.h */
 char *messages_get_buff(const char *key, ...)
 {
@@ -226,11 +301,7 @@ char *messages_get_buff(const char *key, ...)
 
 	assert(key != NULL);
 
-	if (messages_hash == NULL) {
-		return NULL;
-	}
-
-	msg_fmt = hash_get(messages_hash, key);
+	msg_fmt = messages_lookup(key, messages_hash);
 
 	if (msg_fmt == NULL) {
 		return NULL;
@@ -479,4 +550,5 @@ void messages_destroy(void)
 {
 	messages_destroy_ctx(messages_hash);
 	messages_hash = NULL;
+	messages_table = NULL;
 }
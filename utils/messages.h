@@ -39,6 +39,8 @@
 #include "utils/errors.h"
 #include "netsurf/ssl_certs.h"
 
+struct messages_table;
+
 /**
  * Read keys and values from messages file into the standard Messages hash.
  *
@@ -74,6 +76,20 @@ nserror messages_add_from_inline(const uint8_t *data, size_t data_size);
  */
 nserror messages_add_key_value(const char *key, const char *value);
 
+/**
+ * Use a compiled message table for the standard Messages.
+ *
+ * The table is constant data generated at build time (see
+ * utils/messages_table.h) so no parsing or allocation is required.
+ * Messages added with the other interfaces, before or after, take
+ * precedence over those in the table. A subsequent call replaces the
+ * table.
+ *
+ * \param table The compiled message table.
+ * \return NSERROR_OK on success or error code on faliure.
+ */
+nserror messages_set_table(const struct messages_table *table);
+
 /**
  * Fast lookup of a message by key from the standard Messages hash.
  *
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Compiled message tables.
+ *
+ * A message table holds the messages for one language as constant data
+ * generated at build time by the split-messages tool. The messages are
+ * placed with a minimal perfect hash so every key maps to its own slot.
+ *
+ * A key is hashed once. The bucket the hash selects holds a seed which
+ * is mixed with the hash to give the key's slot, so a lookup is a
+ * single probe and one string comparison.
+ *
+ * This header is shared by the generator and the messages module so
+ * both compute the same hash.
+ */
+
+#ifndef NETSURF_UTILS_MESSAGES_TABLE_H_
+#define NETSURF_UTILS_MESSAGES_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A message in a compiled table.
+ */
+struct messages_table_entry {
+	const char *key; /**< message key */
+	const char *value; /**< message text */
+};
+
+/**
+ * A compiled message table.
+ */
+struct messages_table {
+	/** The language the table was generated for */
+	const char *language;
+	/** The number of messages, which is also the number of slots */
+	uint32_t count;
+	/** The number of buckets */
+	uint32_t bucket_count;
+	/** The slot seed of each bucket */
+	const uint16_t *seeds;
+	/** The messages, in slot order */
+	const struct messages_table_entry *entries;
+};
+
+/**
+ * Hash a message key.
+ *
+ * \param key The key to hash.
+ * \return The hash of the key.
+ */
+static inline uint32_t messages_table_hash(const char *key)
+{
+	uint32_t z = 0x811c9dc5;
+
+	while (*key != 0) {
+		z ^= (uint8_t)*key++;
+		z *= 0x01000193;
+	}
+
+	return z;
+}
+
+/**
+ * Compute the slot of a key from its hash and its bucket's seed.
+ *
+ * \param hash The hash of the key.
+ * \param seed The seed of the key's bucket.
+ * \param count The number of slots in the table.
+ * \return The slot index.
+ */
+static inline uint32_t
+messages_table_slot(uint32_t hash, uint16_t seed, uint32_t count)
+{
+	uint32_t z = hash ^ ((uint32_t)seed * 0x9e3779b9);
+
+	z ^= z >> 16;
+	z *= 0x85ebca6b;
+	z ^= z >> 13;
+	z *= 0xc2b2ae35;
+	z ^= z >> 16;
+
+	return z % count;
+}
+
+#endif
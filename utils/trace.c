@@ -0,0 +1,308 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Performance trace span implementation.
+ *
+ * Spans are kept in a ring so a long running session keeps the most
+ * recent ones.
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "utils/sys_time.h"
+#include "utils/trace.h"
+
+/**
+ * Nesting spans shorter than this, in microseconds, are not recorded.
+ *
+ * This stops very frequent small spans from filling the ring with
+ * noise.  Where the total time of such spans matters, as for the style
+ * selection of each element, it is recorded with nstrace_total().
+ */
+#define NSTRACE_MIN_DURATION 20
+
+/** A recorded span or counter sample */
+struct nstrace_span {
+	const char *cat;	/**< Category */
+	const char *name;	/**< Name */
+	uint64_t start;		/**< Start time, in microseconds */
+	uint32_t duration;	/**< Duration, in microseconds, or value */
+	unsigned int id;	/**< Id of overlapping span, or 0 */
+	unsigned int track;	/**< Track span belongs to */
+	bool counter;		/**< Counter sample, not a span */
+};
+
+/* exported interface documented in utils/trace.h */
+bool nstrace_enabled = false;
+
+/* exported interface documented in utils/trace.h */
+unsigned int nstrace_track = 0;
+
+/** Trace state */
+static struct {
+	struct nstrace_span *span; /**< Span ring */
+	unsigned int size;	/**< Number of spans in ring */
+	uint64_t head;		/**< Number of spans ever recorded */
+	uint64_t origin;	/**< Time tracing started */
+	unsigned int tracks;	/**< Number of tracks allocated */
+} trace;
+
+
+/* exported interface documented in utils/trace.h */
+nserror nstrace_init(unsigned int events)
+{
+	nstrace_fini();
+
+	trace.span = calloc(events, sizeof(struct nstrace_span));
+	if (trace.span == NULL) {
+		return NSERROR_NOMEM;
+	}
+	trace.size = events;
+	trace.head = 0;
+	trace.origin = nstrace_time();
+
+	nstrace_enabled = true;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_fini(void)
+{
+	nstrace_enabled = false;
+
+	free(trace.span);
+	trace.span = NULL;
+	trace.size = 0;
+}
+
+
+/* exported interface documented in utils/trace.h */
+unsigned int nstrace_new_track(void)
+{
+	return ++trace.tracks;
+}
+
+
+/* exported interface documented in utils/trace.h */
+uint64_t nstrace_time(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec + 1;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_record(const char *cat, const char *name, uint64_t start,
+		unsigned int id, unsigned int track)
+{
+	struct nstrace_span *span;
+	uint64_t now;
+
+	if (trace.span == NULL) {
+		return;
+	}
+
+	now = nstrace_time();
+	if (now < start) {
+		now = start;
+	}
+	if (id == 0 && now - start < NSTRACE_MIN_DURATION) {
+		return;
+	}
+
+	span = &trace.span[trace.head++ % trace.size];
+	span->cat = cat;
+	span->name = name;
+	span->start = start;
+	span->duration = (now - start > UINT32_MAX) ?
+			UINT32_MAX : now - start;
+	span->id = id;
+	span->track = track;
+	span->counter = false;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_record_total(const char *cat, const char *name,
+		uint64_t duration, unsigned int track)
+{
+	struct nstrace_span *span;
+	uint64_t now;
+
+	if (trace.span == NULL) {
+		return;
+	}
+
+	now = nstrace_time();
+	if (duration > now) {
+		duration = now;
+	}
+
+	span = &trace.span[trace.head++ % trace.size];
+	span->cat = cat;
+	span->name = name;
+	span->start = now - duration;
+	span->duration = (duration > UINT32_MAX) ? UINT32_MAX : duration;
+	span->id = 0;
+	span->track = track;
+	span->counter = false;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_record_counter(const char *cat, const char *name,
+		uint32_t value, unsigned int track)
+{
+	struct nstrace_span *span;
+
+	if (trace.span == NULL) {
+		return;
+	}
+
+	span = &trace.span[trace.head++ % trace.size];
+	span->cat = cat;
+	span->name = name;
+	span->start = nstrace_time();
+	span->duration = value;
+	span->id = 0;
+	span->track = track;
+	span->counter = true;
+}
+
+
+/* exported interface documented in utils/trace.h */
+nserror nstrace_write(FILE *fp, unsigned int track, unsigned int *count)
+{
+	const char *sep = "";
+	bool *seen;
+	uint64_t pos;
+	unsigned int written = 0;
+	unsigned int t;
+
+	if (trace.span == NULL) {
+		return NSERROR_INIT_FAILED;
+	}
+
+	seen = calloc(trace.tracks + 1, sizeof(*seen));
+	if (seen == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+
+	pos = (trace.head > trace.size) ? trace.head - trace.size : 0;
+	for (; pos < trace.head; pos++) {
+		const struct nstrace_span *span = &trace.span[pos % trace.size];
+		uint64_t ts = span->start - trace.origin;
+
+		if (span->start < trace.origin ||
+		    (track != 0 && span->track != track)) {
+			continue;
+		}
+
+		if (span->counter) {
+			fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\","
+				"\"ph\":\"C\",\"ts\":%"PRIu64","
+				"\"pid\":1,\"tid\":%u,"
+				"\"args\":{\"value\":%"PRIu32"}}",
+				sep, span->name, span->cat,
+				ts, span->track, span->duration);
+		} else if (span->id == 0) {
+			fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\","
+				"\"ph\":\"X\",\"ts\":%"PRIu64",\"dur\":%"PRIu32","
+				"\"pid\":1,\"tid\":%u}",
+				sep, span->name, span->cat,
+				ts, span->duration, span->track);
+		} else {
+			fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\","
+				"\"ph\":\"b\",\"id\":%u,\"ts\":%"PRIu64","
+				"\"pid\":1,\"tid\":%u},\n"
+				"{\"name\":\"%s\",\"cat\":\"%s\","
+				"\"ph\":\"e\",\"id\":%u,\"ts\":%"PRIu64","
+				"\"pid\":1,\"tid\":%u}",
+				sep, span->name, span->cat, span->id,
+				ts, span->track,
+				span->name, span->cat, span->id,
+				ts + span->duration, span->track);
+		}
+		sep = ",\n";
+
+		if (span->track <= trace.tracks) {
+			seen[span->track] = true;
+		}
+		written++;
+	}
+
+	/* Name the tracks */
+	for (t = 0; t <= trace.tracks; t++) {
+		if (!seen[t]) {
+			continue;
+		}
+		if (t == 0) {
+			fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\","
+				"\"pid\":1,\"tid\":0,"
+				"\"args\":{\"name\":\"No window\"}}", sep);
+		} else {
+			fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\","
+				"\"pid\":1,\"tid\":%u,"
+				"\"args\":{\"name\":\"Window %u\"}}",
+				sep, t, t);
+		}
+		sep = ",\n";
+	}
+
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	free(seen);
+
+	if (count != NULL) {
+		*count = written;
+	}
+
+	return ferror(fp) ? NSERROR_SAVE_FAILED : NSERROR_OK;
+}
+
+
+/* exported interface documented in utils/trace.h */
+nserror nstrace_write_file(const char *path, unsigned int track,
+		unsigned int *count)
+{
+	nserror res;
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	if (fp == NULL) {
+		return NSERROR_SAVE_FAILED;
+	}
+
+	res = nstrace_write(fp, track, count);
+
+	if (fclose(fp) != 0 && res == NSERROR_OK) {
+		res = NSERROR_SAVE_FAILED;
+	}
+
+	return res;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Performance trace span interface.
+ *
+ * Spans record how long a stage of page loading took.  Each span is
+ * attributed to a track, normally the browser window the work is being
+ * done for, so the spans for one window's page loads can be exported
+ * on their own.  The current track is set with nstrace_enter() by code
+ * which knows which window work is for and is carried through the
+ * fetch, cache and content layers by each of them remembering the
+ * track current when they were created.
+ *
+ * Spans are exported in the Chrome trace event JSON format, which can
+ * be loaded into chrome://tracing or Perfetto.
+ *
+ * When tracing is not enabled recording a span costs a single test.
+ */
+
+#ifndef NETSURF_UTILS_TRACE_H
+#define NETSURF_UTILS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "utils/errors.h"
+
+/** Whether spans are being recorded. */
+extern bool nstrace_enabled;
+
+/** Track spans are currently attributed to, 0 for no window. */
+extern unsigned int nstrace_track;
+
+/**
+ * Start recording spans.
+ *
+ * \param events Number of spans to keep; once reached the oldest spans
+ *               are discarded.
+ * \return NSERROR_OK on success or NSERROR_NOMEM.
+ */
+nserror nstrace_init(unsigned int events);
+
+/**
+ * Stop recording spans and discard those recorded.
+ */
+void nstrace_fini(void);
+
+/**
+ * Allocate a new track.
+ *
+ * \return track id, never 0.
+ */
+unsigned int nstrace_new_track(void);
+
+/**
+ * Get the current trace time.
+ *
+ * \return time in microseconds, never 0.
+ */
+uint64_t nstrace_time(void);
+
+/**
+ * Record a completed span.
+ *
+ * \param cat Span category, a string literal.
+ * \param name Span name, a string literal.
+ * \param start Time span started, from nstrace_time().
+ * \param id 0 for a span which nests within others on its track, or a
+ *           unique id for a span which may overlap others.
+ * \param track Track the span belongs to.
+ */
+void nstrace_record(const char *cat, const char *name, uint64_t start,
+		unsigned int id, unsigned int track);
+
+/**
+ * Record the total duration of many short spans as one span.
+ *
+ * The span ends now.  Unlike other spans it is recorded however short
+ * it is.
+ *
+ * \param cat Span category, a string literal.
+ * \param name Span name, a string literal.
+ * \param duration Total duration, in microseconds.
+ * \param track Track the span belongs to.
+ */
+void nstrace_record_total(const char *cat, const char *name,
+		uint64_t duration, unsigned int track);
+
+/**
+ * Record a counter sample.
+ *
+ * Counters are shown as a graph of their value over time.
+ *
+ * \param cat Counter category, a string literal.
+ * \param name Counter name, a string literal.
+ * \param value Value of the counter now.
+ * \param track Track the sample belongs to.
+ */
+void nstrace_record_counter(const char *cat, const char *name,
+		uint32_t value, unsigned int track);
+
+/**
+ * Write recorded spans as Chrome trace event JSON.
+ *
+ * \param fp File to write to.
+ * \param track Track to write spans of, or 0 for all tracks.
+ * \param count Updated with the number of spans written, may be NULL.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror nstrace_write(FILE *fp, unsigned int track, unsigned int *count);
+
+/**
+ * Write recorded spans as Chrome trace event JSON to a file.
+ *
+ * \param path Path of file to write.
+ * \param track Track to write spans of, or 0 for all tracks.
+ * \param count Updated with the number of spans written, may be NULL.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror nstrace_write_file(const char *path, unsigned int track,
+		unsigned int *count);
+
+/**
+ * Begin a span.
+ *
+ * \return start time to pass to nstrace_end(), 0 if not recording.
+ */
+static inline uint64_t nstrace_begin(void)
+{
+	return nstrace_enabled ? nstrace_time() : 0;
+}
+
+/**
+ * End a span begun with nstrace_begin(), on the current track.
+ *
+ * \param cat Span category, a string literal.
+ * \param name Span name, a string literal.
+ * \param start Value returned by nstrace_begin().
+ */
+static inline void nstrace_end(const char *cat, const char *name,
+		uint64_t start)
+{
+	if (start != 0) {
+		nstrace_record(cat, name, start, 0, nstrace_track);
+	}
+}
+
+/**
+ * Record the total duration of many short spans as one span, on the
+ * current track.
+ *
+ * \param cat Span category, a string literal.
+ * \param name Span name, a string literal.
+ * \param duration Total duration, in microseconds.
+ */
+static inline void nstrace_total(const char *cat, const char *name,
+		uint64_t duration)
+{
+	if (nstrace_enabled && duration != 0) {
+		nstrace_record_total(cat, name, duration, nstrace_track);
+	}
+}
+
+/**
+ * Record a counter sample on the current track.
+ *
+ * \param cat Counter category, a string literal.
+ * \param name Counter name, a string literal.
+ * \param value Value of the counter now.
+ */
+static inline void nstrace_counter(const char *cat, const char *name,
+		uint32_t value)
+{
+	if (nstrace_enabled) {
+		nstrace_record_counter(cat, name, value, nstrace_track);
+	}
+}
+
+/**
+ * Make a track current.
+ *
+ * \param track Track to attribute spans to.
+ * \return the previously current track, to pass to nstrace_leave().
+ */
+static inline unsigned int nstrace_enter(unsigned int track)
+{
+	unsigned int prev = nstrace_track;
+
+	nstrace_track = track;
+
+	return prev;
+}
+
+/**
+ * Restore the track current before nstrace_enter().
+ *
+ * \param prev Value returned by nstrace_enter().
+ */
+static inline void nstrace_leave(unsigned int prev)
+{
+	nstrace_track = prev;
+}
+
+#endif